@@ -94,6 +94,7 @@ SOURCES += main.cpp\
     filters/notesortfilterproxymodel.cpp \
     html/thumbnailer.cpp \
     html/noteformatter.cpp \
+    html/enmltag.cpp \
     settings/startupconfig.cpp \
     dialog/logindialog.cpp \
     gui/lineedit.cpp \
@@ -101,6 +102,7 @@ SOURCES += main.cpp\
     filters/filtercriteria.cpp \
     gui/ntrashtree.cpp \
     filters/filterengine.cpp \
+    filters/filterhistory.cpp \
     models/notecache.cpp \
     gui/nbrowserwindow.cpp \
     threads/indexrunner.cpp \
@@ -132,6 +134,7 @@ SOURCES += main.cpp\
     gui/browserWidgets/colormenu.cpp \
     xml/xmlhighlighter.cpp \
     utilities/mimereference.cpp \
+    utilities/spellcheckservice.cpp \
     dialog/accountdialog.cpp \
     gui/shortcutkeys.cpp \
     dialog/insertlinkdialog.cpp \
@@ -139,6 +142,7 @@ SOURCES += main.cpp\
     dialog/encryptdialog.cpp \
     dialog/insertlatexdialog.cpp \
     gui/plugins/popplerviewer.cpp \
+    gui/plugins/popplerrenderer.cpp \
     gui/plugins/pluginfactory.cpp \
     gui/findreplace.cpp \
     sql/linkednotebooktable.cpp \
@@ -146,11 +150,15 @@ SOURCES += main.cpp\
     dialog/databasestatus.cpp \
     gui/plugins/popplergraphicsview.cpp \
     threads/counterrunner.cpp \
+    threads/maintenancerunner.cpp \
+    threads/notehistoryrunner.cpp \
     gui/nnotebookviewdelegate.cpp \
     gui/ntrashviewdelegate.cpp \
     gui/ntagviewdelegate.cpp \
     watcher/filewatcher.cpp \
     sql/filewatchertable.cpp \
+    sql/pdftexttable.cpp \
+    sql/noteversiontable.cpp \
     watcher/filewatchermanager.cpp \
     dialog/watchfolderadd.cpp \
     dialog/watchfolderdialog.cpp \
@@ -164,10 +172,14 @@ SOURCES += main.cpp\
     gui/truefalsedelegate.cpp \
     gui/browserWidgets/editorbuttonbar.cpp \
     communication/communicationerror.cpp \
+    communication/syncfetcher.cpp \
+    communication/linkedsyncchecker.cpp \
+    communication/noteuploader.cpp \
     dialog/screencapture.cpp \
     gui/imagedelegate.cpp \
     dialog/preferences/searchpreferences.cpp \
     html/attachmenticonbuilder.cpp \
+    html/attachmenticoncache.cpp \
     dialog/locationdialog.cpp \
     gui/browserWidgets/locationeditor.cpp \
     dialog/preferences/localepreferences.cpp \
@@ -209,6 +221,7 @@ SOURCES += main.cpp\
     xml/batchimport.cpp \
     sql/databaseupgrade.cpp \
     email/emailaddress.cpp \
+    email/emailsendtask.cpp \
     email/mimeattachment.cpp \
     email/mimecontentformatter.cpp \
     email/mimefile.cpp \
@@ -218,6 +231,7 @@ SOURCES += main.cpp\
     email/mimemultipart.cpp \
     email/mimepart.cpp \
     email/mimetext.cpp \
+    email/mimewriter.cpp \
     email/quotedprintable.cpp \
     email/smtpclient.cpp \
     dialog/preferences/emailpreferences.cpp \
@@ -284,6 +298,7 @@ HEADERS  += nixnote.h \
     filters/notesortfilterproxymodel.h \
     html/thumbnailer.h \
     html/noteformatter.h \
+    html/enmltag.h \
     settings/startupconfig.h \
     dialog/logindialog.h \
     gui/lineedit.h \
@@ -291,6 +306,7 @@ HEADERS  += nixnote.h \
     filters/filtercriteria.h \
     gui/ntrashtree.h \
     filters/filterengine.h \
+    filters/filterhistory.h \
     models/notecache.h \
     gui/nbrowserwindow.h \
     threads/indexrunner.h \
@@ -322,6 +338,7 @@ HEADERS  += nixnote.h \
     gui/browserWidgets/colormenu.h \
     xml/xmlhighlighter.h \
     utilities/mimereference.h \
+    utilities/spellcheckservice.h \
     dialog/accountdialog.h \
     gui/shortcutkeys.h \
     dialog/insertlinkdialog.h \
@@ -329,6 +346,7 @@ HEADERS  += nixnote.h \
     dialog/encryptdialog.h \
     dialog/insertlatexdialog.h \
     gui/plugins/popplerviewer.h \
+    gui/plugins/popplerrenderer.h \
     gui/plugins/pluginfactory.h \
     gui/findreplace.h \
     sql/linkednotebooktable.h \
@@ -336,11 +354,15 @@ HEADERS  += nixnote.h \
     dialog/databasestatus.h \
     gui/plugins/popplergraphicsview.h \
     threads/counterrunner.h \
+    threads/maintenancerunner.h \
+    threads/notehistoryrunner.h \
     gui/nnotebookviewdelegate.h \
     gui/ntrashviewdelegate.h \
     gui/ntagviewdelegate.h \
     watcher/filewatcher.h \
     sql/filewatchertable.h \
+    sql/pdftexttable.h \
+    sql/noteversiontable.h \
     watcher/filewatchermanager.h \
     dialog/watchfolderadd.h \
     dialog/watchfolderdialog.h \
@@ -352,10 +374,14 @@ HEADERS  += nixnote.h \
     gui/truefalsedelegate.h \
     gui/browserWidgets/editorbuttonbar.h \
     communication/communicationerror.h \
+    communication/syncfetcher.h \
+    communication/linkedsyncchecker.h \
+    communication/noteuploader.h \
     dialog/screencapture.h \
     gui/imagedelegate.h \
     dialog/preferences/searchpreferences.h \
     html/attachmenticonbuilder.h \
+    html/attachmenticoncache.h \
     dialog/locationdialog.h \
     gui/browserWidgets/locationeditor.h \
     dialog/preferences/localepreferences.h \
@@ -408,6 +434,7 @@ HEADERS  += nixnote.h \
     xml/batchimport.h \
     sql/databaseupgrade.h \
     email/emailaddress.h \
+    email/emailsendtask.h \
     email/mimeattachment.h \
     email/mimecontentformatter.h \
     email/mimefile.h \
@@ -417,6 +444,7 @@ HEADERS  += nixnote.h \
     email/mimemultipart.h \
     email/mimepart.h \
     email/mimetext.h \
+    email/mimewriter.h \
     email/quotedprintable.h \
     email/smtpclient.h \
     email/smtpexports.h \
@@ -417,11 +417,7 @@ int CmdLineTool::addNote(StartupConfig config) {
                 file.close();
 
                 MimeReference mimeRef;
-                QString extension = filename;
-                int endPos = filename.lastIndexOf(".");
-                if (endPos != -1)
-                    extension = extension.mid(endPos);
-                QString mime =  mimeRef.getMimeFromExtension(extension);
+                QString mime = mimeRef.getMimeFromData(ba, filename);
                 Resource newRes;
                 bool attachment = true;
                 if (mime == "application/pdf" || mime.startsWith("image/"))
@@ -574,11 +570,7 @@ int CmdLineTool::appendNote(StartupConfig config) {
                 file.close();
 
                 MimeReference mimeRef;
-                QString extension = filename;
-                int endPos = filename.lastIndexOf(".");
-                if (endPos != -1)
-                    extension = extension.mid(endPos);
-                QString mime =  mimeRef.getMimeFromExtension(extension);
+                QString mime = mimeRef.getMimeFromData(ba, filename);
                 Resource newRes;
                 bool attachment = true;
                 if (mime == "application/pdf" || mime.startsWith("image/"))
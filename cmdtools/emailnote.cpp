@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "sql/resourcetable.h"
 #include "sql/notetable.h"
 #include "html/noteformatter.h"
+#include "gui/plugins/popplerviewer.h"
 
 extern Global global;
 
@@ -235,6 +236,7 @@ QString EmailNote::stripContentsForPrint(QString contents) {
         int endPos = contents.indexOf(">", pos);
         QString lidString = contents.mid(contents.indexOf("lid=", pos)+5);
         lidString = lidString.mid(0,lidString.indexOf("\" "));
+        PopplerViewer::writePrintImage(lidString.toInt());
         contents = contents.mid(0,pos) + "<img src=\"file://" +
                 global.fileManager.getTmpDirPath() + lidString +
                 QString("-print.png\" width=\"10%\" height=\"10%\"></img>")+contents.mid(endPos+1);
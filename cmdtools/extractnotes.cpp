@@ -69,9 +69,7 @@ void ExtractNotes::extract() {
                 return;
         }
         NoteTable ntable(global.db);
-        for (int i=0; i<lids.size(); i++) {
-            ntable.deleteNote(lids[i],true);
-        }
+        ntable.deleteMany(lids, true);
     }
 
 }
@@ -19,6 +19,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 
 #include "communicationmanager.h"
+#include "communication/syncfetcher.h"
+#include "communication/noteuploader.h"
 #include "oauth/oauthtokenizer.h"
 #include "global.h"
 
@@ -35,6 +37,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <sql/usertable.h>
 #include <sql/notetable.h>
 #include <QPainter>
+#include <QVector>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -584,6 +587,47 @@ qint32 CommunicationManager::uploadNote(Note &note, QString token) {
 
 
 
+// Upload several of the user's own notes at once.  The notes Evernote
+// accepted are returned in results.  If any failed, the first error is
+// reported the same way uploadNote() does & false is returned.
+bool CommunicationManager::uploadNotes(const QList<qint32> &lids, QList<NoteUploader::Result> &results) {
+    NoteUploader uploader(db, myNoteStore, authToken, global.syncFetchCount);
+    for (int i=0; i<lids.size(); i++)
+        uploader.addNote(lids[i]);
+    bool rc = uploader.upload();
+    results = uploader.uploaded;
+    if (rc)
+        return true;
+
+    try {
+        uploader.error->throwException();
+    } catch (ThriftException e) {
+        QLOG_ERROR() << "ThriftException:";
+        QLOG_ERROR() << "Exception Type:" << e.type();
+        QLOG_ERROR() << "Exception Msg:" << e.what();
+        error.message = errorWhat(e.what());
+        error.type = CommunicationError::ThriftException;
+    } catch (EDAMUserException e) {
+        QLOG_ERROR() << "EDAMUserException:" << e.errorCode;
+        error.code = e.errorCode;
+        error.message = errorWhat(e.what());
+        error.type = CommunicationError::EDAMUserException;
+    } catch (EDAMSystemException e) {
+        QLOG_ERROR() << "EDAMSystemException";
+        handleEDAMSystemException(e);
+    } catch (EDAMNotFoundException e) {
+        QLOG_ERROR() << "EDAMNotFoundException";
+        handleEDAMNotFoundException(e);
+    } catch (EverCloudException e) {
+        QLOG_ERROR() << "EverCloudException:" << e.what();
+        error.message = errorWhat(e.what());
+        error.type = CommunicationError::TTransportException;
+    }
+    return false;
+}
+
+
+
 // delete a note in Evernote
 qint32 CommunicationManager::deleteNote(Guid note, QString token) {
     if (token == "")
@@ -672,6 +716,25 @@ bool CommunicationManager::getSharedNotebookByAuth(SharedNotebook &sharedNoteboo
 }
 
 
+// Point the linked notestore at a notebook's shard using a token that
+// was already obtained (see LinkedSyncChecker).
+void CommunicationManager::useLinkedNotebook(LinkedNotebook &book, QString token) {
+    if (linkedNoteStore != NULL)
+        delete linkedNoteStore;
+    linkedNoteStore = new NoteStore(book.noteStoreUrl, authToken);
+    linkedAuthToken = token;
+    noteStore = linkedNoteStore;
+}
+
+
+
+// Get the token for the user's own account
+QString CommunicationManager::getAuthToken() {
+    return authToken;
+}
+
+
+
 // Authenticate to a linked notebook
 bool CommunicationManager::authenticateToLinkedNotebookShard(LinkedNotebook &book) {
 
@@ -866,6 +929,37 @@ bool CommunicationManager::getNoteVersion(Note &note, QString guid, qint32 usn,
 
 
 
+// Get the binary data of a resource
+bool CommunicationManager::getResourceData(QByteArray &data, QString guid) {
+    try {
+        data = noteStore->getResourceData(guid, authToken);
+        return true;
+    } catch (ThriftException e) {
+        QLOG_ERROR() << "ThriftException:";
+        QLOG_ERROR() << "Exception Type:" << e.type();
+        QLOG_ERROR() << "Exception Msg:" << e.what();
+        error.type = CommunicationError::ThriftException;
+        error.message = errorWhat(e.what());
+        return false;
+    } catch (EDAMUserException e) {
+        QLOG_ERROR() << "EDAMUserException:" << e.errorCode << endl;
+        error.code = e.errorCode;
+        error.message = errorWhat(e.what());
+        error.type = CommunicationError::EDAMUserException;
+        return false;
+    } catch (EDAMSystemException e) {
+        QLOG_ERROR() << "EDAMSystemException";
+        handleEDAMSystemException(e);
+        return false;
+    } catch (EDAMNotFoundException e) {
+        QLOG_ERROR() << "EDAMNotFoundException";
+        handleEDAMNotFoundException(e);
+        return false;
+    }
+}
+
+
+
 // Get a prior version of a notebook
 bool CommunicationManager::getNote(Note &note, QString guid, bool withResource, bool withResourceRecognition, bool withResourceAlternateData) {
     try {
@@ -992,23 +1086,56 @@ void CommunicationManager::checkForInkNotes(QList<Resource> &resources, QString
         if (r->mime.isSet())
             mime = r->mime;
         if (mime == "application/vnd.evernote.ink") {
-            downloadInkNoteImage(r->guid, r, shard, authToken);
+            if (!loadCachedInkNote(r))
+                downloadInkNoteImage(r->guid, r, shard, authToken);
         }
     }
 }
 
 
 
-// Writer function called when curl has an image ready
-size_t curlWriter(void *ptr, size_t size, size_t nmemb, FILE *stream) {
-    size_t written;
-    written = fwrite(ptr, size, nmemb, stream);
-    return written;
+// If an ink note hasn't changed since we last saw it (same guid & USN) reuse
+// the image we already have rather than downloading every slice again.
+bool CommunicationManager::loadCachedInkNote(Resource *r) {
+    if (!r->guid.isSet() || !r->updateSequenceNum.isSet())
+        return false;
+    QString guid = r->guid;
+    qint32 usn = r->updateSequenceNum;
+
+    ResourceTable resTable(db);
+    qint32 lid = resTable.getLid(guid);
+    if (lid <= 0 || resTable.getUpdateSequenceNumber(lid) != usn)
+        return false;
+
+    QByteArray data;
+    if (!resTable.getInkNote(data, lid))
+        return false;
+    QImage *image = new QImage();
+    if (!image->loadFromData(data, "PNG")) {
+        delete image;
+        return false;
+    }
+    QLOG_DEBUG() << "Reusing ink note image for " << guid;
+    QPair<QString, QImage*> *newPair = new QPair<QString, QImage*>();
+    newPair->first = guid;
+    newPair->second = image;
+    inkNoteList->append(newPair);
+    return true;
+}
+
+
+
+// Writer function called when curl has part of an ink note slice ready
+static size_t curlBufferWriter(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    QByteArray *buffer = static_cast<QByteArray*>(userdata);
+    buffer->append(ptr, int(size*nmemb));
+    return size*nmemb;
 }
 
 
 
-// Download an ink note image
+// Download an ink note image.  All of the slices are requested at once
+// into memory and stacked in order once they've arrived.
 void CommunicationManager::downloadInkNoteImage(QString guid, Resource *r, QString shard, QString authToken) {
 // Windows Check
 #ifdef _WIN32
@@ -1042,53 +1169,107 @@ void CommunicationManager::downloadInkNoteImage(QString guid, Resource *r, QStri
     postData.clear();
     postData.addQueryItem("auth", authToken);
 
-    CURL *curl;
-    FILE *fp;
-    CURLcode res;
-
-    curl = curl_easy_init();
-    if (curl) {
-        int position = 0;
-        for (int i=0; i<sliceCount && position >=0; i++) {
-
-            QTemporaryFile tempFile;
-            tempFile.open();
-            tempFile.close();
-            fp = fopen(tempFile.fileName().toStdString().c_str(), "wb");
-
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriter);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
-
+    // The vector is sized up front so the buffers handed to curl never move.
+    // A slice is only accepted once curl, the server and the PNG decoder
+    // all agree it is complete; anything else is requested again.
+    QVector<QByteArray> slices(sliceCount);
+    QVector<QImage> sliceImages(sliceCount);
+    QVector<bool> sliceDone(sliceCount, false);
+    int missing = sliceCount;
+    for (int attempt=0; attempt<INK_SLICE_ATTEMPTS && missing > 0; attempt++) {
+        CURLM *multi = curl_multi_init();
+        if (multi == NULL)
+            return;
+        curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, long(global.syncFetchCount));
+
+        QVector<CURL*> handles(sliceCount, NULL);
+        for (int i=0; i<sliceCount; i++) {
+            if (sliceDone[i])
+                continue;
+            CURL *curl = curl_easy_init();
+            if (curl == NULL)
+                continue;
 #if QT_VERSION < 0x050000
             QString url = urlBase+QString::number(i+1)+"&"+postData.encodedQuery();
 #else
             QString url = urlBase+QString::number(i+1)+"&"+postData.query();
 #endif
+            slices[i].clear();
             curl_easy_setopt(curl, CURLOPT_URL, url.toStdString().c_str());
-            res = curl_easy_perform(curl);
-            QLOG_DEBUG() << "curl inknote result " << res;
-            fclose(fp);
-
-            // Now we have the file, let's read it and add it to the final image
-            QImage replyImage;
-            replyImage.load(tempFile.fileName(), "PNG");
-            tempFile.remove();
-            if (newImage == NULL) {
-                newImage = new QImage(size, replyImage.format());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlBufferWriter);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &slices[i]);
+            curl_multi_add_handle(multi, curl);
+            handles[i] = curl;
+        }
+
+        int running = 0;
+        do {
+            CURLMcode mc = curl_multi_perform(multi, &running);
+            if (mc != CURLM_OK) {
+                QLOG_ERROR() << "curl inknote multi error " << mc;
+                break;
             }
-            position = inkNoteReady(newImage, &replyImage, position);
+            if (running > 0)
+                curl_multi_wait(multi, NULL, 0, 1000, NULL);
+        } while (running > 0);
+
+        CURLMsg *msg;
+        int remaining;
+        while ((msg = curl_multi_info_read(multi, &remaining)) != NULL) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+            int i = handles.indexOf(msg->easy_handle);
+            if (i < 0)
+                continue;
+            long status = 0;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+            if (msg->data.result != CURLE_OK || status != 200) {
+                QLOG_WARN() << "Inknote slice " << i+1 << " of " << guid
+                            << " failed: curl " << msg->data.result << " http " << status;
+                continue;
+            }
+            if (!sliceImages[i].loadFromData(slices[i], "PNG")) {
+                QLOG_WARN() << "Inknote slice " << i+1 << " of " << guid << " is not a valid image";
+                continue;
+            }
+            sliceDone[i] = true;
+            missing--;
         }
 
         // Cleanup
-        curl_easy_cleanup(curl);
+        for (int i=0; i<handles.size(); i++) {
+            slices[i].clear();
+            if (handles[i] == NULL)
+                continue;
+            curl_multi_remove_handle(multi, handles[i]);
+            curl_easy_cleanup(handles[i]);
+        }
+        curl_multi_cleanup(multi);
+    }
 
+    // A partial image would be cached as if it were the real thing, so
+    // leave the resource without one and try again on the next sync.
+    if (missing > 0) {
+        QLOG_ERROR() << "Unable to download " << missing << " of " << sliceCount
+                     << " inknote slices for " << guid;
+        return;
+    }
 
-        // Start writing the resource
-        QPair<QString, QImage*> *newPair = new QPair<QString, QImage*>();
-        newPair->first = guid;
-        newPair->second = newImage;
-        inkNoteList->append(newPair);
+    // Now we have the slices, so stack them into the final image
+    int position = 0;
+    for (int i=0; i<sliceCount && position >=0; i++) {
+        if (newImage == NULL) {
+            newImage = new QImage(size, sliceImages[i].format());
+        }
+        position = inkNoteReady(newImage, &sliceImages[i], position);
+        sliceImages[i] = QImage();
     }
+
+    // Start writing the resource
+    QPair<QString, QImage*> *newPair = new QPair<QString, QImage*>();
+    newPair->first = guid;
+    newPair->second = newImage;
+    inkNoteList->append(newPair);
 #endif // End windows check
 }
 
@@ -1114,16 +1295,27 @@ int CommunicationManager::inkNoteReady(QImage *img, QImage *replyImage, int posi
 //***********************************************************************
 //***********************************************************************
 void CommunicationManager::processSyncChunk(SyncChunk &chunk, QString token) {
-    QHash<QString,QString> noteList;
     QList<Note> notes;
     if (chunk.notes.isSet())
         notes = chunk.notes;
+    QList<Resource> resources;
+    if (chunk.resources.isSet())
+        resources = chunk.resources;
+
+    // Download all of the notes & resources in the chunk.  Several are
+    // downloaded at once, but they come back in the original order.
+    QLOG_DEBUG() << "Fetching " << notes.size() << " notes & " << resources.size() << " resources";
+    SyncFetcher fetcher(noteStore, token, global.syncFetchCount);
+    for (int i=0; i<notes.size(); i++)
+        fetcher.addNote(notes[i].guid);
+    for (int i=0; i<resources.size(); i++)
+        fetcher.addResource(resources[i].guid);
+    if (!fetcher.fetch())
+        fetcher.error->throwException();
+
     for (int i=0; i<notes.size(); i++) {
-        QLOG_TRACE() << "Fetching chunk item: " << i << ": " << notes[i].title;
-        Note n = notes[i];
-        noteList.insert(n.guid,"");
-        n = noteStore->getNote(notes[i].guid, true, true, true, true, token);
-        QLOG_TRACE() << "Note Retrieved";
+        Note n = fetcher.notes[i];
+        QLOG_TRACE() << "Processing chunk item: " << i << ": " << n.title;
 
         // Load up the tag names because Evernote doesn't give them.
         QList<QString> tagNames;
@@ -1138,10 +1330,10 @@ void CommunicationManager::processSyncChunk(SyncChunk &chunk, QString token) {
             }
             n.tagNames = tagNames;
         }
-        QList<Resource> resources;
+        QList<Resource> noteResources;
         if (n.resources.isSet())
-            resources = n.resources;
-        if (resources.size() > 0) {
+            noteResources = n.resources;
+        if (noteResources.size() > 0) {
             QLOG_TRACE() << "Checking for ink note";
             checkForInkNotes(n.resources, "", authToken);
         }
@@ -1150,20 +1342,9 @@ void CommunicationManager::processSyncChunk(SyncChunk &chunk, QString token) {
     if (chunk.notes.isSet())
         chunk.notes = notes;
 
-    QList<Resource> resourceData;
-    QLOG_DEBUG() << "All notes retrieved.  Getting resources";
-    QList<Resource> resources;
-    if (chunk.resources.isSet())
-        resources = chunk.resources;
-    for (int i=0; i<resources.size(); i++) {
-        QLOG_TRACE() << "Fetching chunk resource item: " << i << ": " << resources[i].guid;
-        Resource r;
-        r = noteStore->getResource(resources[i].guid, true, true, true, true, token);
-        QLOG_TRACE() << "Resource retrieved";
-        resourceData.append(r);
-    }
+    resources = fetcher.resources;
     if (chunk.resources.isSet())
-        chunk.resources  = resourceData;
+        chunk.resources  = resources;
     QLOG_DEBUG() << "Getting ink notes";
     if (resources.size()>0) {
         QLOG_TRACE() << "Checking for ink notes";
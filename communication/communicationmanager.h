@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <QString>
 #include "communication/communicationerror.h"
+#include "communication/noteuploader.h"
 
 #include <inttypes.h>
 #include <iostream>
@@ -68,9 +69,12 @@ using namespace std;
 #define SYNC_CHUNK_NOTES                0x0020
 #define SYNC_CHUNK_RESOURCES            0x0040
 
+#define INK_SLICE_ATTEMPTS              3
+
 class CommunicationManager : public QObject
 {
     Q_OBJECT
+    friend class TestNoteHistory;
 
 private:
     bool inkNoteImageDownloaded;              // Is an inknote download ready?
@@ -91,6 +95,7 @@ private:
 
     void downloadInkNoteImage(QString guid, Resource *r, QString shard, QString authToken);   // Function to download ink notes
     void checkForInkNotes(QList<Resource> &resources, QString shard, QString authToken);      // Check if a resource list has any ink notes
+    bool loadCachedInkNote(Resource *r);                                                      // Reuse an unchanged ink note image
 
     QString authToken;                        // Authorization token.
     bool init();                              // Init function.  Run after the thread has started & after first call.
@@ -120,6 +125,8 @@ public:
     bool getLinkedNotebookSyncChunk(SyncChunk &chunk, LinkedNotebook &book, int start, int chunkSize, bool fullSync);   // Get linked notebook sync chunk
     void enDisconnect();                                         // Disconnect from evernote
     bool authenticateToLinkedNotebookShard(LinkedNotebook &book);    // Authenticate to a linked notebook account owner shard
+    void useLinkedNotebook(LinkedNotebook &book, QString token);     // Use an existing linked notebook token
+    QString getAuthToken();                                      // Token for the user's own account
     bool authenticateToLinkedNotebook(AuthenticationResult &authResult, LinkedNotebook &book);   // Authenticate to linked notebook account
     bool getUserInfo(User &user);                              // Get user information
     bool getNote(Note &n, QString guid, bool wthResource, bool withRecognition, bool withResource);
@@ -138,6 +145,7 @@ public:
     qint32 expungeNotebook(Guid guid);                         // Expunge/delete a notebook
 
     qint32 uploadNote(Note &note, QString token="");           // Upload a note to Evernote
+    bool uploadNotes(const QList<qint32> &lids, QList<NoteUploader::Result> &results);   // Upload several notes at once
     qint32 uploadLinkedNote(Note &note);                       // Upload a note to a linked account
     qint32 deleteNote(Guid guid, QString token="");            // Mark a note as deleted (we don't actually expunge)
     qint32 deleteLinkedNote(Guid guid);                        // Mark a note in a linked notebook as deleted
@@ -147,6 +155,7 @@ public:
 
     bool listNoteVersions(QList<NoteVersionId> &list, QString guid);    // Get a list of note revisions
     bool getNoteVersion(Note &note, QString guid, qint32 usn, bool withResourceData=true, bool withResourceRecognition=true, bool withResourceAlternateData=true);  // Download a past version of a note from a linked account
+    bool getResourceData(QByteArray &data, QString guid);        // Download the binary data of a resource
     void loadTagGuidMap();                                     // Load the tag hashmap.
     QString  errorWhat(QString what);                           // help build error string
 
@@ -0,0 +1,192 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "linkedsyncchecker.h"
+#include "global.h"
+
+extern Global global;
+
+
+LinkedSyncChecker::LinkedSyncChecker(QString authToken, int maxRunning, int maxPerShard, QObject *parent) :
+    QObject(parent)
+{
+    this->authToken = authToken;
+    this->maxRunning = qMax(1, maxRunning);
+    this->maxPerShard = qMax(1, maxPerShard);
+    completed = 0;
+    rateLimitReached = false;
+    rateLimitDuration = 0;
+}
+
+
+
+// Queue a linked notebook to be checked
+void LinkedSyncChecker::addNotebook(qint32 lid, const LinkedNotebook &book) {
+    Result result;
+    result.book = book;
+    result.status = Pending;
+    results.insert(lid, result);
+    pending.append(lid);
+}
+
+
+
+// Check everything that was queued.  This doesn't return until every
+// notebook has a result.  A failure only affects its own notebook.
+void LinkedSyncChecker::check() {
+    completed = 0;
+    if (pending.size() == 0)
+        return;
+    startNext();
+    if (running.size() > 0)
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+}
+
+
+
+// Notebooks on the same shard are grouped by shard id.  Older linked
+// notebooks might not have one, so fall back to the notestore URL.
+QString LinkedSyncChecker::shard(const LinkedNotebook &book) {
+    if (book.shardId.isSet())
+        return book.shardId;
+    if (book.noteStoreUrl.isSet())
+        return book.noteStoreUrl;
+    return "";
+}
+
+
+
+// Start as many notebooks as we are allowed without overloading a shard
+void LinkedSyncChecker::startNext() {
+    // Nothing else will get through until the rate limit expires
+    while (rateLimitReached && pending.size() > 0) {
+        results[pending.takeFirst()].status = RateLimited;
+        completed++;
+        emit progress(completed, results.size());
+    }
+    for (int i=0; i<pending.size() && running.size() < maxRunning; i++) {
+        qint32 lid = pending[i];
+        if (!results[lid].book.noteStoreUrl.isSet()) {
+            QLOG_ERROR() << tr("Linked notebook notestore URL missing.");
+            pending.removeAt(i--);
+            results[lid].status = Failed;
+            completed++;
+            emit progress(completed, results.size());
+            continue;
+        }
+        QString key = shard(results[lid].book);
+        if (shardRunning.value(key, 0) >= maxPerShard)
+            continue;
+        pending.removeAt(i--);
+        shardRunning[key] = shardRunning.value(key, 0)+1;
+        authenticate(lid);
+    }
+    if (running.size() == 0 && pending.size() == 0)
+        loop.quit();
+}
+
+
+
+// Connect to the notebook's shard.  Books without a share key are
+// public and don't need to be authenticated.
+void LinkedSyncChecker::authenticate(qint32 lid) {
+    Result &result = results[lid];
+    NoteStore *noteStore = new NoteStore(result.book.noteStoreUrl, authToken, this);
+    noteStores.insert(lid, noteStore);
+    if (!result.book.shareKey.isSet()) {
+        result.token = "<Public Notebook>";
+        getSyncState(lid);
+        return;
+    }
+    AsyncResult *asyncResult = noteStore->authenticateToSharedNotebookAsync(result.book.shareKey, authToken);
+    running.insert(asyncResult, lid);
+    authenticating.insert(lid);
+    connect(asyncResult, SIGNAL(finished(QVariant,QSharedPointer<EverCloudExceptionData>)),
+            this, SLOT(requestFinished(QVariant,QSharedPointer<EverCloudExceptionData>)));
+}
+
+
+
+void LinkedSyncChecker::getSyncState(qint32 lid) {
+    Result &result = results[lid];
+    AsyncResult *asyncResult = noteStores[lid]->getLinkedNotebookSyncStateAsync(result.book, result.token);
+    running.insert(asyncResult, lid);
+    connect(asyncResult, SIGNAL(finished(QVariant,QSharedPointer<EverCloudExceptionData>)),
+            this, SLOT(requestFinished(QVariant,QSharedPointer<EverCloudExceptionData>)));
+}
+
+
+
+void LinkedSyncChecker::requestFinished(QVariant value, QSharedPointer<EverCloudExceptionData> error) {
+    AsyncResult *asyncResult = qobject_cast<AsyncResult*>(sender());
+    if (asyncResult == NULL || !running.contains(asyncResult))
+        return;
+    qint32 lid = running.take(asyncResult);
+    Result &result = results[lid];
+    bool authenticated = !authenticating.remove(lid);
+
+    if (!error.isNull()) {
+        QLOG_ERROR() << "Checking linked notebook " << lid << " failed: " << error->errorMessage;
+        QSharedPointer<EDAMSystemExceptionData> systemError = error.objectCast<EDAMSystemExceptionData>();
+        if (!systemError.isNull() && systemError->errorCode == EDAMErrorCode::RATE_LIMIT_REACHED) {
+            rateLimitReached = true;
+            if (systemError->rateLimitDuration.isSet())
+                rateLimitDuration = qMax(rateLimitDuration, (qint32)systemError->rateLimitDuration);
+            finish(lid, RateLimited, error->errorMessage);
+            return;
+        }
+
+        // Only a refused share key means the notebook is gone.  System errors
+        // & network problems are left for the caller to retry.
+        if (!authenticated && (!error.objectCast<EDAMUserExceptionData>().isNull() ||
+                               !error.objectCast<EDAMNotFoundExceptionData>().isNull()))
+            finish(lid, AuthenticationFailed, error->errorMessage);
+        else
+            finish(lid, Failed, error->errorMessage);
+        return;
+    }
+
+    if (!authenticated) {
+        AuthenticationResult auth = value.value<AuthenticationResult>();
+        result.token = auth.authenticationToken;
+        getSyncState(lid);
+        return;
+    }
+
+    result.syncState = value.value<SyncState>();
+    finish(lid, Ready);
+}
+
+
+
+// A notebook is done.  Free its shard slot & start the next one.
+void LinkedSyncChecker::finish(qint32 lid, Status status, QString message) {
+    Result &result = results[lid];
+    result.status = status;
+    result.message = message;
+    if (status != Ready)
+        result.token = "";
+    QString key = shard(result.book);
+    shardRunning[key] = shardRunning.value(key, 1)-1;
+    if (noteStores.contains(lid))
+        noteStores.take(lid)->deleteLater();
+    completed++;
+    emit progress(completed, results.size());
+    startNext();
+}
@@ -0,0 +1,93 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef LINKEDSYNCCHECKER_H
+#define LINKEDSYNCCHECKER_H
+
+#include <QObject>
+#include <QEventLoop>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QSharedPointer>
+
+#include "qevercloud/include/QEverCloud.h"
+using namespace qevercloud;
+
+
+//************************************************
+//* Authenticate to a set of linked notebooks &
+//* get their sync states.  Several notebooks are
+//* checked at once, with a separate limit on
+//* the number of requests sent to any one shard.
+//************************************************
+
+class LinkedSyncChecker : public QObject
+{
+    Q_OBJECT
+public:
+    enum Status {
+        Pending = 0,
+        Ready = 1,                  // syncState & token are valid
+        AuthenticationFailed = 2,   // Probably no longer shared with us
+        Failed = 3,                 // Anything else.  The caller should retry it on its own.
+        RateLimited = 4             // Not checked because the API rate limit was reached
+    };
+    struct Result {
+        LinkedNotebook book;
+        Status status;
+        QString token;              // Token used to read the notebook
+        SyncState syncState;
+        QString message;
+    };
+
+private:
+    QString authToken;
+    int maxRunning;
+    int maxPerShard;
+    QList<qint32> pending;                    // Notebooks waiting to start
+    QHash<AsyncResult*, qint32> running;      // Requests waiting for a reply
+    QHash<QString, int> shardRunning;         // Notebooks being checked on each shard
+    QHash<qint32, NoteStore*> noteStores;
+    QSet<qint32> authenticating;              // Notebooks waiting on authenticateToSharedNotebook
+    QEventLoop loop;
+    int completed;
+    QString shard(const LinkedNotebook &book);
+    void authenticate(qint32 lid);
+    void getSyncState(qint32 lid);
+    void finish(qint32 lid, Status status, QString message="");
+
+public:
+    explicit LinkedSyncChecker(QString authToken, int maxRunning, int maxPerShard, QObject *parent = 0);
+    QHash<qint32, Result> results;            // Results by linked notebook lid
+    bool rateLimitReached;                    // Evernote refused a request for the rate limit
+    qint32 rateLimitDuration;                 // Seconds until requests are accepted again
+    void addNotebook(qint32 lid, const LinkedNotebook &book);
+    void check();
+
+signals:
+    void progress(int completed, int total);
+
+private slots:
+    void startNext();
+    void requestFinished(QVariant result, QSharedPointer<EverCloudExceptionData> error);
+
+};
+
+#endif // LINKEDSYNCCHECKER_H
@@ -0,0 +1,157 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "noteuploader.h"
+#include "global.h"
+#include "sql/notetable.h"
+#include "sql/nsqlquery.h"
+
+extern Global global;
+
+
+NoteUploader::NoteUploader(DatabaseConnection *db, NoteStore *noteStore, QString token, int maxRunning, QObject *parent) :
+    QObject(parent)
+{
+    this->db = db;
+    this->noteStore = noteStore;
+    this->token = token;
+    this->maxRunning = qMax(1, maxRunning);
+    stopped = false;
+}
+
+
+
+// Queue a note to be uploaded
+void NoteUploader::addNote(qint32 lid) {
+    pending.append(lid);
+}
+
+
+
+// Upload everything that was queued.  This doesn't return until all of
+// the notes are done.  A note that is refused doesn't stop the others,
+// but hitting the rate limit does.  Returns false if anything failed.
+bool NoteUploader::upload() {
+    error.clear();
+    if (pending.size() == 0)
+        return true;
+    startNext();
+    if (running.size() > 0)
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+    return failed.size() == 0;
+}
+
+
+
+// Start as many uploads as we are allowed.
+void NoteUploader::startNext() {
+    while (!stopped && running.size() < maxRunning && pending.size() > 0)
+        start(pending.takeFirst());
+    if (running.size() == 0)
+        loop.quit();
+}
+
+
+
+void NoteUploader::start(qint32 lid) {
+    Note note;
+    NoteTable noteTable(db);
+    noteTable.get(note, lid, true, true, true);
+
+    Result result;
+    result.lid = lid;
+    result.updateSequenceNum = 0;
+    result.created = !note.updateSequenceNum.isSet() || note.updateSequenceNum <= 0;
+
+    AsyncResult *asyncResult;
+    if (result.created)
+        asyncResult = noteStore->createNoteAsync(note, token);
+    else
+        asyncResult = noteStore->updateNoteAsync(note, token);
+    running.insert(asyncResult, result);
+    connect(asyncResult, SIGNAL(finished(QVariant,QSharedPointer<EverCloudExceptionData>)),
+            this, SLOT(requestFinished(QVariant,QSharedPointer<EverCloudExceptionData>)));
+}
+
+
+
+void NoteUploader::requestFinished(QVariant value, QSharedPointer<EverCloudExceptionData> requestError) {
+    AsyncResult *asyncResult = qobject_cast<AsyncResult*>(sender());
+    if (asyncResult == NULL || !running.contains(asyncResult))
+        return;
+    Result result = running.take(asyncResult);
+
+    if (requestError.isNull()) {
+        Note note = value.value<Note>();
+        if (note.updateSequenceNum.isSet())
+            result.updateSequenceNum = note.updateSequenceNum;
+        if (note.guid.isSet())
+            result.guid = note.guid;
+        uploaded.append(result);
+    } else {
+        QLOG_ERROR() << "Upload of note " << result.lid << " failed: " << requestError->errorMessage;
+        failed.append(result.lid);
+        if (error.isNull())
+            error = requestError;
+
+        // Everything else would be refused too, so stop sending
+        QSharedPointer<EDAMSystemExceptionData> systemError = requestError.objectCast<EDAMSystemExceptionData>();
+        if (!systemError.isNull() && systemError->errorCode == EDAMErrorCode::RATE_LIMIT_REACHED) {
+            error = requestError;
+            stopped = true;
+        }
+    }
+    startNext();
+}
+
+
+
+// Record the guid & USN Evernote gave each note & mark it clean.  This
+// is all or nothing: if any of it fails none of it is kept, so the notes
+// are still dirty & the caller must not move its USN past them.
+bool NoteUploader::save(DatabaseConnection *db, const QList<Result> &results) {
+    NoteTable noteTable(db);
+    NSqlQuery transaction(db);
+    if (!transaction.exec("savepoint uploadednotes")) {
+        QLOG_ERROR() << "Unable to record uploaded notes: " << transaction.lastError();
+        return false;
+    }
+    bool ok = true;
+    for (int i=0; i<results.size() && ok; i++) {
+        Result result = results[i];
+        if (result.created && !noteTable.updateGuid(result.lid, result.guid))
+            ok = false;
+        else if (!noteTable.setUpdateSequenceNumber(result.lid, result.updateSequenceNum))
+            ok = false;
+        else if (!noteTable.setDirty(result.lid, false))
+            ok = false;
+        if (!ok)
+            QLOG_ERROR() << "Unable to record upload of note " << result.lid;
+    }
+    if (ok && !transaction.exec("release uploadednotes")) {
+        QLOG_ERROR() << "Unable to record uploaded notes: " << transaction.lastError();
+        ok = false;
+    }
+    if (!ok) {
+        transaction.exec("rollback to uploadednotes");
+        transaction.exec("release uploadednotes");
+    }
+    transaction.finish();
+    return ok;
+}
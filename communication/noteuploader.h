@@ -0,0 +1,78 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef NOTEUPLOADER_H
+#define NOTEUPLOADER_H
+
+#include <QObject>
+#include <QEventLoop>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+
+#include "sql/databaseconnection.h"
+#include "qevercloud/include/QEverCloud.h"
+using namespace qevercloud;
+
+
+//************************************************
+//* Upload a list of dirty notes.  Notes are read
+//* from the database in order just before they
+//* are sent, & only a few are in flight (and in
+//* memory) at once.
+//************************************************
+
+class NoteUploader : public QObject
+{
+    Q_OBJECT
+public:
+    struct Result {
+        qint32 lid;
+        qint32 updateSequenceNum;     // USN Evernote gave the note
+        Guid guid;                    // Guid Evernote gave the note
+        bool created;                 // It was a new note, so the guid changed
+    };
+
+private:
+    DatabaseConnection *db;
+    NoteStore *noteStore;
+    QString token;
+    int maxRunning;
+    QList<qint32> pending;                    // Notes waiting to be read & sent
+    QHash<AsyncResult*, Result> running;      // Notes waiting for a reply
+    QEventLoop loop;
+    bool stopped;
+    void start(qint32 lid);
+
+public:
+    explicit NoteUploader(DatabaseConnection *db, NoteStore *noteStore, QString token, int maxRunning, QObject *parent = 0);
+    QList<Result> uploaded;                   // Notes Evernote accepted
+    QList<qint32> failed;                     // Notes that were not accepted
+    QSharedPointer<EverCloudExceptionData> error;   // The first error reported
+    void addNote(qint32 lid);
+    bool upload();
+    static bool save(DatabaseConnection *db, const QList<Result> &results);
+
+private slots:
+    void startNext();
+    void requestFinished(QVariant result, QSharedPointer<EverCloudExceptionData> error);
+
+};
+
+#endif // NOTEUPLOADER_H
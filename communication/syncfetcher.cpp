@@ -0,0 +1,231 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "syncfetcher.h"
+#include "global.h"
+
+#include <QDir>
+
+extern Global global;
+
+
+SyncFetcher::SyncFetcher(NoteStore *noteStore, QString token, int maxRunning, QObject *parent) :
+    QObject(parent)
+{
+    this->noteStore = noteStore;
+    this->token = token;
+    this->maxRunning = qMax(1, maxRunning);
+    maxAttempts = 3;
+    maxRateLimitWait = 120;
+    stallTimeout = 120;
+    paused = false;
+    resumeTimer.setSingleShot(true);
+    connect(&resumeTimer, SIGNAL(timeout()), this, SLOT(startNext()));
+    stallTimer.setSingleShot(true);
+    connect(&stallTimer, SIGNAL(timeout()), this, SLOT(stalled()));
+}
+
+
+
+// Queue a note to be downloaded
+void SyncFetcher::addNote(Guid guid) {
+    Request request;
+    request.type = NoteRequest;
+    request.guid = guid;
+    request.position = notes.size();
+    request.attempts = 0;
+    notes.append(Note());
+    pending.append(request);
+}
+
+
+
+// Queue a resource to be downloaded
+void SyncFetcher::addResource(Guid guid) {
+    Request request;
+    request.type = ResourceRequest;
+    request.guid = guid;
+    request.position = resources.size();
+    request.attempts = 0;
+    resources.append(Resource());
+    pending.append(request);
+}
+
+
+
+// Download everything that was queued.  This doesn't return until
+// all of the requests are done or one has failed.  If something failed
+// the error is saved & false is returned.
+bool SyncFetcher::fetch() {
+    error.clear();
+    if (pending.size() == 0)
+        return true;
+    startNext();
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+    stallTimer.stop();
+    resumeTimer.stop();
+    return error.isNull();
+}
+
+
+
+// Start as many requests as we are allowed.
+void SyncFetcher::startNext() {
+    paused = false;
+    while (running.size() < maxRunning && pending.size() > 0)
+        start(pending.takeFirst());
+    if (running.size() == 0 && pending.size() == 0)
+        loop.quit();
+    else
+        stallTimer.start(stallTimeout*1000);
+}
+
+
+
+// Nothing has come back for too long.  Abort whatever is still running
+// so one stuck reply can't hang the sync.  Pauses we asked for (rate
+// limits & retries) don't count.
+void SyncFetcher::stalled() {
+    if (resumeTimer.isActive())
+        return;
+    QLOG_ERROR() << "No reply from Evernote in " << stallTimeout << " seconds.  Giving up on " << running.size() << " downloads.";
+    error = QSharedPointer<EverCloudExceptionData>(new EverCloudExceptionData(QStringLiteral("Connection timeout.")));
+    pending.clear();
+    resumeTimer.stop();
+    QList<AsyncResult*> results = running.keys();
+    running.clear();
+    for (int i=0; i<results.size(); i++)
+        results[i]->abort();
+    loop.quit();
+}
+
+
+
+void SyncFetcher::start(Request request) {
+    request.attempts++;
+    AsyncResult *result;
+    if (request.type == NoteRequest)
+        result = noteStore->getNoteAsync(request.guid, true, true, true, true, token);
+    else
+        result = noteStore->getResourceAsync(request.guid, true, true, true, true, token);
+    result->spillLargeData(global.fileManager.getDbaDirPath(), SYNC_SPILL_THRESHOLD);
+    running.insert(result, request);
+    connect(result, SIGNAL(finished(QVariant,QSharedPointer<EverCloudExceptionData>)),
+            this, SLOT(requestFinished(QVariant,QSharedPointer<EverCloudExceptionData>)));
+}
+
+
+
+// Network & HTTP errors are worth retrying.  Errors reported by Evernote
+// itself (not found, permissions, ...) will just happen again.
+bool SyncFetcher::isTransient(QSharedPointer<EverCloudExceptionData> error) {
+    if (!error.objectCast<EvernoteExceptionData>().isNull())
+        return false;
+    if (!error.objectCast<ThriftExceptionData>().isNull())
+        return false;
+    return true;
+}
+
+
+
+void SyncFetcher::requestFinished(QVariant result, QSharedPointer<EverCloudExceptionData> requestError) {
+    AsyncResult *asyncResult = qobject_cast<AsyncResult*>(sender());
+    if (asyncResult == NULL || !running.contains(asyncResult))
+        return;
+    Request request = running.take(asyncResult);
+    stallTimer.start(stallTimeout*1000);
+
+    // Something else already failed.  Just wait for the other requests to finish.
+    if (!error.isNull()) {
+        if (running.size() == 0)
+            loop.quit();
+        return;
+    }
+
+    if (requestError.isNull()) {
+        if (request.type == NoteRequest)
+            notes[request.position] = result.value<Note>();
+        else
+            resources[request.position] = result.value<Resource>();
+        if (!paused)
+            startNext();
+        return;
+    }
+
+    // If we hit the rate limit, stop everything for as long as Evernote asks.
+    // Long waits are treated as errors so the user is told to try again later.
+    QSharedPointer<EDAMSystemExceptionData> systemError = requestError.objectCast<EDAMSystemExceptionData>();
+    if (!systemError.isNull() && systemError->errorCode == EDAMErrorCode::RATE_LIMIT_REACHED) {
+        int duration = systemError->rateLimitDuration.isSet() ? systemError->rateLimitDuration.ref() : 0;
+        if (duration <= maxRateLimitWait) {
+            QLOG_INFO() << "Rate limit reached.  Pausing downloads for " << duration << " seconds.";
+            request.attempts--;
+            pending.prepend(request);
+            paused = true;
+            resumeTimer.start(duration*1000+1000);
+            return;
+        }
+    }
+
+    // Retry network problems with an increasing delay.
+    if (isTransient(requestError) && request.attempts < maxAttempts) {
+        QLOG_DEBUG() << "Retrying download of " << request.guid << ": " << requestError->errorMessage;
+        pending.prepend(request);
+        if (!paused) {
+            paused = true;
+            resumeTimer.start(request.attempts*request.attempts*1000);
+        }
+        return;
+    }
+
+    QLOG_ERROR() << "Download of " << request.guid << " failed: " << requestError->errorMessage;
+    error = requestError;
+    pending.clear();
+    resumeTimer.stop();
+    if (running.size() == 0)
+        loop.quit();
+}
+
+
+
+// A body too large to download into memory is left unset & saved in the
+// dba directory under its hash.  Return that file, or "" if the data has
+// no downloaded body waiting to be stored.
+QString SyncFetcher::spillFile(const Data &data) {
+    if (data.body.isSet() || !data.bodyHash.isSet())
+        return "";
+    QString file = global.fileManager.getDbaDirPath(QString::fromLatin1(data.bodyHash.ref().toHex()) + ".spill");
+    if (!QFile::exists(file))
+        return "";
+    return file;
+}
+
+
+
+// Remove resource bodies which were downloaded to a file but never saved
+// (the sync stopped before the chunk was stored).
+void SyncFetcher::removeSpillFiles() {
+    QDir dir(global.fileManager.getDbaDirPath());
+    QStringList files = dir.entryList(QStringList() << "spill-*.tmp" << "*.spill", QDir::Files);
+    for (int i=0; i<files.size(); i++) {
+        QLOG_DEBUG() << "Removing unsaved download " << files[i];
+        dir.remove(files[i]);
+    }
+}
@@ -0,0 +1,97 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+
+#ifndef SYNCFETCHER_H
+#define SYNCFETCHER_H
+
+#include <QObject>
+#include <QEventLoop>
+#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+
+#include "qevercloud/include/QEverCloud.h"
+using namespace qevercloud;
+
+// Resource bodies bigger than this are downloaded to files in the dba
+// directory instead of being held in memory.
+#define SYNC_SPILL_THRESHOLD 4194304
+
+
+//************************************************
+//* Download the full notes & resources listed in
+//* a sync chunk.  Several requests are kept
+//* running at once.  Results are returned in
+//* the same order they were requested.
+//************************************************
+
+class SyncFetcher : public QObject
+{
+    Q_OBJECT
+private:
+    enum RequestType {
+        NoteRequest = 0,
+        ResourceRequest = 1
+    };
+    struct Request {
+        RequestType type;
+        Guid guid;
+        int position;
+        int attempts;
+    };
+
+    NoteStore *noteStore;
+    QString token;
+    int maxRunning;
+    QList<Request> pending;                   // Requests waiting to start
+    QHash<AsyncResult*, Request> running;     // Requests waiting for a reply
+    QEventLoop loop;
+    QTimer resumeTimer;                       // Restarts requests after a pause
+    QTimer stallTimer;                        // Gives up if no reply arrives for too long
+    bool paused;
+    void start(Request request);
+    bool isTransient(QSharedPointer<EverCloudExceptionData> error);
+
+public:
+    explicit SyncFetcher(NoteStore *noteStore, QString token, int maxRunning, QObject *parent = 0);
+    int maxAttempts;                          // Number of times to try a request
+    int maxRateLimitWait;                     // Longest rate limit pause (seconds) before giving up
+    int stallTimeout;                         // Seconds to wait for a reply before giving up
+    QList<Note> notes;                        // Downloaded notes
+    QList<Resource> resources;                // Downloaded resources
+    QSharedPointer<EverCloudExceptionData> error;   // Error which stopped the download
+    void addNote(Guid guid);
+    void addResource(Guid guid);
+    bool fetch();
+    static QString spillFile(const Data &data);
+    static void removeSpillFiles();
+
+signals:
+
+private slots:
+    void startNext();
+    void stalled();
+    void requestFinished(QVariant result, QSharedPointer<EverCloudExceptionData> error);
+
+};
+
+#endif // SYNCFETCHER_H
@@ -24,6 +24,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "sql/notetable.h"
 #include "sql/resourcetable.h"
 #include "global.h"
+#include "html/thumbnailer.h"
+#include "sql/nsqlquery.h"
+#include "threads/maintenancerunner.h"
+
+#include <QFileInfo>
 
 extern Global global;
 
@@ -54,6 +59,69 @@ DatabaseStatus::DatabaseStatus(QWidget *parent) :
     textGrid->addWidget(new QLabel(QString::number(unindexedResources)),4,2);
     textGrid->addWidget(new QLabel(tr("Thumbnails Needed:")), 5,1);
     textGrid->addWidget(new QLabel(QString::number(thumbnailsNeeded)),5,2);
+    if (global.thumbnailer != NULL) {
+        textGrid->addWidget(new QLabel(tr("Thumbnails Queued:")), 6,1);
+        textGrid->addWidget(new QLabel(QString::number(global.thumbnailer->queueDepth())),6,2);
+        textGrid->addWidget(new QLabel(tr("Thumbnails/Second:")), 7,1);
+        textGrid->addWidget(new QLabel(QString::number(global.thumbnailer->thumbnailsPerSecond(), 'f', 2)),7,2);
+    }
+
+    // Storage health
+    NSqlQuery sql(global.db);
+    qint64 pageSize = 0;
+    qint64 freePages = 0;
+    qint64 cacheSize = 0;
+    sql.exec("pragma page_size");
+    if (sql.next())
+        pageSize = sql.value(0).toLongLong();
+    sql.exec("pragma freelist_count");
+    if (sql.next())
+        freePages = sql.value(0).toLongLong();
+    sql.exec("pragma cache_size");
+    if (sql.next())
+        cacheSize = sql.value(0).toLongLong();
+    sql.finish();
+
+    // A negative cache size is in KiB, a positive one is in pages.
+    if (cacheSize < 0)
+        cacheSize = -cacheSize*1024;
+    else
+        cacheSize = cacheSize*pageSize;
+
+    qint64 databaseSize = QFileInfo(global.fileManager.getDbDirPath("nixnote.db")).size();
+    textGrid->addWidget(new QLabel(tr("Database Size:")), 8,1);
+    textGrid->addWidget(new QLabel(formatSize(databaseSize)),8,2);
+    textGrid->addWidget(new QLabel(tr("Unused Space:")), 9,1);
+    textGrid->addWidget(new QLabel(formatSize(freePages*pageSize)),9,2);
+    textGrid->addWidget(new QLabel(tr("Write-Ahead Log Size:")), 10,1);
+    textGrid->addWidget(new QLabel(formatSize(MaintenanceRunner::walSize())),10,2);
+    textGrid->addWidget(new QLabel(tr("Page Cache:")), 11,1);
+    textGrid->addWidget(new QLabel(formatSize(cacheSize)),11,2);
+    if (global.maintenanceRunner != NULL) {
+        QDateTime checkpointTime, optimizeTime;
+        QString checkpointMode;
+        qint32 checkpointPages;
+        global.maintenanceRunner->getStatus(checkpointTime, checkpointMode, checkpointPages, optimizeTime);
+        QString checkpoint = tr("Never");
+        if (checkpointTime.isValid())
+            checkpoint = checkpointTime.toString(global.dateFormat + " " + global.timeFormat)
+                    + " (" + checkpointMode.toLower() + ", " + QString::number(checkpointPages) + tr(" pages") + ")";
+        QString optimize = tr("Never");
+        if (optimizeTime.isValid())
+            optimize = optimizeTime.toString(global.dateFormat + " " + global.timeFormat);
+        textGrid->addWidget(new QLabel(tr("Last Checkpoint:")), 12,1);
+        textGrid->addWidget(new QLabel(checkpoint),12,2);
+        textGrid->addWidget(new QLabel(tr("Last Optimized:")), 13,1);
+        textGrid->addWidget(new QLabel(optimize),13,2);
+    }
+
+    // Back & forward history
+    QString history = QString::number(global.filterCriteria.size()-global.filterCriteria.firstPosition())
+            + tr(" entries, ") + QString::number(global.filterCriteria.resultCount()) + tr(" cached results");
+    textGrid->addWidget(new QLabel(tr("Navigation History:")), 14,1);
+    textGrid->addWidget(new QLabel(history),14,2);
+    textGrid->addWidget(new QLabel(tr("History Memory:")), 15,1);
+    textGrid->addWidget(new QLabel(formatSize(global.filterCriteria.memoryUsage())),15,2);
 
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
@@ -70,6 +138,19 @@ DatabaseStatus::DatabaseStatus(QWidget *parent) :
 
 
 
+// Show a byte count in a readable form
+QString DatabaseStatus::formatSize(qint64 bytes) {
+    if (bytes < 1024)
+        return QString::number(bytes) + tr(" bytes");
+    if (bytes < 1024*1024)
+        return QString::number(bytes/1024.0, 'f', 1) + tr(" KB");
+    if (bytes < 1024*1024*1024)
+        return QString::number(bytes/(1024.0*1024.0), 'f', 1) + tr(" MB");
+    return QString::number(bytes/(1024.0*1024.0*1024.0), 'f', 2) + tr(" GB");
+}
+
+
+
 // OK button pushed, close the window
 void DatabaseStatus::okPushed() {
     this->close();
@@ -26,6 +26,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 class DatabaseStatus : public QDialog
 {
     Q_OBJECT
+private:
+    QString formatSize(qint64 bytes);
+
 public:
     explicit DatabaseStatus(QWidget *parent = 0);
     QPushButton *ok;
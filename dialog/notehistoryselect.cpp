@@ -74,6 +74,10 @@ void NoteHistorySelect::cancelButtonPressed() {
 
 void NoteHistorySelect::loadData(QList<NoteVersionId> &versions) {
 
+    // The list can be reloaded once a newer list of versions is downloaded
+    list.clear();
+    importButton.setEnabled(false);
+
     // Add the current generation
     QListWidgetItem *item = new QListWidgetItem(&list);
     item->setData(Qt::UserRole, 0);
@@ -69,6 +69,11 @@ SearchPreferences::SearchPreferences(QWidget *parent) :
     mainLayout->addWidget(forceLowerCase,row++,0);
     forceLowerCase->setChecked(global.forceSearchLowerCase);
 
+    searchIndexTrigram = new QCheckBox(tr("Match text anywhere in a word (requires restart & rebuilds the search index)"));
+    mainLayout->addWidget(searchIndexTrigram,row++,0);
+    searchIndexTrigram->setChecked(global.getSearchIndexTrigram());
+    searchIndexTrigram->setEnabled(global.searchIndexFts5);
+
     weight = new QSpinBox(this);
     mainLayout->addWidget(new QLabel(tr("Minimum Image Recognition Weight")), row,0);
     mainLayout->addWidget(weight,row++,1);
@@ -96,4 +101,5 @@ void SearchPreferences::saveValues() {
     global.setForceSearchLowerCase(forceLowerCase->isChecked());
     global.forceSearchLowerCase=forceLowerCase->isChecked();
     global.setBackgroundIndexing(enableBackgroundIndexing->isChecked());
+    global.setSearchIndexTrigram(searchIndexTrigram->isChecked());
 }
@@ -39,6 +39,7 @@ private:
     QCheckBox *tagSelectionOr;          // "OR" tag selections.
     QCheckBox *forceLowerCase;          // Force notes search text to be lower case.  Useful for some non-ASCII languages.
     QCheckBox *enableBackgroundIndexing;  // Do indexing in the background by default.
+    QCheckBox *searchIndexTrigram;      // Match text anywhere in a word (trigram tokenizer)
 
 public:
     explicit SearchPreferences(QWidget *parent = 0);
@@ -0,0 +1,79 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "emailsendtask.h"
+#include "global.h"
+
+extern Global global;
+
+EmailSendTask::EmailSendTask(MimeMessage *message, QString server, int port, SmtpClient::ConnectionType connectionType,
+                             QString userid, QString password) {
+    this->message = message;
+    this->server = server;
+    this->port = port;
+    this->connectionType = connectionType;
+    this->userid = userid;
+    this->password = password;
+}
+
+
+
+// The message doesn't own its parts or addresses, so we clean them up here.
+EmailSendTask::~EmailSendTask() {
+    qDeleteAll(message->getParts());
+    qDeleteAll(message->getRecipients(MimeMessage::To));
+    qDeleteAll(message->getRecipients(MimeMessage::Cc));
+    qDeleteAll(message->getRecipients(MimeMessage::Bcc));
+    delete &message->getSender();
+    delete message;
+}
+
+
+
+void EmailSendTask::run() {
+    // The socket belongs to whichever thread creates it, so the
+    // client has to be created here rather than by the caller.
+    SmtpClient smtp(server, port, connectionType);
+    smtp.setResponseTimeout(-1);
+    smtp.setUser(userid);
+    smtp.setPassword(password);
+    connect(&smtp, SIGNAL(sendProgress(qint64,qint64)), this, SIGNAL(progress(qint64,qint64)), Qt::DirectConnection);
+
+    if (!smtp.connectToHost()) {
+        QLOG_ERROR()<< "Failed to connect to host!";
+        emit failed(tr("Connection Error"), tr("Unable to connect to host."));
+        return;
+    }
+
+    if (!smtp.login()) {
+        QLOG_ERROR() << "Failed to login!";
+        emit failed(tr("Login Error"), tr("Unable to login."));
+        return;
+    }
+
+    if (!smtp.sendMail(*message)) {
+        QLOG_ERROR() << "Failed to send mail!";
+        emit failed(tr("Send Error"), tr("Unable to send email."));
+        return;
+    }
+
+    smtp.quit();
+    emit sent();
+}
@@ -0,0 +1,54 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#ifndef EMAILSENDTASK_H
+#define EMAILSENDTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include "email/smtpclient.h"
+
+// Send an email in the background.  The SMTP conversation blocks,
+// and with large attachments can take minutes, so it is kept off the
+// GUI thread.  The task owns the message & deletes it when done.
+class EmailSendTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+private:
+    MimeMessage *message;
+    QString server;
+    int port;
+    SmtpClient::ConnectionType connectionType;
+    QString userid;
+    QString password;
+
+public:
+    EmailSendTask(MimeMessage *message, QString server, int port, SmtpClient::ConnectionType connectionType,
+                  QString userid, QString password);
+    ~EmailSendTask();
+    void run();
+
+signals:
+    void progress(qint64 bytesSent, qint64 messageSize);
+    void failed(QString title, QString error);
+    void sent();
+};
+
+#endif // EMAILSENDTASK_H
@@ -49,6 +49,13 @@ MimeFile::~MimeFile()
 
 /* [2] Getters and setters */
 
+qint64 MimeFile::getEncodedSize() const
+{
+    if (this->file)
+        return encodedSize(file->size());
+    return MimePart::getEncodedSize();
+}
+
 /* [2] --- */
 
 
@@ -56,7 +63,8 @@ MimeFile::~MimeFile()
 
 void MimeFile::prepare()
 {
-  if (this->file)
+  // When streaming, the file is read as it is written out
+  if (this->file && !streaming)
   {
     file->open(QIODevice::ReadOnly);
     this->content = file->readAll();
@@ -66,5 +74,24 @@ void MimeFile::prepare()
     MimePart::prepare();
 }
 
+bool MimeFile::writeContent(MimeWriter &out)
+{
+    if (!this->file)
+        return MimePart::writeContent(out);
+
+    if (!file->open(QIODevice::ReadOnly))
+        return false;
+    bool result;
+    if (cEncoding == Base64) {
+        result = writeBase64(out, file);
+    } else {
+        this->content = file->readAll();
+        result = MimePart::writeContent(out);
+        this->content.clear();
+    }
+    file->close();
+    return result;
+}
+
 /* [3] --- */
 
@@ -40,6 +40,8 @@ public:
 
     /* [2] Getters and Setters */
 
+    virtual qint64 getEncodedSize() const;
+
     /* [2] --- */
 
 protected:
@@ -55,6 +57,8 @@ protected:
 
     virtual void prepare();
 
+    virtual bool writeContent(MimeWriter &out);
+
     /* [4] --- */
 
 };
@@ -150,6 +150,30 @@ const QList<MimePart*> & MimeMessage::getParts() const
 /* [3] Public Methods */
 
 QString MimeMessage::toString()
+{
+    return headerString() + content->toString();
+}
+
+// Write the message out a piece at a time, so large attachments
+// never have to be held in memory.
+bool MimeMessage::write(MimeWriter &out)
+{
+    if (!out.write(headerString()))
+        return false;
+    return content->write(out);
+}
+
+qint64 MimeMessage::getEncodedSize() const
+{
+    return content->getEncodedSize();
+}
+
+/* [3] --- */
+
+
+/* [4] Protected methods */
+
+QString MimeMessage::headerString()
 {
     QString mime;
 
@@ -250,8 +274,7 @@ QString MimeMessage::toString()
     mime += "\r\n";
     mime += "MIME-Version: 1.0\r\n";
 
-    mime += content->toString();
     return mime;
 }
 
-/* [3] --- */
+/* [4] --- */
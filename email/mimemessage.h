@@ -70,6 +70,10 @@ public:
 
     virtual QString toString();
 
+    bool write(MimeWriter &out);
+
+    qint64 getEncodedSize() const;
+
     /* [3] --- */
 
 protected:
@@ -87,6 +91,13 @@ protected:
     /* [4] --- */
 
 
+    /* [5] Protected methods */
+
+    QString headerString();
+
+    /* [5] --- */
+
+
 };
 
 #endif // MIMEMESSAGE_H
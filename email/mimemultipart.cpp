@@ -57,17 +57,40 @@ void MimeMultiPart::prepare() {
     QList<MimePart*>::iterator it;
 
     content = "";
-    for (it = parts.begin(); it != parts.end(); it++) {
-        content += "--" + cBoundary + "\r\n";
-        (*it)->prepare();
-        content += (*it)->toString();
-    };
 
-    content += "--" + cBoundary + "--\r\n";
+    // When streaming the parts are written by writeContent()
+    if (!streaming) {
+        for (it = parts.begin(); it != parts.end(); it++) {
+            content += "--" + cBoundary + "\r\n";
+            (*it)->prepare();
+            content += (*it)->toString();
+        };
+
+        content += "--" + cBoundary + "--\r\n";
+    }
 
     MimePart::prepare();
 }
 
+bool MimeMultiPart::writeContent(MimeWriter &out) {
+    QList<MimePart*>::iterator it;
+
+    for (it = parts.begin(); it != parts.end(); it++) {
+        if (!out.write("--" + cBoundary + "\r\n"))
+            return false;
+        if (!(*it)->write(out))
+            return false;
+    }
+    return out.write("--" + cBoundary + "--\r\n");
+}
+
+qint64 MimeMultiPart::getEncodedSize() const {
+    qint64 size = 0;
+    for (int i = 0; i < parts.size(); ++i)
+        size += parts[i]->getEncodedSize() + cBoundary.size() + 6;
+    return size;
+}
+
 void MimeMultiPart::setMimeType(const MultiPartType type) {
     this->type = type;
     this->cType = MULTI_PART_NAMES[type];
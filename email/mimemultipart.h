@@ -55,6 +55,8 @@ public:
 
     const QList<MimePart*> & getParts() const;
 
+    virtual qint64 getEncodedSize() const;
+
     /* [2] --- */
 
     /* [3] Public methods */
@@ -66,6 +68,8 @@ public:
     /* [3] --- */
 
 protected:
+    virtual bool writeContent(MimeWriter &out);
+
     QList< MimePart* > parts;
 
     MultiPartType type;
@@ -18,6 +18,10 @@
 
 #include "mimepart.h"
 #include "quotedprintable.h"
+#include <QBuffer>
+
+// Number of encoded lines written at a time when streaming base64
+#define MIME_CHUNK_LINES 1024
 
 /* [1] Constructors and Destructors */
 
@@ -25,6 +29,7 @@ MimePart::MimePart()
 {
     cEncoding = _7Bit;
     prepared = false;
+    streaming = false;
     cBoundary = "";
 }
 
@@ -131,6 +136,29 @@ QString MimePart::toString()
     return mimeString;
 }
 
+// Write the part out a piece at a time instead of building it in
+// memory first.  Large content (files) is read & encoded in chunks.
+bool MimePart::write(MimeWriter &out)
+{
+    // Let prepare() fill in the header, but leave the content to us
+    streaming = true;
+    prepare();
+    streaming = false;
+
+    if (!out.write(mimeString))
+        return false;
+    mimeString = QString();
+    if (!writeContent(out))
+        return false;
+    return out.write(QByteArray("\r\n"));
+}
+
+// About how big the part will be once it is encoded
+qint64 MimePart::getEncodedSize() const
+{
+    return encodedSize(content.size());
+}
+
 /* [3] --- */
 
 
@@ -189,6 +217,12 @@ void MimePart::prepare()
 
     /* === End of Header Prepare === */
 
+    /* When streaming the content is written by writeContent() */
+    if (streaming) {
+        prepared = false;
+        return;
+    }
+
     /* === Content === */
     switch (cEncoding)
     {
@@ -211,4 +245,61 @@ void MimePart::prepare()
     prepared = true;
 }
 
+bool MimePart::writeContent(MimeWriter &out)
+{
+    switch (cEncoding)
+    {
+    case _7Bit:
+        return out.write(QString(content).toLatin1());
+    case _8Bit:
+        return out.write(content);
+    case Base64:
+    {
+        QBuffer buffer;
+        buffer.setData(content);
+        buffer.open(QIODevice::ReadOnly);
+        return writeBase64(out, &buffer);
+    }
+    case QuotedPrintable:
+        return out.write(formatter.format(QuotedPrintable::encode(content), true));
+    }
+    return true;
+}
+
+// Encode a device in base64, a few thousand lines at a time.  The lines
+// are the same as formatting the whole thing at once would give.
+bool MimePart::writeBase64(MimeWriter &out, QIODevice *in)
+{
+    int lineLength = formatter.getMaxLength();
+    int lineBytes = qMax(lineLength/4, 1)*3;
+    lineLength = lineBytes/3*4;
+    bool firstLine = true;
+
+    while (!in->atEnd()) {
+        QByteArray chunk = in->read(lineBytes*MIME_CHUNK_LINES);
+        if (chunk.isEmpty())
+            return false;
+        QByteArray encoded = chunk.toBase64();
+        QByteArray lines;
+        lines.reserve(encoded.size() + (encoded.size()/lineLength+1)*2);
+        for (int i = 0; i < encoded.size(); i += lineLength) {
+            if (!firstLine)
+                lines.append("\r\n");
+            firstLine = false;
+            lines.append(encoded.constData()+i, qMin(lineLength, encoded.size()-i));
+        }
+        if (!out.write(lines))
+            return false;
+    }
+    return true;
+}
+
+qint64 MimePart::encodedSize(qint64 size) const
+{
+    if (cEncoding != Base64)
+        return size;
+    qint64 chars = (size+2)/3*4;
+    return chars + chars/qMax(formatter.getMaxLength(), 1)*2;
+}
+
 /* [4] --- */
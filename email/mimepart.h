@@ -21,6 +21,7 @@
 
 #include <QObject>
 #include "mimecontentformatter.h"
+#include "mimewriter.h"
 
 #include "smtpexports.h"
 
@@ -85,6 +86,10 @@ public:
 
     virtual void prepare();
 
+    virtual bool write(MimeWriter &out);
+
+    virtual qint64 getEncodedSize() const;
+
     /* [3] --- */
 
 
@@ -105,10 +110,22 @@ protected:
 
     QString mimeString;
     bool prepared;
+    bool streaming;
 
     MimeContentFormatter formatter;
 
     /* [4] --- */
+
+
+    /* [5] Protected methods */
+
+    virtual bool writeContent(MimeWriter &out);
+
+    bool writeBase64(MimeWriter &out, QIODevice *in);
+
+    qint64 encodedSize(qint64 size) const;
+
+    /* [5] --- */
 };
 
 #endif // MIMEPART_H
@@ -0,0 +1,106 @@
+/*
+  Copyright (c) 2011-2012 - Tőkés Attila
+
+  This file is part of SmtpClient for Qt.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  See the LICENSE file for more details.
+*/
+
+#include "mimewriter.h"
+
+/* [1] Constructors and Destructors */
+
+// Writes a message to a device a piece at a time.  If the device is
+// slower than we are (a socket) we wait for it to catch up rather than
+// buffering the whole message.  When dotStuffing is set, lines starting
+// with a '.' are escaped as SMTP's DATA command requires.
+MimeWriter::MimeWriter(QIODevice *device, int timeout, bool dotStuffing)
+{
+    this->device = device;
+    this->timeout = timeout;
+    this->dotStuffing = dotStuffing;
+    lineStart = true;
+    bytesWritten = 0;
+}
+
+MimeWriter::~MimeWriter()
+{
+}
+
+/* [1] --- */
+
+
+/* [2] Getters and Setters */
+
+qint64 MimeWriter::getBytesWritten() const
+{
+    return bytesWritten;
+}
+
+/* [2] --- */
+
+
+/* [3] Public methods */
+
+bool MimeWriter::write(const QString &data)
+{
+    return write(data.toUtf8());
+}
+
+bool MimeWriter::write(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return true;
+
+    if (!dotStuffing)
+        return send(data);
+
+    // Double any '.' at the start of a line.  Most data doesn't have
+    // any, so only copy it when we have to.
+    int start = 0;
+    for (int i = 0; i < data.size(); ++i) {
+        if (data[i] == '.' && (i > 0 ? data[i-1] == '\n' : lineStart)) {
+            if (!send(QByteArray::fromRawData(data.constData()+start, i-start+1)))
+                return false;
+            start = i;
+        }
+    }
+    lineStart = data[data.size()-1] == '\n';
+    if (start == 0)
+        return send(data);
+    return send(QByteArray::fromRawData(data.constData()+start, data.size()-start));
+}
+
+/* [3] --- */
+
+
+/* [4] Protected methods */
+
+bool MimeWriter::send(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return true;
+    if (device->write(data) != data.size())
+        return false;
+    bytesWritten += data.size();
+
+    // Don't get too far ahead of the device
+    while (device->bytesToWrite() > MIME_WRITE_BUFFER) {
+        if (!device->waitForBytesWritten(timeout))
+            return false;
+    }
+    emit progress(bytesWritten);
+    return true;
+}
+
+/* [4] --- */
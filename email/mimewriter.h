@@ -0,0 +1,86 @@
+/*
+  Copyright (c) 2011-2012 - Tőkés Attila
+
+  This file is part of SmtpClient for Qt.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  See the LICENSE file for more details.
+*/
+
+#ifndef MIMEWRITER_H
+#define MIMEWRITER_H
+
+#include <QObject>
+#include <QIODevice>
+
+#include "smtpexports.h"
+
+// Most data we let pile up in a socket before waiting for it to be sent
+#define MIME_WRITE_BUFFER 262144
+
+class SMTP_EXPORT MimeWriter : public QObject
+{
+    Q_OBJECT
+public:
+
+    /* [1] Constructors and Destructors */
+
+    MimeWriter(QIODevice *device, int timeout = 60000, bool dotStuffing = false);
+    ~MimeWriter();
+
+    /* [1] --- */
+
+
+    /* [2] Getters and Setters */
+
+    qint64 getBytesWritten() const;
+
+    /* [2] --- */
+
+
+    /* [3] Public methods */
+
+    bool write(const QByteArray &data);
+    bool write(const QString &data);
+
+    /* [3] --- */
+
+protected:
+
+    /* [4] Protected members */
+
+    QIODevice *device;
+    int timeout;
+    bool dotStuffing;
+    bool lineStart;
+    qint64 bytesWritten;
+
+    /* [4] --- */
+
+
+    /* [5] Protected methods */
+
+    bool send(const QByteArray &data);
+
+    /* [5] --- */
+
+signals:
+
+    /* [6] Signals */
+
+    void progress(qint64 bytesWritten);
+
+    /* [6] --- */
+
+};
+
+#endif // MIMEWRITER_H
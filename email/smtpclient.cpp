@@ -35,7 +35,8 @@ SmtpClient::SmtpClient(const QString & host, int port, ConnectionType connection
     authMethod(AuthPlain),
     connectionTimeout(5000),
     responseTimeout(5000),
-    sendMessageTimeout(60000)
+    sendMessageTimeout(60000),
+    messageSize(0)
 {
     setConnectionType(connectionType);
 
@@ -404,7 +405,16 @@ bool SmtpClient::sendMail(MimeMessage& email)
         QLOG_DEBUG() << "SMTP Send Data Response: " << responseCode;
         if (responseCode != 354) return false;
 
-        sendMessage(email.toString());
+        // Stream the message to the server rather than building it
+        // in memory first.  Attachments are read as they are sent.
+        MimeWriter writer(socket, sendMessageTimeout, true);
+        messageSize = email.getEncodedSize();
+        connect(&writer, SIGNAL(progress(qint64)), this, SLOT(messageProgress(qint64)));
+        if (!email.write(writer) || !writer.write(QByteArray("\r\n")))
+        {
+            emit smtpError(SendDataTimeoutError);
+            throw SendMessageTimeoutException();
+        }
 
         // Send \r\n.\r\n to end the mail data
         sendMessage(".");
@@ -492,6 +502,11 @@ void SmtpClient::socketReadyRead()
 {
 }
 
+void SmtpClient::messageProgress(qint64 bytesWritten)
+{
+    emit sendProgress(bytesWritten, qMax(bytesWritten, messageSize));
+}
+
 /* [5] --- */
 
 
@@ -145,6 +145,8 @@ protected:
     QString responseText;
     int responseCode;
 
+    qint64 messageSize;
+
 
     class ResponseTimeoutException {};
     class SendMessageTimeoutException {};
@@ -167,6 +169,7 @@ protected slots:
     void socketStateChanged(QAbstractSocket::SocketState state);
     void socketError(QAbstractSocket::SocketError error);
     void socketReadyRead();
+    void messageProgress(qint64 bytesWritten);
 
     /* [6] --- */
 
@@ -176,6 +179,7 @@ signals:
     /* [7] Signals */
 
     void smtpError(SmtpClient::SmtpError e);
+    void sendProgress(qint64 bytesSent, qint64 messageSize);
 
     /* [7] --- */
 
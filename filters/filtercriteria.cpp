@@ -200,22 +200,18 @@ void FilterCriteria::unsetLid() {
 
 
 
+// The list is implicitly shared, so copying the selection from one
+// history entry to the next doesn't duplicate it until one of them changes.
 void FilterCriteria::getSelectedNotes(QList<qint32> &items) {
     items.clear();
-    if (selectedNotesIsSet) {
-        for (qint32 i=0; i<selectedNotes.size(); i++) {
-            items.append(selectedNotes.at(i));
-        }
-    }
+    if (selectedNotesIsSet)
+        items = selectedNotes;
 }
 
 void FilterCriteria::setSelectedNotes(QList<qint32> &items) {
     selectedNotesIsSet = true;
     valueSet = true;
-    selectedNotes.clear();
-    for (qint32 i=0; i<items.size(); i++) {
-        selectedNotes.append(items.at(i));
-    }
+    selectedNotes = items;
 }
 
 bool FilterCriteria::isSelectedNotesSet() {
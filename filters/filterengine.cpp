@@ -38,6 +38,16 @@ extern Global global;
 FilterEngine::FilterEngine(QObject *parent) :
     QObject(parent)
 {
+    db = global.db;
+}
+
+
+// Filter on a specific database connection.  The results are left in
+// that connection's temporary filter table.
+FilterEngine::FilterEngine(DatabaseConnection *db, QObject *parent) :
+    QObject(parent)
+{
+    this->db = db;
 }
 
 
@@ -46,17 +56,12 @@ void FilterEngine::filter(FilterCriteria *newCriteria, QList<qint32> *results) {
     QLOG_TRACE_IN();
     bool internalSearch = true;
 
-    NSqlQuery sql(global.db);
-    QLOG_DEBUG() << "Purging filters";
-    sql.exec("delete from filter");
-    QLOG_DEBUG() << "Resetting filter table";
-    sql.prepare("Insert into filter (lid) select lid from NoteTable where notebooklid not in (select lid from datastore where key=:closedNotebooks)");
-    sql.bindValue(":closedNotebooks", NOTEBOOK_IS_CLOSED);
-    sql.exec();
-    sql.finish();
-    QLOG_DEBUG() << "Reset complete";
-
-
+    // Searches done for someone else (DBus, the command line, ...) are
+    // run on their own connection so they don't disturb the results
+    // the note list is showing.
+    DatabaseConnection *callerDb = db;
+    if (newCriteria != NULL && db == global.db && global.guiAvailable)
+        db = global.getSearchConnection();
 
     FilterCriteria *criteria = newCriteria;
     if (criteria == NULL)
@@ -64,33 +69,68 @@ void FilterEngine::filter(FilterCriteria *newCriteria, QList<qint32> *results) {
     else
         internalSearch = false;
 
-    QLOG_DEBUG() << "Filtering favorite";
-    filterFavorite(criteria);
-    QLOG_DEBUG() << "Filtering notebooks";
-    filterNotebook(criteria);
-    QLOG_DEBUG() << "Filtering tags";
-    filterTags(criteria);
-    QLOG_DEBUG() << "Filtering trash";
-    filterTrash(criteria);
-    QLOG_DEBUG() << "Filtering search string";
-    filterSearchString(criteria);
-    QLOG_DEBUG() << "Filtering attributes";
-    filterAttributes(criteria);
-    QLOG_DEBUG() << "Filtering complete";
-
-    // Now, re-insert any pinned notes
-    sql.prepare("Insert into filter (lid) select lid from Datastore where key=:key and lid not in (select lid from filter)");
-    sql.bindValue(":key", NOTE_ISPINNED);
-    sql.exec();
-
-    // Remove any selected notes that are not in the filter.
-    NSqlQuery query(global.db);
+    // Going back & forward through the history reuses the results
+    // saved the last time this position was filtered, as long as
+    // nothing has changed in the database since then.
+    bool useHistory = internalSearch && db == global.db;
+    qint64 changesBefore = 0;
+    QString stamp;
     QList<qint32> goodLids;
-    query.exec("select lid from filter;");
-    while (query.next()) {
-        goodLids.append(query.value(0).toInt());
+    if (useHistory) {
+        changesBefore = totalChanges();
+        stamp = resultStamp(changesBefore);
     }
-    query.finish();
+
+    if (useHistory && global.filterCriteria.getResults(global.filterPosition, goodLids, stamp)) {
+        QLOG_DEBUG() << "Restoring " << goodLids.size() << " cached filter results";
+        restoreFilter(goodLids);
+    } else {
+        NSqlQuery sql(db);
+        QLOG_DEBUG() << "Purging filters";
+        sql.exec("delete from filter");
+        QLOG_DEBUG() << "Resetting filter table";
+        sql.prepare("Insert into filter (lid) select lid from NoteTable where notebooklid not in (select lid from datastore where key=:closedNotebooks)");
+        sql.bindValue(":closedNotebooks", NOTEBOOK_IS_CLOSED);
+        sql.exec();
+        sql.finish();
+        QLOG_DEBUG() << "Reset complete";
+
+        QLOG_DEBUG() << "Filtering favorite";
+        filterFavorite(criteria);
+        QLOG_DEBUG() << "Filtering notebooks";
+        filterNotebook(criteria);
+        QLOG_DEBUG() << "Filtering tags";
+        filterTags(criteria);
+        QLOG_DEBUG() << "Filtering trash";
+        filterTrash(criteria);
+        QLOG_DEBUG() << "Filtering search string";
+        filterSearchString(criteria);
+        QLOG_DEBUG() << "Filtering attributes";
+        filterAttributes(criteria);
+        QLOG_DEBUG() << "Filtering complete";
+
+        // Now, re-insert any pinned notes
+        sql.prepare("Insert into filter (lid) select lid from Datastore where key=:key and lid not in (select lid from filter)");
+        sql.bindValue(":key", NOTE_ISPINNED);
+        sql.exec();
+
+        // Remove any selected notes that are not in the filter.
+        NSqlQuery query(db);
+        query.exec("select lid from filter;");
+        while (query.next()) {
+            goodLids.append(query.value(0).toInt());
+        }
+        query.finish();
+
+        if (useHistory)
+            global.filterCriteria.setResults(global.filterPosition, goodLids, stamp);
+    }
+    if (useHistory)
+        global.filterCriteria.addOwnChanges(totalChanges()-changesBefore);
+
+    // Let the other threads know what the note list is now showing.
+    if (internalSearch && db == global.db)
+        global.setFilterSnapshot(goodLids);
 
     if (internalSearch) {
     // Remove any selected notes that are not in the filter.
@@ -112,6 +152,54 @@ void FilterEngine::filter(FilterCriteria *newCriteria, QList<qint32> *results) {
             }
         }
     }
+    db = callerDb;
+}
+
+
+
+// Number of rows changed through this connection since it was opened.
+qint64 FilterEngine::totalChanges() {
+    qint64 changes = 0;
+    NSqlQuery sql(db);
+    sql.exec("select total_changes()");
+    if (sql.next())
+        changes = sql.value(0).toLongLong();
+    sql.finish();
+    return changes;
+}
+
+
+
+// Describe the state of the database a filter result is good for.  It
+// changes when another connection commits, when this connection changes
+// anything other than the filter table, or when the day changes (for
+// things like "created since today").
+QString FilterEngine::resultStamp(qint64 changes) {
+    qint64 dataVersion = 0;
+    NSqlQuery sql(db);
+    sql.exec("pragma data_version");
+    if (sql.next())
+        dataVersion = sql.value(0).toLongLong();
+    sql.finish();
+    return QString::number(dataVersion) + ":"
+            + QString::number(changes-global.filterCriteria.getOwnChanges()) + ":"
+            + QDate::currentDate().toString(Qt::ISODate);
+}
+
+
+
+// Load previously saved results into the filter table.
+void FilterEngine::restoreFilter(const QList<qint32> &lids) {
+    NSqlQuery sql(db);
+    sql.exec("savepoint restoreFilter");
+    sql.exec("delete from filter");
+    sql.prepare("insert into filter (lid) values (:lid)");
+    for (int i=0; i<lids.size(); i++) {
+        sql.bindValue(":lid", lids[i]);
+        sql.exec();
+    }
+    sql.exec("release restoreFilter");
+    sql.finish();
 }
 
 
@@ -122,7 +210,7 @@ void FilterEngine::filterAttributes(FilterCriteria *criteria) {
     QLOG_TRACE_IN();
 
     int attribute = criteria->getAttribute()->data(0,Qt::UserRole).toInt();
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     QDateTime dt;
     dt.setDate(QDate().currentDate());
     int dow = QDate().currentDate().dayOfWeek();
@@ -427,7 +515,7 @@ void FilterEngine::filterFavorite(FilterCriteria *criteria) {
         return;
     QLOG_TRACE_IN();
 
-    FavoritesTable ftable(global.db);
+    FavoritesTable ftable(db);
     FavoritesRecord rec;
     if (!ftable.get(rec, criteria->getFavorite()))
         return;
@@ -438,7 +526,7 @@ void FilterEngine::filterFavorite(FilterCriteria *criteria) {
         rec.type == FavoritesRecord::SharedNotebook ||
         rec.type == FavoritesRecord::SynchronizedNotebook) {
         qint32 notebookLid = rec.target.toInt();
-        NotebookTable ntable(global.db);
+        NotebookTable ntable(db);
         QString guid="";
         if (ntable.getGuid(guid, notebookLid)) {
             filterIndividualNotebook(guid);
@@ -454,9 +542,9 @@ void FilterEngine::filterFavorite(FilterCriteria *criteria) {
     }
 
     if (rec.type == FavoritesRecord::Tag) {
-        NoteTable noteTable(global.db);
-        TagTable tagTable(global.db);
-        NSqlQuery sql(global.db);
+        NoteTable noteTable(db);
+        TagTable tagTable(db);
+        NSqlQuery sql(db);
         sql.exec("create temporary table if not exists goodLids (lid integer)");
         sql.exec("delete from goodLids");
         QList<qint32> notes;
@@ -473,7 +561,7 @@ void FilterEngine::filterFavorite(FilterCriteria *criteria) {
     }
 
     if (rec.type == FavoritesRecord::Note) {
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.prepare("delete from filter where lid <> :lid");
         sql.bindValue(":lid", rec.target);
         sql.exec();
@@ -494,7 +582,7 @@ void FilterEngine::filterNotebook(FilterCriteria *criteria) {
     } else {
         FilterCriteria *criteria = global.filterCriteria[global.filterPosition];
         qint32 notebookLid = criteria->getNotebook()->data(0,Qt::UserRole).toInt();
-        NotebookTable notebookTable(global.db);
+        NotebookTable notebookTable(db);
         QString notebook;
         notebookTable.getGuid(notebook, notebookLid);
         filterIndividualNotebook(notebook);
@@ -507,10 +595,10 @@ void FilterEngine::filterNotebook(FilterCriteria *criteria) {
 // If they only chose one notebook, then delete everything else
 void FilterEngine::filterIndividualNotebook(QString &notebook) {
     QLOG_TRACE_IN();
-    NotebookTable notebookTable(global.db);
+    NotebookTable notebookTable(db);
     qint32 notebookLid = notebookTable.getLid(notebook);
     // Filter out the records
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     sql.prepare("Delete from filter where lid not in (select lid from DataStore where key=:type and data=:notebookLid)");
     sql.bindValue(":type", NOTE_NOTEBOOK_LID);
     sql.bindValue(":notebookLid", notebookLid);
@@ -530,13 +618,13 @@ void FilterEngine::filterStack(QString &stack) {
     if (stack.startsWith("stack:"))
         stack = stack.mid(stack.indexOf("stack:")+6);
 
-    NotebookTable notebookTable(global.db);
+    NotebookTable notebookTable(db);
     QList<qint32> books;
     QList<qint32> stackBooks;
     notebookTable.getAll(books);
     notebookTable.getStack(stackBooks, stack);
 
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     if (negative) {
         sql.exec("create temporary table if not exists goodLids (lid integer)");
         sql.exec("delete from goodLids");
@@ -574,7 +662,7 @@ void FilterEngine::filterTags(FilterCriteria *criteria) {
     QList<QTreeWidgetItem*> tags = criteria->getTags();
 
     if (!global.getTagSelectionOr()) {
-        NSqlQuery query(global.db);
+        NSqlQuery query(db);
         for (qint32 i=0; i<tags.size(); i++) {
             query.prepare("Delete from filter where lid not in (select lid from datastore where key=:notetagkey and data=:data)");
             query.bindValue(":notetagkey", NOTE_TAG_LID);
@@ -583,8 +671,8 @@ void FilterEngine::filterTags(FilterCriteria *criteria) {
         }
         query.finish();
     } else {
-        NoteTable noteTable(global.db);
-        TagTable tagTable(global.db);
+        NoteTable noteTable(db);
+        TagTable tagTable(db);
         QList<qint32> goodNotes;
         for (qint32 i=0; i<tags.size(); i++) {
             QList<qint32> notes;
@@ -597,7 +685,7 @@ void FilterEngine::filterTags(FilterCriteria *criteria) {
             }
         }
 
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.exec("create temporary table if not exists goodLids (lid integer)");
         sql.exec("delete from goodLids");
         sql.prepare("insert into goodLids (lid) values (:note)");
@@ -616,7 +704,7 @@ void FilterEngine::filterTrash(FilterCriteria *criteria) {
     if (!criteria->isSet() || !criteria->isDeletedOnlySet()
             || (criteria->isDeletedOnlySet() && !criteria->getDeletedOnly()))
     {
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.prepare("Delete from filter where lid not in (select lid from DataStore where key=:type and data=1)");
         sql.bindValue(":type", NOTE_ACTIVE);
         sql.exec();
@@ -627,7 +715,7 @@ void FilterEngine::filterTrash(FilterCriteria *criteria) {
         return;
 
     // Filter out the records
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     sql.prepare("Delete from filter where lid not in (select lid from DataStore where key=:type and data=0)");
     sql.bindValue(":type", NOTE_ACTIVE);
     sql.exec();
@@ -716,12 +804,34 @@ void FilterEngine::splitSearchTerms(QStringList &words, QString search) {
 }
 
 
+// Build the full text match expression for a single search term.  Every term is
+// searched as a prefix unless told otherwise.  FTS5 treats most punctuation as query
+// syntax, so there the term is always quoted as a phrase.  The trigram tokenizer
+// already matches anywhere in a word & doesn't support prefix queries.
+QString FilterEngine::matchTerm(QString term, bool prefix) {
+    term = term.trimmed();
+    if (!global.searchIndexFts5) {
+        if (prefix && !term.endsWith("*"))
+            term = term +QString("*");
+        if (term.contains(" "))
+            term = "\""+term+"\"";
+        return term;
+    }
+    while (term.endsWith("*"))
+        term.chop(1);
+    term = "\"" +term.replace("\"", "\"\"") +"\"";
+    if (prefix && !global.searchIndexTrigram)
+        term = term + "*";
+    return term;
+}
+
+
 // Filter based upon the words the user specified (as opposed to the notebook, tags ...)
 // this is for the "all" filter (the default), not the "any:"
 void FilterEngine::filterSearchStringAll(QStringList list) {
     QLOG_TRACE_IN();
     // Filter out the records
-    NSqlQuery sql(global.db), sqlnegative(global.db);
+    NSqlQuery sql(db), sqlnegative(db);
 
     sql.prepare(QString("Delete from filter where lid not in ") +
                 QString("(select lid from SearchIndex where weight>=:weight and content match :word)") +
@@ -830,7 +940,7 @@ void FilterEngine::filterSearchStringAll(QStringList list) {
             string = string.replace("*", "%");
             if (!string.endsWith("%"))
                 string = string +QString("%");
-            NSqlQuery prefix(global.db);
+            NSqlQuery prefix(db);
             prefix.prepare("Delete from filter where lid in (select lid from SearchIndex where weight>=:weight and content like :word) or lid in (select data from DataStore where lid in (select lid from SearchIndex where weight>:weight2 and content like :word2))");
 
             prefix.bindValue(":weight", global.getMinimumRecognitionWeight());
@@ -846,7 +956,7 @@ void FilterEngine::filterSearchStringAll(QStringList list) {
                 string = string +QString("%");
             if (!string.startsWith("%"))
                 string = QString("%") + string;
-            NSqlQuery prefix(global.db);
+            NSqlQuery prefix(db);
             prefix.prepare("Delete from filter where lid not in (select lid from SearchIndex where weight>=:weight and content like :word escape '/') and lid not in (select data from DataStore where key=:key and lid in (select lid from SearchIndex where weight>:weight2 and content like :word2 escape '/'))");
 
             prefix.bindValue(":weight", global.getMinimumRecognitionWeight());
@@ -862,7 +972,7 @@ void FilterEngine::filterSearchStringAll(QStringList list) {
                 string = string +QString("%");
             if (!string.startsWith("%"))
                 string = QString("%") + string;
-            NSqlQuery prefix(global.db);
+            NSqlQuery prefix(db);
             prefix.prepare("Delete from filter where lid not in (select lid from SearchIndex where weight>=:weight and content like :word) and lid not in (select data from DataStore where key=:key and lid in (select lid from SearchIndex where weight>:weight2 and content like :word2))");
 
             prefix.bindValue(":weight", global.getMinimumRecognitionWeight());
@@ -876,7 +986,7 @@ void FilterEngine::filterSearchStringAll(QStringList list) {
             string = string.replace("*", "%");
             if (!string.endsWith("%"))
                 string = string +QString("%");
-            NSqlQuery prefix(global.db);
+            NSqlQuery prefix(db);
             prefix.prepare("Delete from filter where lid not in (select lid from SearchIndex where weight>=:weight and content like :word) and lid not in (select data from DataStore where key=:key and lid in (select lid from SearchIndex where weight>:weight2 and content like :word2))");
 
             prefix.bindValue(":weight", global.getMinimumRecognitionWeight());
@@ -889,20 +999,13 @@ void FilterEngine::filterSearchStringAll(QStringList list) {
         else { // Filter not found.  Use FTS search
             QLOG_TRACE() << "Using FTS search";
             if (string.startsWith("-")) {
-                string = string.remove(0,1).trimmed();
-                if (!string.endsWith("*"))
-                    string = string +QString("*");
-                if (string.contains(" "))
-                    string = "\""+string+"\"";
+                string = matchTerm(string.remove(0,1));
                 sqlnegative.bindValue(":key", RESOURCE_NOTE_LID);
                 sqlnegative.bindValue(":word", string);
                 sqlnegative.bindValue(":word2", string);
                 sqlnegative.exec();
             } else {
-                if (!string.endsWith("*"))
-                    string = string +QString("*");
-                if (string.contains(" "))
-                    string = "\""+string+"\"";
+                string = matchTerm(string);
                 sql.bindValue(":key", RESOURCE_NOTE_LID);
                 sql.bindValue(":word", string);
                 sql.bindValue(":word2", string);
@@ -927,7 +1030,7 @@ void FilterEngine::filterSearchStringIntitleAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         string = string.replace("*", "%");
         if (!string.endsWith("%"))
             string = string +QString("%");
@@ -944,7 +1047,7 @@ void FilterEngine::filterSearchStringIntitleAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             string = QString("%") +string +QString("%");
@@ -973,7 +1076,7 @@ void FilterEngine::filterSearchStringCoordinatesAll(QString string, int key) {
         if (string == "")
             string = "0";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.prepare("Delete from filter where lid not in (select lid from datastore where key=:key and data >= :data)");
         sql.bindValue(":key", key);
         sql.bindValue(":data", string.toDouble());
@@ -983,7 +1086,7 @@ void FilterEngine::filterSearchStringCoordinatesAll(QString string, int key) {
         if (string == "")
             string = "0";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.prepare("Delete from filter where lid in (select lid from datastore where key=:key and data <= :data)");
         sql.bindValue(":key", key);
         sql.bindValue(":data", string.toDouble());
@@ -1006,7 +1109,7 @@ void FilterEngine::filterSearchStringAuthorAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid in (select lid from datastore where key=:key and data like :data)");
@@ -1020,7 +1123,7 @@ void FilterEngine::filterSearchStringAuthorAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -1049,7 +1152,7 @@ void FilterEngine::filterSearchStringSourceAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid in (select lid from datastore where key=:key and data like :data)");
@@ -1063,7 +1166,7 @@ void FilterEngine::filterSearchStringSourceAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -1092,7 +1195,7 @@ void FilterEngine::filterSearchStringContentClassAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid in (select lid from datastore where key=:key and data like :data)");
@@ -1106,7 +1209,7 @@ void FilterEngine::filterSearchStringContentClassAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -1133,7 +1236,7 @@ void FilterEngine::filterSearchStringPlaceNameAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid in (select lid from datastore where key=:key and data like :data)");
@@ -1147,7 +1250,7 @@ void FilterEngine::filterSearchStringPlaceNameAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -1176,7 +1279,7 @@ void FilterEngine::filterSearchStringSourceApplicationAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid in (select lid from datastore where key=:key and data like :data)");
@@ -1190,7 +1293,7 @@ void FilterEngine::filterSearchStringSourceApplicationAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("Delete from filter where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -1216,7 +1319,7 @@ void FilterEngine::filterSearchStringResourceAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             sql.prepare("Delete from filter where lid not in (select data from datastore where key=:notelidkey and lid in (select lid from DataStore where key=:mimekey and data=:data))");
@@ -1232,7 +1335,7 @@ void FilterEngine::filterSearchStringResourceAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             sql.prepare("Delete from filter where lid in (select data from datastore where key=:notelidkey and lid in (select lid from DataStore where key=:mimekey and data like :data))");
@@ -1257,7 +1360,7 @@ void FilterEngine::filterSearchStringResourceRecognitionTypeAll(QString string)
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             sql.prepare("Delete from filter where lid not in (select data from datastore where key=:notelidkey and lid in (select lid from DataStore where key=:mimekey and data=:data))");
@@ -1273,7 +1376,7 @@ void FilterEngine::filterSearchStringResourceRecognitionTypeAll(QString string)
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             sql.prepare("Delete from filter where lid in (select data from datastore where key=:notelidkey and lid in (select lid from DataStore where key=:mimekey and data like :data))");
@@ -1297,7 +1400,7 @@ void FilterEngine::filterSearchStringTagAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         if (not string.contains("*"))
             tagSql.prepare("Delete from filter where lid not in (select lid from datastore where key=:notetagkey and data in (select lid from DataStore where data=:tagname and key=:tagnamekey))");
         else {
@@ -1315,7 +1418,7 @@ void FilterEngine::filterSearchStringTagAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         if (not string.contains("*"))
             tagSql.prepare("Delete from filter where lid in (select lid from datastore where key=:notetagkey and data in (select lid from DataStore where data=:tagname and key=:tagnamekey))");
         else {
@@ -1341,7 +1444,7 @@ void FilterEngine::filterSearchStringNotebookAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery notebookSql(global.db);
+        NSqlQuery notebookSql(db);
         if (not string.contains("*"))
             notebookSql.prepare("Delete from filter where lid not in (select lid from NoteTable where notebook = :notebook)");
         else {
@@ -1358,7 +1461,7 @@ void FilterEngine::filterSearchStringNotebookAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery notebookSql(global.db);
+        NSqlQuery notebookSql(db);
         if (not string.contains("*"))
             notebookSql.prepare("Delete from filter where lid not in (select lid from NoteTable where notebook <> :notebook)");
         else {
@@ -1386,7 +1489,7 @@ void FilterEngine::filterSearchStringTodoAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("Delete from filter where lid not in (select lid from DataStore where key=:key1 or key=:key2)");
             sql.bindValue(":key1", NOTE_HAS_TODO_COMPLETED);
@@ -1407,7 +1510,7 @@ void FilterEngine::filterSearchStringTodoAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("Delete from filter where lid in (select lid from DataStore where key=:key1 or key=:key2)");
             sql.bindValue(":key1", NOTE_HAS_TODO_COMPLETED);
@@ -1445,7 +1548,7 @@ void FilterEngine::filterSearchStringReminderOrderAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("Delete from filter where lid not in (select lid from DataStore where key=:key1)");
             sql.bindValue(":key1", NOTE_ATTRIBUTE_REMINDER_ORDER);
@@ -1462,7 +1565,7 @@ void FilterEngine::filterSearchStringReminderOrderAll(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("Delete from filter where lid in (select lid from DataStore where key=:key1)");
             sql.bindValue(":key1", NOTE_ATTRIBUTE_REMINDER_ORDER);
@@ -1486,7 +1589,7 @@ void FilterEngine::filterSearchStringDateAll(QString string) {
     int separator = string.indexOf(":")+1;
     QString tempString = string.mid(separator);
     QDateTime dt = calculateDateTime(tempString);
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     int key=0;
 
     if (string.startsWith("created:", Qt::CaseInsensitive)) {
@@ -1615,20 +1718,20 @@ QDateTime FilterEngine::calculateDateTime(QString string) {
 void FilterEngine::filterSearchStringAny(QStringList list) {
     QLOG_TRACE_IN();
     // Filter out the records
-    NSqlQuery sql(global.db), sqlnegative(global.db);
-    NSqlQuery resSql(global.db), resSqlNegative(global.db);
+    NSqlQuery sql(db), sqlnegative(db);
+    NSqlQuery resSql(db), resSqlNegative(db);
 
-    sql.exec("create table if not exists anylidsfilter (lid int);");
+    sql.exec("create temporary table if not exists anylidsfilter (lid int);");
     sql.exec("delete from anylidsfilter");
 
-    sql.exec("create table if not exists anylidsfilterRes (lid int);");
+    sql.exec("create temporary table if not exists anylidsfilterRes (lid int);");
     sql.exec("delete from anylidsfilterRes");
 
     sql.prepare("insert into anylidsfilter (lid) select lid from SearchIndex where weight>=:weight and source='text' and content match :word");
-    resSql.prepare("insert into anylidsfilterRes (lid) select lid from SearchIndex where source='recognition' and weight>=:weight and content match :word");
+    resSql.prepare("insert into anylidsfilterRes (lid) select lid from SearchIndex where (source='recognition' or source like 'pdf:%') and weight>=:weight and content match :word");
 
     sqlnegative.prepare("insert into anylidsfilter (lid) select lid from SearchIndex where lid not in (select lid from searchindex where source='text' and weight>=:weight and content match :word)");
-    resSqlNegative.prepare("insert into anylidsfilterRes (lid) select lid from SearchIndex where lid not in (select lid from searchindex where source='recognition' and weight>=:weight and content match :word)");
+    resSqlNegative.prepare("insert into anylidsfilterRes (lid) select lid from SearchIndex where lid not in (select lid from searchindex where (source='recognition' or source like 'pdf:%') and weight>=:weight and content match :word)");
 
     sql.bindValue(":weight", global.getMinimumRecognitionWeight());
     sqlnegative.bindValue(":weight", global.getMinimumRecognitionWeight());
@@ -1716,15 +1819,16 @@ void FilterEngine::filterSearchStringAny(QStringList list) {
         }
         else { // Filter not found
             if (string.startsWith("-")) {
-                string = string.remove(0,1);
-                sqlnegative.bindValue(":word", string.trimmed()+"*");
+                string = matchTerm(string.remove(0,1));
+                sqlnegative.bindValue(":word", string);
                 sqlnegative.exec();
-                resSqlNegative.bindValue(":word", string.trimmed()+"*");
+                resSqlNegative.bindValue(":word", string);
                 resSqlNegative.exec();
             } else {
-                sql.bindValue(":word", string.trimmed()+"*");
+                string = matchTerm(string);
+                sql.bindValue(":word", string);
                 sql.exec();
-                resSql.bindValue(":word", string.trimmed()+"*");
+                resSql.bindValue(":word", string);
                 resSql.exec();
             }
         }
@@ -1751,7 +1855,7 @@ void FilterEngine::filterSearchStringNotebookAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery notebookSql(global.db);
+        NSqlQuery notebookSql(db);
         if (not string.contains("*"))
             notebookSql.prepare("insert into anylidsfilter (lid) select lid from NoteTable where notebook=:notebook");
         else {
@@ -1766,7 +1870,7 @@ void FilterEngine::filterSearchStringNotebookAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery notebookSql(global.db);
+        NSqlQuery notebookSql(db);
         if (not string.contains("*"))
             notebookSql.prepare("insert into anylidsfilter (lid) select lid from NoteTable where notebook <> :notebook");
         else {
@@ -1791,7 +1895,7 @@ void FilterEngine::filterSearchStringTodoAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("insert into anylidsfilter (lid) select lid from DataStore where key=:key1 or key=:key2");
             sql.bindValue(":key1", NOTE_HAS_TODO_COMPLETED);
@@ -1812,7 +1916,7 @@ void FilterEngine::filterSearchStringTodoAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("insert into anylidsfilter (lid) select lid from DataStore where key<>:key1 or key<>:key2");
             sql.bindValue(":key1", NOTE_HAS_TODO_COMPLETED);
@@ -1845,7 +1949,7 @@ void FilterEngine::filterSearchStringReminderOrderAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("insert into anylidsfilter (lid) select lid from DataStore where key=:key1");
             sql.bindValue(":key1", NOTE_ATTRIBUTE_REMINDER_ORDER);
@@ -1862,7 +1966,7 @@ void FilterEngine::filterSearchStringReminderOrderAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.startsWith("*")) {
             sql.prepare("insert into anylidsfilter (lid) select distinct lid from DataStore where lid not in (select lid from DataStore where key = :key)");
             sql.bindValue(":key", NOTE_ATTRIBUTE_REMINDER_ORDER);
@@ -1889,7 +1993,7 @@ void FilterEngine::filterSearchStringTagAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         if (not string.contains("*"))
             tagSql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:notetagkey and data in (select lid from DataStore where data=:tagname and key=:tagnamekey)");
         else {
@@ -1907,7 +2011,7 @@ void FilterEngine::filterSearchStringTagAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         if (not string.contains("*"))
             tagSql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select lid from datastore where key=:notetagkey and data in (select lid from DataStore where data=:tagname and key=:tagnamekey))");
         else {
@@ -1934,7 +2038,7 @@ void FilterEngine::filterSearchStringIntitleAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             string = QString("%") +string +QString("%");
@@ -1950,7 +2054,7 @@ void FilterEngine::filterSearchStringIntitleAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery tagSql(global.db);
+        NSqlQuery tagSql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             string = QString("%") +string +QString("%");
@@ -1975,7 +2079,7 @@ void FilterEngine::filterSearchStringResourceAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             sql.prepare("insert into anylidsfilter (lid) select data from datastore where key=:notelidkey and lid in (select lid from DataStore where key=:mimekey and data=:data)");
@@ -1992,7 +2096,7 @@ void FilterEngine::filterSearchStringResourceAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         string = string.replace("*", "%");
         if (not string.contains("%"))
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select data from datastore where key=:notelid and lid in (select lid from DataStore where data=:data and key = :mimekey))");
@@ -2023,7 +2127,7 @@ void FilterEngine::filterSearchStringCoordinatesAny(QString string, int key) {
         if (string == "")
             string = "0";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data >= :data");
         sql.bindValue(":key", key);
         sql.bindValue(":data", string.toDouble());
@@ -2033,7 +2137,7 @@ void FilterEngine::filterSearchStringCoordinatesAny(QString string, int key) {
         if (string == "")
             string = "0";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data <= :data");
         sql.bindValue(":key", key);
         sql.bindValue(":data", string.toDouble());
@@ -2058,7 +2162,7 @@ void FilterEngine::filterSearchStringAuthorAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data like :data");
@@ -2072,7 +2176,7 @@ void FilterEngine::filterSearchStringAuthorAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -2093,7 +2197,7 @@ void FilterEngine::filterSearchStringDateAny(QString string) {
     int separator = string.indexOf(":")+1;
     QString tempString = string.mid(separator);
     QDateTime dt = calculateDateTime(tempString);
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     int key=0;
 
     if (string.startsWith("created:", Qt::CaseInsensitive)) {
@@ -2145,7 +2249,7 @@ void FilterEngine::filterSearchStringSourceAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data like :data");
@@ -2158,7 +2262,7 @@ void FilterEngine::filterSearchStringSourceAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -2187,7 +2291,7 @@ void FilterEngine::filterSearchStringSourceApplicationAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data like :data");
@@ -2201,7 +2305,7 @@ void FilterEngine::filterSearchStringSourceApplicationAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -2231,7 +2335,7 @@ void FilterEngine::filterSearchStringContentClassAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data like :data");
@@ -2245,7 +2349,7 @@ void FilterEngine::filterSearchStringContentClassAny(QString string) {
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -2273,7 +2377,7 @@ void FilterEngine::filterSearchStringResourceRecognitionTypeAny(QString string)
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where key=:key and data like :data");
@@ -2287,7 +2391,7 @@ void FilterEngine::filterSearchStringResourceRecognitionTypeAny(QString string)
         if (string == "")
             string = "*";
         // Filter out the records
-        NSqlQuery sql(global.db);
+        NSqlQuery sql(db);
         if (string.contains("*")) {
             string = string.replace("*", "%");
             sql.prepare("insert into anylidsfilter (lid) select lid from datastore where lid not in (select lid from datastore where key=:key and data like :data)");
@@ -2312,8 +2416,8 @@ bool FilterEngine::resourceContains(qint32 resourceLid, QString searchString, QS
     bool returnValue = false;
     if (returnHits != NULL)
         returnHits->empty();
-    NSqlQuery query(global.db);
-    NSqlQuery query2(global.db);
+    NSqlQuery query(db);
+    NSqlQuery query2(db);
     query.prepare("select lid from SearchIndex where lid=:resourceLid and weight>=:weight and content match :word");
     query2.prepare("select lid from SearchIndex where lid=:resourceLid and weight>=:weight and content like :word");
     QStringList terms;
@@ -2376,7 +2480,7 @@ bool FilterEngine::resourceContains(qint32 resourceLid, QString searchString, QS
             } else {
                 query.bindValue(":resourceLid", resourceLid);
                 query.bindValue(":weight", global.getMinimumRecognitionWeight());
-                query.bindValue(":word", term);
+                query.bindValue(":word", matchTerm(term, false));
                 query.exec();
                 if (query.next()) {
                     returnValue = true;
@@ -2394,13 +2498,121 @@ bool FilterEngine::resourceContains(qint32 resourceLid, QString searchString, QS
 
 
 
+// Find all of the resources for a note that contain any of the search terms.
+// This is the same as calling resourceContains() for each attachment, but all
+// of the attachments & terms are checked with a single query.
+void FilterEngine::noteResourcesContaining(QList<qint32> &resourceLids, qint32 noteLid, QString searchString) {
+    QLOG_TRACE_IN();
+    resourceLids.clear();
+    QStringList terms;
+    splitSearchTerms(terms, searchString);
+
+    QStringList subqueries;
+    QStringList values;
+    for (int i=0; i<terms.size(); i++) {
+        QString term = terms[i];
+
+        // Ignore special search terms (notebook:, tag:, created:, ...)
+        int colon = term.indexOf(":");
+        if (colon > 0 && !term.left(colon).contains(" "))
+            continue;
+        if (term.startsWith("-"))
+            continue;
+        if (term.endsWith("*"))
+            term.chop(1);
+        QString n = QString::number(values.size());
+        QString select = "select lid from SearchIndex where lid in (select resourceLid from ResourceHashIndex where noteLid=:noteLid"+n
+                +") and weight>=:weight"+n;
+        if (term.startsWith("*")) {
+            subqueries.append(select + " and content like :word"+n);
+            values.append("%"+term.mid(1)+"%");
+        } else {
+            subqueries.append(select + " and content match :word"+n);
+            values.append(matchTerm(term, false));
+        }
+    }
+    if (subqueries.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    query.prepare(subqueries.join(" union "));
+    for (int i=0; i<values.size(); i++) {
+        QString n = QString::number(i);
+        query.bindValue(":noteLid"+n, noteLid);
+        query.bindValue(":weight"+n, global.getMinimumRecognitionWeight());
+        query.bindValue(":word"+n, values[i]);
+    }
+    query.exec();
+    while (query.next()) {
+        resourceLids.append(query.value(0).toInt());
+    }
+    query.finish();
+}
+
+
+
+
+// Find the pages of a PDF that contain any of the search terms.  Each
+// page of a PDF is indexed separately, with a source of "pdf:<page>".
+void FilterEngine::pdfPagesContaining(QList<qint32> &pages, qint32 resourceLid, QString searchString) {
+    QLOG_TRACE_IN();
+    pages.clear();
+    QStringList terms;
+    splitSearchTerms(terms, searchString);
+
+    QStringList subqueries;
+    QStringList values;
+    for (int i=0; i<terms.size(); i++) {
+        QString term = terms[i];
+
+        // Ignore special search terms (notebook:, tag:, created:, ...)
+        int colon = term.indexOf(":");
+        if (colon > 0 && !term.left(colon).contains(" "))
+            continue;
+        if (term.startsWith("-"))
+            continue;
+        if (term.endsWith("*"))
+            term.chop(1);
+        QString n = QString::number(values.size());
+        QString select = "select source from SearchIndex where lid=:lid"+n+" and source like 'pdf:%'";
+        if (term.startsWith("*")) {
+            subqueries.append(select + " and content like :word"+n);
+            values.append("%"+term.mid(1)+"%");
+        } else {
+            subqueries.append(select + " and content match :word"+n);
+            values.append(matchTerm(term, false));
+        }
+    }
+    if (subqueries.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    query.prepare(subqueries.join(" union "));
+    for (int i=0; i<values.size(); i++) {
+        QString n = QString::number(i);
+        query.bindValue(":lid"+n, resourceLid);
+        query.bindValue(":word"+n, values[i]);
+    }
+    query.exec();
+    while (query.next()) {
+        qint32 page = query.value(0).toString().mid(4).toInt();
+        if (!pages.contains(page))
+            pages.append(page);
+    }
+    query.finish();
+    qSort(pages);
+}
+
+
+
+
 // Filter based on reminder time
 void FilterEngine::filterSearchStringReminderTimeAll(QString string) {
     QLOG_TRACE_IN();
     int separator = string.indexOf(":")+1;
     QString tempString = string.mid(separator);
     QDateTime dt = calculateDateTime(tempString);
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     int key= NOTE_ATTRIBUTE_REMINDER_TIME;
 
     if (string.startsWith("-", Qt::CaseInsensitive)) {
@@ -2423,7 +2635,7 @@ void FilterEngine::filterSearchStringReminderTimeAny(QString string) {
     int separator = string.indexOf(":")+1;
     QString tempString = string.mid(separator);
     QDateTime dt = calculateDateTime(tempString);
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     int key = NOTE_ATTRIBUTE_REMINDER_TIME;
 
     if (string.startsWith("-reminderDoneTime:", Qt::CaseInsensitive)) {
@@ -2445,7 +2657,7 @@ void FilterEngine::filterSearchStringReminderDoneTimeAll(QString string) {
     int separator = string.indexOf(":")+1;
     QString tempString = string.mid(separator);
     QDateTime dt = calculateDateTime(tempString);
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     int key = NOTE_ATTRIBUTE_REMINDER_DONE_TIME;
 
     if (string.startsWith("-", Qt::CaseInsensitive)) {
@@ -2468,7 +2680,7 @@ void FilterEngine::filterSearchStringReminderDoneTimeAny(QString string) {
     int separator = string.indexOf(":")+1;
     QString tempString = string.mid(separator);
     QDateTime dt = calculateDateTime(tempString);
-    NSqlQuery sql(global.db);
+    NSqlQuery sql(db);
     int key = NOTE_ATTRIBUTE_REMINDER_DONE_TIME;
 
     if (string.startsWith("-reminderDoneTime:", Qt::CaseInsensitive)) {
@@ -2482,3 +2694,48 @@ void FilterEngine::filterSearchStringReminderDoneTimeAny(QString string) {
     sql.finish();
     QLOG_TRACE_OUT();
 }
+
+
+
+
+// Rank the notes matching a search string.  With an FTS5 index this is the bm25
+// score (negated, so higher is more relevant).  Matches in attachments count
+// towards the note they belong to.  FTS4 can't rank, so there we just count how
+// many index entries match.
+void FilterEngine::getRelevance(QHash<qint32, double> &relevance, QString searchString) {
+    QLOG_TRACE_IN();
+    relevance.clear();
+    QStringList terms;
+    splitSearchTerms(terms, searchString);
+
+    QStringList words;
+    for (int i=0; i<terms.size(); i++) {
+        QString term = terms[i];
+
+        // Ignore special search terms (notebook:, tag:, created:, ...), negative
+        // terms & postfix terms since they can't be ranked.
+        int colon = term.indexOf(":");
+        if (colon > 0 && !term.left(colon).contains(" "))
+            continue;
+        if (term.startsWith("-") || term.startsWith("*") || term.trimmed() == "")
+            continue;
+        words.append(matchTerm(term));
+    }
+    if (words.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    if (global.searchIndexFts5)
+        query.prepare("select coalesce((select data from DataStore where key=:key and lid=SearchIndex.lid), lid), -bm25(SearchIndex) from SearchIndex where content match :word and weight>=:weight");
+    else
+        query.prepare("select coalesce((select data from DataStore where key=:key and lid=SearchIndex.lid), lid), 1 from SearchIndex where content match :word and weight>=:weight");
+    query.bindValue(":key", RESOURCE_NOTE_LID);
+    query.bindValue(":word", words.join(" OR "));
+    query.bindValue(":weight", global.getMinimumRecognitionWeight());
+    query.exec();
+    while (query.next()) {
+        qint32 lid = query.value(0).toInt();
+        relevance[lid] = relevance.value(lid, 0) + query.value(1).toDouble();
+    }
+    query.finish();
+}
@@ -22,12 +22,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <QObject>
 #include "filtercriteria.h"
+#include "sql/databaseconnection.h"
+#include <QHash>
 
 class FilterEngine : public QObject
 {
     Q_OBJECT
 private:
     void filterFavorite(FilterCriteria *criteria);
+    qint64 totalChanges();
+    QString resultStamp(qint64 changes);
+    void restoreFilter(const QList<qint32> &lids);
     void filterNotebook(FilterCriteria *criteria);
     void filterIndividualNotebook(QString &guid);
     void filterStack(QString& stack);
@@ -37,6 +42,7 @@ private:
     void filterSearchString(FilterCriteria *criteria);
     void filterSearchStringAll(QStringList list);
     void splitSearchTerms(QStringList &list, QString search);
+    QString matchTerm(QString term, bool prefix=true);
     void filterSearchStringNotebookAll(QString string);
 //    void filterSearchTodoAll(QStringList list);
     void filterSearchStringTodoAll(QString string);
@@ -73,11 +79,16 @@ private:
     void filterSearchStringContentClassAny(QString string);
     void filterSearchStringResourceRecognitionTypeAny(QString string);
     bool anyFlagSet;
+    DatabaseConnection *db;
 
 public:
     explicit FilterEngine(QObject *parent = 0);
+    explicit FilterEngine(DatabaseConnection *db, QObject *parent = 0);
     void filter(FilterCriteria *newCriteria=NULL, QList<qint32> *results=NULL);
     bool resourceContains(qint32 resourceLid, QString searchString, QStringList *returnHits);
+    void noteResourcesContaining(QList<qint32> &resourceLids, qint32 noteLid, QString searchString);
+    void pdfPagesContaining(QList<qint32> &pages, qint32 resourceLid, QString searchString);
+    void getRelevance(QHash<qint32, double> &relevance, QString searchString);
     
 signals:
     
@@ -0,0 +1,242 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "filterhistory.h"
+#include "filtercriteria.h"
+#include "global.h"
+
+#include <QSet>
+
+extern Global global;
+
+FilterHistory::FilterHistory()
+{
+    base = 0;
+    capacity = 100;
+    resultCapacity = 10;
+    ownChanges = 0;
+}
+
+
+
+// Get the criteria at an absolute history position
+FilterCriteria* FilterHistory::operator[](qint32 position) const {
+    return entries.at(position-base);
+}
+
+
+FilterCriteria* FilterHistory::at(qint32 position) const {
+    return entries.at(position-base);
+}
+
+
+
+// The absolute position just past the newest entry.  This
+// matches what a QList would return if nothing had ever been
+// dropped from the front of the history.
+qint32 FilterHistory::size() const {
+    return base+entries.size();
+}
+
+
+
+// The oldest position the user can go back to.
+qint32 FilterHistory::firstPosition() const {
+    return base;
+}
+
+
+
+// Add a new entry to the end of the history & drop the oldest
+// entries if it is now too long.
+void FilterHistory::append(FilterCriteria *criteria) {
+    entries.append(criteria);
+    trim();
+}
+
+
+void FilterHistory::push_back(FilterCriteria *criteria) {
+    append(criteria);
+}
+
+
+
+// Remove the newest entry.  This is done when the user is
+// viewing an older entry and starts a new selection, so
+// the entry is never used again.
+void FilterHistory::removeLast() {
+    if (entries.size() == 0)
+        return;
+    dropResults(size()-1);
+    delete entries.takeLast();
+}
+
+
+
+// Remove an entry & give it to the caller.
+FilterCriteria* FilterHistory::takeAt(qint32 position) {
+    dropResults(position);
+    return entries.takeAt(position-base);
+}
+
+
+
+// Set how many entries & cached results are kept.
+void FilterHistory::setCapacity(qint32 entries, qint32 results) {
+    capacity = qMax(entries, 2);
+    resultCapacity = qMax(results, 0);
+    trim();
+    while (resultOrder.size() > resultCapacity)
+        dropResults(resultOrder[0]);
+}
+
+
+
+// Drop the oldest entries until we are back down to the capacity.
+// The entry being viewed is never dropped.
+void FilterHistory::trim() {
+    while (entries.size() > capacity && base < global.filterPosition) {
+        dropResults(base);
+        delete entries.takeFirst();
+        base++;
+    }
+}
+
+
+
+// Remember which notes the filter at a position matched so going back &
+// forward through the history doesn't need to run the filter again.
+// The stamp describes the state of the database the results are good for.
+void FilterHistory::setResults(qint32 position, const QList<qint32> &lids, const QString &stamp) {
+    if (resultCapacity == 0 || position < base || position >= size())
+        return;
+    CachedResults cached;
+    cached.lids = lids;
+    cached.stamp = stamp;
+    results.insert(position, cached);
+    resultOrder.removeAll(position);
+    resultOrder.append(position);
+    while (resultOrder.size() > resultCapacity)
+        dropResults(resultOrder[0]);
+}
+
+
+
+// Get the cached results for a position.  Results saved for a
+// different database state are thrown away.
+bool FilterHistory::getResults(qint32 position, QList<qint32> &lids, const QString &stamp) {
+    if (!results.contains(position))
+        return false;
+    if (results[position].stamp != stamp) {
+        dropResults(position);
+        return false;
+    }
+    lids = results[position].lids;
+    resultOrder.removeAll(position);
+    resultOrder.append(position);
+    return true;
+}
+
+
+
+void FilterHistory::dropResults(qint32 position) {
+    results.remove(position);
+    resultOrder.removeAll(position);
+}
+
+
+
+// Throw away all cached results.  Used when something other than
+// the database (like the search preferences) changes what a filter matches.
+void FilterHistory::clearResults() {
+    results.clear();
+    resultOrder.clear();
+}
+
+
+qint32 FilterHistory::resultCount() const {
+    return results.size();
+}
+
+
+
+// The filter engine keeps track of how many rows it changed itself
+// so they can be told apart from real changes to the notes.
+void FilterHistory::addOwnChanges(qint64 changes) {
+    ownChanges += changes;
+}
+
+
+qint64 FilterHistory::getOwnChanges() const {
+    return ownChanges;
+}
+
+
+
+// Check if any entry points to a tree item.  The trees use this to
+// know when it is safe to delete an item which has been removed.
+bool FilterHistory::usesItem(QTreeWidgetItem *item) const {
+    for (int i=0; i<entries.size(); i++) {
+        FilterCriteria *criteria = entries[i];
+        if (criteria->getNotebook() == item || criteria->getAttribute() == item
+                || criteria->getSavedSearch() == item)
+            return true;
+        if (criteria->getTags().contains(item))
+            return true;
+    }
+    return false;
+}
+
+
+
+// Approximate the memory used by the history.  The note lists & search
+// strings are implicitly shared between entries which were copied from
+// each other, so each shared copy is only counted once.  QList has no
+// constData(), so a list is identified by the address of its first
+// element.  Each QList entry takes a pointer sized slot.
+qint64 FilterHistory::memoryUsage() const {
+    qint64 bytes = 0;
+    QSet<const void*> counted;
+    for (int i=0; i<entries.size(); i++) {
+        FilterCriteria *criteria = entries[i];
+        bytes += sizeof(FilterCriteria) + sizeof(FilterCriteria*);
+        QList<qint32> selectedNotes;
+        criteria->getSelectedNotes(selectedNotes);
+        if (selectedNotes.size() > 0 && !counted.contains(&selectedNotes.at(0))) {
+            counted.insert(&selectedNotes.at(0));
+            bytes += selectedNotes.size()*sizeof(void*);
+        }
+        QString searchString = criteria->getSearchString();
+        if (searchString.size() > 0 && !counted.contains(searchString.constData())) {
+            counted.insert(searchString.constData());
+            bytes += searchString.size()*sizeof(QChar);
+        }
+        bytes += criteria->getTags().size()*sizeof(QTreeWidgetItem*);
+    }
+    QHash<qint32, CachedResults>::const_iterator it;
+    for (it = results.constBegin(); it != results.constEnd(); ++it) {
+        bytes += it.value().stamp.size()*sizeof(QChar);
+        if (it.value().lids.size() > 0 && !counted.contains(&it.value().lids.at(0))) {
+            counted.insert(&it.value().lids.at(0));
+            bytes += it.value().lids.size()*sizeof(void*);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,77 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#ifndef FILTERHISTORY_H
+#define FILTERHISTORY_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+
+class FilterCriteria;
+class QTreeWidgetItem;
+
+// The back & forward history of selection criteria.  Positions are
+// absolute, so global.filterPosition and the positions the trees remember
+// stay valid when the oldest entries are dropped once the history is full.
+class FilterHistory
+{
+private:
+    class CachedResults {
+    public:
+        QList<qint32> lids;                   // Notes the filter matched
+        QString stamp;                        // Database state the lids are valid for
+    };
+
+    QList<FilterCriteria*> entries;           // History entries, oldest first
+    qint32 base;                              // Absolute position of entries[0]
+    qint32 capacity;                          // Maximum number of entries kept
+    qint32 resultCapacity;                    // Maximum number of cached results kept
+    QHash<qint32, CachedResults> results;     // Cached filter results by position
+    QList<qint32> resultOrder;                // Cached positions, least recently used first
+    qint64 ownChanges;                        // Database changes made by filtering itself
+
+    void trim();
+    void dropResults(qint32 position);
+
+public:
+    FilterHistory();
+    FilterCriteria* operator[](qint32 position) const;
+    FilterCriteria* at(qint32 position) const;
+    qint32 size() const;                      // One past the newest position
+    qint32 firstPosition() const;             // Oldest position still available
+    void append(FilterCriteria *criteria);
+    void push_back(FilterCriteria *criteria);
+    void removeLast();
+    FilterCriteria* takeAt(qint32 position);
+    void setCapacity(qint32 entries, qint32 results);
+
+    void setResults(qint32 position, const QList<qint32> &lids, const QString &stamp);
+    bool getResults(qint32 position, QList<qint32> &lids, const QString &stamp);
+    void clearResults();
+    qint32 resultCount() const;
+    void addOwnChanges(qint64 changes);
+    qint64 getOwnChanges() const;
+
+    bool usesItem(QTreeWidgetItem *item) const; // Does any entry point to this tree item?
+    qint64 memoryUsage() const;               // Approximate bytes used by the history
+};
+
+#endif // FILTERHISTORY_H
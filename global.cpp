@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "global.h"
 
 #include <string>
+#include <iostream>
 #include <limits.h>
 #include <unistd.h>
 #include <QWebSettings>
@@ -49,6 +50,7 @@ Global::Global()
     FilterCriteria *criteria = new FilterCriteria();
     filterCriteria.push_back(criteria);
     filterPosition = 0;
+    thumbnailer = NULL;
 
     this->argv = NULL;
     this->argc = 0;
@@ -77,6 +79,10 @@ Global::Global()
     this->sharedMemory = NULL;
     this->forceSystemTrayAvailable = false;
     this->guiAvailable = true;
+    profileStartup = false;
+    searchDb = NULL;
+    filterSnapshotGeneration = 0;
+    startupTimer.start();
     strictDTD = true;
     forceUTF8 = false;
     startupNote = 0;
@@ -89,6 +95,12 @@ Global::Global()
     this->maxIndexInterval = 500;
     this->forceNoStartMimized = false;
     this->forceSearchLowerCase = false;
+    this->searchIndexFts5 = false;
+    this->searchIndexTrigram = false;
+    this->syncFetchCount = 4;
+    this->walCheckpointInterval = 5;
+    this->walTruncateSize = 64;
+    this->maintenanceRunner = NULL;
     this->forceStartMinimized = false;
     this->globalSettings = NULL;
     this->disableUploads = false;
@@ -162,6 +174,7 @@ void Global::setup(StartupConfig startupConfig, bool guiAvailable) {
     //this->syncAndExit = startupConfig.syncAndExit;
     this->forceStartMinimized = startupConfig.forceStartMinimized;
     this->startupNote = startupConfig.startupNoteLid;
+    this->profileStartup = startupConfig.profileStartup;
     startupConfig.accountId = accountId;
     accountsManager = new AccountsManager(startupConfig.accountId);
     if (startupConfig.enableIndexing || getBackgroundIndexing())
@@ -250,6 +263,35 @@ void Global::setup(StartupConfig startupConfig, bool guiAvailable) {
     disableThumbnails = settings->value("disabled", false).toBool();
     settings->endGroup();
 
+    settings->beginGroup("Sync");
+    syncFetchCount = qBound(1, settings->value("fetchCount", 4).toInt(), 16);
+    settings->endGroup();
+
+    settings->beginGroup("Search");
+    filterCriteria.setCapacity(settings->value("historySize", 100).toInt(),
+                               settings->value("historyCachedResults", 10).toInt());
+    settings->endGroup();
+
+    // Database tuning.  The settings are read once here since the
+    // connections are opened from several threads.
+    QStringList roles;
+    QList<qint32> defaultCacheSizes;
+    roles << "gui" << "sync" << "index" << "counter" << "other";
+    defaultCacheSizes << 32768 << 16384 << 8192 << 4096 << 2048;
+    settings->beginGroup("Database");
+    for (int i=0; i<roles.size(); i++) {
+        StorageProfile profile;
+        profile.cacheSize = qMax(settings->value(roles[i]+"CacheSize", defaultCacheSizes[i]).toInt(), 512);
+        profile.mmapSize = qMax(settings->value(roles[i]+"MmapSize", 256).toInt(), 0);
+        profile.synchronous = settings->value(roles[i]+"Synchronous", "NORMAL").toString().toUpper();
+        if (profile.synchronous != "OFF" && profile.synchronous != "NORMAL" && profile.synchronous != "FULL")
+            profile.synchronous = "NORMAL";
+        storageProfiles.insert(roles[i], profile);
+    }
+    walCheckpointInterval = qMax(settings->value("checkpointInterval", 5).toInt(), 1);
+    walTruncateSize = qMax(settings->value("walTruncateSize", 64).toInt(), 1);
+    settings->endGroup();
+
     // reset username
     full_username = "";
 
@@ -307,11 +349,8 @@ QString Global::tagBehavior() {
 void Global::appendFilter(FilterCriteria *criteria) {
     // First, find out if we're already viewing history.  If we are we
     // chop off the end of the history & start a new one
-    if (filterPosition+1 < filterCriteria.size()) {
-        int position = filterPosition;
-        while (position+1 < filterCriteria.size())
-            delete filterCriteria.takeAt(position);
-    }
+    while (filterPosition+1 < filterCriteria.size())
+        filterCriteria.removeLast();
 
     filterCriteria.append(criteria);
 }
@@ -560,6 +599,26 @@ bool Global::getForceSearchLowerCase() {
 
 
 
+// Use the trigram tokenizer for the search index.  This lets
+// searches match anywhere in a word, but the index is larger.
+// Changing it rebuilds the index on the next start.
+void Global::setSearchIndexTrigram(bool value) {
+    settings->beginGroup("Search");
+    settings->setValue("searchIndexTrigram",value);
+    settings->endGroup();
+}
+
+
+bool Global::getSearchIndexTrigram() {
+    settings->beginGroup("Search");
+    bool value = settings->value("searchIndexTrigram",false).toBool();
+    settings->endGroup();
+    return value;
+}
+
+
+
+
 
 void Global::setStrictDTD(bool value) {
     settings->beginGroup("Debugging");
@@ -666,6 +725,65 @@ void Global::setLastReminderTime(qlonglong value) {
 
 
 
+// Get the database tuning for a kind of connection.  Anything we
+// don't know about gets the "other" profile.
+StorageProfile Global::getStorageProfile(QString role) {
+    if (storageProfiles.contains(role))
+        return storageProfiles[role];
+    if (storageProfiles.contains("other"))
+        return storageProfiles["other"];
+    StorageProfile profile;
+    profile.cacheSize = 2048;
+    profile.mmapSize = 0;
+    profile.synchronous = "NORMAL";
+    return profile;
+}
+
+
+
+// Get the connection used for searches that shouldn't touch the
+// results the note list is showing.  It is opened the first time it
+// is needed and must only be used from the main thread.
+DatabaseConnection *Global::getSearchConnection() {
+    if (searchDb == NULL)
+        searchDb = new DatabaseConnection("search");
+    return searchDb;
+}
+
+
+
+// Save the list of notes the note list is showing.  Each connection
+// has its own filter table, so this is how the other threads find
+// out what the user is looking at.
+void Global::setFilterSnapshot(const QList<qint32> &lids) {
+    QMutexLocker locker(&filterSnapshotMutex);
+    filterSnapshot = lids;
+    filterSnapshotGeneration++;
+}
+
+
+
+// Get the list of notes the note list is showing.  The generation
+// is returned so callers can tell if it has changed since they last
+// looked.
+qint32 Global::getFilterSnapshot(QList<qint32> &lids) {
+    QMutexLocker locker(&filterSnapshotMutex);
+    lids = filterSnapshot;
+    return filterSnapshotGeneration;
+}
+
+
+
+// Print how long it took to get to a point in the startup.  This is
+// only done if the user asked for it with --profile-startup.
+void Global::startupPhase(QString phase) {
+    if (!profileStartup)
+        return;
+    std::cout << QString("%1 ms: %2").arg(startupTimer.elapsed(), 6).arg(phase).toStdString() << std::endl;
+}
+
+
+
 // Setup the default date & time formatting
 void Global::setupDateTimeFormat() {
     QString datefmt;
@@ -30,7 +30,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "settings/filemanager.h"
 #include "settings/startupconfig.h"
 #include "filters/filtercriteria.h"
+#include "filters/filterhistory.h"
 #include "models/notecache.h"
+#include "html/attachmenticoncache.h"
 #include "gui/shortcutkeys.h"
 #include "settings/accountsmanager.h"
 #include "reminders/remindermanager.h"
@@ -43,6 +45,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <string>
 #include <QSqlDatabase>
 #include <QReadWriteLock>
+#include <QMutex>
+#include <QElapsedTimer>
 
 //*******************************
 //* This class is used to store
@@ -76,8 +80,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #define NOTE_TABLE_PINNED_POSITION 23
 #define NOTE_TABLE_COLOR_POSITION 24
 #define NOTE_TABLE_THUMBNAIL_POSITION 25
+#define NOTE_TABLE_RELEVANCE_POSITION 26
 
-#define NOTE_TABLE_COLUMN_COUNT 26
+#define NOTE_TABLE_COLUMN_COUNT 27
 
 
 #define MOUSE_MIDDLE_CLICK_NEW_TAB 0
@@ -89,6 +94,16 @@ using namespace std;
 // Forward declare future classes
 class DatabaseConnection;
 class IndexRunner;
+class Thumbnailer;
+class MaintenanceRunner;
+
+
+// SQLite tuning used by each kind of database connection.
+struct StorageProfile {
+    qint32 cacheSize;           // Page cache size in KiB
+    qint32 mmapSize;            // Memory map size in MiB.  0 disables it.
+    QString synchronous;        // OFF, NORMAL or FULL
+};
 
 
 
@@ -167,6 +182,8 @@ public:
     QString dateFormat;                                   // Desired display date format
     QString timeFormat;                                   // Desired display time format
     DatabaseConnection *db;                               // "default" DB connection for the main thread.
+    DatabaseConnection *searchDb;                         // Main thread connection for searches not shown in the note list
+    DatabaseConnection *getSearchConnection();            // Get (or open) the search connection
     bool javaFound;                                       // Have we found Java?
     bool forceUTF8;                                       // force UTF8 encoding
     QString defaultFont;                                  // Default editor font name
@@ -180,6 +197,9 @@ public:
     bool startMinimized;                                  // Do user prefernces say to start minimized?
     bool forceWebFonts;
     qint32 startupNote;                                   // Initial note to startup with.
+    bool profileStartup;                                  // Print a timeline of the startup phases?
+    QElapsedTimer startupTimer;                           // Time since the program was loaded
+    void startupPhase(QString phase);                     // Record the end of a startup phase
 
     qint32 minIndexInterval;                              // Minimum interval to check for any unindexed notes.
     qint32 maxIndexInterval;                              // Maximum interval to check for any unindexed notes.
@@ -187,12 +207,19 @@ public:
     qint32 indexNoteCountPause;                           // After indexing this many notes we pause to avoid overloading the CPU
 
     // Filter criteria.  Used for things like the back & forward buttons
-    QList<FilterCriteria*> filterCriteria;
+    FilterHistory filterCriteria;
     qint32 filterPosition;
+    void setFilterSnapshot(const QList<qint32> &lids);      // Save the notes the note list is showing
+    qint32 getFilterSnapshot(QList<qint32> &lids);         // Get the notes the note list is showing & the snapshot generation
+    QList<qint32> filterSnapshot;                          // Notes the note list is showing
+    qint32 filterSnapshotGeneration;                       // Incremented each time the snapshot changes
+    QMutex filterSnapshotMutex;                            // Lock for the snapshot since the counter thread reads it
 
     QReadWriteLock  *dbLock;                               // Database read/write lock mutex
 
     QHash<qint32, NoteCache*> cache;                         // Note cache  used to keep from needing to re-format the same note for a display
+    AttachmentIconCache attachmentIconCache;                 // Rendered attachment icons so they are only drawn once
+    Thumbnailer *thumbnailer;                                // Background thumbnail generator
 
     void setup(StartupConfig config, bool guiAvailable);                         // Setup the global variables
     bool guiAvailable;                                        // Is there a GUI available?
@@ -279,11 +306,22 @@ public:
     void stackDump(int max=0);                                 // Utility to dump the running stack
     bool getForceSearchLowerCase();                            // Get value to force search db in lower case from settings
     void setForceSearchLowerCase(bool value);                  // save forceSearchLowerCase
+    bool searchIndexFts5;                                      // Is the SearchIndex an FTS5 table?
+    bool searchIndexTrigram;                                   // Does the SearchIndex use the trigram tokenizer?
+    bool getSearchIndexTrigram();                              // Should the search index match substrings (trigram tokenizer)?
+    void setSearchIndexTrigram(bool value);                    // save the search index tokenizer option
     IndexRunner *indexRunner;                                    // Pointer to index thread
 
     int minimumThumbnailInterval;                               // Minimum time to scan for thumbnails
     int maximumThumbnailInterval;                               // Maximum time to scan for thumbnails
     bool disableThumbnails;                                     // Disable thumbnail generation
+    int syncFetchCount;                                         // Number of notes & resources to download at once
+
+    QHash<QString, StorageProfile> storageProfiles;             // Database tuning for each connection role
+    StorageProfile getStorageProfile(QString role);             // Get the tuning for a connection role
+    qint32 walCheckpointInterval;                               // Minutes between background WAL checkpoints
+    qint32 walTruncateSize;                                     // Truncate the WAL when it is bigger than this (MiB)
+    MaintenanceRunner *maintenanceRunner;                       // Pointer to the database maintenance object
     int batchThumbnailCount;                                    // Maximum number of thumbails to generate per batch
 
     int getAutoSaveInterval();                                  // Time (in seconds) between auto-saving of notes.
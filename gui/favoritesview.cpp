@@ -84,7 +84,7 @@ FavoritesView::FavoritesView(QWidget *parent) :
     this->setMinimumHeight(1);
     this->addTopLevelItem(root);
     this->rebuildFavoritesTreeNeeded = true;
-    this->loadData();
+    // The data is loaded by NixNote once the main window is showing.
 
     context.addSeparator();
     deleteAction = context.addAction(tr("Remove from shortcuts"));
@@ -31,9 +31,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "email/mimehtml.h"
 #include "email/mimemessage.h"
 #include "email/mimeinlinefile.h"
+#include "email/emailsendtask.h"
 #include "global.h"
 #include "gui/browserWidgets/colormenu.h"
 #include "gui/plugins/pluginfactory.h"
+#include "gui/plugins/popplerviewer.h"
 #include "dialog/insertlinkdialog.h"
 #include "html/thumbnailer.h"
 #include "dialog/tabledialog.h"
@@ -68,6 +70,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QPrinterInfo>
 #include <QPrintPreviewDialog>
 #include <QPaintEngine>
+#include <QThreadPool>
 #include <iostream>
 #include <istream>
 #include <qcalendarwidget.h>
@@ -219,7 +222,6 @@ NBrowserWindow::NBrowserWindow(QWidget *parent) :
 
     hammer = new Thumbnailer(global.db);
     lid = -1;
-    thumbnailer = NULL;
 
 
     //Setup shortcuts for context menu
@@ -278,6 +280,8 @@ NBrowserWindow::NBrowserWindow(QWidget *parent) :
     saveTimer.start();
 
     hunspellInterface = NULL;
+    spellCheckRequest = -1;
+    connect(SpellCheckService::instance(), SIGNAL(checked(int,QList<SpellCheckRange>)), this, SLOT(spellCheckFinished(int,QList<SpellCheckRange>)));
 }
 
 
@@ -605,8 +609,11 @@ void NBrowserWindow::setContent(qint32 lid) {
     }
 
     QLOG_DEBUG() << "Checking thumbnail";
-    if (hammer->idle && noteTable.isThumbnailNeeded(this->lid)) {
-        hammer->render(this->lid);
+    if (noteTable.isThumbnailNeeded(this->lid)) {
+        if (global.thumbnailer != NULL)
+            global.thumbnailer->request(this->lid, Thumbnailer::Visible);
+        else
+            hammer->request(this->lid, Thumbnailer::Visible);
     }
     this->setEditorStyle();
 
@@ -844,11 +851,11 @@ void NBrowserWindow::saveNoteContent() {
         } else
             emit requestNoteContentUpdate(lid, formatter.getEnml(), true);
         editor->isDirty = false;
-        if (thumbnailer == NULL)
-            thumbnailer = new Thumbnailer(global.db);
-        QLOG_DEBUG() << "Beginning thumbnail";
-        thumbnailer->render(lid);
-        QLOG_DEBUG() << "Thumbnail compleded";
+        QLOG_DEBUG() << "Queueing thumbnail";
+        if (global.thumbnailer != NULL)
+            global.thumbnailer->request(lid, Thumbnailer::RecentlyEdited);
+        else
+            hammer->request(lid, Thumbnailer::RecentlyEdited);
 
         NoteCache* cache = global.cache[lid];
         if (cache != NULL) {
@@ -1793,6 +1800,7 @@ void NBrowserWindow::rotateImage(qreal degrees) {
     QMatrix matrix;
     matrix.rotate( degrees );
     image = image.transformed(matrix);
+    QFile::remove(global.fileManager.getDbaDirPath() +selectedFileName);
     image.save(global.fileManager.getDbaDirPath() +selectedFileName);
     editor->setHtml(editor->page()->mainFrame()->toHtml());
 
@@ -2176,6 +2184,9 @@ void NBrowserWindow::setTableCursorPositionTab(int currentRow, int currentCol, i
 #ifdef _WIN32
          fileUrl = fileUrl.replace("\\", "/");
 #endif // End windows check
+         // The file may be shared with a duplicated note, so it needs its
+         // own copy before another program can change it
+         global.fileManager.unshareDbaFile(fileUrl);
          global.resourceWatcher->addPath(fileUrl);
          QDesktopServices::openUrl(fileUrl);
          return;
@@ -2754,70 +2765,70 @@ void NBrowserWindow::emailNote() {
     if (smtpConnectionType == "TlsConnection")
         type = SmtpClient::TlsConnection;
 
-    SmtpClient smtp(server, port, type);
-    smtp.setResponseTimeout(-1);
-
-    // We need to set the username (your email address) and password
-    // for smtp authentication.
-    smtp.setUser(userid);
-    smtp.setPassword(password);
-
     // Now we create a MimeMessage object. This is the email.
-    MimeMessage message;
+    MimeMessage *message = new MimeMessage();
 
-    EmailAddress sender(senderEmail, senderName);
-    message.setSender(&sender);
+    EmailAddress *sender = new EmailAddress(senderEmail, senderName);
+    message->setSender(sender);
 
     for (int i=0; i<toAddresses.size(); i++) {
         EmailAddress *to = new EmailAddress(toAddresses[i], toAddresses[i]);
-        message.addRecipient(to);
+        message->addRecipient(to);
     }
 
     for (int i=0; i<ccAddresses.size(); i++) {
         EmailAddress *cc = new EmailAddress(ccAddresses[i], ccAddresses[i]);
-        message.addRecipient(cc);
+        message->addRecipient(cc, MimeMessage::Cc);
     }
 
 
     if (emailDialog.ccSelf->isChecked()) {
         EmailAddress *cc = new EmailAddress(senderEmail, senderName);
-        message.addRecipient(cc);
+        message->addRecipient(cc, MimeMessage::Cc);
     }
 
     for (int i=0; i<bccAddresses.size(); i++) {
         EmailAddress *bcc = new EmailAddress(bccAddresses[i], bccAddresses[i]);
-        message.addRecipient(bcc);
+        message->addRecipient(bcc, MimeMessage::Bcc);
     }
 
     // Set the subject
-    message.setSubject(emailDialog.subject->text().trimmed());
+    message->setSubject(emailDialog.subject->text().trimmed());
 
     // Build the note content
     QString text =  emailDialog.note->toPlainText();
-    prepareEmailMessage(&message, text);
+    prepareEmailMessage(message, text);
 
-    // Send the actual message.
-    if (!smtp.connectToHost()) {
-        QLOG_ERROR()<< "Failed to connect to host!";
-        QMessageBox::critical(this, tr("Connection Error"), tr("Unable to connect to host."), QMessageBox::Ok);
-        return;
-    }
+    // Send the actual message in the background.  Attachments are
+    // read from disk as they are sent.
+    EmailSendTask *task = new EmailSendTask(message, server, port, type, userid, password);
+    connect(task, SIGNAL(progress(qint64,qint64)), this, SLOT(emailProgress(qint64,qint64)));
+    connect(task, SIGNAL(failed(QString,QString)), this, SLOT(emailFailed(QString,QString)));
+    connect(task, SIGNAL(sent()), this, SLOT(emailSent()));
+    QThreadPool::globalInstance()->start(task);
+}
 
-    if (!smtp.login()) {
-        QLOG_ERROR() << "Failed to login!";
-        QMessageBox::critical(this, tr("Login Error"), tr("Unable to login."), QMessageBox::Ok);
-        return;
-    }
 
-    if (!smtp.sendMail(message)) {
-        QMessageBox::critical(this, tr("Send Error"), tr("Unable to send email."), QMessageBox::Ok);
-        QLOG_ERROR() << "Failed to send mail!";
+
+// Show how much of an email has been sent
+void NBrowserWindow::emailProgress(qint64 bytesSent, qint64 messageSize) {
+    if (messageSize <= 0)
         return;
-    }
+    int percent = bytesSent*100/messageSize;
+    emit(setMessage(tr("Sending Email: %1% complete").arg(percent)));
+}
+
+
 
-    smtp.quit();
-    emit(setMessage("Message Sent"));
-//    QMessageBox::information(this, tr("Message Sent"), tr("Message sent."), QMessageBox::Ok);
+void NBrowserWindow::emailFailed(QString title, QString error) {
+    emit(setMessage(""));
+    QMessageBox::critical(this, title, error, QMessageBox::Ok);
+}
+
+
+
+void NBrowserWindow::emailSent() {
+    emit(setMessage(tr("Message Sent")));
 }
 
 
@@ -2835,6 +2846,7 @@ QString NBrowserWindow::stripContentsForPrint() {
         int endPos = contents.indexOf(">", pos);
         QString lidString = contents.mid(contents.indexOf("lid=", pos)+5);
         lidString = lidString.mid(0,lidString.indexOf("\" "));
+        PopplerViewer::writePrintImage(lidString.toInt());
 #ifndef _WIN32
         contents = contents.mid(0,pos) + "<img src=\"file://" +
                 global.fileManager.getTmpDirPath() + lidString +
@@ -3510,6 +3522,20 @@ void NBrowserWindow::spellCheckPressed() {
         return;
     }
 
+    // The words are checked in the background.  We carry on in
+    // spellCheckFinished() once they have been.
+    spellCheckRequest = SpellCheckService::instance()->check(editor->page()->mainFrame()->toPlainText());
+}
+
+
+
+// The background spell check has finished.  Step through the misspelled
+// words, letting the user decide what to do with each one.
+void NBrowserWindow::spellCheckFinished(int request, QList<SpellCheckRange> misspelled) {
+    if (request != spellCheckRequest)
+        return;
+    spellCheckRequest = -1;
+
     QWebPage *page = editor->page();
     page->action(QWebPage::MoveToStartOfDocument);
     page->mainFrame()->setFocus();
@@ -3520,31 +3546,29 @@ void NBrowserWindow::spellCheckPressed() {
     editor->keyPressEvent(&key);
     page->mainFrame()->setFocus();
 
-    QStringList words = page->mainFrame()->toPlainText().split(" ");
-    QStringList ignoreWords;
-    QStringList rwords;
-    //SpellChecker checker;
+    SpellCheckService *checker = SpellCheckService::instance();
+    QSet<QString> ignoreWords;
     bool finished = false;
 
-    for (int i=0; i<words.size() && !finished; i++) {
-        QString currentWord = words[i];
-        page->findText(currentWord);
-        rwords.clear();
-        if (!hunspellInterface->spellCheck(currentWord, rwords) && !ignoreWords.contains(currentWord)) {
-            SpellCheckDialog dialog(currentWord, rwords, this);
-            dialog.move(0,0);
-            dialog.exec();
-            if (dialog.cancelPressed)
-                finished = true;
-            if (dialog.ignoreAllPressed)
-                ignoreWords.append(currentWord);
-            if (dialog.replacePressed)  {
-                QApplication::clipboard()->setText(dialog.replacement);
-                pasteButtonPressed();
-            }
-            if (dialog.addToDictionaryPressed) {
-                hunspellInterface->addWord(global.fileManager.getSpellDirPathUser() +"user.lst", currentWord);
-            }
+    for (int i=0; i<misspelled.size() && !finished; i++) {
+        QString currentWord = misspelled[i].word;
+        if (ignoreWords.contains(currentWord))
+            continue;
+        page->findText(currentWord, QWebPage::FindCaseSensitively);
+        SpellCheckDialog dialog(currentWord, checker->suggestions(currentWord), this);
+        dialog.move(0,0);
+        dialog.exec();
+        if (dialog.cancelPressed)
+            finished = true;
+        if (dialog.ignoreAllPressed)
+            ignoreWords.insert(currentWord);
+        if (dialog.replacePressed)  {
+            QApplication::clipboard()->setText(dialog.replacement);
+            pasteButtonPressed();
+        }
+        if (dialog.addToDictionaryPressed) {
+            checker->addWord(global.fileManager.getSpellDirPathUser() +"user.lst", currentWord);
+            ignoreWords.insert(currentWord);
         }
     }
 
@@ -3809,7 +3833,7 @@ void NBrowserWindow::loadPlugins() {
                     hunspellInterface = qobject_cast<HunspellInterface *>(plugin);
                     if (hunspellInterface) {
                         hunspellPluginAvailable = true;
-                        hunspellInterface->initialize(global.fileManager.getProgramDirPath(""), global.fileManager.getSpellDirPathUser());
+                        SpellCheckService::instance()->initialize(hunspellInterface, global.fileManager.getProgramDirPath(""), global.fileManager.getSpellDirPathUser());
                     }
                 } else {
                     QLOG_ERROR() << pluginLoader.errorString();
@@ -60,6 +60,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "email/mimemessage.h"
 #include "plugins/hunspell/hunspellinterface.h"
 #include "plugins/hunspell/hunspellplugin.h"
+#include "utilities/spellcheckservice.h"
 #include "gui/findreplace.h"
 #include "threads/browserrunner.h"
 
@@ -96,7 +97,6 @@ private:
     qint32 createResource(Resource &r, int sequence, QByteArray data, QString mime, bool attachment, QString filename);
     PluginFactory *factory;
     Thumbnailer *hammer;
-    Thumbnailer *thumbnailer;
     QTimer focusTimer;
     QTimer saveTimer;
     QString attachFilePath;  // Save path of last selected attachment.
@@ -105,6 +105,7 @@ private:
     bool hunspellPluginAvailable;
     HunspellInterface *hunspellInterface;
     void loadPlugins();
+    int spellCheckRequest;               // Spell check we are waiting on, or -1
 
 
     // Shortcuts for context menu
@@ -333,6 +334,10 @@ private slots:
     void saveTimeCheck();
     void browserThreadStarted();
     void repositionAfterSourceEdit(bool);
+    void spellCheckFinished(int request, QList<SpellCheckRange> misspelled);
+    void emailProgress(qint64 bytesSent, qint64 messageSize);
+    void emailFailed(QString title, QString error);
+    void emailSent();
 };
 
 #endif // NBROWSERWINDOW_H
@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QMessageBox>
 #include <QTextDocument>
 #include <QFontMetrics>
+#include <QSet>
 
 #include "sql/notebooktable.h"
 #include "sql/linkednotebooktable.h"
@@ -76,7 +77,7 @@ NNotebookView::NNotebookView(QWidget *parent) :
     this->setMinimumHeight(1);
     this->addTopLevelItem(root);
     this->rebuildNotebookTreeNeeded = true;
-    this->loadData();
+    // The data is loaded by NixNote once the main window is showing.
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     connect(this, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(calculateHeight()));
@@ -238,54 +239,95 @@ void NNotebookView::loadData() {
     QList<qint32> closedLids;
     notebookTable.getClosedNotebooks(closedLids);
 
-
-    QHash<qint32, NNotebookViewItem*>::iterator i1;
-    for (i1=dataStore.begin(); i1!=dataStore.end(); ++i1) {
-        if (i1.value() != NULL)
-            i1.value()->setHidden(true);
-    }
-
-    QHash<QString, NNotebookViewItem*>::iterator i2;
-    for (i2=stackStore.begin(); i2!=stackStore.end(); ++i2) {
-        if (i2.value() != NULL)
-            i2.value()->setHidden(true);
-    }
-
-    dataStore.clear();
+    // Find the deleted notebooks in one query rather than one per notebook
+    QSet<qint32> deletedLids;
+    query.prepare("select lid from DataStore where key=:key and data=:value");
+    query.bindValue(":key", NOTEBOOK_IS_DELETED);
+    query.bindValue(":value", true);
+    query.exec();
+    while (query.next())
+        deletedLids.insert(query.value(0).toInt());
+
+    // Update the items we already have in place so anything pointing
+    // at them (like the selection history) stays valid.
+    QSet<qint32> found;
     query.exec("Select lid, name, stack, username from NotebookModel order by username, name");
     while (query.next()) {
         qint32 lid = query.value(0).toInt();
-        if (!notebookTable.isDeleted(query.value(0).toInt())) {
-            NNotebookViewItem *newWidget = new NNotebookViewItem(lid);
-            newWidget->setData(NAME_POSITION, Qt::DisplayRole, query.value(1).toString());
-            newWidget->setData(NAME_POSITION, Qt::UserRole, lid);
-            if (closedLids.contains(lid))
-                newWidget->setHidden(true);
-            QString username = query.value(3).toString();
-            if (username.trimmed() != "")
-                newWidget->stack = username;
-            else
-                newWidget->stack = query.value(2).toString();
-            this->dataStore.insert(query.value(0).toInt(), newWidget);
+        if (deletedLids.contains(lid))
+            continue;
+        found.insert(lid);
+        NNotebookViewItem *newWidget = dataStore.value(lid, NULL);
+        if (newWidget == NULL) {
+            newWidget = new NNotebookViewItem(lid);
+            this->dataStore.insert(lid, newWidget);
             root->addChild(newWidget);
+        }
+        newWidget->setData(NAME_POSITION, Qt::DisplayRole, query.value(1).toString());
+        newWidget->setData(NAME_POSITION, Qt::UserRole, lid);
+        if (closedLids.contains(lid))
+            newWidget->setHidden(true);
+        else
+            newWidget->setHidden(false);
+        QString username = query.value(3).toString();
+        if (username.trimmed() != "")
+            newWidget->stack = username;
+        else
+            newWidget->stack = query.value(2).toString();
 
-            if (newWidget->stack != "" && !stackStore.contains(newWidget->stack)) {
-                NNotebookViewItem *stackWidget = new NNotebookViewItem(0);
-                stackWidget->setData(NAME_POSITION, Qt::DisplayRole, newWidget->stack);
-                stackWidget->setData(NAME_POSITION, Qt::UserRole, "STACK");
-                if (username != "")
-                    stackWidget->setType(NNotebookViewItem::LinkedStack);
-                stackStore.insert(newWidget->stack, stackWidget);
-                root->addChild(stackWidget);
-            }
+        if (newWidget->stack != "" && !stackStore.contains(newWidget->stack)) {
+            NNotebookViewItem *stackWidget = new NNotebookViewItem(0);
+            stackWidget->setData(NAME_POSITION, Qt::DisplayRole, newWidget->stack);
+            stackWidget->setData(NAME_POSITION, Qt::UserRole, "STACK");
+            if (username != "")
+                stackWidget->setType(NNotebookViewItem::LinkedStack);
+            stackStore.insert(newWidget->stack, stackWidget);
+            root->addChild(stackWidget);
         }
     }
     query.finish();
+
+    // Remove anything which is no longer in the database
+    QList<qint32> keys = dataStore.keys();
+    for (int i=0; i<keys.size(); i++) {
+        if (!found.contains(keys[i]))
+            releaseItem(dataStore.take(keys[i]));
+    }
+    releaseRetiredItems();
+
+    this->rebuildNotebookTreeNeeded = true;
     this->rebuildTree();
     this->resetSize();
 }
 
 
+
+// Take an item out of the tree & free it.  Its children are moved to the
+// root until the tree is rebuilt.  Items the selection history still
+// points to are kept until the history no longer needs them.
+void NNotebookView::releaseItem(NNotebookViewItem *item) {
+    if (item == NULL)
+        return;
+    root->addChildren(item->takeChildren());
+    if (item->parent() != NULL)
+        item->parent()->removeChild(item);
+    if (global.filterCriteria.usesItem(item))
+        retiredItems.append(item);
+    else
+        delete item;
+}
+
+
+
+// Free any removed items the history no longer points to.
+void NNotebookView::releaseRetiredItems() {
+    for (int i=retiredItems.size()-1; i>=0; i--) {
+        if (!global.filterCriteria.usesItem(retiredItems[i]))
+            delete retiredItems.takeAt(i);
+    }
+}
+
+
 // Rebuild the notebook tree view
 void NNotebookView::rebuildTree() {
     if (!this->rebuildNotebookTreeNeeded)
@@ -295,10 +337,16 @@ void NNotebookView::rebuildTree() {
     // it should be hidden (because the notebook is closed
     // then hide it, othwise make it visible.  If it has
     // a stack, then save the stack name later so we can
-    // display stacks properly.
+    // display stacks properly.  Widgets are only moved
+    // if their stack changed.
     NotebookTable notebookTable(global.db);
     QList<qint32> closedLids;
     notebookTable.getClosedNotebooks(closedLids);
+    QHashIterator<QString, NNotebookViewItem *> c(stackStore);
+    while (c.hasNext()) {
+        c.next();
+        c.value()->childrenLids.clear();
+    }
     QHashIterator<qint32, NNotebookViewItem *> i(dataStore);
     while (i.hasNext()) {
         i.next();
@@ -309,15 +357,22 @@ void NNotebookView::rebuildTree() {
                 if (stackStore.contains(i.value()->stack)) {
                     stackWidget = stackStore[i.value()->stack];
                 } else {
-                    NNotebookViewItem *stackWidget = new NNotebookViewItem(0);
+                    stackWidget = new NNotebookViewItem(0);
                     stackWidget->setData(NAME_POSITION, Qt::DisplayRole, i.value()->stack);
                     stackWidget->setData(NAME_POSITION, Qt::UserRole, "STACK");
                     stackStore.insert(widget->stack, stackWidget);
                     root->addChild(stackWidget);
                 }
-                i.value()->parent()->removeChild(i.value());
+                if (widget->parent() != stackWidget) {
+                    if (widget->parent() != NULL)
+                        widget->parent()->removeChild(widget);
+                    stackWidget->addChild(widget);
+                }
                 stackWidget->childrenLids.append(i.key());
-                stackWidget->addChild(i.value());
+            } else if (widget->parent() != root) {
+                if (widget->parent() != NULL)
+                    widget->parent()->removeChild(widget);
+                root->addChild(widget);
             }
             if (closedLids.contains(widget->lid))
                 widget->setHidden(true);
@@ -331,7 +386,7 @@ void NNotebookView::rebuildTree() {
     while (s.hasNext()) {
         s.next();
         if (s.value()->childCount() == 0) {
-            root->removeChild(s.value());
+            releaseItem(s.value());
             stackStore.remove(s.key());
         } else {
             s.value()->setHidden(true);  // hide by default.  We'll unhide later when chirdren are found
@@ -520,15 +575,11 @@ void NNotebookView::notebookExpunged(qint32 lid) {
         NNotebookViewItem *parent = (NNotebookViewItem*)item->parent();
         //this->removeItemWidget(item, 0);
         dataStore.remove(lid);
-        if (parent != NULL) {
-            parent->removeChild(item);
-            if (parent->childCount() == 0 && parent->parent() != NULL) {
-               parent->parent()->removeChild(parent);
-                stackStore.remove(parent->stack);
-                dataStore.remove(parent->lid);
-            }
+        releaseItem(item);
+        if (parent != NULL && parent->childCount() == 0 && parent->parent() != NULL) {
+            stackStore.remove(parent->data(NAME_POSITION, Qt::DisplayRole).toString());
+            releaseItem(parent);
         }
-        //delete item;
 
     }
     this->resetSize();
@@ -964,24 +1015,20 @@ bool NNotebookView::dropMimeData(QTreeWidgetItem *parent, int index, const QMime
         Notebook notebook;
         bookTable.get(notebook, bookLid);
 
-        // The string has a long list of note lids.  We parse them out & update the note
+        // The string has a long list of note lids.  We parse them out & update the notes
         QStringList stringLids = data.split(" ");
+        QList<qint32> noteLids;
         for (int i=0; i<stringLids.size(); i++) {
-            if (stringLids[i].trimmed() != "") {
-                qint32 noteLid = stringLids.at(i).toInt();
-                if (noteLid > 0) {
-                    NoteTable noteTable(global.db);
-                    qint32 currentNotebook = noteTable.getNotebookLid(noteLid);
-                    if (currentNotebook != bookLid) {
-                        noteTable.updateNotebook(noteLid, bookLid, true);
-                        emit(updateNoteList(noteLid, NOTE_TABLE_NOTEBOOK_POSITION, notebook.name.value()));
-//                        qint64 dt = QDateTime::currentMSecsSinceEpoch();
-//                        noteTable.updateDate(noteLid,  dt, NOTE_UPDATED_DATE, true);
-//                        emit(updateNoteList(noteLid, NOTE_TABLE_DATE_UPDATED_POSITION, dt));
-                    }
-                }
-            }
+            qint32 noteLid = stringLids.at(i).trimmed().toInt();
+            if (noteLid > 0)
+                noteLids.append(noteLid);
         }
+        NoteTable noteTable(global.db);
+        noteTable.moveToNotebook(noteLids, bookLid, true);
+        if (noteLids.size() == 1)
+            emit(updateNoteList(noteLids[0], NOTE_TABLE_NOTEBOOK_POSITION, notebook.name.value()));
+        else if (noteLids.size() > 1)
+            emit(refreshNoteList());
         if (stringLids.size() > 0) {
             emit(updateCounts());
         }
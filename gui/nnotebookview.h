@@ -48,6 +48,9 @@ private:
     void sortStackMenu();
     QImage *collapsedImage;
     QImage *expandedImage;
+    QList<NNotebookViewItem*> retiredItems;    // Removed items the history still points to
+    void releaseItem(NNotebookViewItem *item);
+    void releaseRetiredItems();
 
 
 private slots:
@@ -81,6 +84,7 @@ signals:
     void stackRenamed(QString oldName, QString newName);
     void notebookSelectionChanged(qint32);
     void updateNoteList(qint32 noteLid, int column, QVariant tags);
+    void refreshNoteList();
     void updateCounts();
 
 public slots:
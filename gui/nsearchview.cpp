@@ -64,7 +64,7 @@ NSearchView::NSearchView(QWidget *parent) :
     root->setData(NAME_POSITION, Qt::UserRole, "root");
     root->setData(NAME_POSITION, Qt::DisplayRole, tr("Saved Searches"));
     this->addTopLevelItem(root);
-    this->loadData();
+    // The data is loaded by NixNote once the main window is showing.
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     connect(this, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(calculateHeight()));
@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "sql/notebooktable.h"
 #include "utilities/nuuid.h"
 #include "dialog/noteproperties.h"
+#include "html/thumbnailer.h"
 
 //*****************************************************************
 //* This class overrides QTableView and is used to provide a
@@ -124,6 +125,7 @@ NTableView::NTableView(QWidget *parent) :
     this->setColumnHidden(NOTE_TABLE_SOURCE_APPLICATION_POSITION, true);
     this->setColumnHidden(NOTE_TABLE_PINNED_POSITION, true);
     this->setColumnHidden(NOTE_TABLE_COLOR_POSITION, true);
+    this->setColumnHidden(NOTE_TABLE_RELEVANCE_POSITION, true);
 
     blockSignals(true);
     if (!isColumnHidden(NOTE_TABLE_DATE_CREATED_POSITION))
@@ -167,8 +169,11 @@ NTableView::NTableView(QWidget *parent) :
 
     if (!isColumnHidden(NOTE_TABLE_REMINDER_ORDER_POSITION))
         tableViewHeader->reminderOrderAction->setChecked(true);
+    if (!isColumnHidden(NOTE_TABLE_RELEVANCE_POSITION))
+        tableViewHeader->relevanceAction->setChecked(true);
 
     connect(tableViewHeader, SIGNAL(setColumnVisible(int,bool)), this, SLOT(toggleColumnVisible(int,bool)));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(requestVisibleThumbnails()));
 
     blockSignals(false);
 
@@ -195,6 +200,7 @@ NTableView::NTableView(QWidget *parent) :
     this->model()->setHeaderData(NOTE_TABLE_SIZE_POSITION, Qt::Horizontal, QObject::tr("Size"));
     this->model()->setHeaderData(NOTE_TABLE_THUMBNAIL_POSITION, Qt::Horizontal, QObject::tr("Thumbnail"));
     this->model()->setHeaderData(NOTE_TABLE_PINNED_POSITION, Qt::Horizontal, QObject::tr("Pinned"));
+    this->model()->setHeaderData(NOTE_TABLE_RELEVANCE_POSITION, Qt::Horizontal, QObject::tr("Relevance"));
 
     contextMenu = new QMenu(this);
     this->setFont(global.getGuiFont(font()));
@@ -475,6 +481,16 @@ void NTableView::refreshData() {
     while(model()->canFetchMore())
         model()->fetchMore();
 
+    // Rank the notes by the search string if the user can see or sort by it
+    noteModel->relevance.clear();
+    FilterCriteria *criteria = global.filterCriteria[global.filterPosition];
+    if (criteria->isSearchStringSet() &&
+            (!isColumnHidden(NOTE_TABLE_RELEVANCE_POSITION) ||
+             tableViewHeader->sortIndicatorSection() == NOTE_TABLE_RELEVANCE_POSITION)) {
+        FilterEngine engine;
+        engine.getRelevance(noteModel->relevance, criteria->getSearchString());
+    }
+
     // resort the table.  I'm not sure why, but it doesn't always
     // do this itself.
     Qt::SortOrder so = this->tableViewHeader->sortIndicatorOrder();
@@ -493,6 +509,28 @@ void NTableView::refreshData() {
         verticalHeader()->setDefaultSectionSize(fm.height());
         //verticalHeader()->setDefaultSectionSize(QApplication::fontMetrics().height()*200);
     }
+    requestVisibleThumbnails();
+}
+
+
+
+// Ask the thumbnailer to render any notes currently on the screen
+// which don't have a thumbnail yet, ahead of anything else.
+void NTableView::requestVisibleThumbnails() {
+    if (global.thumbnailer == NULL || !this->tableViewHeader->isThumbnailVisible())
+        return;
+    int first = rowAt(0);
+    int last = rowAt(viewport()->height()-1);
+    if (first < 0)
+        return;
+    if (last < 0)
+        last = proxy->rowCount()-1;
+    QList<qint32> lids;
+    for (int i=first; i<=last; i++) {
+        QModelIndex idx = proxy->index(i, NOTE_TABLE_LID_POSITION);
+        lids.append(idx.data().toInt());
+    }
+    global.thumbnailer->request(lids, Thumbnailer::Visible);
 }
 
 
@@ -633,11 +671,10 @@ void NTableView::restoreSelectedNotes() {
         return;
 
     NoteTable ntable(global.db);
+    ntable.restoreMany(lids, true);
     NSqlQuery sql(global.db);
-    //transaction.exec("begin");
     sql.prepare("Delete from filter where lid=:lid");
     for (int i=0; i<lids.size(); i++) {
-        ntable.restoreNote(lids[i], true);
         sql.bindValue(":lid", lids[i]);
         sql.exec();
         global.cache.remove(lids[i]);
@@ -684,20 +721,18 @@ void NTableView::deleteSelectedNotes() {
         return;
 
     NoteTable ntable(global.db);
+    if (expunged)
+        ntable.expungeMany(lids, true);
+    else
+        ntable.deleteMany(lids, true);
     NSqlQuery sql(global.db);
-//    NSqlQuery transaction(*global.db);
-    //transaction.exec("begin");
     sql.prepare("Delete from filter where lid=:lid");
     for (int i=0; i<lids.size(); i++) {
-        ntable.deleteNote(lids[i], true);
-        if (expunged)
-            ntable.expunge(lids[i]);
         sql.bindValue(":lid", lids[i]);
         sql.exec();
         delete global.cache[lids[i]];
         global.cache.remove(lids[i]);
     }
-    //transaction.exec("commit");
     sql.finish();
     emit(notesDeleted(lids, expunged));
 }
@@ -957,6 +992,8 @@ void NTableView::copyNoteLink() {
 // Toggle columns hidden or visible
 void NTableView::toggleColumnVisible(int position, bool visible) {
     setColumnHidden(position, !visible);
+    if (position == NOTE_TABLE_RELEVANCE_POSITION && visible)
+        refreshData();
     if (this->tableViewHeader->isThumbnailVisible())
         verticalHeader()->setDefaultSectionSize(100);
     else
@@ -1050,6 +1087,9 @@ void NTableView::saveColumnsVisible() {
     value = isColumnHidden(NOTE_TABLE_PINNED_POSITION);
     global.settings->setValue("isPinned", value);
 
+    value = isColumnHidden(NOTE_TABLE_RELEVANCE_POSITION);
+    global.settings->setValue("relevance", value);
+
     global.settings->endGroup();
 }
 
@@ -1147,6 +1187,10 @@ void NTableView::setColumnsVisible() {
     tableViewHeader->pinnedAction->setChecked(!value);
     setColumnHidden(NOTE_TABLE_PINNED_POSITION, value);
 
+    value = global.settings->value("relevance", true).toBool();
+    tableViewHeader->relevanceAction->setChecked(!value);
+    setColumnHidden(NOTE_TABLE_RELEVANCE_POSITION, value);
+
     global.settings->endGroup();
 }
 
@@ -1249,6 +1293,10 @@ void NTableView::repositionColumns() {
     to = global.getColumnPosition("noteTableReminderOrderPosition");
     if (to>=0) horizontalHeader()->moveSection(from, to);
 
+    from = horizontalHeader()->visualIndex(NOTE_TABLE_RELEVANCE_POSITION);
+    to = global.getColumnPosition("noteTableRelevancePosition");
+    if (to>=0) horizontalHeader()->moveSection(from, to);
+
 }
 
 
@@ -1302,6 +1350,8 @@ void NTableView::resizeColumns() {
     if (width>0) setColumnWidth(NOTE_TABLE_REMINDER_TIME_DONE_POSITION, width);
     width = global.getColumnWidth("noteTableReminderOrderPosition");
     if (width>0) setColumnWidth(NOTE_TABLE_REMINDER_ORDER_POSITION, width);
+    width = global.getColumnWidth("noteTableRelevancePosition");
+    if (width>0) setColumnWidth(NOTE_TABLE_RELEVANCE_POSITION, width);
 }
 
 
@@ -1415,14 +1465,14 @@ void NTableView::mergeNotes() {
         content = note.content;
     content = content.replace("</en-note>","<p/>");
 
-    // Duplicate the source notes so we can undelete them later if something
-    // goes horribly wrong
+    // Copy the source notes' resources so the source notes can be undeleted
+    // later if something goes horribly wrong.  The copies share their data
+    // with the originals, so nothing is read or rewritten.
     for (int i=1; i<lids.size(); i++) {
-        qint32 newLid = nTable.duplicateNote(lids[i]);
         QList<qint32> resLids;
-        rTable.getResourceList(resLids, newLid);
+        rTable.getResourceList(resLids, lids[i]);
         for (int j=0; j<resLids.size(); j++) {
-            rTable.updateNoteLid(resLids[j], lid);
+            rTable.duplicateResource(resLids[j], lid);
         }
 
         Note oldNote;
@@ -1435,7 +1485,6 @@ void NTableView::mergeNotes() {
         QLOG_DEBUG() << content;
 
         nTable.deleteNote(lids[i], true);
-        nTable.expunge(newLid);
     }
     content = content+QString("</en-note>");
     QLOG_DEBUG() << content;
@@ -154,6 +154,7 @@ public slots:
 
     void downNote();
     void upNote();
+    void requestVisibleThumbnails();
 
 };
 
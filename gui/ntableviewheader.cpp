@@ -144,6 +144,10 @@ NTableViewHeader::NTableViewHeader(Qt::Orientation orientation, QWidget *parent)
     thumbnailAction->setCheckable(true);
     addAction(thumbnailAction);
 
+    relevanceAction = new QAction(this);
+    relevanceAction->setText(tr("Relevance"));
+    relevanceAction->setCheckable(true);
+    addAction(relevanceAction);
 
     this->setMouseTracking(true);
 
@@ -170,6 +174,7 @@ NTableViewHeader::NTableViewHeader(Qt::Orientation orientation, QWidget *parent)
    connect(reminderTimeDoneAction, SIGNAL(toggled(bool)), this, SLOT(reminderTimeDoneChecked(bool)));
    connect(reminderOrderAction, SIGNAL(toggled(bool)), this, SLOT(reminderOrderChecked(bool)));
    connect(pinnedAction, SIGNAL(toggled(bool)), this, SLOT(pinnedChecked(bool)));
+   connect(relevanceAction, SIGNAL(toggled(bool)), this, SLOT(relevanceChecked(bool)));
 
     this->setFont(global.getGuiFont(font()));
 }
@@ -297,6 +302,11 @@ void NTableViewHeader::pinnedChecked(bool checked) {
     checkActions();
 }
 
+void NTableViewHeader::relevanceChecked(bool checked) {
+    emit (setColumnVisible(NOTE_TABLE_RELEVANCE_POSITION, checked));
+    checkActions();
+}
+
 bool NTableViewHeader::isThumbnailVisible() {
     return thumbnailAction->isChecked();
 }
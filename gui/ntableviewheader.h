@@ -52,6 +52,7 @@ public:
     QAction *reminderOrderAction;
     QAction *reminderTimeDoneAction;
     QAction *pinnedAction;
+    QAction *relevanceAction;
     void checkActions();
     bool isThumbnailVisible();
 
@@ -84,6 +85,7 @@ public slots:
     void reminderTimeDoneChecked(bool);
     void reminderOrderChecked(bool);
     void pinnedChecked(bool);
+    void relevanceChecked(bool);
 };
 
 #endif // NTABLEVIEWHEADER_H
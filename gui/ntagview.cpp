@@ -37,6 +37,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "sql/notetable.h"
 #include <QMessageBox>
 #include <QPainter>
+#include <QSet>
+#include <QTimer>
 
 #define NAME_POSITION 0
 
@@ -73,7 +75,8 @@ NTagView::NTagView(QWidget *parent) :
     this->setMinimumHeight(1);
     this->addTopLevelItem(root);
     this->rebuildTagTreeNeeded = true;
-    this->loadData();
+    resortPending = false;
+    // The data is loaded by NixNote once the main window is showing.
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     connect(this, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(calculateHeight()));
@@ -234,30 +237,26 @@ void NTagView::mousePressEvent(QMouseEvent *event)
 
 // Load up the data from the database
 void NTagView::loadData() {
+    loadGuidMap();
 
-    // Empty out the old data store
-    QList<qint32> keys = dataStore.keys();
-    for (int i=0; i<keys.size(); i++) {
-        if (dataStore.contains(keys[i])) {
-            NTagViewItem *ptr = dataStore.take(keys[i]);
-            dataStore.remove(keys[i]);
-            if (ptr->parent() != NULL)
-                ptr->parent()->removeChild(ptr);
-            ptr->setHidden(true);
-           // delete ptr;  << We can leak memory, but otherwise it sometimes gets confused and causes crashes
-        }
-    }
-
+    // Update the items we already have in place so anything pointing
+    // at them (like the selection history) stays valid.
+    QSet<qint32> found;
     NSqlQuery query(global.db);
-    TagTable tagTable(global.db);
     query.exec("Select lid, name, parent_gid, account from TagModel order by name");
     while (query.next()) {
         qint32 lid = query.value(0).toInt();
         QString name = query.value(1).toString();
         QString parentGid = query.value(2).toString();
         qint32 account = query.value(3).toInt();
+        found.insert(lid);
 
-        NTagViewItem *newWidget = new NTagViewItem();
+        NTagViewItem *newWidget = dataStore.value(lid, NULL);
+        if (newWidget == NULL) {
+            newWidget = new NTagViewItem();
+            root->addChild(newWidget);
+            this->dataStore.insert(lid, newWidget);
+        }
         newWidget->setData(NAME_POSITION, Qt::DisplayRole, name);
         newWidget->setData(NAME_POSITION, Qt::UserRole, lid);
         newWidget->account = account;
@@ -265,38 +264,116 @@ void NTagView::loadData() {
             newWidget->setHidden(true);
         else
             newWidget->setHidden(false);
-        this->dataStore.insert(lid, newWidget);
         newWidget->parentGuid = parentGid;
-        newWidget->parentLid = tagTable.getLid(parentGid);
-        root->addChild(newWidget);
+        newWidget->parentLid = getGuidLid(parentGid);
     }
     query.finish();
+
+    // Remove anything which is no longer in the database
+    QList<qint32> keys = dataStore.keys();
+    for (int i=0; i<keys.size(); i++) {
+        if (!found.contains(keys[i]))
+            releaseItem(dataStore.take(keys[i]));
+    }
+    releaseRetiredItems();
+
+    this->rebuildTagTreeNeeded = true;
     this->rebuildTree();
 }
 
 
-// Rebuild the GUI tree.
+
+// Load the tag guid to lid map in one query rather than
+// looking up each tag's parent separately.
+void NTagView::loadGuidMap() {
+    guidLids.clear();
+    NSqlQuery query(global.db);
+    query.prepare("Select data, lid from DataStore where key=:key");
+    query.bindValue(":key", TAG_GUID);
+    query.exec();
+    while (query.next())
+        guidLids.insert(query.value(0).toString(), query.value(1).toInt());
+    query.finish();
+}
+
+
+
+// Get the lid for a tag guid.  Tags added since the map was
+// loaded are looked up & remembered.
+qint32 NTagView::getGuidLid(QString guid) {
+    if (guid == "")
+        return 0;
+    if (guidLids.contains(guid))
+        return guidLids[guid];
+    TagTable tagTable(global.db);
+    qint32 lid = tagTable.getLid(guid);
+    if (lid > 0)
+        guidLids.insert(guid, lid);
+    return lid;
+}
+
+
+
+// Take an item out of the tree & free it.  Its children are moved to the
+// root until the tree is rebuilt.  Items the selection history still
+// points to are kept until the history no longer needs them.
+void NTagView::releaseItem(NTagViewItem *item) {
+    if (item == NULL)
+        return;
+    root->addChildren(item->takeChildren());
+    if (item->parent() != NULL)
+        item->parent()->removeChild(item);
+    if (global.filterCriteria.usesItem(item))
+        retiredItems.append(item);
+    else
+        delete item;
+}
+
+
+
+// Free any removed items the history no longer points to.
+void NTagView::releaseRetiredItems() {
+    for (int i=retiredItems.size()-1; i>=0; i--) {
+        if (!global.filterCriteria.usesItem(retiredItems[i]))
+            delete retiredItems.takeAt(i);
+    }
+}
+
+
+// Rebuild the GUI tree.  Items are only moved if their parent changed.
 void NTagView::rebuildTree() {
     if (!this->rebuildTagTreeNeeded)
         return;
 
     QHashIterator<qint32, NTagViewItem *> i(dataStore);
-    TagTable tagTable(global.db);
+    while (i.hasNext()) {
+        i.next();
+        if (i.value() != NULL)
+            i.value()->childrenLids.clear();
+    }
 
+    i.toFront();
     while (i.hasNext()) {
         i.next();
         NTagViewItem *widget = i.value();
-        if (widget != NULL && widget->parentGuid != "") {
+        if (widget == NULL)
+            continue;
+        NTagViewItem *parent = root;
+        if (widget->parentGuid != "") {
             if (widget->parentLid == 0) {
-                widget->parentLid = tagTable.getLid(widget->parentGuid);
+                widget->parentLid = getGuidLid(widget->parentGuid);
             }
-            NTagViewItem *parent = dataStore[widget->parentLid];
-            widget->parent()->removeChild(widget);
-            if (parent != NULL) {
-                parent->childrenLids.append(i.key());
-                parent->addChild(widget);
+            NTagViewItem *parentWidget = dataStore.value(widget->parentLid, NULL);
+            if (parentWidget != NULL) {
+                parentWidget->childrenLids.append(i.key());
+                parent = parentWidget;
             }
         }
+        if (widget->parent() != parent) {
+            if (widget->parent() != NULL)
+                widget->parent()->removeChild(widget);
+            parent->addChild(widget);
+        }
     }
     this->sortByColumn(NAME_POSITION, Qt::AscendingOrder);
     this->rebuildTagTreeNeeded = false;
@@ -304,6 +381,24 @@ void NTagView::rebuildTree() {
 }
 
 
+
+// Sort the tree & recalculate its size once the current batch of
+// updates (like a sync) has been handled, rather than after each tag.
+void NTagView::scheduleResort() {
+    if (resortPending)
+        return;
+    resortPending = true;
+    QTimer::singleShot(0, this, SLOT(resortTree()));
+}
+
+
+void NTagView::resortTree() {
+    resortPending = false;
+    this->sortByColumn(NAME_POSITION);
+    resetSize();
+}
+
+
 // A tag has been updated.   Things like a sync can cause this to be called
 // because a tag's name may have changed.
 void NTagView::tagUpdated(qint32 lid, QString name, QString parentGuid, qint32 account) {
@@ -312,7 +407,6 @@ void NTagView::tagUpdated(qint32 lid, QString name, QString parentGuid, qint32 a
 
     qint32 parentLid = 0;
     NTagViewItem *parentWidget = root;
-    TagTable tagTable(global.db);
 
     // Check if it already exists and if its parent exists
     NTagViewItem *newWidget = NULL;
@@ -326,7 +420,7 @@ void NTagView::tagUpdated(qint32 lid, QString name, QString parentGuid, qint32 a
         dataStore.remove(lid);
         dataStore.insert(lid, newWidget);
     }
-    parentLid = tagTable.getLid(parentGuid);
+    parentLid = getGuidLid(parentGuid);
     if (parentGuid != "") {
         if (parentLid > 0 && dataStore.contains(parentLid)) {
             parentWidget = dataStore[parentLid];
@@ -344,7 +438,9 @@ void NTagView::tagUpdated(qint32 lid, QString name, QString parentGuid, qint32 a
                 parentTag.guid = parentGuid;
                 parentTag.updateSequenceNum = 0;
                 parentTag.name = parentGuid;
+                TagTable tagTable(global.db);
                 parentLid = tagTable.add(0, parentTag, false, account);
+                guidLids.insert(parentGuid, parentLid);
             }
             parentWidget = new NTagViewItem();
             root->addChild(parentWidget);
@@ -370,8 +466,7 @@ void NTagView::tagUpdated(qint32 lid, QString name, QString parentGuid, qint32 a
     if (this->dataStore.count() == 1) {
         this->expandAll();
     }
-    resetSize();
-    this->sortByColumn(NAME_POSITION);
+    scheduleResort();
 }
 
 
@@ -507,24 +602,20 @@ bool NTagView::dropMimeData(QTreeWidgetItem *parent, int index, const QMimeData
         // Find the tag lid we dropped onto
         qint32 tagLid = parent->data(NAME_POSITION, Qt::UserRole).toInt();
 
-        // The string has a long list of note lids.  We parse them out & update the note
+        // The string has a long list of note lids.  We parse them out & update the notes
         QStringList stringLids = data.split(" ");
+        QList<qint32> noteLids;
         for (int i=0; i<stringLids.size(); i++) {
-            if (stringLids[i].trimmed() != "") {
-                qint32 noteLid = stringLids.at(i).toInt();
-                if (noteLid > 0) {
-                    NoteTable noteTable(global.db);
-                    if (!noteTable.hasTag(noteLid, tagLid)) {
-                        noteTable.addTag(noteLid, tagLid, true);
-                        QString tagString = noteTable.getNoteListTags(noteLid);
-                        emit(updateNoteList(noteLid, NOTE_TABLE_TAGS_POSITION, tagString));
-//                        qint64 dt = QDateTime::currentMSecsSinceEpoch();
-//                        noteTable.updateDate(noteLid,  dt, NOTE_UPDATED_DATE, true);
-//                        emit(updateNoteList(noteLid, NOTE_TABLE_DATE_UPDATED_POSITION, dt));
-                    }
-                }
-            }
+            qint32 noteLid = stringLids.at(i).trimmed().toInt();
+            if (noteLid > 0)
+                noteLids.append(noteLid);
         }
+        NoteTable noteTable(global.db);
+        noteTable.addTag(noteLids, tagLid, true);
+        if (noteLids.size() == 1)
+            emit(updateNoteList(noteLids[0], NOTE_TABLE_TAGS_POSITION, noteTable.getNoteListTags(noteLids[0])));
+        else if (noteLids.size() > 1)
+            emit(refreshNoteList());
         if (stringLids.size() > 0)
             emit updateCounts();
         return true;
@@ -717,17 +808,9 @@ void NTagView::mergeRequested() {
     QList<qint32> notes;
     for (int j=1; j<items.size(); j++) {
         ntable.findNotesByTag(notes, items[j]->data(NAME_POSITION, Qt::UserRole).toInt());
-        for (int i=0; i<notes.size(); i++) {
-            if (!ntable.hasTag(notes[i], lid)) {
-                ntable.addTag(notes[i], lid, true);
-                QString tagString = ntable.getNoteListTags(notes[i]);
-                emit(updateNoteList(notes[i], NOTE_TABLE_TAGS_POSITION, tagString));
-//                qint64 dt = QDateTime::currentMSecsSinceEpoch();
-//                ntable.updateDate(notes[i],  dt, NOTE_UPDATED_DATE, true);
-//                emit(updateNoteList(notes[i], NOTE_TABLE_DATE_UPDATED_POSITION, dt));
-            }
-        }
+        ntable.addTag(notes, lid, true);
     }
+    emit(refreshNoteList());
 
     // Now delete the old tags.
     for (int i=1; i<items.size(); i++) {
@@ -838,9 +921,14 @@ void NTagView::editComplete() {
 void NTagView::tagExpunged(qint32 lid) {
     // Check if it already exists
     if (this->dataStore.contains(lid)) {
-        NTagViewItem *item = this->dataStore.value(lid);
-        item->parent()->removeChild(item);
-        this->dataStore.remove(lid);
+        releaseItem(this->dataStore.take(lid));
+        QMutableHashIterator<QString, qint32> i(guidLids);
+        while (i.hasNext()) {
+            if (i.next().value() == lid)
+                i.remove();
+        }
+        this->rebuildTagTreeNeeded = true;
+        this->rebuildTree();
     }
     this->resetSize();
 }
@@ -904,12 +992,15 @@ void NTagView::hideUnassignedTags() {
         }
     }
 
+    // Walk up from each visible tag.  We can stop at the first visible
+    // parent since its own parents were (or will be) made visible by it.
     for (int i=0; i<keys.size(); i++) {
         item = dataStore[keys[i]];
         if (item != NULL && !item->isHidden()) {
-            while(item->parentLid > 0) {
-                item->parent()->setHidden(false);
-                item = (NTagViewItem*)item->parent();
+            QTreeWidgetItem *parent = item->parent();
+            while (parent != NULL && parent != root && parent->isHidden()) {
+                parent->setHidden(false);
+                parent = parent->parent();
             }
         }
     }
@@ -48,11 +48,20 @@ private:
     qint32 accountFilter;
     QImage *expandedImage;
     QImage *collapsedImage;
+    QHash<QString, qint32> guidLids;           // Tag guid to lid map used to find parents
+    QList<NTagViewItem*> retiredItems;         // Removed items the history still points to
+    bool resortPending;
+    void loadGuidMap();
+    qint32 getGuidLid(QString guid);
+    void releaseItem(NTagViewItem *item);
+    void releaseRetiredItems();
+    void scheduleResort();
 
 private slots:
     int calculateHeightRec(QTreeWidgetItem * item);
     void calculateHeight();
     void editComplete();
+    void resortTree();
 
 public:
     NTagViewItem *root;
@@ -82,6 +91,7 @@ signals:
     void tagDeleted(qint32 lid, QString name);
     void tagAdded(qint32 lid);
     void updateNoteList(qint32 noteLid, int column, QVariant tags);
+    void refreshNoteList();
     void updateCounts();
 
 public slots:
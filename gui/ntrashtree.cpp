@@ -220,8 +220,8 @@ void NTrashTree::restoreAll() {
     NoteTable ntable(global.db);
     QList<qint32> lids;
     ntable.getAllDeleted(lids);
+    ntable.restoreMany(lids, true);
     for (int i=0; i<lids.size(); i++) {
-        ntable.restoreNote(lids[i], true);
         delete global.cache[lids[i]];
         global.cache.remove(lids[i]);
     }
@@ -247,19 +247,13 @@ void NTrashTree::expungeAll() {
     NoteTable ntable(global.db);
     QList<qint32> lids;
     ntable.getAllDeleted(lids);
-    for (int i=0; i<lids.size(); i++) {
 
-        Note n;
-        ntable.get(n,lids[i],false,false);
-        ntable.expunge(lids[i]);
+    // Synchronized notes are kept in the delete queue so Evernote
+    // can be told to delete them.
+    ntable.expungeMany(lids, true);
+    for (int i=0; i<lids.size(); i++) {
         delete global.cache[lids[i]];
         global.cache.remove(lids[i]);
-
-        // Check to see if the note is synchronized.  If so, we
-        // need to keep it to let Evernote to delete it.
-        if (n.updateSequenceNum.isSet() && n.updateSequenceNum>0) {
-            ntable.addToDeleteQueue(lids[i],n);
-        }
     }
     emit(updateSelectionRequested());
 }
@@ -0,0 +1,108 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "popplerrenderer.h"
+#if QT_VERSION < 0x050000
+#include <poppler-qt4.h>
+#else
+#include <poppler-qt5.h>
+#endif
+
+
+PopplerRenderTask::PopplerRenderTask(QString file, int page, double dpi, bool preview) :
+    QObject(0)
+{
+    this->file = file;
+    this->page = page;
+    this->dpi = dpi;
+    this->preview = preview;
+    setAutoDelete(true);
+}
+
+
+
+// Rendering can take seconds for large scanned pages, so it is kept to
+// a couple of threads to leave the rest of the machine responsive.
+QThreadPool *PopplerRenderTask::pool() {
+    static QThreadPool *renderPool = NULL;
+    if (renderPool == NULL) {
+        renderPool = new QThreadPool();
+        renderPool->setMaxThreadCount(2);
+    }
+    return renderPool;
+}
+
+
+
+void PopplerRenderTask::run() {
+    QImage image;
+    Poppler::Document *doc = Poppler::Document::load(file);
+    if (doc != NULL && !doc->isLocked() && page < doc->numPages()) {
+        Poppler::Page *pdfPage = doc->page(page);
+        if (pdfPage != NULL) {
+            image = pdfPage->renderToImage(dpi, dpi);
+            delete pdfPage;
+        }
+    }
+    if (doc != NULL)
+        delete doc;
+    emit rendered(page, image, preview);
+}
+
+
+
+
+PopplerTextTask::PopplerTextTask(QString file, QSharedPointer<QAtomicInt> cancelled) :
+    QObject(0)
+{
+    this->file = file;
+    this->cancelled = cancelled;
+    setAutoDelete(true);
+}
+
+
+
+// Go through the pages in order so the first hit is found as soon as
+// possible.  We stop early if the viewer is closed.
+void PopplerTextTask::run() {
+    Poppler::Document *doc = Poppler::Document::load(file);
+    if (doc == NULL)
+        return;
+    if (doc->isLocked()) {
+        delete doc;
+        return;
+    }
+    for (int i=0; i<doc->numPages() && cancelled->fetchAndAddRelaxed(0) == 0; i++) {
+        QStringList words;
+        QList<QRectF> boxes;
+        Poppler::Page *pdfPage = doc->page(i);
+        if (pdfPage != NULL) {
+            QList<Poppler::TextBox*> text = pdfPage->textList();
+            for (int j=0; j<text.size(); j++) {
+                words.append(text[j]->text());
+                boxes.append(text[j]->boundingBox());
+            }
+            qDeleteAll(text);
+            delete pdfPage;
+        }
+        emit pageText(i, words, boxes);
+    }
+    delete doc;
+}
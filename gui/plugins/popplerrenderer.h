@@ -0,0 +1,72 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#ifndef POPPLERRENDERER_H
+#define POPPLERRENDERER_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QImage>
+#include <QRectF>
+#include <QStringList>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QThreadPool>
+
+// Render a PDF page in the background.  Poppler documents can't be
+// shared between threads, so each task opens its own copy of the file.
+class PopplerRenderTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+private:
+    QString file;
+    int page;
+    double dpi;
+    bool preview;
+
+public:
+    PopplerRenderTask(QString file, int page, double dpi, bool preview);
+    void run();
+    static QThreadPool *pool();           // Threads shared by all the PDF viewers
+
+signals:
+    void rendered(int page, QImage image, bool preview);
+};
+
+
+
+// Extract the words & their locations from each page of a PDF so
+// search hits can be highlighted without searching the page again.
+class PopplerTextTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+private:
+    QString file;
+    QSharedPointer<QAtomicInt> cancelled;
+
+public:
+    PopplerTextTask(QString file, QSharedPointer<QAtomicInt> cancelled);
+    void run();
+
+signals:
+    void pageText(int page, QStringList words, QList<QRectF> boxes);
+};
+
+#endif // POPPLERRENDERER_H
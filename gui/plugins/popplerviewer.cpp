@@ -18,6 +18,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 ***********************************************************************************/
 
 #include "popplerviewer.h"
+#include "popplerrenderer.h"
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -30,53 +31,81 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QImage>
 #include <QPushButton>
 #include "filters/filterengine.h"
+#include "sql/pdftexttable.h"
 #include <global.h>
 
+#define PDF_DPI 72.0            // Resolution pages are shown at
+#define PDF_PREVIEW_DPI 36.0    // Resolution of the quick copy shown while a page renders
+#define PDF_CACHE_SIZE 32768    // KB of rendered pages kept by each viewer
+
 extern Global global;
 
+QHash<qint32, PopplerViewer*> PopplerViewer::openViewers;
+
 PopplerViewer::PopplerViewer(const QString &mimeType, const QString &reslid, QWidget *parent) :
     QWidget(parent)
 {
     pageLabel = new QLabel(this);
     this->mimeType = mimeType;
     this->lid = reslid.toInt();
-    printImageFile = global.fileManager.getTmpDirPath() + QString::number(lid) +QString("-print.png");
-    QString file = global.fileManager.getDbaDirPath() + reslid +".pdf";
+    scene = NULL;
+    item = NULL;
+    currentPage = 0;
+    totalPages = 0;
+    seekingHit = false;
+    textCached = false;
+    textCancelled = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+    pageCache.setMaxCost(PDF_CACHE_SIZE);
+    file = global.fileManager.getDbaDirPath() + reslid +".pdf";
     doc = Poppler::Document::load(file);
     if (doc == NULL || doc->isLocked())
         return;
 
-    currentPage = 0;
-
     totalPages = doc->numPages();
+    openViewers.insert(lid, this);
+    qRegisterMetaType< QList<QRectF> >("QList<QRectF>");
 
+    // If we are searching, find the words on each page.  If the indexer
+    // has already cached them we can go straight to the first page with
+    // a hit, otherwise they are found in the background and the first
+    // page with a hit is shown once it is found.
     FilterCriteria *criteria = global.filterCriteria[global.filterPosition];
     searchHits.empty();
-    QList<QRectF> searchLocations;
     if (criteria->isSearchStringSet() && criteria->getSearchString() != "") {
         FilterEngine engine;
         if (engine.resourceContains(lid, criteria->getSearchString(), &searchHits)) {
             pageLabel->setStyleSheet("QLabel { background-color : yellow; }");
-            findNextPage(searchHits, &searchLocations);
+            PdfTextTable pdfTable(global.db);
+            textCached = pdfTable.exists(lid);
+            if (textCached) {
+                QList<qint32> pages;
+                engine.pdfPagesContaining(pages, lid, criteria->getSearchString());
+                if (pages.size() > 0 && pages[0] < totalPages)
+                    currentPage = pages[0];
+            } else {
+                seekingHit = true;
+                PopplerTextTask *task = new PopplerTextTask(file, textCancelled);
+                connect(task, SIGNAL(pageText(int,QStringList,QList<QRectF>)), this, SLOT(pageTextLoaded(int,QStringList,QList<QRectF>)), Qt::QueuedConnection);
+                PopplerRenderTask::pool()->start(task, -1);
+            }
         }
     }
 
-
-    image = new QImage(doc->page(currentPage)->renderToImage());    
-
-    QPixmap finalPix = highlightImage();
-
+    // Size the scene from the first page so the layout doesn't
+    // jump around once the page has been rendered.
     scene = new QGraphicsScene();
+    Poppler::Page *firstPage = doc->page(0);
+    if (firstPage != NULL) {
+        QSizeF size = firstPage->pageSizeF();
+        scene->setSceneRect(0, 0, size.width()*PDF_DPI/72.0, size.height()*PDF_DPI/72.0);
+        delete firstPage;
+    }
     view = new PopplerGraphicsView(scene);
     view->filename = file;
-    item = new QGraphicsPixmapItem(finalPix);
-    finalPix.save(printImageFile);   // This is in case we want to print a note.  Otherwise it isn't used.
-    scene->addItem(item);
 
     view->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
-    pageLabel->setText(tr("Page ") +QString::number(currentPage+1) + QString(tr(" of ") +QString::number(totalPages)));
 
     pageLeft = new QPushButton();
     pageRight = new QPushButton();
@@ -95,85 +124,203 @@ PopplerViewer::PopplerViewer(const QString &mimeType, const QString &reslid, QWi
     this->setLayout(layout);
     connect(pageRight, SIGNAL(clicked()), this, SLOT(pageRightPressed()));
     connect(pageLeft, SIGNAL(clicked()), this, SLOT(pageLeftPressed()));
-    if (totalPages == 1) {
-        pageRight->setEnabled(false);
-    }
-    if (currentPage == 1)
-        pageLeft->setEnabled(false);
+    showPage();
+}
+
+
+
+PopplerViewer::~PopplerViewer() {
+    textCancelled->fetchAndStoreRelaxed(1);
+    if (openViewers.value(lid, NULL) == this)
+        openViewers.remove(lid);
+    if (scene != NULL)
+        delete scene;
+    if (doc != NULL)
+        delete doc;
 }
 
 
+
 void PopplerViewer::pageRightPressed() {
     if (currentPage+1 < totalPages) {
+        seekingHit = false;
         currentPage++;
-        if (image != NULL)
-            delete image;
-        image = new QImage(doc->page(currentPage)->renderToImage());
-        image->save(printImageFile);
-        if (item != NULL)
-            delete item;
-        QPixmap finalPix = highlightImage();
-        item = new QGraphicsPixmapItem(finalPix);
-        scene->addItem(item);
-        if (currentPage+1 == totalPages)
-            pageRight->setEnabled(false);
-        if (currentPage>0)
-            pageLeft->setEnabled(true);
-        pageLabel->setText(tr("Page ") +QString::number(currentPage+1) + QString(tr(" of ") +QString::number(totalPages)));
-
+        showPage();
     }
-
 }
 
 void PopplerViewer::pageLeftPressed() {
     if (currentPage>0) {
+        seekingHit = false;
         currentPage--;
-        if (image != NULL)
-            delete image;
-        image = new QImage(doc->page(currentPage)->renderToImage());
-        if (item != NULL)
-            delete item;
-
-        QPixmap finalPix = highlightImage();
-        item = new QGraphicsPixmapItem(finalPix);
-
-        scene->addItem(item);
-        if (currentPage==0)
-            pageLeft->setEnabled(false);
-        if (totalPages>1)
-            pageRight->setEnabled(true);
+        showPage();
+    }
+}
+
+
+
+// Show the current page.  If it hasn't been rendered yet a quick low
+// resolution copy is shown until it is.  The pages on either side are
+// rendered ahead of time so turning the page is immediate.
+void PopplerViewer::showPage() {
+    pageLabel->setText(tr("Page ") +QString::number(currentPage+1) + QString(tr(" of ") +QString::number(totalPages)));
+    pageLeft->setEnabled(currentPage > 0);
+    pageRight->setEnabled(currentPage+1 < totalPages);
+
+    if (pageCache.contains(currentPage)) {
+        displayImage(*pageCache.object(currentPage));
+    } else {
+        requestPage(currentPage, true);
+        requestPage(currentPage, false);
+    }
+    if (currentPage+1 < totalPages)
+        requestPage(currentPage+1, false);
+    if (currentPage > 0)
+        requestPage(currentPage-1, false);
+}
+
+
+
+// Queue a page to be rendered.  The page being viewed goes ahead of
+// any pages we are rendering in case the user turns to them.
+void PopplerViewer::requestPage(int page, bool preview) {
+    if (!preview && (pageCache.contains(page) || pendingPages.contains(page)))
+        return;
+    if (!preview)
+        pendingPages.insert(page);
+    int priority = 0;
+    if (page == currentPage)
+        priority = (preview ? 2 : 1);
+    PopplerRenderTask *task = new PopplerRenderTask(file, page, preview ? PDF_PREVIEW_DPI : PDF_DPI, preview);
+    connect(task, SIGNAL(rendered(int,QImage,bool)), this, SLOT(pageRendered(int,QImage,bool)), Qt::QueuedConnection);
+    PopplerRenderTask::pool()->start(task, priority);
+}
+
+
+
+// A page has finished rendering.
+void PopplerViewer::pageRendered(int page, QImage image, bool preview) {
+    if (!preview)
+        pendingPages.remove(page);
+    if (image.isNull())
+        return;
+
+    if (preview) {
+        if (page == currentPage && !pageCache.contains(page))
+            displayImage(image.scaled(image.size()*(PDF_DPI/PDF_PREVIEW_DPI)));
+        return;
+    }
+
+    pageCache.insert(page, new QImage(image), qMax(image.byteCount()/1024, 1));
+    if (page == currentPage)
+        displayImage(image);
+}
+
+
+
+// The words on a page have been found.
+void PopplerViewer::pageTextLoaded(int page, QStringList words, QList<QRectF> boxes) {
+    PageText text;
+    text.words = words;
+    text.boxes = boxes;
+    textIndex.insert(page, text);
+
+    if (seekingHit && hitLocations(page).size() > 0) {
+        seekingHit = false;
+        if (page != currentPage) {
+            currentPage = page;
+            showPage();
+            return;
+        }
     }
+    if (page == currentPage && pageCache.contains(page))
+        displayImage(*pageCache.object(page));
+}
+
+
+
+void PopplerViewer::displayImage(const QImage &image) {
+    QPixmap finalPix = highlightImage(image);
+    if (item != NULL)
+        delete item;
+    item = new QGraphicsPixmapItem(finalPix);
+    scene->addItem(item);
 }
 
 
-// Search for the next page containing text
-void PopplerViewer::findNextPage(QStringList searchHits, QList<QRectF> *searchLocations) {
-
-    int page = currentPage;
-    bool found = false;
-    searchLocations->clear();
-
-    while (page < doc->numPages() && !found) {
-        for (int i=0; i<searchHits.size(); i++) {
-//#if QT_VERSION < 0x050000
-//            QList<QRectF> results = doc->page(page)->search(searchHits[i], Poppler::Page::CaseInsensitive);
-//#else
-            QList<QRectF> results = doc->page(page)->search(searchHits[i], Poppler::Page::IgnoreCase);
-//#endif
-            searchLocations->append(results);
-            if (results.size() > 0) {
-                currentPage = page;
-                return;
+
+// Find where the search hits are on a page using the words cached
+// by the indexer or found in the background.
+QList<QRectF> PopplerViewer::hitLocations(int page) {
+    QList<QRectF> locations;
+    if (searchHits.size() == 0)
+        return locations;
+    if (textCached && !textIndex.contains(page)) {
+        PageText text;
+        PdfTextTable pdfTable(global.db);
+        pdfTable.getPage(lid, page, text.words, text.boxes);
+        textIndex.insert(page, text);
+    }
+    if (!textIndex.contains(page))
+        return locations;
+
+    QStringList terms;
+    for (int i=0; i<searchHits.size(); i++) {
+        QString term = searchHits[i].toLower();
+        term.remove('"');
+        term.remove('*');
+        terms.append(term.split(' ', QString::SkipEmptyParts));
+    }
+
+    const PageText &text = textIndex[page];
+    for (int i=0; i<text.words.size(); i++) {
+        QString word = text.words[i].toLower();
+        for (int j=0; j<terms.size(); j++) {
+            if (word.contains(terms[j])) {
+                locations.append(text.boxes[i]);
+                break;
             }
         }
-        page++;
     }
+    return locations;
+}
+
+
+
+// Write the image used in place of the PDF when a note is printed.  An
+// open viewer prints the page it is showing, otherwise the first page is used.
+void PopplerViewer::writePrintImage(qint32 lid) {
+    QString printImageFile = global.fileManager.getTmpDirPath() + QString::number(lid) +QString("-print.png");
+    PopplerViewer *viewer = openViewers.value(lid, NULL);
+    if (viewer != NULL && viewer->pageCache.contains(viewer->currentPage)) {
+        viewer->highlightImage(*viewer->pageCache.object(viewer->currentPage)).save(printImageFile);
+        return;
+    }
+
+    int page = 0;
+    if (viewer != NULL)
+        page = viewer->currentPage;
+    Poppler::Document *pdf = Poppler::Document::load(global.fileManager.getDbaDirPath() + QString::number(lid) +".pdf");
+    if (pdf == NULL)
+        return;
+    if (!pdf->isLocked() && page < pdf->numPages()) {
+        Poppler::Page *pdfPage = pdf->page(page);
+        if (pdfPage != NULL) {
+            QImage image = pdfPage->renderToImage(PDF_DPI, PDF_DPI);
+            if (viewer != NULL)
+                viewer->highlightImage(image).save(printImageFile);
+            else
+                image.save(printImageFile);
+            delete pdfPage;
+        }
+    }
+    delete pdf;
 }
 
 
-QPixmap PopplerViewer::highlightImage() {
+QPixmap PopplerViewer::highlightImage(const QImage &image) {
     // Highlight any search terms
-    QPixmap overlayPix(image->size());
+    QPixmap overlayPix(image.size());
     overlayPix.fill(Qt::transparent);
     QPainter p2(&overlayPix);
     p2.setBackgroundMode(Qt::TransparentMode);
@@ -181,19 +328,12 @@ QPixmap PopplerViewer::highlightImage() {
     QColor yellow(Qt::yellow);
     p2.setBrush(yellow);
 
-    QList<QRectF> searchLocations;
-    for (int i=0; i<searchHits.size(); i++) {
-//        searchLocations.append(doc->page(currentPage)->search(searchHits[i], Poppler::Page::CaseInsensitive));
-//#if QT_VERSION < 0x050000
-//        searchLocations.append(doc->page(currentPage)->search(searchHits[i], Poppler::Page::CaseInsensitive));
-//#else
-        searchLocations.append(doc->page(currentPage)->search(searchHits[i],Poppler::Page::IgnoreCase));
-//#endif
-    }
+    QList<QRectF> searchLocations = hitLocations(currentPage);
     for (int i=0; i<searchLocations.size(); i++) {
         QRectF highlightRect = searchLocations[i];
         p2.drawRect(highlightRect.x(), highlightRect.y(), highlightRect.width(), highlightRect.height());
     }
+    p2.end();
     if (searchLocations.size() > 0)
         pageLabel->setStyleSheet("QLabel { background-color : yellow; }");
     else
@@ -203,12 +343,12 @@ QPixmap PopplerViewer::highlightImage() {
 
     // Create the actual overlay.  We do this in two steps to avoid
     // constantly painting the same area
-    QPixmap finalPix(image->size());
+    QPixmap finalPix(image.size());
     finalPix.fill(Qt::transparent);
     QPainter p3(&finalPix);
     p3.setBackgroundMode(Qt::TransparentMode);
     p3.setRenderHint(QPainter::Antialiasing,true);
-    p3.drawPixmap(0,0,QPixmap::fromImage(*image));
+    p3.drawPixmap(0,0,QPixmap::fromImage(image));
     p3.setOpacity(0.4);
     p3.drawPixmap(0,0,overlayPix);
     p3.end();
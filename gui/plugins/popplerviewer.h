@@ -28,6 +28,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QLabel>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QCache>
+#include <QSet>
+#include <QHash>
+#include <QSharedPointer>
+#include <QAtomicInt>
 #if QT_VERSION < 0x050000
 #include <poppler-qt4.h>
 #else
@@ -42,12 +47,19 @@ class PopplerViewer : public QWidget
 
 public:
     PopplerViewer(const QString &mimeType, const QString &lid, QWidget *parent = 0);
+    ~PopplerViewer();
+    static void writePrintImage(qint32 lid);    // Create the image used when printing a note
 
 private:
+    class PageText {
+    public:
+        QStringList words;
+        QList<QRectF> boxes;
+    };
+
     QGraphicsScene *scene;
     PopplerGraphicsView *view;
     QGraphicsPixmapItem *item;
-    QImage *image;
     QString mimeType;
     QLabel *pageLabel;
     QLabel *imageLabel;
@@ -56,10 +68,20 @@ private:
     QPushButton *pageLeft;
     QPushButton *pageRight;
     qint32 lid;
-    QString printImageFile;
+    QString file;
     QStringList searchHits;
-    void findNextPage(QStringList searchHits, QList<QRectF> *searchLocations);
-    QPixmap highlightImage();
+    bool seekingHit;                          // Move to the first page with a hit once it is found?
+    bool textCached;                          // Were the words on each page cached by the indexer?
+    QCache<int, QImage> pageCache;            // Rendered pages, least recently used dropped first
+    QSet<int> pendingPages;                   // Pages being rendered
+    QHash<int, PageText> textIndex;           // Words & locations on each page
+    QSharedPointer<QAtomicInt> textCancelled; // Stops the text extraction when we close
+    void showPage();
+    void requestPage(int page, bool preview);
+    void displayImage(const QImage &image);
+    QList<QRectF> hitLocations(int page);
+    QPixmap highlightImage(const QImage &image);
+    static QHash<qint32, PopplerViewer*> openViewers;
 
 
 public:
@@ -68,6 +90,10 @@ public:
 public slots:
     void pageRightPressed();
     void pageLeftPressed();
+
+private slots:
+    void pageRendered(int page, QImage image, bool preview);
+    void pageTextLoaded(int page, QStringList words, QList<QRectF> boxes);
 };
 
 #endif // POPPLERVIEWER_H
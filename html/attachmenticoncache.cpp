@@ -0,0 +1,131 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "attachmenticoncache.h"
+#include "global.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+extern Global global;
+
+AttachmentIconCache::AttachmentIconCache()
+{
+    trimmed = false;
+    maxFiles = ICON_CACHE_MAX_FILES;
+}
+
+
+
+// Build the cache key.  Anything that changes the appearance of the
+// badge must be part of the key.
+QString AttachmentIconCache::buildKey(qint32 lid, qint64 fileSize, QString displayName,
+                                      QString font, QString fontColor, QString backgroundColor, bool highlight) {
+    return QString::number(lid) + "|" + QString::number(fileSize) + "|"
+            + displayName + "|" + font + "|" + fontColor + "|" + backgroundColor + "|"
+            + (highlight ? "1" : "0");
+}
+
+
+
+// The file name is derived from the key so a badge rendered in a
+// previous session can be picked up again without repainting it.
+QString AttachmentIconCache::fileName(QString key) {
+    QString lid = key.section("|", 0, 0);
+    QByteArray digest = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+    QString file = global.fileManager.getIconCacheDirPath(lid + "_" + QString(digest) + QString("_icon.png"));
+    return file.replace("\\", "/");
+}
+
+
+
+// Look for a badge.  We check memory first & then the cache directory.
+bool AttachmentIconCache::find(QString key, QString &file) {
+    QMutexLocker locker(&mutex);
+    if (!trimmed)
+        trim();
+    if (files.contains(key)) {
+        file = files[key];
+        return true;
+    }
+    QString name = fileName(key);
+    if (QFile::exists(name)) {
+        files.insert(key, name);
+        file = name;
+        return true;
+    }
+    return false;
+}
+
+
+
+// Save a newly rendered badge.  Any other badge for the same resource
+// was drawn with an old size, name, font or colour, so it is removed.
+void AttachmentIconCache::insert(QString key, QString file) {
+    QMutexLocker locker(&mutex);
+    QString lid = key.section("|", 0, 0);
+    files.insert(key, file);
+
+    QDir dir(global.fileManager.getIconCacheDirPath());
+    QStringList old = dir.entryList(QStringList() << lid + "_*_icon.png", QDir::Files);
+    QString newName = QFileInfo(file).fileName();
+    for (int i=0; i<old.size(); i++) {
+        if (old[i] != newName)
+            dir.remove(old[i]);
+    }
+    QHash<QString, QString>::iterator it = files.begin();
+    while (it != files.end()) {
+        if (it.key() != key && it.key().section("|", 0, 0) == lid)
+            it = files.erase(it);
+        else
+            ++it;
+    }
+}
+
+
+
+// Remove the least recently written badges once there are too many.
+// This is done the first time the cache is used in a session.
+void AttachmentIconCache::trim() {
+    trimmed = true;
+    QDir dir(global.fileManager.getIconCacheDirPath());
+    QStringList names = dir.entryList(QStringList() << "*_icon.png", QDir::Files, QDir::Time);
+    for (int i=maxFiles; i<names.size(); i++)
+        dir.remove(names[i]);
+}
+
+
+
+void AttachmentIconCache::setMaxFiles(int maxFiles) {
+    QMutexLocker locker(&mutex);
+    this->maxFiles = maxFiles;
+    trim();
+}
+
+
+
+// Forget all of the badges in memory.  The files are left for the next
+// lookup.
+void AttachmentIconCache::clear() {
+    QMutexLocker locker(&mutex);
+    files.clear();
+}
@@ -0,0 +1,60 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef ATTACHMENTICONCACHE_H
+#define ATTACHMENTICONCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+
+//**********************************************************
+// Cache of the attachment "badges" drawn into a note for
+// non-image resources.  Each badge is keyed by everything
+// that affects how it looks, so a cached file never needs
+// to be invalidated.  The badge is only painted & written
+// the first time a key is seen.  The files are kept in the
+// database directory so they survive a restart.  A
+// resource only keeps its newest badge, and the oldest
+// files are removed once there are too many.
+//**********************************************************
+
+#define ICON_CACHE_MAX_FILES 2000
+
+class AttachmentIconCache
+{
+private:
+    QHash<QString, QString> files;       // key -> file name of the rendered badge
+    QMutex mutex;
+    bool trimmed;
+    int maxFiles;
+    void trim();                          // Remove the oldest files if there are too many
+
+public:
+    AttachmentIconCache();
+    static QString buildKey(qint32 lid, qint64 fileSize, QString displayName,
+                            QString font, QString fontColor, QString backgroundColor, bool highlight);
+    QString fileName(QString key);        // Where the badge for a key is (or will be) stored
+    bool find(QString key, QString &file); // Get an existing badge
+    void insert(QString key, QString file); // Remember a newly rendered badge
+    void clear();                         // Forget everything
+    void setMaxFiles(int maxFiles);       // Change the number of files kept
+};
+
+#endif // ATTACHMENTICONCACHE_H
@@ -0,0 +1,241 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "enmltag.h"
+#include <QStringList>
+
+
+EnmlTag::EnmlTag()
+{
+    isEndTag = false;
+    isSelfClosing = false;
+}
+
+
+
+// Parse the tag starting at source[start] (which must be a '<').  On
+// return end is the position of the closing '>'.  Quoted attribute
+// values may contain a '>', so we can't just look for the next one.
+bool EnmlTag::parse(const QString &source, qint32 start, EnmlTag &tag, qint32 &end) {
+    qint32 len = source.length();
+    qint32 i = start+1;
+    tag.name = "";
+    tag.attributes.clear();
+    tag.isEndTag = false;
+    tag.isSelfClosing = false;
+
+    if (i < len && source[i] == '/') {
+        tag.isEndTag = true;
+        i++;
+    }
+
+    // Get the tag name
+    qint32 nameStart = i;
+    while (i < len && !source[i].isSpace() && source[i] != '>' && source[i] != '/')
+        i++;
+    tag.name = source.mid(nameStart, i-nameStart);
+    if (tag.name == "")
+        return false;
+
+    // Read the attributes
+    while (i < len) {
+        while (i < len && source[i].isSpace())
+            i++;
+        if (i >= len)
+            return false;
+        if (source[i] == '>') {
+            end = i;
+            return true;
+        }
+        if (source[i] == '/') {
+            i++;
+            if (i < len && source[i] == '>') {
+                tag.isSelfClosing = true;
+                end = i;
+                return true;
+            }
+            continue;
+        }
+
+        qint32 attrStart = i;
+        while (i < len && !source[i].isSpace() && source[i] != '=' && source[i] != '>' && source[i] != '/')
+            i++;
+        QString attrName = source.mid(attrStart, i-attrStart);
+        while (i < len && source[i].isSpace())
+            i++;
+        QString value = "";
+        if (i < len && source[i] == '=') {
+            i++;
+            while (i < len && source[i].isSpace())
+                i++;
+            if (i >= len)
+                return false;
+            QChar quote = source[i];
+            if (quote == '"' || quote == '\'') {
+                qint32 valueEnd = source.indexOf(quote, i+1);
+                if (valueEnd == -1)
+                    return false;
+                value = source.mid(i+1, valueEnd-i-1);
+                if (quote == '\'')
+                    value.replace("\"", "&quot;");
+                i = valueEnd+1;
+            } else {
+                qint32 valueStart = i;
+                while (i < len && !source[i].isSpace() && source[i] != '>')
+                    i++;
+                value = source.mid(valueStart, i-valueStart);
+            }
+        }
+        if (attrName != "")
+            tag.attributes.append(QPair<QString,QString>(attrName, value));
+    }
+    return false;
+}
+
+
+
+// Escape a value so it can be written inside a double quoted attribute
+QString EnmlTag::escape(QString value) {
+    value.replace("&", "&amp;");
+    value.replace("\"", "&quot;");
+    value.replace("<", "&lt;");
+    value.replace(">", "&gt;");
+    return value;
+}
+
+
+
+// Add a numeric entity's character.  Characters above U+FFFF (emoji
+// for example) need a surrogate pair, so QChar can't be used directly.
+bool EnmlTag::appendCodePoint(QString &result, QString number, int base) {
+    bool valid;
+    uint codePoint = number.toUInt(&valid, base);
+    if (!valid || codePoint == 0 || codePoint > 0x10FFFF)
+        return false;
+    result.append(QString::fromUcs4(&codePoint, 1));
+    return true;
+}
+
+
+
+// Reverse of escape().  Numeric entities are also decoded.  Anything
+// we don't recognize is left alone.
+QString EnmlTag::unescape(QString value) {
+    if (!value.contains("&"))
+        return value;
+    QString result;
+    result.reserve(value.length());
+    qint32 i = 0;
+    while (i < value.length()) {
+        if (value[i] == '&') {
+            qint32 semi = value.indexOf(";", i);
+            if (semi != -1 && semi-i <= 10) {
+                QString entity = value.mid(i+1, semi-i-1);
+                bool found = true;
+                if (entity == "amp")
+                    result.append('&');
+                else if (entity == "quot")
+                    result.append('"');
+                else if (entity == "lt")
+                    result.append('<');
+                else if (entity == "gt")
+                    result.append('>');
+                else if (entity == "apos")
+                    result.append('\'');
+                else if (entity.startsWith("#x") || entity.startsWith("#X"))
+                    found = appendCodePoint(result, entity.mid(2), 16);
+                else if (entity.startsWith("#"))
+                    found = appendCodePoint(result, entity.mid(1), 10);
+                else
+                    found = false;
+                if (found) {
+                    i = semi+1;
+                    continue;
+                }
+            }
+        }
+        result.append(value[i]);
+        i++;
+    }
+    return result;
+}
+
+
+
+// HTML elements that never have an end tag
+bool EnmlTag::isVoidElement(QString name) {
+    static QStringList voidElements = QStringList() << "area" << "base" << "br" << "col"
+                                                    << "hr" << "img" << "input" << "link"
+                                                    << "meta" << "param" << "wbr";
+    return voidElements.contains(name.toLower());
+}
+
+
+
+qint32 EnmlTag::indexOf(QString name) const {
+    for (int i=0; i<attributes.size(); i++) {
+        if (attributes[i].first.compare(name, Qt::CaseInsensitive) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+bool EnmlTag::hasAttribute(QString name) const {
+    return indexOf(name) != -1;
+}
+
+
+QString EnmlTag::attribute(QString name, QString defaultValue) const {
+    qint32 i = indexOf(name);
+    if (i == -1)
+        return defaultValue;
+    return unescape(attributes[i].second);
+}
+
+
+// Set an attribute.  Existing attributes keep their position, new
+// ones are added to the end.
+void EnmlTag::setAttribute(QString name, QString value) {
+    qint32 i = indexOf(name);
+    if (i == -1)
+        attributes.append(QPair<QString,QString>(name, escape(value)));
+    else
+        attributes[i].second = escape(value);
+}
+
+
+void EnmlTag::removeAttribute(QString name) {
+    qint32 i = indexOf(name);
+    if (i != -1)
+        attributes.removeAt(i);
+}
+
+
+
+// Write the start tag back out.  If newName is given, the tag is
+// renamed (for example en-media -> img).
+QString EnmlTag::startTag(QString newName) const {
+    QString tag = "<" + (newName == "" ? name : newName);
+    for (int i=0; i<attributes.size(); i++) {
+        tag.append(" " + attributes[i].first + "=\"" + attributes[i].second + "\"");
+    }
+    tag.append(">");
+    return tag;
+}
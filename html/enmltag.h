@@ -0,0 +1,60 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef ENMLTAG_H
+#define ENMLTAG_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+
+//**********************************************************
+// A single start or end tag read from an ENML document.
+// Attribute values are kept exactly as they appear in the
+// source (escaped) so unchanged tags can be written back
+// out untouched.  This is used by the NoteFormatter to
+// rewrite ENML tags without loading the note into a
+// QWebPage.
+//**********************************************************
+class EnmlTag
+{
+private:
+    QList< QPair<QString, QString> > attributes;   // name & escaped value
+    qint32 indexOf(QString name) const;
+    static bool appendCodePoint(QString &result, QString number, int base);
+
+public:
+    QString name;              // Tag name as it appears in the source
+    bool isEndTag;             // </tag>
+    bool isSelfClosing;        // <tag/>
+
+    EnmlTag();
+    static bool parse(const QString &source, qint32 start, EnmlTag &tag, qint32 &end);  // Parse the tag beginning at source[start]
+    static QString escape(QString value);
+    static QString unescape(QString value);
+    static bool isVoidElement(QString name);
+
+    bool hasAttribute(QString name) const;
+    QString attribute(QString name, QString defaultValue="") const;   // Unescaped attribute value
+    void setAttribute(QString name, QString value);                    // Set an unescaped attribute value
+    void removeAttribute(QString name);
+    QString startTag(QString newName="") const;                        // Write the tag back out as HTML
+};
+
+#endif // ENMLTAG_H
@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "noteformatter.h"
 #include "sql/resourcetable.h"
+#include "sql/notetable.h"
 #include "sql/notebooktable.h"
 #include "sql/sharednotebooktable.h"
 #include "sql/linkednotebooktable.h"
@@ -27,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "filters/filtercriteria.h"
 #include "filters/filterengine.h"
 #include "utilities/mimereference.h"
+#include "html/enmltag.h"
 
 #include <QFileSystemModel>
 #include <QFileIconProvider>
@@ -36,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <poppler-qt5.h>
 #endif
 #include <QIcon>
+#include <QElapsedTimer>
 #include <QList>
 
 
@@ -121,38 +124,41 @@ QByteArray NoteFormatter::rebuildNoteHTML() {
     readOnly = false;
 
     ResourceTable resTable(global.db);
+    lidByHash.clear();
+    highlightResources.clear();
     if (!note.guid.isSet())  {
         formatError=true;
         readOnly=true;
         QLOG_TRACE() << "NOTE GUID IS NOT SET!!!";
     } else {
         QLOG_TRACE() << "getting resource from hash";
-        resTable.getResourceMap(hashMap, resourceMap, note.guid);
+        NoteTable noteTable(global.db);
+        qint32 noteLid = noteTable.getLid(note.guid);
+        resTable.getResourceMap(hashMap, resourceMap, noteLid);
+        resTable.getLidsByHashes(lidByHash, noteLid);
+
+        // Find which attachments match the current search so they can be highlighted
+        FilterCriteria *criteria = global.filterCriteria[global.filterPosition];
+        if (criteria->isSearchStringSet() && criteria->getSearchString() != "") {
+            FilterEngine engine;
+            engine.noteResourcesContaining(highlightResources, noteLid, criteria->getSearchString());
+        }
     }
 
-    QWebPage page;
-    QEventLoop loop;
-    QLOG_TRACE() << "Before preHTMLFormat";
-    QString html = "<body></body>";
+    QElapsedTimer timer;
+    timer.start();
+    // The rendered HTML is not stored back in note.content.  The note is
+    // our own copy & only read here, so keeping the HTML would just make
+    // a second call render HTML as if it were ENML.
+    QString enml = "";
     if (note.content.isSet())
-        html = preHtmlFormat(note.content);
-    html.replace("<en-note", "<body");
-    html.replace("</en-note>", "</body>");
-    QByteArray htmlPage;
-    htmlPage.append(html);
-    QLOG_TRACE() << "About to set content";
-    page.mainFrame()->setContent(htmlPage);
-    QObject::connect(&page, SIGNAL(loadFinished(bool)), &loop, SLOT(quit()));
+        enml = note.content;
 
     QLOG_TRACE() << "Starting to modify tags";
-    modifyTags(page);
-    QLOG_TRACE() << "Done modifying tags";
-    note.content = page.mainFrame()->toHtml();
     content.clear();
-    content.append(note.content);
+    content.append(renderEnml(enml));
+    QLOG_TRACE() << "Done modifying tags";
 
-    qint32 index = content.indexOf("<body");
-    content.remove(0,index);
     content.prepend("<style>img { height:auto; width:auto; max-height:auto; max-width:100%; }</style>");
     content.prepend("<head><meta http-equiv=\"content-type\" content=\"text-html; charset=utf-8\"></head>");
     content.prepend("<html>");
@@ -172,137 +178,229 @@ QByteArray NoteFormatter::rebuildNoteHTML() {
         QLOG_DEBUG() << "Note is inactive.  Setting to read-only.";
         readOnly = true;
     }
+    QLOG_DEBUG() << "Note rendered in" << timer.elapsed() << "ms";
     QLOG_TRACE() << "Done rebuiling HTML";
     return content;
 }
 
 
 
-// This is to turn the <en-media/> tags into <en-media></en-media> tags because
-// QWebPage tends to miss the /> tag and it can cause some text to be missed
-QString NoteFormatter::preHtmlFormat(QString note) {
+/*
+  This will go through and modify some of the ENML tags and turn
+  them into HTML tags.  Things like en-media & en-crypt have no
+  HTML values, so we turn them into HTML.  The note is read as a
+  stream of tags, so anything we don't need to change is copied
+  straight through without being parsed into a DOM.
+  */
+QString NoteFormatter::renderEnml(QString enml) {
     QLOG_TRACE_IN();
-    int pos;
+    tempFiles.clear();
+
+    QString html;
+    html.reserve(enml.length() + enml.length()/4);
+    qint32 len = enml.length();
+
+    // Everything before the <en-note> (the XML declaration & DTD) is dropped
+    qint32 pos = enml.indexOf("<en-note", 0, Qt::CaseInsensitive);
+    bool missingNoteTag = false;
+    if (pos == -1) {
+        missingNoteTag = true;
+        html.append("<body>");
+        pos = 0;
+    }
+
+    while (pos < len) {
+        qint32 next = enml.indexOf('<', pos);
+        if (next == -1) {
+            html.append(enml.mid(pos));
+            break;
+        }
+        html.append(enml.midRef(pos, next-pos));
+        pos = next;
+
+        // Comments & CDATA sections are copied as they are.  Processing
+        // instructions & doctype declarations are dropped.
+        if (enml.midRef(pos, 4) == QLatin1String("<!--")) {
+            qint32 endComment = enml.indexOf("-->", pos);
+            endComment = (endComment == -1 ? len : endComment+3);
+            html.append(enml.midRef(pos, endComment-pos));
+            pos = endComment;
+            continue;
+        }
+        if (enml.midRef(pos, 9) == QLatin1String("<![CDATA[")) {
+            qint32 endCdata = enml.indexOf("]]>", pos);
+            endCdata = (endCdata == -1 ? len : endCdata+3);
+            html.append(enml.midRef(pos, endCdata-pos));
+            pos = endCdata;
+            continue;
+        }
+        if (enml.midRef(pos, 2) == QLatin1String("<?") || enml.midRef(pos, 2) == QLatin1String("<!")) {
+            qint32 endDecl = enml.indexOf('>', pos);
+            pos = (endDecl == -1 ? len : endDecl+1);
+            continue;
+        }
+
+        EnmlTag tag;
+        qint32 end;
+        if (!EnmlTag::parse(enml, pos, tag, end)) {
+            html.append("&lt;");
+            pos++;
+            continue;
+        }
+        qint32 start = pos;
+        pos = end+1;
+        QString name = tag.name.toLower();
+
+        if (tag.isEndTag) {
+            if (name == "en-note")
+                html.append("</body>");
+            else if (name != "en-todo" && name != "en-media" && name != "en-crypt"
+                     && !EnmlTag::isVoidElement(name))
+                html.append(enml.midRef(start, pos-start));
+            continue;
+        }
+
+        if (name == "en-note") {
+            html.append(tag.startTag("body"));
+            if (tag.isSelfClosing)
+                html.append("</body>");
+            continue;
+        }
+
+        // The en-media body (if any) is thrown away
+        if (name == "en-media") {
+            if (!tag.isSelfClosing) {
+                qint32 close = enml.indexOf("</en-media>", pos, Qt::CaseInsensitive);
+                if (close != -1)
+                    pos = close+QString("</en-media>").length();
+            }
+            html.append(modifyEnMediaTags(tag));
+            continue;
+        }
+
+        if (name == "en-todo") {
+            html.append(modifyTodoTags(tag));
+            continue;
+        }
 
-    // Correct <br></br> because Webkit messes it up.
-    QString content = note.replace("<br></br>", "<br/>");
+        // The body of an en-crypt tag is the encrypted text
+        if (name == "en-crypt") {
+            QString encryptedText = "";
+            if (!tag.isSelfClosing) {
+                qint32 close = enml.indexOf("</en-crypt>", pos, Qt::CaseInsensitive);
+                if (close == -1)
+                    close = len;
+                encryptedText = enml.mid(pos, close-pos);
+                pos = qMin(close+QString("</en-crypt>").length(), len);
+            }
+            html.append(modifyCryptTags(tag, encryptedText));
+            continue;
+        }
 
-    pos = content.indexOf("<en-media");
-    while (pos != -1) {
-        int endPos = content.indexOf(">", pos);
-        int tagEndPos = content.indexOf("/>", pos);
+        if (name == "a") {
+            html.append(modifyLinkTags(tag, enml, pos));
+            if (tag.isSelfClosing)
+                html.append("</a>");
+            continue;
+        }
 
-        // Check the next /> end tag.  If it is before the end
-        // of the current tag or if it doesn't exist then we
-        // need to fix the end of the img
-        if (tagEndPos == -1 || tagEndPos < endPos) {
-            content = content.mid(0, endPos) + QByteArray("></en-media>") +content.mid(endPos+1);
+        // WebKit doesn't understand <div/>, so give it a real end tag.
+        if (tag.isSelfClosing) {
+            html.append(tag.startTag());
+            if (!EnmlTag::isVoidElement(name))
+                html.append("</" + tag.name + ">");
+            continue;
         }
-        pos = content.indexOf("<en-media", pos+1);
+
+        html.append(enml.midRef(start, pos-start));
     }
+
+    if (missingNoteTag)
+        html.append("</body>");
     QLOG_TRACE_OUT();
-    return content;
+    return html;
 }
 
 
 
+// Modify an en-media tag.  Depending on the type it turns into an
+// image, an attachment link, an ink note or a PDF object.
+QString NoteFormatter::modifyEnMediaTags(EnmlTag &enmedia) {
+    QString unchanged = enmedia.startTag() + "</" + enmedia.name + ">";
+    if (!enmedia.hasAttribute("type"))
+        return unchanged;
 
-/*
-  This will go through and modify some of the ENML tags and turn
-  them into HTML tags.  Things like en-media & en-crypt have no
-  HTML values, so we turn them into HTML.
-  */
-void NoteFormatter::modifyTags(QWebPage &doc) {
-    QLOG_TRACE_IN();
-    tempFiles.clear();
+    QString attr = enmedia.attribute("type");
+    QString hash = enmedia.attribute("hash");
+    QStringList type = attr.split("/");
+    if (type.size() < 2)
+        return unchanged;
 
-    // Modify en-media tags
-    QLOG_TRACE() << "Searching for all en-media tags;";
-    QWebElementCollection anchors = doc.mainFrame()->findAllElements("en-media");
-    QLOG_TRACE() << "Search complete: " << anchors.toList().size();
-    foreach (QWebElement enmedia, anchors) {
-        if (enmedia.hasAttribute("type")) {
-            QString attr = enmedia.attribute("type");
-            QString hash = enmedia.attribute("hash");
-            QStringList type = attr.split("/");
-            if (type.size() >= 2) {
-                QString appl = type[1];
-                QLOG_TRACE() << "En-Media tag type: " << type[0];
-                if (type[0] == "image")
-                    modifyImageTags(enmedia, hash);
-                else
-                    modifyApplicationTags(enmedia, hash, appl);
-                QLOG_TRACE() << "Type modified";
-            }
-        }
-    }
+    QString appl = type[1];
+    QLOG_TRACE() << "En-Media tag type: " << type[0];
+    if (type[0] == "image")
+        return modifyImageTags(enmedia, hash);
+    return modifyApplicationTags(enmedia, hash, appl);
+}
 
-    // Modify todo tags
-    anchors = doc.mainFrame()->findAllElements("en-todo");
-    qint32 enTodoCount = anchors.count();
-    for (qint32 i=enTodoCount-1; i>=0; i--) {
-            QWebElement enmedia = anchors.at(i);
-            modifyTodoTags(enmedia);
-    }
 
-    anchors = doc.mainFrame()->findAllElements("en-crypt");
-    qint32 enCryptLen = anchors.count();
-    for (qint32 i=enCryptLen-1; i>=0; i--) {
-        QWebElement enmedia = anchors.at(i);
-        QString hint = enmedia.attribute("hint");
-        QString cipher = enmedia.attribute("cipher", "RC2");
-        QString length = enmedia.attribute("length","64");
-
-        enmedia.setAttribute("contentEditable","false");
-        enmedia.setAttribute("src", QString("file://")+global.fileManager.getImageDirPath("encrypt.png"));
-        enmedia.setAttribute("en-tag","en-crypt");
-        enmedia.setAttribute("cipher", cipher);
-        enmedia.setAttribute("length", length);
-        enmedia.setAttribute("hint", hint);
-        enmedia.setAttribute("alt", enmedia.toInnerXml());
-        global.cryptCounter++;
-        enmedia.setAttribute("id", "crypt"+QString().number(global.cryptCounter));
-        QString encryptedText = enmedia.toInnerXml();
-
-        // If the encryption string contains crlf at the end, remove them because they mess up the javascript.
-        if (encryptedText.endsWith("\n"))
-                encryptedText.truncate(encryptedText.length()-1);
-        if (encryptedText.endsWith("\r"))
-                encryptedText.truncate(encryptedText.length()-1);
-
-        // Add the commands
-        hint = hint.replace("'","&apos;");
-        enmedia.setAttribute("onClick", "window.browserWindow.decryptText('crypt"+
-                             QString().number(global.cryptCounter)+
-                             "', '"+encryptedText+"', '"+
-                             hint +"', '" +
-                             cipher+ "', " +
-                             length +
-                             ");");
-        enmedia.setAttribute("onMouseOver", "style.cursor='hand'");
-        enmedia.setInnerXml("");
-        QString k = enmedia.toOuterXml();
-        k.replace("<en-crypt", "<img");
-        k.replace("img>", "<en-crypt");
-        enmedia.setOuterXml(k);
-    }
+
+// Turn an en-crypt tag into an image that can be clicked to decrypt the text
+QString NoteFormatter::modifyCryptTags(EnmlTag &enmedia, QString encryptedText) {
+    QString hint = enmedia.attribute("hint");
+    QString cipher = enmedia.attribute("cipher", "RC2");
+    QString length = enmedia.attribute("length","64");
+
+    enmedia.setAttribute("contentEditable","false");
+    enmedia.setAttribute("src", QString("file://")+global.fileManager.getImageDirPath("encrypt.png"));
+    enmedia.setAttribute("en-tag","en-crypt");
+    enmedia.setAttribute("cipher", cipher);
+    enmedia.setAttribute("length", length);
+    enmedia.setAttribute("hint", hint);
+    enmedia.setAttribute("alt", encryptedText);
+    global.cryptCounter++;
+    enmedia.setAttribute("id", "crypt"+QString().number(global.cryptCounter));
+
+    // If the encryption string contains crlf at the end, remove them because they mess up the javascript.
+    if (encryptedText.endsWith("\n"))
+            encryptedText.truncate(encryptedText.length()-1);
+    if (encryptedText.endsWith("\r"))
+            encryptedText.truncate(encryptedText.length()-1);
+
+    // Add the commands
+    hint = hint.replace("'","&apos;");
+    enmedia.setAttribute("onClick", "window.browserWindow.decryptText('crypt"+
+                         QString().number(global.cryptCounter)+
+                         "', '"+encryptedText+"', '"+
+                         hint +"', '" +
+                         cipher+ "', " +
+                         length +
+                         ");");
+    enmedia.setAttribute("onMouseOver", "style.cursor='hand'");
+    return enmedia.startTag("img");
+}
+
 
 
-    // Modify link tags
-    anchors = doc.mainFrame()->findAllElements("a");
-    enCryptLen = anchors.count();
-    for (qint32 i=0; i<anchors.count(); i++) {
-        QWebElement element = anchors.at(i);
-        if (!element.attribute("href").toLower().startsWith("http://latex.codecogs.com/gif.latex?")) {
-            element.setAttribute("title", element.attribute("href"));
-        } else {
-            QString formula = element.attribute("href").toLower().replace("http://latex.codecogs.com/gif.latex?","");
-            element.setAttribute("title", formula);
-            QString resLid = element.firstChild().attribute("lid","");
-            element.setAttribute("href", "latex:///"+resLid);
+// Modify link tags.  LaTeX formulas are pointed at the image that
+// follows them, which is the first child of the link.
+QString NoteFormatter::modifyLinkTags(EnmlTag &element, const QString &enml, qint32 pos) {
+    if (!element.attribute("href").toLower().startsWith("http://latex.codecogs.com/gif.latex?")) {
+        element.setAttribute("title", element.attribute("href"));
+    } else {
+        QString formula = element.attribute("href").toLower().replace("http://latex.codecogs.com/gif.latex?","");
+        element.setAttribute("title", formula);
+        QString resLid = "";
+        qint32 child = enml.indexOf('<', pos);
+        EnmlTag childTag;
+        qint32 childEnd;
+        if (child != -1 && EnmlTag::parse(enml, child, childTag, childEnd) &&
+                !childTag.isEndTag && childTag.name.toLower() == "en-media") {
+            resLid = QString::number(lidByHash.value(childTag.attribute("hash").toLower(), 0));
         }
+        element.setAttribute("href", "latex:///"+resLid);
     }
-    QLOG_TRACE_OUT();
+    return element.startTag();
 }
 
 
@@ -453,11 +551,10 @@ const char* NoteFormatter::findImageFormat(QString file) {
 
 /* Modify an image tag.  Basically we turn it back into a picture, write out the file, and
   modify the ENML */
-void NoteFormatter::modifyImageTags(QWebElement &enMedia, QString &hash) {
+QString NoteFormatter::modifyImageTags(EnmlTag &enMedia, QString &hash) {
     QLOG_TRACE_IN();
     QString mimetype = enMedia.attribute("type");
-    qint32 resLid = 0;
-    resLid = hashMap[hash];
+    qint32 resLid = lidByHash.value(hash.toLower(), 0);
     QString highlightString = "";
     if (resLid>0) {
         QLOG_TRACE() << "Getting resource";
@@ -478,21 +575,15 @@ void NoteFormatter::modifyImageTags(QWebElement &enMedia, QString &hash) {
         if (data.size.isSet() && data.size > 0) {
             QString imgfile = "file:///"+global.fileManager.getDbDirPath(QString("dba/") +QString::number(resLid) +type);
             enMedia.setAttribute("src", imgfile);
-            // Check if this is a LaTeX image
-            ResourceAttributes attributes;
-            if (r.attributes.isSet())
-                attributes = r.attributes;
+
+            // LaTeX images show their formula & can be clicked to edit it
             QString sourceUrl = "";
             if (attributes.sourceURL.isSet())
                 sourceUrl = attributes.sourceURL;
             if (sourceUrl.toLower().startsWith("http://latex.codecogs.com/gif.latex?")) {
-                enMedia.appendInside("<img/>");
-                QWebElement newText = enMedia.lastChild();
-                enMedia.setAttribute("en-tag", "en-latex");
-                newText.setAttribute("onMouseOver", "style.cursor='pointer'");
-                sourceUrl.replace("http://latex.codecogs.com/gif.latex?","");
-                newText.setAttribute("title", sourceUrl);
-                newText.setAttribute("href", "latex:///"+QString::number(resLid));
+                sourceUrl = sourceUrl.mid(QString("http://latex.codecogs.com/gif.latex?").length());
+                enMedia.setAttribute("title", sourceUrl);
+                enMedia.setAttribute("onMouseOver", "style.cursor='pointer'");
             }
             enMedia.setAttribute("onContextMenu", "window.browserWindow.imageContextMenu('"
                                  +QString::number(resLid) +"', '"
@@ -503,12 +594,7 @@ void NoteFormatter::modifyImageTags(QWebElement &enMedia, QString &hash) {
 
                 if (highlightString != "")
                     enMedia.setAttribute("src", highlightString);
-
-                //if (highlightString != "")
-                //    enMedia.setAttribute("onload", highlightString);
             }
-
-
         }
     } else {
         resourceError = true;
@@ -518,37 +604,38 @@ void NoteFormatter::modifyImageTags(QWebElement &enMedia, QString &hash) {
 
     // Reset the tags to something that WebKit will understand
     enMedia.setAttribute("en-tag", "en-media");
-    enMedia.setPlainText("");
     enMedia.setAttribute("lid", QString::number(resLid));
 
     // rename the <enmedia> tag to <img>
-    enMedia.setOuterXml(enMedia.toOuterXml().replace("<en-media","<img"));
-    enMedia.setOuterXml(enMedia.toOuterXml().replace("</en-media>","</img>"));
     QLOG_TRACE_OUT();
+    return enMedia.startTag("img");
 }
 
 
 
 // Modify the en-media tag into an attachment
-void NoteFormatter::modifyApplicationTags(QWebElement &enmedia, QString &hash, QString appl) {
+QString NoteFormatter::modifyApplicationTags(EnmlTag &enmedia, QString &hash, QString appl) {
     QLOG_TRACE_IN();
+    QString unchanged = enmedia.startTag() + "</" + enmedia.name + ">";
     if (appl.toLower() == "vnd.evernote.ink") {
             QLOG_DEBUG() << "Note is ink-note.  Setting to read-only.";
             inkNote = true;
             readOnly = true;
-            buildInkNote(enmedia, hash);
-            return;
+            if (!buildInkNote(enmedia, hash))
+                return unchanged;
+            return enmedia.startTag("img");
     }
 
     ResourceTable resTable(global.db);
     QString contextFileName;
     QLOG_DEBUG() << "Fetching for note: " << note.guid << " hash: " << hash;
-    qint32 resLid = resTable.getLidByHashHex(note.guid, hash);
+    qint32 resLid = lidByHash.value(hash.toLower(), 0);
     Resource r;
     resTable.get(r, resLid, false);
-    if (!r.data.isSet())
+    if (!r.data.isSet()) {
         resourceError = true;
-    else {
+        return unchanged;
+    } else {
         // If we are running the formatter and we are not generating a thumbnail
         QString mimetype = "";
         if (r.mime.isSet())
@@ -560,11 +647,11 @@ void NoteFormatter::modifyApplicationTags(QWebElement &enmedia, QString &hash, Q
             Poppler::Document *doc = Poppler::Document::load(file);
             if (doc != NULL && doc->isLocked())
                 pdfPreview = false;
+            delete doc;
         }
 
         if (mimetype == "application/pdf" && pdfPreview && !thumbnail) {
-           modifyPdfTags(resLid, enmedia);
-           return;
+           return modifyPdfTags(resLid, enmedia);
         }
 
 
@@ -575,18 +662,17 @@ void NoteFormatter::modifyApplicationTags(QWebElement &enmedia, QString &hash, Q
             Poppler::Document *doc;
             doc = Poppler::Document::load(file);
             if (doc == NULL)
-                return;
+                return unchanged;
 
             QImage *image = new QImage(doc->page(0)->renderToImage());
             image->save(printImageFile,"jpg");
             delete image;
+            delete doc;
 
             enmedia.setAttribute("src", printImageFile);
             enmedia.removeAttribute("hash");
             enmedia.removeAttribute("type");
-            enmedia.setOuterXml(enmedia.toOuterXml().replace("<en-media","<img"));
-            enmedia.setOuterXml(enmedia.toOuterXml().replace("</en-media>","</img>"));
-            return;
+            return enmedia.startTag("img");
         }
         QString fileDetails = "";
         MimeReference ref;
@@ -605,9 +691,10 @@ void NoteFormatter::modifyApplicationTags(QWebElement &enmedia, QString &hash, Q
         enmedia.setAttribute("onContextMenu", "window.browserWindow.resourceContextMenu('" +contextFileName +"');");
         enmedia.setAttribute("en-tag", "en-media");
         enmedia.setAttribute("lid", QString::number(resLid));
+        enmedia.setAttribute("title", enmedia.attribute("href"));
 
-        enmedia.appendInside("<img/>");
-        QWebElement newText = enmedia.lastChild();
+        EnmlTag newText;
+        newText.name = "img";
 
         // Build an icon of the image
         QString fileExt;
@@ -628,31 +715,23 @@ void NoteFormatter::modifyApplicationTags(QWebElement &enmedia, QString &hash, Q
             newText.setAttribute("title",attributes.fileName);
         newText.setAttribute("en-tag", "temporary");
         //Rename the tag to a <a> link
-        enmedia.setOuterXml(enmedia.toOuterXml().replace("<en-media","<a"));
-        enmedia.setOuterXml(enmedia.toOuterXml().replace("</en-media>","</a>"));
+        QLOG_TRACE_OUT();
+        return enmedia.startTag("a") + newText.startTag() + "</a>";
     }
-    QLOG_TRACE_OUT();
 }
 
 
 
-// Build an icon for any attachments
+// Build an icon for any attachments.  Icons are cached, so we only
+// need to paint one if nothing matching it has been drawn before.
 QString NoteFormatter::findIcon(qint32 lid, Resource r, QString appl) {
     QLOG_TRACE_IN();
 
-    FilterCriteria *criteria = global.filterCriteria[global.filterPosition];
-    // First get the icon for this type of file
-    resourceHighlight = false;
-    if (criteria->isSearchStringSet() && criteria->getSearchString() != "") {
-        FilterEngine engine;
-        resourceHighlight = engine.resourceContains(lid, criteria->getSearchString(), NULL);
-    }
+    resourceHighlight = highlightResources.contains(lid);
 
     QString fileName = global.fileManager.getDbaDirPath(QString::number(lid) +appl);
-    QIcon icon;
     QFileInfo info(fileName);
-    QFileIconProvider provider;
-    icon = provider.icon(info);
+    qint64 size = info.size();
 
     // Build a string name for the display
     QString displayName;
@@ -664,14 +743,30 @@ QString NoteFormatter::findIcon(qint32 lid, Resource r, QString appl) {
     else
         displayName =  appl.toUpper() +" " +QString(tr("File"));
 
-    // Setup the painter
-    QPainter p;
-
     // Setup the font
     QFont font; // =p.font() ;
     global.getGuiFont(font);
+
+    // Check if we've already drawn this icon
+    QString fontColor = global.getEditorFontColor();
+    QString backgroundColor = global.getEditorBackgroundColor();
+    QString key = AttachmentIconCache::buildKey(lid, size, displayName, font.toString(),
+                                                fontColor, backgroundColor, resourceHighlight);
+    QString tmpFile;
+    if (global.attachmentIconCache.find(key, tmpFile)) {
+        QLOG_TRACE_OUT();
+        return tmpFile;
+    }
+
+    // First get the icon for this type of file
+    QIcon icon;
+    QFileIconProvider provider;
+    icon = provider.icon(info);
+
+    // Setup the painter
+    QPainter p;
     QPen fontPen;
-    fontPen.setColor(QColor(global.getEditorFontColor()));
+    fontPen.setColor(QColor(fontColor));
 //    font.setFamily("Arial");
     QFontMetrics fm(font);
     int width =  fm.width(displayName);
@@ -686,7 +781,7 @@ QString NoteFormatter::findIcon(qint32 lid, Resource r, QString appl) {
     if (resourceHighlight) {
         pixmap.fill(Qt::yellow);
     } else
-        pixmap.fill(QColor(global.getEditorBackgroundColor()));
+        pixmap.fill(QColor(backgroundColor));
 
     p.begin(&pixmap);
     p.setPen(fontPen);
@@ -697,7 +792,6 @@ QString NoteFormatter::findIcon(qint32 lid, Resource r, QString appl) {
     p.drawText(textPoint, displayName);
 
     QString unit = QString(tr("Bytes"));
-    qint64 size = QFileInfo(fileName).size();
     if (size > 1024) {
         size = size/1024;
         unit = QString(tr("KB"));
@@ -712,17 +806,18 @@ QString NoteFormatter::findIcon(qint32 lid, Resource r, QString appl) {
     p.end();
 
     // Now that it is drawn, we write it out to a temporary file
-    QString tmpFile = global.fileManager.getTmpDirPath(QString::number(lid) + QString("_icon.png"));
+    tmpFile = global.attachmentIconCache.fileName(key);
     pixmap.save(tmpFile, "png");
-    return tmpFile;
+    global.attachmentIconCache.insert(key, tmpFile);
     QLOG_TRACE_OUT();
+    return tmpFile;
 }
 
 
 
 
 // Modify the en-to tag into an input field
-void NoteFormatter::modifyTodoTags(QWebElement &todo) {
+QString NoteFormatter::modifyTodoTags(EnmlTag &todo) {
     QLOG_TRACE_IN();
     todo.setAttribute("type", "checkbox");
 
@@ -736,8 +831,8 @@ void NoteFormatter::modifyTodoTags(QWebElement &todo) {
 
     todo.setAttribute("onClick", "if(!checked) removeAttribute('checked'); else setAttribute('checked', 'checked'); editorWindow.editAlert();");
     todo.setAttribute("style", "cursor: hand;");
-    todo.setOuterXml(todo.toOuterXml().replace("en-todo","input"));
     QLOG_TRACE_OUT();
+    return todo.startTag("input");
 }
 
 
@@ -745,11 +840,10 @@ void NoteFormatter::modifyTodoTags(QWebElement &todo) {
 
 
 /* If we have an ink note, then we need to pull the image and display it */
-bool NoteFormatter::buildInkNote(QWebElement &docElem, QString &hash) {
+bool NoteFormatter::buildInkNote(EnmlTag &docElem, QString &hash) {
     QLOG_TRACE_IN();
 
-    ResourceTable resTable(global.db);
-    qint32 resLid = resTable.getLidByHashHex(note.guid, hash);
+    qint32 resLid = lidByHash.value(hash.toLower(), 0);
     if (resLid <= 0)
         return false;
     docElem.setAttribute("en-tag", "en-media");
@@ -757,10 +851,6 @@ bool NoteFormatter::buildInkNote(QWebElement &docElem, QString &hash) {
     docElem.setAttribute("type", "application/vnd.evernote.ink");
     QString filename = QString("file:///") +global.fileManager.getDbaDirPath()+QString::number(resLid)+QString(".png");
     docElem.setAttribute("src", filename);
-    QString k  = docElem.toOuterXml();
-    k.replace("<en-media", "<img");
-    k.replace("enmedia>", "img>");;
-    docElem.setOuterXml(k);
 
     QLOG_TRACE_OUT();
     return true;
@@ -768,17 +858,14 @@ bool NoteFormatter::buildInkNote(QWebElement &docElem, QString &hash) {
 
 
 
-void NoteFormatter::modifyPdfTags(qint32 resLid, QWebElement &enmedia) {
+QString NoteFormatter::modifyPdfTags(qint32 resLid, EnmlTag &enmedia) {
     QLOG_TRACE_IN();
 
     enmedia.setAttribute("width", "100%");
     enmedia.setAttribute("height", "100%");
     enmedia.setAttribute("lid", QString::number(resLid));
-    QString x = enmedia.toOuterXml();
-    x.replace("en-media", "object");
-    enmedia.setOuterXml(x);
-    x = enmedia.toOuterXml();
     QLOG_TRACE_OUT();
+    return enmedia.startTag("object") + "</object>";
 }
 
 
@@ -32,6 +32,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QVector>
 #include <QtXml>
 
+#include "html/enmltag.h"
+
 #include "qevercloud/include/QEverCloud.h"
 using namespace qevercloud;
 
@@ -41,6 +43,7 @@ using namespace std;
 class NoteFormatter : public QObject
 {
     Q_OBJECT
+    friend class TestNoteFormatter;
 private:
     Note note;
     QByteArray content;
@@ -50,15 +53,19 @@ private:
     bool noteHistory;
     bool formatError;
     QString addImageHighlight(qint32 resLid, QString imgfile);
-    void modifyImageTags(QWebElement &enMedia, QString &hash);
-    void modifyApplicationTags(QWebElement &enmedia, QString &hash, QString appl);
-    void modifyPdfTags(qint32 resLid, QWebElement &enmedia);
-    void modifyTodoTags(QWebElement &todo);
-    void modifyTags(QWebPage &doc);
+    QString renderEnml(QString enml);
+    QString modifyEnMediaTags(EnmlTag &enmedia);
+    QString modifyImageTags(EnmlTag &enMedia, QString &hash);
+    QString modifyApplicationTags(EnmlTag &enmedia, QString &hash, QString appl);
+    QString modifyPdfTags(qint32 resLid, EnmlTag &enmedia);
+    QString modifyTodoTags(EnmlTag &todo);
+    QString modifyCryptTags(EnmlTag &enmedia, QString encryptedText);
+    QString modifyLinkTags(EnmlTag &element, const QString &enml, qint32 pos);
     QString findIcon(qint32 lid, Resource r, QString appl);
-    QString preHtmlFormat(QString content);
     QHash<QString, qint32> hashMap;
     QHash<qint32, Resource> resourceMap;
+    QHash<QString, qint32> lidByHash;
+    QList<qint32> highlightResources;
     bool resourceHighlight;
     const char* findImageFormat(QString file);
 
@@ -76,7 +83,7 @@ public:
     //void setHighlight();
     void setNoteHistory(bool value);
     QByteArray rebuildNoteHTML();
-    bool  buildInkNote(QWebElement &docElem, QString &hash);
+    bool  buildInkNote(EnmlTag &docElem, QString &hash);
     void setHighlightText(QString text);
 
 
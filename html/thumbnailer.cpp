@@ -17,6 +17,7 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 ***********************************************************************************/
 
+
 #include "thumbnailer.h"
 #include <QtWebKit>
 #include <QWebPage>
@@ -28,23 +29,147 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 extern Global global;
 
+// Maximum time a page can take before we give up on it
+#define THUMBNAIL_DEADLINE_SECS 20
+
 /* Generic constructor. */
 Thumbnailer::Thumbnailer(DatabaseConnection *db)
 {
     this->db = db;
-    page = new QWebPage();
-    connect(page, SIGNAL(loadFinished(bool)), this, SLOT(pageReady(bool)));
-    idle = true;
+    renderedCount = 0;
+    dispatchScheduled = false;
     connect(&timer, SIGNAL(timeout()), this, SLOT(generateNextThumbnail()));
 }
 
 Thumbnailer::~Thumbnailer() {
-    delete page;
+    QList<QWebPage*> pages = busyPages.keys();
+    pages.append(idlePages);
+    for (int i=0; i<pages.size(); i++)
+        delete pages[i];
 }
 
+
+// Render a note's thumbnail.  This is used after a note has been
+// edited, so it goes ahead of the backlog.
 void Thumbnailer::render(qint32 lid) {
-    idle = false;
-    this->lid = lid;
+    request(lid, RecentlyEdited);
+}
+
+
+
+// Ask for a thumbnail.  If the note is already waiting we just
+// move it up if this priority is higher.  This is called when a
+// note is saved, so the render itself is started later.
+void Thumbnailer::request(qint32 lid, Priority priority) {
+    if (lid <= 0 || global.disableThumbnails)
+        return;
+    if (queued.contains(lid)) {
+        Priority current = queued[lid];
+        if (current <= priority)
+            return;
+        queue[current].removeOne(lid);
+    }
+    queue[priority].append(lid);
+    queued.insert(lid, priority);
+    scheduleDispatch();
+}
+
+
+
+// Ask for a group of thumbnails.  Notes in the note list are only
+// rendered if they actually need a thumbnail.
+void Thumbnailer::request(QList<qint32> lids, Priority priority) {
+    if (global.disableThumbnails)
+        return;
+    if (priority != RecentlyEdited) {
+        NoteTable noteTable(db);
+        noteTable.filterThumbnailsNeeded(lids);
+    }
+    QList<qint32> rendering = busyPages.values();
+    for (int i=0; i<lids.size(); i++) {
+        qint32 lid = lids[i];
+        if (lid <= 0 || (priority == Backlog && rendering.contains(lid)))
+            continue;
+        if (queued.contains(lid)) {
+            Priority current = queued[lid];
+            if (current <= priority)
+                continue;
+            queue[current].removeOne(lid);
+        }
+        queue[priority].append(lid);
+        queued.insert(lid, priority);
+    }
+    scheduleDispatch();
+}
+
+
+
+// Start rendering once we are back in the event loop
+void Thumbnailer::scheduleDispatch() {
+    if (dispatchScheduled)
+        return;
+    dispatchScheduled = true;
+    QTimer::singleShot(0, this, SLOT(dispatchQueued()));
+}
+
+
+
+void Thumbnailer::dispatchQueued() {
+    dispatchScheduled = false;
+    dispatch();
+}
+
+
+
+// How many pages can render at once
+qint32 Thumbnailer::maxPages() {
+    return qBound(1, global.batchThumbnailCount, 8);
+}
+
+
+
+// Get the next note to render.  Notes already being rendered are
+// left in the queue until that render completes.
+bool Thumbnailer::takeNext(qint32 &lid) {
+    QList<qint32> rendering = busyPages.values();
+    for (int p=Visible; p<=Backlog; p++) {
+        for (int i=0; i<queue[p].size(); i++) {
+            if (!rendering.contains(queue[p][i])) {
+                lid = queue[p].takeAt(i);
+                queued.remove(lid);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+
+// Start as many renders as we have pages for.
+void Thumbnailer::dispatch() {
+    if (global.disableThumbnails)
+        return;
+    qint32 lid;
+    while (busyPages.size() < maxPages() && takeNext(lid)) {
+        QWebPage *page;
+        if (idlePages.size() > 0)
+            page = idlePages.takeFirst();
+        else {
+            page = new QWebPage();
+            connect(page, SIGNAL(loadFinished(bool)), this, SLOT(pageReady(bool)));
+        }
+        render(page, lid);
+    }
+}
+
+
+
+// Load a note into a page.  The thumbnail is captured when the
+// page has finished loading.
+void Thumbnailer::render(QWebPage *page, qint32 lid) {
+    busyPages.insert(page, lid);
+    startTimes.insert(page, QDateTime::currentDateTime());
 
     NoteFormatter formatter;
     formatter.thumbnail = true;
@@ -72,21 +197,36 @@ void Thumbnailer::render(qint32 lid) {
 void Thumbnailer::startTimer() {
     timer.stop();
     timer.start(global.minimumThumbnailInterval*1000);
+    rateTimer.start();
 }
 
 
 
 void Thumbnailer::pageReady(bool ok) {
+    QWebPage *page = qobject_cast<QWebPage*>(sender());
+    if (page == NULL || !busyPages.contains(page))
+        return;
+    finish(page, ok);
+    idlePages.append(page);
+    dispatch();
+}
+
+
+
+// A page is done (or has taken too long).  Save the thumbnail.
+void Thumbnailer::finish(QWebPage *page, bool ok) {
+    qint32 lid = busyPages.take(page);
+    startTimes.remove(page);
     if (ok) {
-        capturePage(page);
+        capturePage(page, lid);
+        renderedCount++;
     }
     NoteTable ntable(db);
     ntable.setThumbnailNeeded(lid, false);
-    idle = true;
 }
 
 
-void Thumbnailer::capturePage(QWebPage *page) {
+void Thumbnailer::capturePage(QWebPage *page, qint32 lid) {
     page->mainFrame()->setZoomFactor(3);
     page->setViewportSize(QSize(300,300));
     page->mainFrame()->setScrollBarPolicy(Qt::Horizontal, Qt::ScrollBarAlwaysOff);
@@ -103,7 +243,44 @@ void Thumbnailer::capturePage(QWebPage *page) {
 }
 
 
+
+// Number of notes waiting for a thumbnail
+qint32 Thumbnailer::queueDepth() {
+    return queued.size();
+}
+
+
+
+// Average number of thumbnails created per second
+double Thumbnailer::thumbnailsPerSecond() {
+    qint64 elapsed = rateTimer.isValid() ? rateTimer.elapsed() : 0;
+    if (elapsed <= 0)
+        return 0;
+    return renderedCount*1000.0/elapsed;
+}
+
+
+
+// Called by the timer.  Give up on any pages that are stuck & fill
+// the backlog with anything else in the database needing a thumbnail.
 void Thumbnailer::generateNextThumbnail() {
+    timer.stop();
+
+    QDateTime deadlineTime = QDateTime::currentDateTime().addSecs(-THUMBNAIL_DEADLINE_SECS);
+    QList<QWebPage*> pages = startTimes.keys();
+    for (int i=0; i<pages.size(); i++) {
+        if (startTimes[pages[i]] < deadlineTime) {
+            QLOG_DEBUG() << "Thumbnail timer exceeded for note " << busyPages[pages[i]];
+
+            // The page isn't reused.  A late loadFinished() from it
+            // would otherwise complete the next note's render.
+            disconnect(pages[i], 0, this, 0);
+            pages[i]->triggerAction(QWebPage::Stop);
+            finish(pages[i], false);
+            pages[i]->deleteLater();
+        }
+    }
+
     // If we are connected we are downloading or uploading or
     // if we have thumbnails disabled, so
     // we don't want to do this now.
@@ -112,31 +289,19 @@ void Thumbnailer::generateNextThumbnail() {
         return;
     }
 
-    timer.stop();
-    NoteTable noteTable(db);
-    int i=0;
-    for (; i<global.batchThumbnailCount; i++) {
-        QDateTime current;
-        QDateTime deadlineTime;
-        deadlineTime.addSecs(20);
-
-        // Make sure we haven't been looping too long.
-        if (current > deadlineTime) {
-            QLOG_DEBUG() << "Thumbnail timer exceeded. Going to seep";
-            timer.start(global.maximumThumbnailInterval*1000);
-            return;
-        }
+    if (queue[Backlog].size() == 0) {
+        NoteTable noteTable(db);
+        QList<qint32> lids;
+        noteTable.getNextThumbnailsNeeded(lids, maxPages()*4);
+        request(lids, Backlog);
+    } else
+        dispatch();
 
-        if (this->idle) {
-            i++;
-            qint32 lid = noteTable.getNextThumbnailNeeded();
-            if (lid>0) {
-                render(lid);
-            } else {
-                timer.start(global.maximumThumbnailInterval*1000);
-                return;
-            }
-        }
-    }
-    timer.start(global.minimumThumbnailInterval*1000);
+    QLOG_DEBUG() << "Thumbnail queue depth:" << queueDepth() << " rendering:" << busyPages.size()
+                 << " thumbnails/sec:" << thumbnailsPerSecond();
+
+    if (queued.size() == 0 && busyPages.size() == 0)
+        timer.start(global.maximumThumbnailInterval*1000);
+    else
+        timer.start(global.minimumThumbnailInterval*1000);
 }
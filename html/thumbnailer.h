@@ -18,12 +18,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 ***********************************************************************************/
 
 
+
 #ifndef THUMBNAILER_H
 #define THUMBNAILER_H
 
 #include <QtWebKit>
 #include <QObject>
 #include <QSqlDatabase>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QElapsedTimer>
 
 #include "html/noteformatter.h"
 #include "sql/databaseconnection.h"
@@ -35,31 +40,62 @@ using namespace qevercloud;
 using namespace std;
 
 
+//**********************************************************
+// Generate note thumbnails.  Requests are kept in a
+// priority queue (notes visible in the note list first,
+// then recently edited notes, then anything else in the
+// database needing one) & several pages are rendered at
+// the same time.  Asking for the same note more than once
+// only renders it once.
+//**********************************************************
 class Thumbnailer : public QObject
 {
     Q_OBJECT
 
+public:
+    enum Priority {
+        Visible = 0,
+        RecentlyEdited = 1,
+        Backlog = 2
+    };
+
 private:
     DatabaseConnection *db;
     QTimer timer;
     int minTime;
     int maxTime;
+    QList<qint32> queue[3];                 // Waiting notes for each priority
+    QHash<qint32, Priority> queued;         // Notes waiting & their priority
+    QList<QWebPage*> idlePages;             // Pages ready to render
+    QHash<QWebPage*, qint32> busyPages;     // Pages currently rendering & the note
+    QHash<QWebPage*, QDateTime> startTimes; // When each page started
+    QElapsedTimer rateTimer;                // Used to compute thumbnails/second
+    qint32 renderedCount;                   // Number of thumbnails created
+    bool dispatchScheduled;                 // Has a dispatch been queued?
+    qint32 maxPages();
+    bool takeNext(qint32 &lid);
+    void dispatch();
+    void scheduleDispatch();
+    void render(QWebPage *page, qint32 lid);
+    void finish(QWebPage *page, bool ok);
 
 
 public:
-    QWebPage *page;
     Thumbnailer(DatabaseConnection *db);
     ~Thumbnailer();
     void render(qint32 lid);
-    qint32 lid;
-    bool idle;
-    void capturePage(QWebPage *page);
+    void request(qint32 lid, Priority priority);
+    void request(QList<qint32> lids, Priority priority);
+    void capturePage(QWebPage *page, qint32 lid);
     void startTimer();
+    qint32 queueDepth();
+    double thumbnailsPerSecond();
 
 
 signals:
 
 private slots:
+    void dispatchQueued();
 
 public slots:
     void pageReady(bool ok);
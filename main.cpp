@@ -141,6 +141,7 @@ int main(int argc, char *argv[])
     startupConfig.programDirPath = global.getProgramDirPath() + QDir().separator();
     startupConfig.name = "NixNote";
     global.setup(startupConfig, guiAvailable);
+    global.startupPhase("configuration loaded");
 //    global.syncAndExit=startupConfig.syncAndExit;
 
     // We were passed a SQL command
@@ -262,6 +263,7 @@ int main(int argc, char *argv[])
         w->hide();
     if (global.startMinimized)
         w->showMinimized();
+    global.startupPhase("main window shown");
 
     // Setup the proxy
     QNetworkProxy proxy;
@@ -156,6 +156,14 @@ Qt::ItemFlags NoteModel::flags(const QModelIndex &index) const
 
 
 QVariant NoteModel::data (const QModelIndex & index, int role) const {
+    // Relevance isn't stored in the table.  It is computed for each search.
+    if (index.column() == NOTE_TABLE_RELEVANCE_POSITION) {
+        if (role != Qt::DisplayRole && role != Qt::EditRole)
+            return QVariant();
+        qint32 lid = index.sibling(index.row(), NOTE_TABLE_LID_POSITION).data().toInt();
+        return qRound(relevance.value(lid, 0)*100)/100.0;
+    }
+
     if (role == Qt::ForegroundRole) {
         QString color = index.sibling(index.row(), NOTE_TABLE_COLOR_POSITION).data().toString();
         if (color != "") {
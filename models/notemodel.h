@@ -21,6 +21,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #define NOTEMODEL_H
 
 #include <QSqlTableModel>
+#include <QHash>
 #include "sql/databaseconnection.h"
 
 class NoteModel : public QSqlTableModel
@@ -28,6 +29,7 @@ class NoteModel : public QSqlTableModel
     Q_OBJECT
 private:
 public:
+    QHash<qint32, double> relevance;           // Search relevance of each note
     explicit NoteModel(QObject *parent = 0);
     ~NoteModel();
     //int rowCount(const QModelIndex &parent) const;
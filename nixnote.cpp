@@ -47,6 +47,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QDesktopWidget>
 #include <QFileIconProvider>
 #include <QSplashScreen>
+#include <QEventLoop>
 #include <unistd.h>
 
 #include "sql/notetable.h"
@@ -54,6 +55,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "gui/ntabwidget.h"
 #include "sql/notebooktable.h"
 #include "sql/usertable.h"
+#include "sql/noteversiontable.h"
 #include "settings/startupconfig.h"
 #include "dialog/logindialog.h"
 #include "dialog/closenotebookdialog.h"
@@ -134,7 +136,9 @@ NixNote::NixNote(QWidget *parent) : QMainWindow(parent)
     connect(&syncThread, SIGNAL(started()), this, SLOT(syncThreadStarted()));
     connect(&counterThread, SIGNAL(started()), this, SLOT(counterThreadStarted()));
     connect(&indexThread, SIGNAL(started()), this, SLOT(indexThreadStarted()));
+    connect(&historyThread, SIGNAL(started()), this, SLOT(historyThreadStarted()));
     counterThread.start(QThread::LowestPriority);
+    historyThread.start(QThread::LowestPriority);
     syncThread.start(QThread::LowPriority);
     indexThread.start(QThread::LowestPriority);
     this->thread()->setPriority(QThread::HighestPriority);
@@ -158,8 +162,25 @@ NixNote::NixNote(QWidget *parent) : QMainWindow(parent)
     // Setup the counter thread
     QLOG_TRACE() << "Setting up sync thread";
     connect(this,SIGNAL(syncRequested()),&syncRunner,SLOT(synchronize()));
+    connect(this, SIGNAL(syncRequested()), &maintenanceRunner, SLOT(syncStarted()));
+    connect(&syncRunner, SIGNAL(syncComplete()), &maintenanceRunner, SLOT(syncFinished()));
     connect(&syncRunner, SIGNAL(setMessage(QString, int)), this, SLOT(setMessage(QString, int)));
 
+    // Setup the note history thread
+    QLOG_TRACE() << "Setting up note history thread";
+    historyDialog = NULL;
+    historyWait = NULL;
+    historyWaitUsn = 0;
+    historyWaitFound = false;
+    historyTimer.setSingleShot(true);
+    historyTimer.setInterval(NOTE_HISTORY_PREFETCH_DELAY);
+    connect(&historyTimer, SIGNAL(timeout()), this, SLOT(prefetchNoteHistory()));
+    connect(this, SIGNAL(requestNoteVersions(QString,qint32)), &historyRunner, SLOT(loadVersions(QString,qint32)));
+    connect(this, SIGNAL(requestNoteVersion(QString,qint32,bool)), &historyRunner, SLOT(loadVersion(QString,qint32,bool)));
+    connect(this, SIGNAL(cancelNoteVersions()), &historyRunner, SLOT(cancelVersions()));
+    connect(&historyRunner, SIGNAL(versionsReady(QString)), this, SLOT(noteVersionsReady(QString)));
+    connect(&historyRunner, SIGNAL(versionReady(QString,qint32,bool)), this, SLOT(noteVersionReady(QString,qint32,bool)));
+
     QLOG_TRACE() << "Setting up GUI";
     global.filterPosition = 0;
     this->setupGui();
@@ -177,6 +198,7 @@ NixNote::NixNote(QWidget *parent) : QMainWindow(parent)
 
     hammer = new Thumbnailer(global.db);
     hammer->startTimer();
+    global.thumbnailer = hammer;
     finalSync = false;
 
 
@@ -235,13 +257,190 @@ NixNote::NixNote(QWidget *parent) : QMainWindow(parent)
     connect(importManager, SIGNAL(fileImported(qint32,qint32)), this, SLOT(updateSelectionCriteria()));
     connect(importManager, SIGNAL(fileImported()), this, SLOT(updateSelectionCriteria()));
     importManager->setup();
-    this->updateSelectionCriteria(true);  // This is only needed in case we imported something at statup.
+
+    // The trees and the note list are filled in once the window has
+    // had a chance to paint itself.
+    global.startupPhase("main window built");
+    QTimer::singleShot(0, this, SLOT(finishStartup()));
     QLOG_DEBUG() << "Exiting NixNote constructor";
 }
 
 
 
 
+//****************************************************************
+//* Load the data into the trees & the note list.  This is done
+//* after the main window is shown so the user isn't left staring
+//* at nothing while a large database is read.
+//****************************************************************
+void NixNote::finishStartup() {
+    QLOG_DEBUG() << "Loading startup data";
+
+    notebookTreeView->loadData();
+    searchTreeView->loadData();
+    tagTreeView->loadData();
+    favoritesTreeView->loadData();
+    tagTreeView->resetSize();
+    searchTreeView->resetSize();
+    global.startupPhase("sidebar trees loaded");
+
+    global.settings->beginGroup("Appearance");
+    int selectionBehavior = global.settings->value("startupNotebook", AppearancePreferences::UseLastViewedNotebook).toInt();
+    global.settings->endGroup();
+
+    // Reload saved selection criteria
+    if (selectionBehavior != AppearancePreferences::UseAllNotebooks) {
+        bool criteriaFound = false;
+        FilterCriteria *criteria = new FilterCriteria();
+
+        // Restore whatever they were looking at in the past
+        if (selectionBehavior == AppearancePreferences::UseLastViewedNotebook) {
+
+            global.settings->beginGroup("SaveState");
+            qint32 notebookLid = global.settings->value("selectedNotebook", 0).toInt();
+            if (notebookLid > 0 && notebookTreeView->dataStore[notebookLid] != NULL) {
+                criteria->setNotebook(*notebookTreeView->dataStore[notebookLid]);
+                criteriaFound = true;
+            } else {
+                QString selectedStack = global.settings->value("selectedStack", "").toString();
+                if (selectedStack != "" && notebookTreeView->stackStore[selectedStack] != NULL) {
+                    criteria->setNotebook(*notebookTreeView->stackStore[selectedStack]);
+                    criteriaFound = true;
+                }
+            }
+
+            QString prevSearch = global.settings->value("searchString", "").toString();
+            if (prevSearch != "") {
+                searchText->setText(prevSearch);
+                criteria->setSearchString(prevSearch);
+                criteriaFound = true;
+            }
+
+            qint32 searchLid = global.settings->value("selectedSearch", 0).toInt();
+            if (searchLid > 0 && searchTreeView->dataStore[searchLid] != NULL) {
+                criteria->setSavedSearch(*searchTreeView->dataStore[searchLid]);
+                criteriaFound = true;
+            }
+
+            QString selectedTags = global.settings->value("selectedTags", "").toString();
+            if (selectedTags != "") {
+                QStringList tags = selectedTags.split(" ");
+                QList<QTreeWidgetItem *> items;
+                for (int i=0; i<tags.size(); i++) {
+                    if (tagTreeView->dataStore[tags[i].toInt()] != NULL)
+                        items.append(tagTreeView->dataStore[tags[i].toInt()]);
+                }
+                criteriaFound = true;
+                criteria->setTags(items);
+            }
+
+            global.settings->endGroup();
+        }
+
+        // Select the default notebook
+        if (selectionBehavior == AppearancePreferences::UseDefaultNotebook) {
+            NotebookTable ntable(global.db);
+            qint32 lid = ntable.getDefaultNotebookLid();
+            if (notebookTreeView->dataStore[lid] != NULL) {
+                criteria->setNotebook(*notebookTreeView->dataStore[lid]);
+                criteriaFound = true;
+            }
+        }
+
+
+
+        // If we have some filter criteria, save it.  Otherwise delete
+        // the unused memory.
+        if (criteriaFound) {
+            global.filterPosition++;
+            global.appendFilter(criteria);
+        } else
+            delete criteria;
+    }
+
+    // Reopen the notes we were viewing the last time.  This has to follow
+    // the criteria above so the first note is selected in it; each of the
+    // others gets its own copy of it, the same as opening notes in new tabs.
+    global.settings->beginGroup("SaveState");
+    QStringList lidList = global.settings->value("openTabs", "").toString().split(' ', QString::SkipEmptyParts);
+    global.settings->endGroup();
+    for (int i=0; i<lidList.size(); i++) {
+        FilterCriteria *filter = global.filterCriteria[global.filterPosition];
+        if (i>0) {
+            FilterCriteria *newFilter = new FilterCriteria();
+            filter->duplicate(*newFilter);
+            global.filterPosition++;
+            global.appendFilter(newFilter);
+            filter = newFilter;
+        }
+        qint32 lid = lidList[i].toInt();
+        QList<qint32> selectedLids;
+        selectedLids.append(lid);
+        filter->setSelectedNotes(selectedLids);
+        filter->setLid(lid);
+        openNote(i>0);
+    }
+
+    NoteTable noteTable(global.db);
+    if (global.startupNote > 0 && noteTable.exists(global.startupNote)) {
+        openExternalNote(global.startupNote);
+    }
+
+
+    // Restore expanded tags & stacks
+    global.settings->beginGroup("SaveState");
+    QString expandedTags = global.settings->value("expandedTags", "").toString();
+    if (expandedTags != "") {
+        QStringList tags = expandedTags.split(" ");
+        for (int i=0; i<tags.size(); i++) {
+            NTagViewItem *item;
+            item = tagTreeView->dataStore[tags[i].toInt()];
+            if (item != NULL)
+                item->setExpanded(true);
+        }
+    }
+    QString expandedNotebooks = global.settings->value("expandedStacks", "").toString();
+    if (expandedNotebooks != "") {
+        QStringList books = expandedNotebooks.split(" ");
+        for (int i=0; i<books.size(); i++) {
+            NNotebookViewItem *item;
+            item = notebookTreeView->dataStore[books[i].toInt()];
+            if (item != NULL && item->stack != "" && item->parent() != NULL) {
+                item->parent()->setExpanded(true);
+                //QLOG_DEBUG() << "Parent of " << books[i] << " expanded.";
+            }
+        }
+    }
+
+    searchTreeView->root->setExpanded(true);
+    QString collapsedTrees = global.settings->value("collapsedTrees", "").toString();
+    if (collapsedTrees != "") {
+        QStringList trees = collapsedTrees.split(" ");
+        for (int i=0; i<trees.size(); i++) {
+            QString item = trees[i].toLower();
+            if (item=="favorites")
+                this->favoritesTreeView->root->setExpanded(false);
+            if (item=="notebooks")
+                this->notebookTreeView->root->setExpanded(false);
+            if (item=="tags")
+                this->tagTreeView->root->setExpanded(false);
+            if (item=="attributes")
+                this->attributeTree->root->setExpanded(false);
+            if (item=="savedsearches")
+                this->searchTreeView->root->setExpanded(false);
+        }
+    }
+    global.settings->endGroup();
+
+    // Finish by filtering & displaying the data.  This is also needed
+    // in case we imported something at startup.
+    this->updateSelectionCriteria();
+    global.startupPhase("note list loaded");
+}
+
+
+
+
 
 // Destructor to call when all done
 NixNote::~NixNote()
@@ -250,9 +449,11 @@ NixNote::~NixNote()
     syncThread.quit();
     indexThread.quit();
     counterThread.quit();
+    historyThread.quit();
     while (!syncThread.isFinished());
     while (!indexThread.isFinished());
     while(!counterThread.isFinished());
+    while(!historyThread.isFinished());
 
     // Cleanup any temporary files
     if (global.purgeTemporaryFilesOnShutdown) {
@@ -411,7 +612,6 @@ void NixNote::setupGui() {
     global.startMinimized = false;
     QLOG_TRACE() << "Restoring window state";
     global.settings->beginGroup("Appearance");
-    int selectionBehavior = global.settings->value("startupNotebook", AppearancePreferences::UseLastViewedNotebook).toInt();
     global.startMinimized = global.settings->value("startMinimized", false).toBool();
     global.settings->endGroup();
 
@@ -430,7 +630,6 @@ void NixNote::setupGui() {
     rightPanelSplitter->restoreState(global.settings->value("rightSplitter", 0).toByteArray());
     if (global.settings->value("isMaximized", false).toBool())
         this->setWindowState(Qt::WindowMaximized);
-    QString lidListString = global.settings->value("openTabs", "").toString().trimmed();
     bool value = global.settings->value("leftPanelVisible", true).toBool();
     if (!value) {
         menuBar->viewLeftPanel->setChecked(false);
@@ -484,39 +683,6 @@ void NixNote::setupGui() {
     else
         viewNoteListNarrow();
 
-    QStringList lidList = lidListString.split(' ');
-    // If we have old notes we were viewing the last time
-    if (lidList.size() > 0) {
-        FilterCriteria *filter = global.filterCriteria[global.filterPosition];
-
-        for (int i=0; i<lidList.size(); i++) {
-            // if we are doing multiple notes, they each need
-            // to be added to the selection criteria.
-            if (i>0)
-                filter = new FilterCriteria();
-            int lid = lidList[i].toInt();
-            QList<qint32> selectedLids;
-            selectedLids.append(lid);
-            filter->setSelectedNotes(selectedLids);
-            filter->setLid(lid);
-            if (i>0)
-                global.filterCriteria.append(filter);
-        }
-
-        for (int i=0; i<lidList.size(); i++) {
-            global.filterPosition = i;
-            if(i==0)
-                openNote(false);
-            else
-                openNote(true);
-        }
-    }
-
-    NoteTable noteTable(global.db);
-    if (global.startupNote > 0 && noteTable.exists(global.startupNote)) {
-        openExternalNote(global.startupNote);
-    }
-
     // Setup the tray icon
     closeFlag = false;
     minimizeToTray = global.minimizeToTray();
@@ -603,77 +769,6 @@ void NixNote::setupGui() {
     connect(tagTreeView, SIGNAL(tagRenamed(qint32,QString,QString)), this, SLOT(updateSelectionCriteria()));
     connect(notebookTreeView, SIGNAL(notebookRenamed(qint32,QString,QString)), this, SLOT(updateSelectionCriteria()));
 
-    // Reload saved selection criteria
-    if (selectionBehavior != AppearancePreferences::UseAllNotebooks) {
-        bool criteriaFound = false;
-        FilterCriteria *criteria = new FilterCriteria();
-
-        // Restore whatever they were looking at in the past
-        if (selectionBehavior == AppearancePreferences::UseLastViewedNotebook) {
-
-            global.settings->beginGroup("SaveState");
-            qint32 notebookLid = global.settings->value("selectedNotebook", 0).toInt();
-            if (notebookLid > 0 && notebookTreeView->dataStore[notebookLid] != NULL) {
-                criteria->setNotebook(*notebookTreeView->dataStore[notebookLid]);
-                criteriaFound = true;
-            } else {
-                QString selectedStack = global.settings->value("selectedStack", "").toString();
-                if (selectedStack != "" && notebookTreeView->stackStore[selectedStack] != NULL) {
-                    criteria->setNotebook(*notebookTreeView->stackStore[selectedStack]);
-                    criteriaFound = true;
-                }
-            }
-
-            QString prevSearch = global.settings->value("searchString", "").toString();
-            if (prevSearch != "") {
-                searchText->setText(prevSearch);
-                criteria->setSearchString(prevSearch);
-                criteriaFound = true;
-            }
-
-            qint32 searchLid = global.settings->value("selectedSearch", 0).toInt();
-            if (searchLid > 0 && searchTreeView->dataStore[searchLid] != NULL) {
-                criteria->setSavedSearch(*searchTreeView->dataStore[searchLid]);
-                criteriaFound = true;
-            }
-
-            QString selectedTags = global.settings->value("selectedTags", "").toString();
-            if (selectedTags != "") {
-                QStringList tags = selectedTags.split(" ");
-                QList<QTreeWidgetItem *> items;
-                for (int i=0; i<tags.size(); i++) {
-                    if (tagTreeView->dataStore[tags[i].toInt()] != NULL)
-                        items.append(tagTreeView->dataStore[tags[i].toInt()]);
-                }
-                criteriaFound = true;
-                criteria->setTags(items);
-            }
-
-            global.settings->endGroup();
-        }
-
-        // Select the default notebook
-        if (selectionBehavior == AppearancePreferences::UseDefaultNotebook) {
-            NotebookTable ntable(global.db);
-            qint32 lid = ntable.getDefaultNotebookLid();
-            if (notebookTreeView->dataStore[lid] != NULL) {
-                criteria->setNotebook(*notebookTreeView->dataStore[lid]);
-                criteriaFound = true;
-            }
-        }
-
-
-
-        // If we have some filter criteria, save it.  Otherwise delete
-        // the unused memory.
-        if (criteriaFound) {
-            global.filterPosition++;
-            global.appendFilter(criteria);
-        } else
-            delete criteria;
-    }
-
-    this->updateSelectionCriteria();
     // Set default focuse to the editor window
     tabWindow->currentBrowser()->editor->setFocus();
 
@@ -699,52 +794,6 @@ void NixNote::setupGui() {
             QTimer::singleShot(100,this, SLOT(hide()));
     }
 
-    // Restore expanded tags & stacks
-    global.settings->beginGroup("SaveState");
-    QString expandedTags = global.settings->value("expandedTags", "").toString();
-    if (expandedTags != "") {
-        QStringList tags = expandedTags.split(" ");
-        for (int i=0; i<tags.size(); i++) {
-            NTagViewItem *item;
-            item = tagTreeView->dataStore[tags[i].toInt()];
-            if (item != NULL)
-                item->setExpanded(true);
-        }
-    }
-    QString expandedNotebooks = global.settings->value("expandedStacks", "").toString();
-    if (expandedNotebooks != "") {
-        QStringList books = expandedNotebooks.split(" ");
-        for (int i=0; i<books.size(); i++) {
-            NNotebookViewItem *item;
-            item = notebookTreeView->dataStore[books[i].toInt()];
-            if (item != NULL && item->stack != "" && item->parent() != NULL) {
-                item->parent()->setExpanded(true);
-                //QLOG_DEBUG() << "Parent of " << books[i] << " expanded.";
-            }
-        }
-    }
-
-    searchTreeView->root->setExpanded(true);
-    QString collapsedTrees = global.settings->value("collapsedTrees", "").toString();
-    if (collapsedTrees != "") {
-        QStringList trees = collapsedTrees.split(" ");
-        for (int i=0; i<trees.size(); i++) {
-            QString item = trees[i].toLower();
-            if (item=="favorites")
-                this->favoritesTreeView->root->setExpanded(false);
-            if (item=="notebooks")
-                this->notebookTreeView->root->setExpanded(false);
-            if (item=="tags")
-                this->tagTreeView->root->setExpanded(false);
-            if (item=="attributes")
-                this->attributeTree->root->setExpanded(false);
-            if (item=="savedsearches")
-                this->searchTreeView->root->setExpanded(false);
-        }
-    }
-    global.settings->endGroup();
-
-
     // Setup application-wide shortcuts
     focusSearchShortcut = new QShortcut(this);
     focusSearchShortcut->setContext(Qt::WidgetWithChildrenShortcut);
@@ -863,6 +912,18 @@ void NixNote::indexFinished(bool finished) {
 //**************************************************************
 void NixNote::counterThreadStarted() {
     counterRunner.moveToThread(&counterThread);
+    maintenanceRunner.moveToThread(&counterThread);
+    QMetaObject::invokeMethod(&maintenanceRunner, "start", Qt::QueuedConnection);
+    global.maintenanceRunner = &maintenanceRunner;
+}
+
+
+
+//**************************************************************
+//* Move the note history runner to its thread.
+//**************************************************************
+void NixNote::historyThreadStarted() {
+    historyRunner.moveToThread(&historyThread);
 }
 
 
@@ -969,6 +1030,7 @@ void NixNote::setupTagTree() {
     connect(&counterRunner, SIGNAL(tagCountComplete()), tagTreeView, SLOT(hideUnassignedTags()));
     connect(notebookTreeView, SIGNAL(notebookSelectionChanged(qint32)), tagTreeView, SLOT(notebookSelectionChanged(qint32)));
     connect(tagTreeView, SIGNAL(updateNoteList(qint32,int,QVariant)), noteTableView, SLOT(refreshCell(qint32,int,QVariant)));
+    connect(tagTreeView, SIGNAL(refreshNoteList()), noteTableView, SLOT(refreshData()));
     connect(tagTreeView, SIGNAL(updateCounts()), &counterRunner, SLOT(countAll()));
     QLOG_TRACE() << "Exiting NixNote.setupTagTree()";
 }
@@ -1049,6 +1111,7 @@ void NixNote::setupSynchronizedNotebookTree() {
     connect(&syncRunner, SIGNAL(notebookExpunged(qint32)), notebookTreeView, SLOT(notebookExpunged(qint32)));
     connect(&counterRunner, SIGNAL(notebookTotals(qint32,qint32, qint32)), notebookTreeView, SLOT(updateTotals(qint32,qint32, qint32)));
     connect(notebookTreeView, SIGNAL(updateNoteList(qint32,int,QVariant)), noteTableView, SLOT(refreshCell(qint32,int,QVariant)));
+    connect(notebookTreeView, SIGNAL(refreshNoteList()), noteTableView, SLOT(refreshData()));
     connect(notebookTreeView, SIGNAL(updateCounts()), &counterRunner, SLOT(countAll()));
     QLOG_TRACE() << "Exiting NixNote.setupSynchronizedNotebookTree()";
 }
@@ -1246,6 +1309,7 @@ void NixNote::saveOnExit() {
     QLOG_DEBUG() << "Closing threads";
     indexThread.quit();
     counterThread.quit();
+    historyThread.quit();
 
     QLOG_DEBUG() << "Exitng saveOnExit()";
 }
@@ -1341,6 +1405,8 @@ void NixNote::saveNoteColumnPositions() {
     global.setColumnPosition("noteTableReminderTimeDonePosition", position);
     position = noteTableView->horizontalHeader()->visualIndex(NOTE_TABLE_REMINDER_ORDER_POSITION);
     global.setColumnPosition("noteTableReminderOrderPosition", position);
+    position = noteTableView->horizontalHeader()->visualIndex(NOTE_TABLE_RELEVANCE_POSITION);
+    global.setColumnPosition("noteTableRelevancePosition", position);
 }
 
 
@@ -1394,6 +1460,8 @@ void NixNote::saveNoteColumnWidths() {
     global.setColumnWidth("noteTableReminderTimeDonePosition", width);
     width = noteTableView->columnWidth(NOTE_TABLE_REMINDER_ORDER_POSITION);
     global.setColumnWidth("noteTableReminderOrderPosition", width);
+    width = noteTableView->columnWidth(NOTE_TABLE_RELEVANCE_POSITION);
+    global.setColumnWidth("noteTableRelevancePosition", width);
 }
 
 
@@ -1549,11 +1617,12 @@ void NixNote::openNote(bool newWindow) {
     } else {
         tabWindow->openNote(-1, NTabWidget::CurrentTab);
     }
+    historyTimer.start();
     rightArrowButton->setEnabled(false);
     leftArrowButton->setEnabled(false);
     if (global.filterPosition+1 < global.filterCriteria.size())
         rightArrowButton->setEnabled(true);
-    if (global.filterPosition > 0)
+    if (global.filterPosition > global.filterCriteria.firstPosition())
         leftArrowButton->setEnabled(true);
     checkReadOnlyNotebook();
 }
@@ -1580,16 +1649,8 @@ void NixNote::updateSelectionCriteria(bool afterSync) {
 
     tabWindow->currentBrowser()->saveNoteContent();
 
-    // Invalidate the cache
-    QDir dir(global.fileManager.getTmpDirPath());
-    QFileInfoList files = dir.entryInfoList();
-
-    for (int i=0; i<files.size(); i++) {
-        if (files[i].fileName().endsWith("_icon.png")) {
-            QFile file(files[i].absoluteFilePath());
-            file.remove();
-        }
-    }
+    // Invalidate the cache.  Attachment icons are keyed by their highlight
+    // state, so they don't need to be removed here.
     QList<qint32> keys = global.cache.keys();
     for (int i=0; i<keys.size(); i++) {
         global.cache.remove(keys[i]);
@@ -1614,7 +1675,7 @@ void NixNote::updateSelectionCriteria(bool afterSync) {
     leftArrowButton->setEnabled(false);
     if (global.filterPosition+1 < global.filterCriteria.size())
         rightArrowButton->setEnabled(true);
-    if (global.filterPosition > 0)
+    if (global.filterPosition > global.filterCriteria.firstPosition())
         leftArrowButton->setEnabled(true);
 
     QList<qint32> selectedNotes;
@@ -2363,38 +2424,41 @@ void NixNote::viewNoteHistory() {
         global.accountsManager->setOAuthToken(token);
     }
 
-    UserTable userTable(global.db);
-    User user;
-    userTable.getUser(user);
-    bool normalUser = false;
-    if (user.privilege == PrivilegeLevel::NORMAL)
-        normalUser = true;
-
+    // Show whatever versions we already have & ask the history thread
+    // for a newer list.  The dialog is reloaded if one arrives.
     NoteHistorySelect dialog;
-    QString guid = ntable.getGuid(tabWindow->currentBrowser()->lid);
-    QList<NoteVersionId> versions;
-
-    CommunicationManager comm(global.db);
-    if (comm.enConnect()) {
-        QList<NoteVersionId> versions;
-        NoteTable ntable(global.db);
-        QString guid = ntable.getGuid(tabWindow->currentBrowser()->lid);
-        if (!normalUser)
-            comm.listNoteVersions(versions, guid);
-    }
-    dialog.loadData(versions);
+    QString guid = ntable.getGuid(lid);
+    NoteVersionTable versionTable(global.db);
+    historyGuid = guid;
+    historyVersions.clear();
+    versionTable.getVersions(guid, -1, historyVersions);
+    dialog.loadData(historyVersions);
+    historyDialog = &dialog;
+    emit requestNoteVersions(guid, n.updateSequenceNum);
     dialog.exec();
+    historyDialog = NULL;
+    emit cancelNoteVersions();
     if (!dialog.importPressed)
         return;
+
+    // The cached copy doesn't have its attachments, so the history thread
+    // fills them in (from the note we have where it can) before we restore.
     Note note;
-    if (dialog.usn > 0 && !comm.getNoteVersion(note, guid, dialog.usn)) {
-        QMessageBox mbox;
-        mbox.setText(tr("Error retrieving note."));
-        mbox.setWindowTitle(tr("Error retrieving note"));
-        mbox.exec();
-        return;
-    }
-    if (dialog.usn <= 0 && !comm.getNote(note, guid,true,true,true)) {
+    qint32 usn = dialog.usn;
+    if (usn < 0)
+        usn = 0;
+    QEventLoop loop;
+    historyWait = &loop;
+    historyWaitUsn = usn;
+    historyWaitFound = false;
+    setMessage(tr("Retrieving note from Evernote"));
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    emit requestNoteVersion(guid, usn, true);
+    loop.exec();
+    QApplication::restoreOverrideCursor();
+    historyWait = NULL;
+    statusBar()->clearMessage();
+    if (!historyWaitFound || !versionTable.getVersion(guid, usn, note)) {
         QMessageBox mbox;
         mbox.setText(tr("Error retrieving note."));
         mbox.setWindowTitle(tr("Error retrieving note"));
@@ -2437,6 +2501,64 @@ void NixNote::viewNoteHistory() {
 
 
 
+//**********************************************
+//* The user has stayed on a note for a while,
+//* so get its history ready in case they ask.
+//**********************************************
+void NixNote::prefetchNoteHistory() {
+    if (!global.accountsManager->oauthTokenFound())
+        return;
+    qint32 lid = tabWindow->currentBrowser()->lid;
+    if (lid <= 0)
+        return;
+    NoteTable ntable(global.db);
+    QString guid = ntable.getGuid(lid);
+    qint32 usn = ntable.getUpdateSequenceNumber(lid);
+    if (guid == "" || usn <= 0)
+        return;
+    emit requestNoteVersions(guid, usn);
+}
+
+
+
+//**********************************************
+//* A note's list of versions has been
+//* downloaded.  If the history dialog is
+//* showing it, refresh it & start getting the
+//* newest versions ready in case one is
+//* restored.
+//**********************************************
+void NixNote::noteVersionsReady(QString guid) {
+    if (historyDialog == NULL || guid != historyGuid)
+        return;
+
+    NoteVersionTable versionTable(global.db);
+    historyVersions.clear();
+    versionTable.getVersions(guid, -1, historyVersions);
+    historyDialog->loadData(historyVersions);
+
+    for (int i=0; i<historyVersions.size() && i<NOTE_HISTORY_PREFETCH; i++) {
+        if (!versionTable.hasVersion(guid, historyVersions[i].updateSequenceNum))
+            emit requestNoteVersion(guid, historyVersions[i].updateSequenceNum, false);
+    }
+}
+
+
+
+//**********************************************
+//* A version of a note has been downloaded.
+//* Stop waiting if it is the one the user
+//* chose to restore.
+//**********************************************
+void NixNote::noteVersionReady(QString guid, qint32 usn, bool found) {
+    if (historyWait == NULL || guid != historyGuid || usn != historyWaitUsn)
+        return;
+    historyWaitFound = found;
+    historyWait->quit();
+}
+
+
+
 //****************************************
 //* Search for text within a note
 //****************************************
@@ -2960,6 +3082,9 @@ void NixNote::openPreferences() {
             //trayIconBehavior();
         }
         indexRunner.officeFound = global.synchronizeAttachments();
+
+        // Search preferences can change what a filter matches
+        global.filterCriteria.clearResults();
     }
     global.setDebugLevel();
 }
@@ -49,6 +49,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "gui/ntrashtree.h"
 #include "dialog/accountdialog.h"
 #include "threads/counterrunner.h"
+#include "threads/maintenancerunner.h"
+#include "threads/notehistoryrunner.h"
 //#include "oauth/oauthwindow.h"
 #include "html/thumbnailer.h"
 #include "reminders/remindermanager.h"
@@ -73,6 +75,8 @@ class NTabWidget;
 class Thumbnailer;
 class NTableView;
 class SyncRunner;
+class NoteHistorySelect;
+class QEventLoop;
 
 // Define the actual class
 class NixNote : public QMainWindow
@@ -152,6 +156,15 @@ private:
 
     QTimer heartbeatTimer;   // Timer to check shared memory for other instance commands.
 
+    // Note history
+    QTimer historyTimer;                    // Wait for the user to settle on a note before asking for its history
+    NoteHistorySelect *historyDialog;       // The history dialog, while it is open
+    QString historyGuid;                    // The note the history dialog is showing
+    QList<NoteVersionId> historyVersions;   // The versions shown in the history dialog
+    QEventLoop *historyWait;                // Used to wait on a version the user has chosen
+    qint32 historyWaitUsn;                  // The version being waited on
+    bool historyWaitFound;                  // Was the version waited on downloaded?
+
     void setupGui();
     void setupNoteList();
     void setupSearchTree();
@@ -201,6 +214,9 @@ public:
     QThread counterThread;
     IndexRunner indexRunner;
     CounterRunner counterRunner;
+    QThread historyThread;
+    NoteHistoryRunner historyRunner;
+    MaintenanceRunner maintenanceRunner;
     void closeEvent(QCloseEvent *event);
     //bool notify(QObject* receiver, QEvent* event);
     bool event(QEvent *event);
@@ -217,6 +233,7 @@ public slots:
     void updateSyncButton();
     void syncButtonReset();
     void updateSelectionCriteria(bool afterSync=false);
+    void finishStartup();
     void leftButtonTriggered();
     void rightButtonTriggered();
     void openNote(bool newWindow);
@@ -284,6 +301,10 @@ public slots:
     void indexThreadStarted();
     void syncThreadStarted();
     void counterThreadStarted();
+    void historyThreadStarted();
+    void prefetchNoteHistory();
+    void noteVersionsReady(QString guid);
+    void noteVersionReady(QString guid, qint32 usn, bool found);
     void openCloseNotebooks();
     void newWebcamNote();
     void deleteCurrentNote();
@@ -310,6 +331,9 @@ public slots:
 signals:
     void syncRequested();
     void updateCounts();
+    void requestNoteVersions(QString guid, qint32 noteUsn);
+    void requestNoteVersion(QString guid, qint32 usn, bool restore);
+    void cancelNoteVersions();
 };
 
 #endif // NIXNOTE_H
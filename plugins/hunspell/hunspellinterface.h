@@ -35,10 +35,11 @@ public:
 
     virtual void initialize(QString programDictionary, QString userDictionary) = 0;
     virtual bool spellCheck(QString word, QStringList &suggestions) = 0;
+    virtual bool isCorrect(QString word) = 0;
     virtual void addWord(QString dictionary, QString word) = 0;
 
 };
 
-Q_DECLARE_INTERFACE(HunspellInterface, "org.nixnote.NixNote2.HunspellInterface/2.0")
+Q_DECLARE_INTERFACE(HunspellInterface, "org.nixnote.NixNote2.HunspellInterface/2.1")
 
 #endif // HUNSPELLINTERFACE_H
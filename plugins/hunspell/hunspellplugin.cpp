@@ -39,6 +39,11 @@ bool HunspellPlugin::spellCheck(QString word, QStringList &suggestions) {
 }
 
 
+bool HunspellPlugin::isCorrect(QString word) {
+    return checker->isCorrect(word);
+}
+
+
 void HunspellPlugin::addWord(QString dictionary, QString word) {
     return checker->addWord(dictionary, word);
 }
@@ -33,7 +33,7 @@ class HunspellPlugin : public QObject, HunspellInterface
     Q_INTERFACES(HunspellInterface)
 #if QT_VERSION < 0x050000
 #else
-    Q_PLUGIN_METADATA(IID "org.nixnote.NixNote2.HunspellInterface/2.0");
+    Q_PLUGIN_METADATA(IID "org.nixnote.NixNote2.HunspellInterface/2.1");
 #endif
 
 private:
@@ -43,6 +43,7 @@ public:
     HunspellPlugin();
     void initialize(QString programDictionary, QString userDictionary);
     bool spellCheck(QString word, QStringList &suggestions);
+    bool isCorrect(QString word);
     void addWord(QString dictionary, QString word);
 };
 
@@ -13,13 +13,15 @@ QVariant qevercloud::AsyncResult::asIs(QByteArray replyData)
 }
 
 qevercloud::AsyncResult::AsyncResult(QString url, QByteArray postData, qevercloud::AsyncResult::ReadFunctionType readFunction, bool autoDelete, QObject *parent)
-    : QObject(parent), request_(createEvernoteRequest(url)), postData_(postData), readFunction_(readFunction), autoDelete_(autoDelete)
+    : QObject(parent), request_(createEvernoteRequest(url)), postData_(postData), readFunction_(readFunction), autoDelete_(autoDelete),
+      fetcher_(0), aborted_(false), spillThreshold_(0)
 {
     QMetaObject::invokeMethod(this, "start", Qt::QueuedConnection);
 }
 
 qevercloud::AsyncResult::AsyncResult(QNetworkRequest request, QByteArray postData, qevercloud::AsyncResult::ReadFunctionType readFunction, bool autoDelete, QObject *parent)
- : QObject(parent), request_(request), postData_(postData), readFunction_(readFunction), autoDelete_(autoDelete)
+ : QObject(parent), request_(request), postData_(postData), readFunction_(readFunction), autoDelete_(autoDelete),
+   fetcher_(0), aborted_(false), spillThreshold_(0)
 {
     QMetaObject::invokeMethod(this, "start", Qt::QueuedConnection);
 }
@@ -41,9 +43,28 @@ bool qevercloud::AsyncResult::waitForFinished(int timeout)
     }
 }
 
+void qevercloud::AsyncResult::abort()
+{
+    aborted_ = true;
+    if(fetcher_) fetcher_->abort();
+}
+
+void qevercloud::AsyncResult::spillLargeData(QString dir, qint32 threshold)
+{
+    spillDir_ = dir;
+    spillThreshold_ = threshold;
+}
+
 void qevercloud::AsyncResult::start()
 {
+    if(aborted_) {
+        emit finished(QVariant(), QSharedPointer<EverCloudExceptionData>(new EverCloudExceptionData(QStringLiteral("Request aborted."))));
+        if(autoDelete_) this->deleteLater();
+        return;
+    }
     ReplyFetcher* f = new ReplyFetcher;
+    fetcher_ = f;
+    if(spillThreshold_ > 0) f->setSpill(spillDir_, spillThreshold_);
     QObject::connect(f, QEC_SIGNAL(ReplyFetcher,replyFetched,QObject*),
                      this, QEC_SLOT(AsyncResult,onReplyFetched,QObject*));
     f->start(evernoteNetworkAccessManager(), request_, postData_);
@@ -52,6 +73,7 @@ void qevercloud::AsyncResult::start()
 void qevercloud::AsyncResult::onReplyFetched(QObject *rp)
 {
     ReplyFetcher* reply = qobject_cast<ReplyFetcher*>(rp);
+    fetcher_ = 0;
     QSharedPointer<EverCloudExceptionData> error;
     QVariant result;
     try {
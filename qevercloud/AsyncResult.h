@@ -51,6 +51,23 @@ public:
      * @return true if finished succesfully, flase in case of the timeout
      */
     bool waitForFinished(int timeout = -1);
+
+    /**
+     * @brief Give up on the operation.  finished is emitted with an error.
+     */
+    void abort();
+
+    /**
+     * @brief Keep large replies out of memory.
+     * @param dir
+     * Directory for the files.
+     * @param threshold
+     * Data bodies bigger than this many bytes are written straight from the network
+     * to dir/<MD5 of the body in hex>.spill and are left unset in the result.  The
+     * rest of the reply is kept in memory as usual.  The caller owns the files.
+     * Must be called before the request starts.
+     */
+    void spillLargeData(QString dir, qint32 threshold);
 signals:
     /**
      * @brief Emitted upon asyncronous call completition.
@@ -73,6 +90,10 @@ private:
     QByteArray postData_;
     ReadFunctionType readFunction_;
     bool autoDelete_;
+    ReplyFetcher* fetcher_;
+    bool aborted_;
+    QString spillDir_;
+    qint32 spillThreshold_;
 
     /** @endcond  */
 };
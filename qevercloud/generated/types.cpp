@@ -3594,7 +3594,7 @@ void readTag(ThriftBinaryBufferReader& r, Tag& s) {
         if(fieldId == 3) {
             if(fieldType == ThriftFieldType::T_STRING) {
                 Guid v;
-                r.readString(v);
+                r.readStringInterned(v);
                 s.parentGuid = v;
             } else {
                 r.skip(fieldType);
@@ -3993,7 +3993,7 @@ void readResource(ThriftBinaryBufferReader& r, Resource& s) {
         if(fieldId == 4) {
             if(fieldType == ThriftFieldType::T_STRING) {
                 QString v;
-                r.readString(v);
+                r.readStringInterned(v);
                 s.mime = v;
             } else {
                 r.skip(fieldType);
@@ -4241,7 +4241,7 @@ void readNoteAttributes(ThriftBinaryBufferReader& r, NoteAttributes& s) {
         if(fieldId == 14) {
             if(fieldType == ThriftFieldType::T_STRING) {
                 QString v;
-                r.readString(v);
+                r.readStringInterned(v);
                 s.source = v;
             } else {
                 r.skip(fieldType);
@@ -4259,7 +4259,7 @@ void readNoteAttributes(ThriftBinaryBufferReader& r, NoteAttributes& s) {
         if(fieldId == 16) {
             if(fieldType == ThriftFieldType::T_STRING) {
                 QString v;
-                r.readString(v);
+                r.readStringInterned(v);
                 s.sourceApplication = v;
             } else {
                 r.skip(fieldType);
@@ -4313,7 +4313,7 @@ void readNoteAttributes(ThriftBinaryBufferReader& r, NoteAttributes& s) {
         if(fieldId == 22) {
             if(fieldType == ThriftFieldType::T_STRING) {
                 QString v;
-                r.readString(v);
+                r.readStringInterned(v);
                 s.contentClass = v;
             } else {
                 r.skip(fieldType);
@@ -4579,7 +4579,7 @@ void readNote(ThriftBinaryBufferReader& r, Note& s) {
         if(fieldId == 11) {
             if(fieldType == ThriftFieldType::T_STRING) {
                 QString v;
-                r.readString(v);
+                r.readStringInterned(v);
                 s.notebookGuid = v;
             } else {
                 r.skip(fieldType);
@@ -4595,7 +4595,7 @@ void readNote(ThriftBinaryBufferReader& r, Note& s) {
                 if(elemType != ThriftFieldType::T_STRING) throw ThriftException(ThriftException::Type::INVALID_DATA, "Incorrect list type (Note.tagGuids)");
                 for(quint32 i = 0; i < size; i++) {
                     Guid elem;
-                    r.readString(elem);
+                    r.readStringInterned(elem);
                     v.append(elem);
                 }
                 r.readListEnd();
@@ -4642,7 +4642,7 @@ void readNote(ThriftBinaryBufferReader& r, Note& s) {
                 if(elemType != ThriftFieldType::T_STRING) throw ThriftException(ThriftException::Type::INVALID_DATA, "Incorrect list type (Note.tagNames)");
                 for(quint32 i = 0; i < size; i++) {
                     QString elem;
-                    r.readString(elem);
+                    r.readStringInterned(elem);
                     v.append(elem);
                 }
                 r.readListEnd();
@@ -4,10 +4,12 @@
 #include "http.h"
 #include "exceptions.h"
 #include "globals.h"
+#include "thrift.h"
 #include <QEventLoop>
 #include <QtNetwork>
 #include <QSharedPointer>
 #include <QUrl>
+#include <climits>
 
 /** @cond HIDDEN_SYMBOLS  */
 
@@ -23,12 +25,272 @@ QNetworkAccessManager* evernoteNetworkAccessManager() {
     return networkAccessManager_.data();
 }
 
-ReplyFetcher::ReplyFetcher(): success_(false), httpStatusCode_(0)
+ReplySpiller::ReplySpiller(QString dir, qint64 threshold): dir_(dir), threshold_(threshold), pos_(0),
+    headerDone_(false), done_(false), pendingType_(-1), copyRemaining_(0), spillRemaining_(0), spill_(0),
+    md5_(QCryptographicHash::Md5)
+{
+}
+
+ReplySpiller::~ReplySpiller()
+{
+    // A body that was only partly received is of no use to anyone
+    if(spill_) {
+        spill_->remove();
+        delete spill_;
+    }
+}
+
+bool ReplySpiller::write(const QByteArray& data)
+{
+    if(!errorText_.isEmpty()) return false;
+    in_.append(data);
+    while(!done_ && errorText_.isEmpty() && step()) {}
+    in_.remove(0, pos_);
+    pos_ = 0;
+    return errorText_.isEmpty();
+}
+
+bool ReplySpiller::finish()
+{
+    if(!errorText_.isEmpty()) return false;
+    if(!done_) return fail(QStringLiteral("Incomplete reply."));
+    return true;
+}
+
+bool ReplySpiller::fail(QString errorText)
+{
+    errorText_ = errorText;
+    return false;
+}
+
+void ReplySpiller::copy(int bytes)
+{
+    out_.append(in_.constData() + pos_, bytes);
+    pos_ += bytes;
+}
+
+void ReplySpiller::push(qint8 kind, qint8 keyType, qint8 valueType, qint64 remaining)
+{
+    Frame frame;
+    frame.kind = kind;
+    frame.keyType = keyType;
+    frame.valueType = valueType;
+    frame.remaining = remaining;
+    frame.size = -1;
+    stack_.append(frame);
+}
+
+// Handle the next piece of the reply.  Returns false if more data is
+// needed first (or the reply is invalid, see errorText_).
+bool ReplySpiller::step()
+{
+    if(spillRemaining_ > 0) {
+        int bytes = static_cast<int>(qMin<qint64>(spillRemaining_, in_.size() - pos_));
+        if(bytes == 0) return false;
+        if(spill_->write(in_.constData() + pos_, bytes) != bytes) {
+            return fail(QStringLiteral("Unable to write to ") + spill_->fileName());
+        }
+        md5_.addData(in_.constData() + pos_, bytes);
+        pos_ += bytes;
+        spillRemaining_ -= bytes;
+        if(spillRemaining_ == 0) finishSpill();
+        return true;
+    }
+    if(copyRemaining_ > 0) {
+        int bytes = static_cast<int>(qMin<qint64>(copyRemaining_, in_.size() - pos_));
+        if(bytes == 0) return false;
+        copy(bytes);
+        copyRemaining_ -= bytes;
+        return true;
+    }
+    if(!headerDone_) return readHeader();
+    if(pendingType_ >= 0) {
+        if(!readValue(pendingType_)) return false;
+        pendingType_ = -1;
+        return true;
+    }
+    if(stack_.isEmpty()) {
+        done_ = true;
+        return true;
+    }
+    Frame& frame = stack_.last();
+    if(frame.kind == ThriftFieldType::T_STRUCT) return readField(frame);
+    if(frame.remaining == 0) {
+        stack_.removeLast();
+        return true;
+    }
+    // Map keys & values alternate, starting with a key
+    if(frame.kind == ThriftFieldType::T_MAP && frame.remaining % 2 == 0) {
+        pendingType_ = frame.keyType;
+    } else {
+        pendingType_ = frame.valueType;
+    }
+    frame.remaining--;
+    return true;
+}
+
+// The message header: name, type & sequence id.  The result follows as a struct.
+bool ReplySpiller::readHeader()
+{
+    if(!available(4)) return false;
+    qint32 first = peekI32(0);
+    qint64 length;
+    if(first < 0) {
+        if(!available(8)) return false;
+        qint32 nameLength = peekI32(4);
+        if(nameLength < 0) return fail(QStringLiteral("Invalid reply."));
+        length = 4 + 4 + static_cast<qint64>(nameLength) + 4;
+    } else {
+        length = 4 + static_cast<qint64>(first) + 1 + 4;
+    }
+    if(length > 65536) return fail(QStringLiteral("Invalid reply."));
+    if(!available(static_cast<int>(length))) return false;
+    copy(static_cast<int>(length));
+    headerDone_ = true;
+    push(ThriftFieldType::T_STRUCT, 0, 0, 0);
+    return true;
+}
+
+bool ReplySpiller::readField(Frame& frame)
+{
+    if(!available(1)) return false;
+    qint8 type = in_.at(pos_);
+    if(type == ThriftFieldType::T_STOP) {
+        copy(1);
+        stack_.removeLast();
+        return true;
+    }
+    if(!available(3)) return false;
+    qint16 id = peekI16(1);
+    if(type == ThriftFieldType::T_STRING) {
+        if(!available(7)) return false;
+        qint32 length = peekI32(3);
+        if(length < 0) return fail(QStringLiteral("Invalid reply."));
+        if(id == 3 && length > threshold_ && length == frame.size && frame.bodyHash.size() == 16) {
+            pos_ += 7;
+            return startSpill(length, frame.bodyHash);
+        }
+        if(id == 1 && length == 16) {
+            if(!available(7 + 16)) return false;
+            frame.bodyHash = in_.mid(pos_ + 7, 16);
+        }
+        copy(7);
+        copyRemaining_ = length;
+        return true;
+    }
+    if(type == ThriftFieldType::T_I32 && id == 2) {
+        if(!available(7)) return false;
+        frame.size = peekI32(3);
+        copy(7);
+        return true;
+    }
+    copy(3);
+    pendingType_ = type;
+    return true;
+}
+
+bool ReplySpiller::readValue(int type)
+{
+    switch(type) {
+    case ThriftFieldType::T_BOOL:
+    case ThriftFieldType::T_BYTE:
+        if(!available(1)) return false;
+        copy(1);
+        return true;
+    case ThriftFieldType::T_I16:
+        if(!available(2)) return false;
+        copy(2);
+        return true;
+    case ThriftFieldType::T_I32:
+        if(!available(4)) return false;
+        copy(4);
+        return true;
+    case ThriftFieldType::T_I64:
+    case ThriftFieldType::T_U64:
+    case ThriftFieldType::T_DOUBLE:
+        if(!available(8)) return false;
+        copy(8);
+        return true;
+    case ThriftFieldType::T_STRING:
+    case ThriftFieldType::T_UTF8:
+    case ThriftFieldType::T_UTF16: {
+        if(!available(4)) return false;
+        qint32 length = peekI32(0);
+        if(length < 0) return fail(QStringLiteral("Invalid reply."));
+        copy(4);
+        copyRemaining_ = length;
+        return true;
+    }
+    case ThriftFieldType::T_STRUCT:
+        push(ThriftFieldType::T_STRUCT, 0, 0, 0);
+        return true;
+    case ThriftFieldType::T_LIST:
+    case ThriftFieldType::T_SET: {
+        if(!available(5)) return false;
+        qint8 elementType = in_.at(pos_);
+        qint32 size = peekI32(1);
+        if(size < 0) return fail(QStringLiteral("Invalid reply."));
+        copy(5);
+        push(ThriftFieldType::T_LIST, 0, elementType, size);
+        return true;
+    }
+    case ThriftFieldType::T_MAP: {
+        if(!available(6)) return false;
+        qint8 keyType = in_.at(pos_);
+        qint8 valueType = in_.at(pos_ + 1);
+        qint32 size = peekI32(2);
+        if(size < 0) return fail(QStringLiteral("Invalid reply."));
+        copy(6);
+        push(ThriftFieldType::T_MAP, keyType, valueType, 2 * static_cast<qint64>(size));
+        return true;
+    }
+    default:
+        return fail(QStringLiteral("Invalid reply."));
+    }
+}
+
+// The body goes to a temporary name first so a file with the final name
+// is always complete
+bool ReplySpiller::startSpill(qint32 size, QByteArray hash)
+{
+    QTemporaryFile* file = new QTemporaryFile(dir_ + QStringLiteral("/spill-XXXXXX.tmp"));
+    file->setAutoRemove(false);
+    spill_ = file;
+    if(!file->open()) {
+        return fail(QStringLiteral("Unable to create ") + file->fileName());
+    }
+    spillHash_ = hash;
+    spillRemaining_ = size;
+    md5_.reset();
+    return true;
+}
+
+void ReplySpiller::finishSpill()
+{
+    spill_->close();
+    QString target = dir_ + QStringLiteral("/") + QString::fromLatin1(spillHash_.toHex()) + QStringLiteral(".spill");
+    if(md5_.result() != spillHash_) {
+        fail(QStringLiteral("Resource data does not match its hash."));
+    } else {
+        QFile::remove(target);
+        if(!spill_->rename(target)) fail(QStringLiteral("Unable to rename ") + spill_->fileName());
+    }
+    if(!errorText_.isEmpty()) spill_->remove();
+    delete spill_;
+    spill_ = 0;
+}
+
+ReplyFetcher::ReplyFetcher(): success_(false), httpStatusCode_(0), spillThreshold_(0), spiller_(0)
 {
     ticker_ = new QTimer(this);
     connect(ticker_, SIGNAL(timeout()), this, SLOT(checkForTimeout()));
 }
 
+ReplyFetcher::~ReplyFetcher()
+{
+    delete spiller_;
+}
+
 void ReplyFetcher::start(QNetworkAccessManager *nam, QUrl url)
 {
     QNetworkRequest request;
@@ -41,6 +303,8 @@ void ReplyFetcher::start(QNetworkAccessManager *nam, QNetworkRequest request, QB
     httpStatusCode_= 0;
     errorText_.clear();
     receivedData_.clear();
+    delete spiller_;
+    spiller_ = 0;
     success_ = true; // not in finished() signal handler, it might be not called according to the docs
                      // besides, I've added timeout feature
     lastNetworkTime_ = QDateTime::currentMSecsSinceEpoch();
@@ -51,6 +315,7 @@ void ReplyFetcher::start(QNetworkAccessManager *nam, QNetworkRequest request, QB
         reply = QSharedPointer<QNetworkReply>(nam->post(request, postData), &QObject::deleteLater);
     }
     connect(reply.data(), SIGNAL(finished()), this, SLOT(onFinished()));
+    connect(reply.data(), SIGNAL(readyRead()), this, SLOT(onReadyRead()));
     connect(reply.data(), SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(onError()));
     connect(reply.data(), SIGNAL(sslErrors(QList<QSslError>)), this, SLOT(onSslErrors(QList<QSslError>)));
     connect(reply.data(), SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(onDownloadProgress(qint64,qint64)));
@@ -64,22 +329,59 @@ void ReplyFetcher::onDownloadProgress(qint64, qint64)
 void ReplyFetcher::checkForTimeout()
 {
     const int connectionTimeout = 30*1000;
-    if((lastNetworkTime_ - QDateTime::currentMSecsSinceEpoch()) > connectionTimeout) {
+    if((QDateTime::currentMSecsSinceEpoch() - lastNetworkTime_) > connectionTimeout) {
         setError(QStringLiteral("Connection timeout."));
     }
 }
 
 
+// Move data out of the reply as it arrives, so the reply doesn't hold a
+// second copy of a large response.  The buffer is sized from the
+// Content-Length header so it isn't reallocated while growing.  If large
+// bodies are to be spilled, a successful reply goes through the spiller.
+void ReplyFetcher::onReadyRead()
+{
+    if(!success_) return;
+    if(receivedData_.isEmpty() && !spiller_) {
+        if(spillThreshold_ > 0 && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+            spiller_ = new ReplySpiller(spillDir_, spillThreshold_);
+        } else {
+            qint64 length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+            if(length > 0 && length < INT_MAX) receivedData_.reserve(static_cast<int>(length));
+        }
+    }
+    if(spiller_) {
+        if(!spiller_->write(reply->readAll())) setError(spiller_->errorText());
+    } else {
+        receivedData_.append(reply->readAll());
+    }
+}
+
 void ReplyFetcher::onFinished()
 {
     ticker_->stop();
     if(!success_) return;
-    receivedData_ = reply->readAll();
+    onReadyRead();
+    if(!success_) return;
+    if(spiller_) {
+        if(!spiller_->finish()) {
+            setError(spiller_->errorText());
+            return;
+        }
+        receivedData_ = spiller_->data();
+    }
     httpStatusCode_ = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     disconnect(reply.data());
     emit replyFetched(this);
 }
 
+void ReplyFetcher::abort()
+{
+    if(!success_) return;
+    setError(QStringLiteral("Request aborted."));
+    if(!reply.isNull()) reply->abort();
+}
+
 void ReplyFetcher::onError()
 {
     setError(reply->errorString());
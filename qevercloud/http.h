@@ -11,6 +11,9 @@
 #include <QSharedPointer>
 #include <QTypeInfo>
 #include <QSslError>
+#include <QFile>
+#include <QList>
+#include <QCryptographicHash>
 
 /** @cond HIDDEN_SYMBOLS  */
 
@@ -18,11 +21,66 @@ namespace qevercloud {
 
 QNetworkAccessManager* evernoteNetworkAccessManager();
 
+// Copies a Thrift binary protocol reply as it arrives, except for Data
+// bodies bigger than the threshold.  Those are written straight to
+// dir/<MD5 of the body in hex>.spill and the field is left out of the
+// copy, so the reader sees the body as unset.  A Data struct is known by
+// its bodyHash (field 1, 16 bytes) & size (field 2) arriving before a
+// body (field 3) of that size; a note's content, also field 3, has neither.
+class ReplySpiller {
+public:
+    ReplySpiller(QString dir, qint64 threshold);
+    ~ReplySpiller();
+    bool write(const QByteArray& data); // false if the reply is invalid or a file can't be written
+    bool finish();                      // false if the reply was cut short
+    QByteArray data() {return out_;}    // the reply without the spilled bodies
+    QString errorText() {return errorText_;}
+
+private:
+    struct Frame {
+        qint8 kind;                     // T_STRUCT, T_LIST or T_MAP
+        qint8 keyType;
+        qint8 valueType;
+        qint64 remaining;               // list elements, or map keys & values, still to come
+        QByteArray bodyHash;            // struct field 1 if it is 16 bytes of binary
+        qint32 size;                    // struct field 2 if it is an i32
+    };
+    QString dir_;
+    qint64 threshold_;
+    QByteArray in_;                     // received data not processed yet
+    int pos_;
+    QByteArray out_;
+    QList<Frame> stack_;
+    bool headerDone_;
+    bool done_;
+    int pendingType_;                   // type of the value to read next, -1 if none
+    qint64 copyRemaining_;              // bytes of a binary value still to copy
+    qint64 spillRemaining_;             // bytes of a body still to write to spill_
+    QFile* spill_;
+    QByteArray spillHash_;
+    QCryptographicHash md5_;
+    QString errorText_;
+
+    bool available(int bytes) {return in_.size() - pos_ >= bytes;}
+    qint32 peekI32(int offset) {return qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(in_.constData() + pos_ + offset));}
+    qint16 peekI16(int offset) {return qFromBigEndian<qint16>(reinterpret_cast<const uchar*>(in_.constData() + pos_ + offset));}
+    void copy(int bytes);
+    void push(qint8 kind, qint8 keyType, qint8 valueType, qint64 remaining);
+    bool step();
+    bool readHeader();
+    bool readField(Frame& frame);
+    bool readValue(int type);
+    bool startSpill(qint32 size, QByteArray hash);
+    void finishSpill();
+    bool fail(QString errorText);
+};
+
 // the class greatly simplifies QNetworkReply handling
 class ReplyFetcher: public QObject {
     Q_OBJECT
 public:
     ReplyFetcher();
+    ~ReplyFetcher();
     void start(QNetworkAccessManager* nam, QUrl url);
     // if !postData.isNull() then POST will be issued instead of GET
     void start(QNetworkAccessManager* nam, QNetworkRequest request, QByteArray postData = QByteArray());
@@ -30,12 +88,17 @@ public:
     QString errorText() {return errorText_;}
     QByteArray receivedData() {return receivedData_;}
     int httpStatusCode() {return httpStatusCode_;}
+    void abort(); // gives up on the request, replyFetched is emitted with an error
+    // Data bodies bigger than threshold bytes are written to files in dir as
+    // they arrive instead of being kept in memory (see ReplySpiller)
+    void setSpill(QString dir, qint64 threshold) {spillDir_ = dir; spillThreshold_ = threshold;}
 
 signals:
     void replyFetched(QObject*); // sends itself
 
 private slots:
     void onFinished();
+    void onReadyRead();
     void onError();
     void onSslErrors(QList<QSslError> l);
     void onDownloadProgress(qint64, qint64);
@@ -50,6 +113,9 @@ private:
     void setError(QString errorText);
     QTimer* ticker_;
     qint64 lastNetworkTime_;
+    QString spillDir_;
+    qint64 spillThreshold_;
+    ReplySpiller* spiller_;
 };
 
 QNetworkRequest createEvernoteRequest(QString url);
@@ -3,6 +3,8 @@
 
 #include <QByteArray>
 #include <QtEndian>
+#include <QHash>
+#include <QThreadStorage>
 #include <cstring>
 #include "exceptions.h"
 #include "qt4helpers.h"
@@ -243,20 +245,26 @@ class ThriftBinaryBufferReader {
     qint32 pos;
     qint32 stringLimit;
     bool strict;
+    bool interning;
+
+    static const qint32 INTERN_MAX_LENGTH = 64;
+    static const int INTERN_MAX_ENTRIES = 4096;
 
     void read(quint8* dest, qint32 bytesCount) {
         if((pos + bytesCount) > buf.length()) {
             throw ThriftException(ThriftException::Type::PROTOCOL_ERROR, QStringLiteral("Unexpected end of data"));
         }
-        std::memcpy(dest, buf.mid(pos, bytesCount).constData(), bytesCount);
+        std::memcpy(dest, buf.constData() + pos, bytesCount);
         pos += bytesCount;
     }
 
 public:
 
-    ThriftBinaryBufferReader(QByteArray buffer): buf(buffer), pos(0), stringLimit(0), strict(false) {}
+    ThriftBinaryBufferReader(QByteArray buffer): buf(buffer), pos(0), stringLimit(0), strict(false), interning(true) {}
     void setStringLimit(qint32 limit) {stringLimit = limit;}
     void setStrictMode(bool on) {strict = on;}
+    // with interning off readStringInterned() behaves like readString()
+    void setInterning(bool on) {interning = on;}
 
     quint32 readMessageBegin(QString& name, ThriftMessageType::type& messageType, qint32& seqid)
     {
@@ -443,6 +451,60 @@ public:
         return result;
     }
 
+    // Same as readString(), but short values are shared through a per-thread
+    // pool.  Meant for fields that repeat across a sync chunk (notebook & tag
+    // guids, mime types, source applications) so each distinct value is only
+    // decoded and allocated once instead of once per note.  Mostly unique
+    // values (urls, people, places, note guids) would only fill the pool, so
+    // they use readString().
+    inline quint32 readStringInterned(QString& str)
+    {
+        quint32 result;
+        qint32 size;
+        result = readI32(size);
+
+        if (size < 0) {
+            throw ThriftException(ThriftException::Type::PROTOCOL_ERROR, QStringLiteral("Negative size!"));
+        }
+        if (stringLimit > 0 && size > stringLimit) {
+            throw ThriftException(ThriftException::Type::PROTOCOL_ERROR, QStringLiteral("The size limit is exceeded."));
+        }
+
+        if (size == 0) {
+          str.clear();
+          return result;
+        }
+
+        if((pos + size) > buf.length()) {
+            throw ThriftException(ThriftException::Type::PROTOCOL_ERROR, QStringLiteral("Unexpected end of data"));
+        }
+
+        if (size > INTERN_MAX_LENGTH || !interning) {
+            str = QString::fromUtf8(buf.constData() + pos, size);
+        } else {
+            static QThreadStorage<QHash<QByteArray, QString>*> pools;
+            if (!pools.hasLocalData())
+                pools.setLocalData(new QHash<QByteArray, QString>());
+            QHash<QByteArray, QString> *pool = pools.localData();
+
+            // The lookup key points into the reply buffer, so a hit costs no allocation.
+            QHash<QByteArray, QString>::const_iterator it =
+                    pool->constFind(QByteArray::fromRawData(buf.constData() + pos, size));
+            if (it != pool->constEnd()) {
+                str = it.value();
+            } else {
+                if (pool->size() >= INTERN_MAX_ENTRIES)
+                    pool->clear();
+                str = QString::fromUtf8(buf.constData() + pos, size);
+                pool->insert(QByteArray(buf.constData() + pos, size), str);
+            }
+        }
+        pos += size;
+        result += size;
+
+        return result;
+    }
+
     inline quint32 readBinary(QByteArray& str)
     {
         quint32 result;
@@ -466,7 +528,9 @@ public:
             throw ThriftException(ThriftException::Type::PROTOCOL_ERROR, QStringLiteral("Unexpected end of data"));
         }
 
-        str = buf.mid(pos, size);
+        // Copy exactly the slice; sharing the reply buffer through fromRawData()
+        // would leave the result dangling once the reply is released.
+        str = QByteArray(buf.constData() + pos, size);
         pos += size;
         result += size;
 
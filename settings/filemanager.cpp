@@ -21,6 +21,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "global.h"
 #include <iostream>
 #include <cstdlib>
+#include <QFileInfo>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
 
 
 //*******************************************
@@ -109,6 +114,10 @@ void FileManager::setup(QString homeDirPath, QString programDirPath, int id) {
     thumbnailDir.setPath(dbDirPath+"tdba");
     createDirOrCheckWriteable(thumbnailDir);
     thumbnailDirPath = slashTerminatePath(thumbnailDir.path());
+
+    iconCacheDir.setPath(dbDirPath+"icons");
+    createDirOrCheckWriteable(iconCacheDir);
+    iconCacheDirPath = slashTerminatePath(iconCacheDir.path());
 }
 
 
@@ -296,6 +305,12 @@ QString FileManager::getThumbnailDirPath(QString relativePath) {
 QString FileManager::getThumbnailDirPathSpecialChar(QString relativePath) {
     return thumbnailDirPath + toPlatformPathSeparator(relativePath).replace("#", "%23");
 }
+QString FileManager::getIconCacheDirPath() {
+    return iconCacheDirPath;
+}
+QString FileManager::getIconCacheDirPath(QString relativePath) {
+    return iconCacheDirPath + toPlatformPathSeparator(relativePath);
+}
 /*
 QDir FileManager::getXMLDirFile(QString relativePath) {
     return QDir(xmlDir.dirName() + toPlatformPathSeparator(relativePath));
@@ -310,6 +325,41 @@ void FileManager::purgeResDirectory(bool exitOnFail) {
 
 
 
+// Give a resource file a second name without copying its data.  A hard
+// link is used where possible, otherwise the file is copied.  Anything
+// changing a resource file in place must call unshareDbaFile() first.
+// Anything replacing the whole file should just remove it & write a new
+// one, which leaves the other name untouched without copying.
+bool FileManager::shareDbaFile(QString source, QString target) {
+#ifndef _WIN32
+    if (link(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0)
+        return true;
+#endif
+    return QFile::copy(source, target);
+}
+
+
+// If a resource file is shared with another resource, give this one its
+// own copy so changing it doesn't change the other.
+void FileManager::unshareDbaFile(QString path) {
+#ifndef _WIN32
+    struct stat info;
+    if (stat(QFile::encodeName(path).constData(), &info) != 0 || info.st_nlink <= 1)
+        return;
+    QFileInfo fileInfo(path);
+    QString copy = fileInfo.absolutePath() + "/." + fileInfo.fileName();
+    QFile::remove(copy);
+    if (!QFile::copy(path, copy))
+        return;
+    if (rename(QFile::encodeName(copy).constData(), QFile::encodeName(path).constData()) != 0)
+        QFile::remove(copy);
+#else
+    Q_UNUSED(path);
+#endif
+}
+
+
+
 
 
 
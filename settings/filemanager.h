@@ -81,6 +81,9 @@ private:
     QString thumbnailDirPath;
     QDir thumbnailDir;
 
+    QString iconCacheDirPath;
+    QDir iconCacheDir;
+
     //QDir xmlDir;
 
     QString translateDirPath;
@@ -116,6 +119,8 @@ public:
     QString getThumbnailDirPath();
     QString getThumbnailDirPath(QString relativePath);
     QString getThumbnailDirPathSpecialChar(QString relativePath);
+    QString getIconCacheDirPath();
+    QString getIconCacheDirPath(QString relativePath);
     QDir getImageDirFile(QString relativePath);
     QString getImageDirPath(QString relativePath);
     QDir getJavaDirFile(QString relativePath);
@@ -130,6 +135,8 @@ public:
     //QDir getXMLDirFile(QString relativePath);
     QString getTranslateFilePath(QString relativePath);
     void purgeResDirectory(bool exitOnFail);
+    bool shareDbaFile(QString source, QString target);     // Share a resource file's data with a new name
+    void unshareDbaFile(QString path);                     // Stop sharing a resource file before it is changed
 
 
 signals:
@@ -40,6 +40,7 @@ StartupConfig::StartupConfig()
     this->startupNoteLid = 0;
     this->forceSystemTrayAvailable=false;
     this->disableEditing = false;
+    this->profileStartup = false;
     this->accountId=-1;
     command = new QBitArray(STARTUP_OPTION_COUNT);
     command->fill(false);
@@ -71,6 +72,7 @@ void StartupConfig::printHelp() {
                    +QString("          --disableEditing             Disable note editing\n")
                    +QString("          --enableIndexing             Enable background Indexing (can cause problems)\n")
                    +QString("          --openNote=<lid>             Open a specific note on startup\n")
+                   +QString("          --profile-startup            Print the time taken by each startup phase.\n")
                    +QString("          --forceSystemTrayAvailable   Force the program to accept that\n")
                    +QString("                                       the desktop supports tray icons.\n")
                    +QString("          --startMinimized             Force a startup with NixNote minimized\n")
@@ -453,6 +455,9 @@ int StartupConfig::init(int argc, char *argv[], bool &guiAvailable) {
             if (parm == "--forceSystemTrayAvailable") {
                 forceSystemTrayAvailable = true;
             }
+            if (parm == "--profile-startup") {
+                profileStartup = true;
+            }
         }
         if (command->at(STARTUP_DELETENOTE)) {
             if (parm == "--noVerify") {
@@ -78,6 +78,7 @@ public:
     bool enableIndexing;
     bool forceSystemTrayAvailable;
     bool disableEditing;
+    bool profileStartup;
     bool purgeTemporaryFiles;
     AddNote *newNote;
     SignalGui *signalGui;
@@ -53,10 +53,9 @@ DatabaseConnection::DatabaseConnection(QString connection)
     dataStore = new DataStore(this);
 
     NSqlQuery tempTable(this);
-//    tempTable.exec("pragma cache_size=8096");
-//    tempTable.exec("pragma page_size=8096");
     tempTable.exec("pragma busy_timeout=50000");
     tempTable.exec("pragma journal_mode=wal");
+    applyStorageProfile();
 
 //    tempTable.exec("pragma SQLITE_THREADSAFE=2");
     if (connection == "nixnote") {
@@ -75,25 +74,78 @@ DatabaseConnection::DatabaseConnection(QString connection)
         }
         global.setDatabaseVersion(2);
 
+        // Make sure the search index is using the best format available
+        DatabaseUpgrade searchUpgrade;
+        searchUpgrade.upgradeSearchIndex();
+
         // Get username to use for default notes.  This needs to be done after
         // the database is started because we set it by default to the usertable
         // username.
         global.full_username = global.getUsername();
 
+        // Search results used to be kept in shared tables.  They are
+        // temporary now, so the old ones are just taking up space.
+        tempTable.exec("drop table if exists main.filter");
+        tempTable.exec("drop table if exists main.anylidsfilter");
+        tempTable.exec("drop table if exists main.anylidsfilterRes");
     }
 
     QLOG_TRACE() << "Creating filter table";
-    tempTable.exec("Create table if not exists filter (lid integer)");
-    tempTable.exec("delete from filter");
-    QLOG_TRACE() << "Adding to filter table";
-    tempTable.exec("insert into filter select distinct lid from NoteTable;");
-    QLOG_TRACE() << "Addition complete";
+    // The filter table is temporary so each connection has its own
+    // results and searching never writes to the database file.  The
+    // contents are built by FilterEngine when a selection is made.
+    tempTable.exec("Create temporary table if not exists filter (lid integer)");
     tempTable.finish();
 
 
 }
 
 
+// Tune the connection for the kind of work it does.  The GUI gets the
+// biggest page cache since it does most of the reading.  Synchronous
+// NORMAL is safe with WAL; at worst the last commit is lost on a power
+// failure.  Temporary tables (like the filter) are kept in memory, and
+// the journal size limit keeps the WAL from staying huge after a
+// checkpoint.
+void DatabaseConnection::applyStorageProfile() {
+    QStringList pragmas = getStoragePragmas(global.getStorageProfile(getStorageRole()));
+    NSqlQuery sql(this);
+    for (int i=0; i<pragmas.size(); i++)
+        sql.exec(pragmas[i]);
+    sql.finish();
+    QLOG_DEBUG() << "Connection " << connection << " using " << getStorageRole() << " storage profile";
+}
+
+
+
+// The statements that apply a storage profile to a connection
+QStringList DatabaseConnection::getStoragePragmas(const StorageProfile &profile) {
+    QStringList pragmas;
+    pragmas.append("pragma cache_size=-" +QString::number(profile.cacheSize));
+    pragmas.append("pragma mmap_size=" +QString::number(qint64(profile.mmapSize)*1024*1024));
+    pragmas.append("pragma synchronous=" +profile.synchronous);
+    pragmas.append("pragma temp_store=memory");
+    pragmas.append("pragma journal_size_limit=" +QString::number(qint64(global.walTruncateSize)*1024*1024));
+    return pragmas;
+}
+
+
+
+// Which storage profile should this connection use?
+QString DatabaseConnection::getStorageRole() {
+    if (connection == "nixnote")
+        return "gui";
+    if (connection == "syncrunner")
+        return "sync";
+    if (connection == "indexrunner")
+        return "index";
+    if (connection == "counterrunner")
+        return "counter";
+    return "other";
+}
+
+
+
 // Destructor.  Close the database & delete the
 // memory used by the valiables.
 DatabaseConnection::~DatabaseConnection() {
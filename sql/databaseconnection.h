@@ -58,10 +58,13 @@ public:
     void lockForWrite();
     void unlock();
     QString getConnectionName();
+    QString getStorageRole();       // Which storage profile this connection uses
+    static QStringList getStoragePragmas(const StorageProfile &profile);   // Statements that apply a profile
 
 private:
     LockMethod dbLocked;
     QString connection;
+    void applyStorageProfile();     // Set the cache, mmap & sync pragmas
 };
 
 #endif // DATABASECONNECTION_H
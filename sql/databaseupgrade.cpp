@@ -8,7 +8,9 @@
 #include "sql/linkednotebooktable.h"
 #include "sql/sharednotebooktable.h"
 #include "sql/nsqlquery.h"
+#include "sql/datastore.h"
 #include "global.h"
+#include <QElapsedTimer>
 
 
 DatabaseUpgrade::DatabaseUpgrade(QObject *parent) :
@@ -81,3 +83,74 @@ void DatabaseUpgrade::fixSql(bool toQt5) {
         trueQuery.exec();
     }
 }
+
+
+
+// Get the database size in bytes, not counting free pages.
+static qint64 databaseSize() {
+    NSqlQuery sql(global.db);
+    qint64 pages = 0, freePages = 0, pageSize = 0;
+    if (sql.exec("pragma page_count") && sql.next())
+        pages = sql.value(0).toLongLong();
+    if (sql.exec("pragma freelist_count") && sql.next())
+        freePages = sql.value(0).toLongLong();
+    if (sql.exec("pragma page_size") && sql.next())
+        pageSize = sql.value(0).toLongLong();
+    sql.finish();
+    return (pages-freePages)*pageSize;
+}
+
+
+
+// Move the search index to FTS5 if this SQLite supports it, or rebuild
+// it if the user changed the tokenizer option.  The existing index rows
+// are copied, so nothing needs to be reindexed.
+void DatabaseUpgrade::upgradeSearchIndex() {
+    DataStore *dataStore = global.db->dataStore;
+    NSqlQuery sql(global.db);
+    sql.exec("select sql from sqlite_master where type='table' and name='SearchIndex'");
+    QString current = "";
+    if (sql.next())
+        current = sql.value(0).toString();
+    sql.finish();
+
+    if (!dataStore->fts5Available()) {
+        QLOG_DEBUG() << "FTS5 is not available.  Using FTS4 search index.";
+        global.searchIndexFts5 = false;
+        return;
+    }
+    bool trigram = dataStore->searchIndexTrigram();
+    if (current.contains("fts5", Qt::CaseInsensitive) &&
+            current.contains("trigram", Qt::CaseInsensitive) == trigram) {
+        global.searchIndexFts5 = true;
+        global.searchIndexTrigram = trigram;
+        return;
+    }
+
+    QLOG_INFO() << "Rebuilding search index.  This may take a while.";
+    QElapsedTimer timer;
+    timer.start();
+    qint64 sizeBefore = databaseSize();
+
+    sql.exec("begin");
+    bool ok = sql.exec("drop table if exists SearchIndexOld") &&
+            sql.exec("alter table SearchIndex rename to SearchIndexOld") &&
+            dataStore->createSearchIndex("SearchIndex") &&
+            sql.exec("insert into SearchIndex (lid, weight, source, content) select lid, weight, source, content from SearchIndexOld") &&
+            sql.exec("drop table SearchIndexOld");
+    if (!ok) {
+        QLOG_ERROR() << "Search index rebuild failed: " << sql.lastError();
+        sql.exec("rollback");
+        sql.finish();
+        global.searchIndexFts5 = current.contains("fts5", Qt::CaseInsensitive);
+        global.searchIndexTrigram = current.contains("trigram", Qt::CaseInsensitive);
+        return;
+    }
+    sql.exec("commit");
+    sql.exec("insert into SearchIndex (SearchIndex) values ('optimize')");
+    sql.finish();
+    global.searchIndexFts5 = true;
+    global.searchIndexTrigram = trigram;
+    QLOG_INFO() << "Search index rebuilt in " << timer.elapsed() << " ms.  Database size before: "
+                << sizeBefore << " bytes, after: " << databaseSize() << " bytes.";
+}
@@ -9,6 +9,7 @@ class DatabaseUpgrade : public QObject
 public:
     explicit DatabaseUpgrade(QObject *parent = 0);
     void fixSql(bool toQt5=true);
+    void upgradeSearchIndex();
 
 signals:
 
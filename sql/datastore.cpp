@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "searchtable.h"
 #include "tagtable.h"
 #include "notebooktable.h"
+#include "resourcetable.h"
 #include "global.h"
 #include "sql/nsqlquery.h"
 
@@ -47,6 +48,21 @@ DataStore::DataStore(DatabaseConnection *db)
       db->unlock();
       this->createTable();
   }
+  sql.exec("Select * from sqlite_master where type='table' and name='ResourceHashIndex';");
+  if (!sql.next()) {
+      db->unlock();
+      this->createResourceHashIndex();
+  }
+  sql.exec("Select * from sqlite_master where type='table' and name='PdfTextCache';");
+  if (!sql.next()) {
+      db->unlock();
+      this->createPdfTextCache();
+  }
+  sql.exec("Select * from sqlite_master where type='table' and name='NoteVersionCache' and sql like '%lastUsed%';");
+  if (!sql.next()) {
+      db->unlock();
+      this->createNoteVersionCache();
+  }
   this->setTable("DataStore");
   this->select();
   this->setEditStrategy(QSqlTableModel::OnFieldChange);
@@ -88,11 +104,9 @@ void DataStore::createTable() {
         QLOG_ERROR() << "Creation of NotebookModel table failed: " << sql.lastError();
     }
 
-    if (!sql.exec("Create virtual table SearchIndex using fts4 (lid int, weight int, source text, content text)")) {
-        QLOG_ERROR() << "Creation of SearchIndex table failed: " << sql.lastError();
-    }
     sql.finish();
     db->unlock();
+    createSearchIndex("SearchIndex");
     Notebook notebook;
     NotebookTable table(db);
     notebook.name = "My Notebook";
@@ -102,3 +116,111 @@ void DataStore::createTable() {
     table.add(0,notebook,true,false);
 }
 
+
+
+//* Check if the SQLite library can build an FTS5 table with the given options.
+//* FTS5 (and the trigram tokenizer) depend upon how SQLite was compiled.
+bool DataStore::fts5Available(QString options) {
+    NSqlQuery sql(db);
+    sql.exec("drop table if exists temp.Fts5Check");
+    bool retval = sql.exec("create virtual table temp.Fts5Check using fts5 (content" + options + ")");
+    sql.exec("drop table if exists temp.Fts5Check");
+    sql.finish();
+    return retval;
+}
+
+
+
+//* The trigram tokenizer is only used if the user asked for it & this SQLite has it.
+bool DataStore::searchIndexTrigram() {
+    return global.getSearchIndexTrigram() && fts5Available(", tokenize='trigram'");
+}
+
+
+
+//* Create the search index table.  FTS5 is used if possible since it supports
+//* prefix indexes & bm25 ranking.  Only the content column is indexed.  The
+//* trigram tokenizer indexes every 3 character sequence, so it can also answer
+//* "like '%word%'" searches from the index.  Otherwise prefix indexes are built
+//* for short prefixes since every search term is a prefix search.
+bool DataStore::createSearchIndex(QString table) {
+    db->lockForWrite();
+    NSqlQuery sql(db);
+    QString command;
+    if (fts5Available()) {
+        command = "Create virtual table " +table +" using fts5 (lid unindexed, weight unindexed, source unindexed, content";
+        if (searchIndexTrigram())
+            command = command + ", tokenize='trigram')";
+        else
+            command = command + ", prefix='2 3', tokenize='unicode61')";
+    } else
+        command = "Create virtual table " +table +" using fts4 (lid int, weight int, source text, content text)";
+    bool retval = sql.exec(command);
+    if (!retval) {
+        QLOG_ERROR() << "Creation of " << table << " table failed: " << sql.lastError();
+    }
+    sql.finish();
+    db->unlock();
+    return retval;
+}
+
+
+
+//* Create the PDF text cache.  It holds the text & word locations of each
+//* page of a PDF so they only need to be pulled out of the file once.  The
+//* data hash tells us when the PDF has changed & the text must be rebuilt.
+void DataStore::createPdfTextCache() {
+    db->lockForWrite();
+    QLOG_DEBUG() << "Creating table PdfTextCache";
+    NSqlQuery sql(db);
+    if (!sql.exec("Create table if not exists PdfTextCache (resourceLid integer, hash text, page integer, content text, words blob, primary key (resourceLid, page))")) {
+        QLOG_ERROR() << "Creation of PdfTextCache table failed: " << sql.lastError();
+    }
+    sql.finish();
+    db->unlock();
+}
+
+
+
+//* Create the note history cache.  NoteVersionList holds the versions
+//* Evernote has of a note, as of the note's update sequence number.
+//* NoteVersionCache holds the versions we have downloaded, with their
+//* size & when they were last used so the cache can be kept to a limit.
+//* A cache from before the size was kept is simply dropped.
+void DataStore::createNoteVersionCache() {
+    db->lockForWrite();
+    QLOG_DEBUG() << "Creating table NoteVersionCache";
+    NSqlQuery sql(db);
+    if (!sql.exec("Create table if not exists NoteVersionList (noteGuid text, noteUsn integer, usn integer, updated integer, saved integer, title text, primary key (noteGuid, usn))") ||
+            !sql.exec("Drop table if exists NoteVersionCache") ||
+            !sql.exec("Create table NoteVersionCache (noteGuid text, usn integer, data blob, size integer, lastUsed integer, primary key (noteGuid, usn))")) {
+        QLOG_ERROR() << "Creation of NoteVersionCache table failed: " << sql.lastError();
+    }
+    sql.finish();
+    db->unlock();
+}
+
+
+
+//* Create the resource hash index.  This maps a note & resource data hash
+//* to the resource lid so <en-media> tags can be resolved without scanning
+//* the DataStore.  If the database already has resources we build it from
+//* the existing rows.
+void DataStore::createResourceHashIndex() {
+    db->lockForWrite();
+    QLOG_DEBUG() << "Creating table ResourceHashIndex";
+    NSqlQuery sql(db);
+    if (!sql.exec("Create table if not exists ResourceHashIndex (resourceLid integer primary key, noteLid integer, hash text)") ||
+            !sql.exec("CREATE INDEX if not exists ResourceHashIndex_Note_Hash on ResourceHashIndex (noteLid, hash)")) {
+        QLOG_ERROR() << "Creation of ResourceHashIndex table failed: " << sql.lastError();
+    }
+
+    sql.prepare("Insert or replace into ResourceHashIndex (resourceLid, noteLid, hash) select h.lid, n.data, lower(h.data) from DataStore h, DataStore n where h.key=:hashKey and n.lid=h.lid and n.key=:noteKey");
+    sql.bindValue(":hashKey", RESOURCE_DATA_HASH);
+    sql.bindValue(":noteKey", RESOURCE_NOTE_LID);
+    if (!sql.exec()) {
+        QLOG_ERROR() << "Population of ResourceHashIndex table failed: " << sql.lastError();
+    }
+    sql.finish();
+    db->unlock();
+}
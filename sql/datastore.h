@@ -45,10 +45,16 @@ class DataStore : public QSqlTableModel
     Q_OBJECT
 private:
     void createTable();
+    void createResourceHashIndex();
+    void createPdfTextCache();
+    void createNoteVersionCache();
     DatabaseConnection *db;
 
 public:
     explicit DataStore(DatabaseConnection *db);
+    bool fts5Available(QString options="");      // Can SQLite create an FTS5 table with these options?
+    bool searchIndexTrigram();                   // Will a new search index use the trigram tokenizer?
+    bool createSearchIndex(QString table);       // Create the full text search table
 
 signals:
 
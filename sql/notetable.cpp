@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "linkednotebooktable.h"
 #include "sql/nsqlquery.h"
 #include "tagtable.h"
+#include "noteversiontable.h"
 #include "global.h"
 #include "utilities/noteindexer.h"
 
@@ -43,7 +44,7 @@ NoteTable::NoteTable(DatabaseConnection *db)
 
 // Given a note's lid, we give it a new guid.  This can happen
 // the first time a record is synchronized
-void NoteTable::updateGuid(qint32 lid, Guid &guid) {
+bool NoteTable::updateGuid(qint32 lid, Guid &guid) {
     QLOG_TRACE() << "Entering NoteTable::updateNoteGuid()";
 
     NSqlQuery query(db);
@@ -52,10 +53,11 @@ void NoteTable::updateGuid(qint32 lid, Guid &guid) {
     query.bindValue(":data", guid);
     query.bindValue(":lid", lid);
     query.bindValue(":key", NOTE_GUID);
-    query.exec();
+    bool rc = query.exec();
     db->unlock();
 
     QLOG_TRACE() << "Leaving NoteTable::updateNoteGuid()";
+    return rc;
 }
 
 
@@ -747,7 +749,7 @@ bool NoteTable::updateNotebookName(qint32 lid, QString name) {
 
 
 // Return a note structure given the LID
-bool NoteTable::get(Note &note, qint32 lid,bool loadResources, bool loadBinary) {
+bool NoteTable::get(Note &note, qint32 lid,bool loadResources, bool loadBinary, bool changedBinaryOnly) {
 
     NSqlQuery query(db);
     db->lockForRead();
@@ -885,7 +887,7 @@ bool NoteTable::get(Note &note, qint32 lid,bool loadResources, bool loadBinary)
     QLOG_TRACE() << "Fetching Resources? " << loadResources << " With binary? " << loadBinary;
 
     QList<Resource> resources;
-    resTable.getAllResources(resources, lid, loadResources, loadBinary);
+    resTable.getAllResources(resources, lid, loadResources, loadBinary, changedBinaryOnly);
     note.resources = resources;
         QLOG_TRACE() << "Fetched resources";
 
@@ -1447,13 +1449,14 @@ QString NoteTable::getNoteListTags(qint32 lid) {
 }
 
 
-void NoteTable::setDirty(qint32 lid, bool dirty, bool setDateUpdated) {
+bool NoteTable::setDirty(qint32 lid, bool dirty, bool setDateUpdated) {
     if (lid <=0)
-        return;
+        return false;
     qint64 dt = QDateTime::currentMSecsSinceEpoch();
 
     db->lockForWrite();
     NSqlQuery query(db);
+    bool rc = true;
 
     // If it is setting it as dirty, we need to update the
     // update date &  time.
@@ -1461,18 +1464,18 @@ void NoteTable::setDirty(qint32 lid, bool dirty, bool setDateUpdated) {
         query.prepare("Delete from DataStore where lid=:lid and key=:key");
         query.bindValue(":lid", lid);
         query.bindValue(":key", NOTE_UPDATED_DATE);
-        query.exec();
+        rc = query.exec() && rc;
 
         query.prepare("Insert into DataStore (lid, key, data) values (:lid, :key, :value)");
         query.bindValue(":lid", lid);
         query.bindValue(":key", NOTE_UPDATED_DATE);
         query.bindValue(":value", dt);
-        query.exec();
+        rc = query.exec() && rc;
 
         query.prepare("Update NoteTable set dateUpdated=:value where lid=:lid");
         query.bindValue(":lid", lid);
         query.bindValue(":value", dt);
-        query.exec();
+        rc = query.exec() && rc;
     }
 
     // If it is already set to the value, then we don't
@@ -1480,7 +1483,7 @@ void NoteTable::setDirty(qint32 lid, bool dirty, bool setDateUpdated) {
     if (isDirty(lid) == dirty) {
         query.finish();
         db->unlock();
-        return;
+        return rc;
     }
 
     // If we got here, then the current dirty state doesn't match
@@ -1488,19 +1491,19 @@ void NoteTable::setDirty(qint32 lid, bool dirty, bool setDateUpdated) {
     query.prepare("Update NoteTable set isDirty=:isDirty where lid=:lid");
     query.bindValue(":isDirty", dirty);
     query.bindValue(":lid", lid);
-    query.exec();
+    rc = query.exec() && rc;
 
     query.prepare("Delete from DataStore where lid=:lid and key=:key");
     query.bindValue(":lid", lid);
     query.bindValue(":key", NOTE_ISDIRTY);
-    query.exec();
+    rc = query.exec() && rc;
 
     if (dirty) {
         query.prepare("Insert into DataStore (lid, key, data) values (:lid, :key, :data)");
         query.bindValue(":lid", lid);
         query.bindValue(":key", NOTE_ISDIRTY);
         query.bindValue(":data", dirty);
-        query.exec();
+        rc = query.exec() && rc;
         query.finish();
         db->unlock();
         setIndexNeeded(lid, true);
@@ -1508,6 +1511,7 @@ void NoteTable::setDirty(qint32 lid, bool dirty, bool setDateUpdated) {
         query.finish();
         db->unlock();
     }
+    return rc;
 }
 
 
@@ -1663,6 +1667,10 @@ void NoteTable::expunge(qint32 lid) {
     for (int i=0; i<resources.size(); i++) {
         resTable.expunge(resources[i].guid);
     }
+    if (note.guid.isSet()) {
+        NoteVersionTable versionTable(db);
+        versionTable.expunge(note.guid);
+    }
 
     NSqlQuery query(db);
     db->lockForWrite();
@@ -1690,6 +1698,335 @@ void NoteTable::expunge(QString guid) {
 
 
 
+//*********************************************************************
+//* Bulk changes.  These work on a whole set of notes with a handful
+//* of set-based statements inside one savepoint, rather than a few
+//* statements for every note.  The lids are loaded into a temporary
+//* table so the statements can join against them.
+//*********************************************************************
+
+// Load the notes we are about to change.  This must be called inside
+// the caller's savepoint.
+void NoteTable::loadBulkLids(const QList<qint32> &lids) {
+    NSqlQuery query(db);
+    query.exec("create temporary table if not exists bulkNoteLids (lid integer primary key)");
+    query.exec("delete from bulkNoteLids");
+    query.prepare("insert or ignore into bulkNoteLids (lid) values (:lid)");
+    for (int i=0; i<lids.size(); i++) {
+        if (lids[i] <= 0)
+            continue;
+        query.bindValue(":lid", lids[i]);
+        query.exec();
+    }
+    query.finish();
+}
+
+
+
+// Mark every note in the bulk set as dirty.  Notes which weren't
+// already dirty are flagged for reindexing.  Unlike setDirty() they
+// aren't indexed right away; their content hasn't changed.
+void NoteTable::setBulkDirty() {
+    NSqlQuery query(db);
+    query.prepare("insert into DataStore (lid, key, data) select lid, :indexKey, 1 from bulkNoteLids where lid not in (select lid from DataStore where key=:dirtyKey and data=1) and lid not in (select lid from DataStore where key=:indexKey2)");
+    query.bindValue(":indexKey", NOTE_INDEX_NEEDED);
+    query.bindValue(":dirtyKey", NOTE_ISDIRTY);
+    query.bindValue(":indexKey2", NOTE_INDEX_NEEDED);
+    query.exec();
+
+    query.exec("update NoteTable set isDirty=1 where lid in (select lid from bulkNoteLids)");
+
+    query.prepare("delete from DataStore where key=:key and lid in (select lid from bulkNoteLids)");
+    query.bindValue(":key", NOTE_ISDIRTY);
+    query.exec();
+
+    query.prepare("insert into DataStore (lid, key, data) select lid, :key, 1 from bulkNoteLids");
+    query.bindValue(":key", NOTE_ISDIRTY);
+    query.exec();
+    query.finish();
+}
+
+
+
+// Rebuild the tag names shown in the note list for the bulk set.
+void NoteTable::rebuildBulkNoteListTags() {
+    QHash<qint32, QStringList> tagNames;
+    NSqlQuery query(db);
+    query.exec("select lid from bulkNoteLids");
+    while (query.next())
+        tagNames.insert(query.value(0).toInt(), QStringList());
+
+    query.prepare("select n.lid, t.data from DataStore n join DataStore t on t.lid=n.data and t.key=:nameKey where n.key=:tagKey and n.lid in (select lid from bulkNoteLids)");
+    query.bindValue(":nameKey", TAG_NAME);
+    query.bindValue(":tagKey", NOTE_TAG_LID);
+    query.exec();
+    while (query.next())
+        tagNames[query.value(0).toInt()].append(query.value(1).toString());
+
+    query.prepare("update NoteTable set tags=:tags where lid=:lid");
+    QHash<qint32, QStringList>::iterator i;
+    for (i=tagNames.begin(); i!=tagNames.end(); ++i) {
+        qSort(i.value().begin(), i.value().end(), caseInsensitiveLessThan);
+        query.bindValue(":tags", i.value().join(", "));
+        query.bindValue(":lid", i.key());
+        query.exec();
+    }
+    query.finish();
+}
+
+
+
+// Mark a set of notes as deleted
+void NoteTable::deleteMany(const QList<qint32> &lids, bool isDirty) {
+    if (lids.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint deleteNotes");
+    loadBulkLids(lids);
+
+    query.prepare("delete from DataStore where key in (:activeKey, :deletedKey) and lid in (select lid from bulkNoteLids)");
+    query.bindValue(":activeKey", NOTE_ACTIVE);
+    query.bindValue(":deletedKey", NOTE_DELETED_DATE);
+    query.exec();
+
+    query.prepare("insert into DataStore (lid, key, data) select lid, :key, 0 from bulkNoteLids");
+    query.bindValue(":key", NOTE_ACTIVE);
+    query.exec();
+
+    query.exec("update NoteTable set dateDeleted=strftime('%s','now') where lid in (select lid from bulkNoteLids)");
+
+    if (isDirty) {
+        query.prepare("delete from DataStore where key=:key and lid in (select lid from bulkNoteLids)");
+        query.bindValue(":key", NOTE_ISDIRTY);
+        query.exec();
+        query.prepare("insert into DataStore (lid, key, data) select lid, :key, 1 from bulkNoteLids");
+        query.bindValue(":key", NOTE_ISDIRTY);
+        query.exec();
+    }
+    query.exec("release deleteNotes");
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Take a set of notes out of the trash
+void NoteTable::restoreMany(const QList<qint32> &lids, bool isDirty) {
+    if (lids.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint restoreNotes");
+    loadBulkLids(lids);
+
+    query.prepare("delete from DataStore where key in (:activeKey, :deletedKey) and lid in (select lid from bulkNoteLids)");
+    query.bindValue(":activeKey", NOTE_ACTIVE);
+    query.bindValue(":deletedKey", NOTE_DELETED_DATE);
+    query.exec();
+
+    query.prepare("insert into DataStore (lid, key, data) select lid, :key, 1 from bulkNoteLids");
+    query.bindValue(":key", NOTE_ACTIVE);
+    query.exec();
+
+    query.exec("update NoteTable set dateDeleted=0 where lid in (select lid from bulkNoteLids)");
+
+    if (isDirty) {
+        query.prepare("delete from DataStore where key=:key and lid in (select lid from bulkNoteLids)");
+        query.bindValue(":key", NOTE_ISDIRTY);
+        query.exec();
+        query.prepare("insert into DataStore (lid, key, data) select lid, :key, 1 from bulkNoteLids");
+        query.bindValue(":key", NOTE_ISDIRTY);
+        query.exec();
+    }
+    query.exec("release restoreNotes");
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Permanently delete a set of notes along with their resources.  If
+// queueSyncedDeletes is set, notes Evernote knows about are added to
+// the delete queue so the next sync removes them there too.
+void NoteTable::expungeMany(const QList<qint32> &lids, bool queueSyncedDeletes) {
+    if (lids.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint expungeNotes");
+    loadBulkLids(lids);
+
+    QList<qint32> queueLids;
+    QStringList queueGuids;
+    QStringList queueNotebooks;
+    if (queueSyncedDeletes) {
+        query.prepare("select g.lid, g.data, b.data from DataStore g "
+                      "join DataStore u on u.lid=g.lid and u.key=:usnKey and u.data>0 "
+                      "join DataStore nb on nb.lid=g.lid and nb.key=:notebookKey "
+                      "left join DataStore b on b.lid=nb.data and b.key=:notebookGuidKey "
+                      "where g.key=:guidKey and g.lid in (select lid from bulkNoteLids)");
+        query.bindValue(":usnKey", NOTE_UPDATE_SEQUENCE_NUMBER);
+        query.bindValue(":notebookKey", NOTE_NOTEBOOK_LID);
+        query.bindValue(":notebookGuidKey", NOTEBOOK_GUID);
+        query.bindValue(":guidKey", NOTE_GUID);
+        query.exec();
+        while (query.next()) {
+            queueLids.append(query.value(0).toInt());
+            queueGuids.append(query.value(1).toString());
+            queueNotebooks.append(query.value(2).toString());
+        }
+    }
+
+    QList<qint32> resourceLids;
+    query.prepare("select lid from DataStore where key=:key and data in (select lid from bulkNoteLids)");
+    query.bindValue(":key", RESOURCE_NOTE_LID);
+    query.exec();
+    while (query.next())
+        resourceLids.append(query.value(0).toInt());
+    ResourceTable resTable(db);
+    resTable.expungeMany(resourceLids);
+
+    // Forget their history, the same as expunge(lid) does
+    QStringList noteGuids;
+    query.prepare("select data from DataStore where key=:key and lid in (select lid from bulkNoteLids)");
+    query.bindValue(":key", NOTE_GUID);
+    query.exec();
+    while (query.next())
+        noteGuids.append(query.value(0).toString());
+    NoteVersionTable versionTable(db);
+    versionTable.expungeMany(noteGuids);
+
+    query.exec("delete from DataStore where lid in (select lid from bulkNoteLids)");
+    query.exec("delete from NoteTable where lid in (select lid from bulkNoteLids)");
+
+    query.prepare("insert into DataStore (lid, key, data) values (:lid, :key, :data)");
+    for (int i=0; i<queueLids.size(); i++) {
+        query.bindValue(":lid", queueLids[i]);
+        query.bindValue(":key", NOTE_DELETE_PENDING_GUID);
+        query.bindValue(":data", queueGuids[i]);
+        query.exec();
+        query.bindValue(":lid", queueLids[i]);
+        query.bindValue(":key", NOTE_DELETE_PENDING_NOTEBOOK);
+        query.bindValue(":data", queueNotebooks[i]);
+        query.exec();
+    }
+    query.exec("release expungeNotes");
+    query.finish();
+    db->unlock();
+
+    // Get rid of the thumbnails
+    ResourceTable::removeFilesLater(global.fileManager.getThumbnailDirPath(), lids);
+}
+
+
+
+// Move a set of notes to a notebook.  Notes already in that notebook
+// are left alone.
+void NoteTable::moveToNotebook(const QList<qint32> &lids, qint32 notebookLid, bool setAsDirty) {
+    if (lids.size() == 0)
+        return;
+
+    Notebook book;
+    NotebookTable notebookTable(db);
+    notebookTable.get(book, notebookLid);
+    if (!book.guid.isSet())
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint moveNotes");
+    loadBulkLids(lids);
+
+    query.prepare("delete from bulkNoteLids where lid in (select lid from DataStore where key=:key and data=:notebookLid)");
+    query.bindValue(":key", NOTE_NOTEBOOK_LID);
+    query.bindValue(":notebookLid", notebookLid);
+    query.exec();
+
+    query.prepare("update DataStore set data=:notebookLid where key=:key and lid in (select lid from bulkNoteLids)");
+    query.bindValue(":notebookLid", notebookLid);
+    query.bindValue(":key", NOTE_NOTEBOOK_LID);
+    query.exec();
+
+    QString bookName = book.name;
+    query.prepare("update NoteTable set notebook=:name, notebookLid=:notebookLid where lid in (select lid from bulkNoteLids)");
+    query.bindValue(":name", bookName);
+    query.bindValue(":notebookLid", notebookLid);
+    query.exec();
+
+    if (setAsDirty)
+        setBulkDirty();
+    query.exec("release moveNotes");
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Add a tag to a set of notes.  Notes that already have it are left
+// alone.
+void NoteTable::addTag(const QList<qint32> &lids, qint32 tag, bool isDirty) {
+    if (lids.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint addTag");
+    loadBulkLids(lids);
+
+    query.prepare("delete from bulkNoteLids where lid in (select lid from DataStore where key=:key and data=:tag)");
+    query.bindValue(":key", NOTE_TAG_LID);
+    query.bindValue(":tag", tag);
+    query.exec();
+
+    query.prepare("insert into DataStore (lid, key, data) select lid, :key, :tag from bulkNoteLids");
+    query.bindValue(":key", NOTE_TAG_LID);
+    query.bindValue(":tag", tag);
+    query.exec();
+
+    if (isDirty)
+        setBulkDirty();
+    rebuildBulkNoteListTags();
+    query.exec("release addTag");
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Remove a tag from a set of notes.
+void NoteTable::removeTag(const QList<qint32> &lids, qint32 tag, bool isDirty) {
+    if (lids.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint removeTag");
+    loadBulkLids(lids);
+
+    query.prepare("delete from bulkNoteLids where lid not in (select lid from DataStore where key=:key and data=:tag)");
+    query.bindValue(":key", NOTE_TAG_LID);
+    query.bindValue(":tag", tag);
+    query.exec();
+
+    query.prepare("delete from DataStore where key=:key and data=:tag and lid in (select lid from bulkNoteLids)");
+    query.bindValue(":key", NOTE_TAG_LID);
+    query.bindValue(":tag", tag);
+    query.exec();
+
+    if (isDirty)
+        setBulkDirty();
+    rebuildBulkNoteListTags();
+    query.exec("release removeTag");
+    query.finish();
+    db->unlock();
+}
+
+
+
 // Add to the deletion queue
 void NoteTable::addToDeleteQueue(qint32 lid, Note n) {
     get(n,lid,true,true);
@@ -1997,57 +2334,25 @@ qint32 NoteTable::duplicateNote(qint32 oldLid, bool keepCreatedDate) {
     updateNoteList(newLid, n, true, notebookLid);
 
     setDirty(newLid, true);
-    setIndexNeeded(newLid, true);
 
     if (!keepCreatedDate) {
         qint64 dt = QDateTime::currentMSecsSinceEpoch();
         this->updateDate(newLid, dt, NOTE_CREATED_DATE, true);
     }
 
+    // Copy the search index rather than indexing the same text again
+    query.prepare("insert into SearchIndex (lid, weight, source, content) select :newLid, weight, source, content from SearchIndex where lid=:oldLid");
+    query.bindValue(":newLid", newLid);
+    query.bindValue(":oldLid", oldLid);
+    query.exec();
+
     // Update all the resources
     ResourceTable resTable(db);
     QList<qint32> lids;
     resTable.getResourceList(lids, oldLid);
-    for (int i=0; i<lids.size(); i++) {
-        qint32 newResLid = cs.incrementLidCounter();
-
-        query.prepare("insert into datastore (lid, key,data) select :newLid, key, data from datastore where lid=:oldLid");
-        query.bindValue(":newLid", newResLid);
-        query.bindValue(":oldLid", lids[i]);
-        query.exec();
-
-        query.prepare("update datastore set data=:data where lid=:lid and key=:key");
-        query.bindValue(":data", QString::number(newResLid));
-        query.bindValue(":lid", newResLid);
-        query.bindValue(":key", RESOURCE_GUID);
-        query.exec();
-
-        query.prepare("update datastore set data=:data where lid=:lid and key=:key");
-        query.bindValue(":data", 0);
-        query.bindValue(":lid", newResLid);
-        query.bindValue(":key", RESOURCE_UPDATE_SEQUENCE_NUMBER);
-        query.exec();
+    for (int i=0; i<lids.size(); i++)
+        resTable.duplicateResource(lids[i], newLid);
 
-        query.prepare("update datastore set data=:data where lid=:lid and key=:key");
-        query.bindValue(":data", newLid);
-        query.bindValue(":lid", newResLid);
-        query.bindValue(":key", RESOURCE_NOTE_LID);
-        query.exec();
-
-        QStringList filter;
-        QDir resDir(global.fileManager.getDbaDirPath());
-        filter << QString::number(lids[i])+".*";
-        QStringList files = resDir.entryList(filter);
-        for (int j=0; j<files.size(); j++) {
-            QFile file(global.fileManager.getDbaDirPath()+files[j]);
-            int pos = files[j].indexOf(".");
-            QString type = files[j].mid(pos);
-            file.open(QIODevice::ReadOnly);
-            file.copy(global.fileManager.getDbaDirPath()+
-                      QString::number(newResLid) +type);
-            file.close();
-        }
-    }
     query.finish();
     db->unlock();
     return newLid;
@@ -2076,6 +2381,50 @@ qint32 NoteTable::getAllDirty(QList<qint32> &lids) {
 
 
 
+// Sort every dirty note in the user's own notebooks by what the upload
+// has to do with it, using a single query rather than several per note.
+// Notes in linked notebooks are uploaded with their notebook & skipped here.
+void NoteTable::getDirtyPersonalNotes(QList<qint32> &updatedLids, QList<qint32> &deletedLids, QList<qint32> &movedLids) {
+    NSqlQuery query(db);
+    db->lockForRead();
+    updatedLids.clear();
+    deletedLids.clear();
+    movedLids.clear();
+    query.prepare("Select d.lid, active.data, usn.data, local.data, linked.lid from DataStore d "
+                  "left join DataStore notebook on notebook.lid=d.lid and notebook.key=:notebookKey "
+                  "left join DataStore active on active.lid=d.lid and active.key=:activeKey "
+                  "left join DataStore usn on usn.lid=d.lid and usn.key=:usnKey "
+                  "left join DataStore local on local.lid=notebook.data and local.key=:localKey "
+                  "left join DataStore linked on linked.lid=notebook.data and linked.key=:linkedKey "
+                  "where d.key=:key and d.data=1");
+    query.bindValue(":notebookKey", NOTE_NOTEBOOK_LID);
+    query.bindValue(":activeKey", NOTE_ACTIVE);
+    query.bindValue(":usnKey", NOTE_UPDATE_SEQUENCE_NUMBER);
+    query.bindValue(":localKey", NOTEBOOK_IS_LOCAL);
+    query.bindValue(":linkedKey", LINKEDNOTEBOOK_SHARE_NAME);
+    query.bindValue(":key", NOTE_ISDIRTY);
+    query.exec();
+    while (query.next()) {
+        qint32 lid = query.value(0).toInt();
+        if (!query.value(4).isNull())
+            continue;
+        if (query.value(3).toBool()) {
+            // A local note that was once synchronized was moved to a local
+            // notebook & now needs to be deleted on the remote end
+            if (query.value(2).toInt() > 0)
+                movedLids.append(lid);
+        } else if (!query.value(1).isNull() && !query.value(1).toBool()) {
+            deletedLids.append(lid);
+        } else {
+            updatedLids.append(lid);
+        }
+    }
+    query.finish();
+    db->unlock();
+}
+
+
+
 // Get all dirty lids
 qint32 NoteTable::getAllDirty(QList<qint32> &lids, qint32 linkedNotebookLid) {
     NSqlQuery query(db);
@@ -2120,17 +2469,36 @@ qint32 NoteTable::getNotebookLid(qint32 noteLid) {
 
 
 
+// Get the USN of a note.  Returns -1 if it isn't known.
+qint32 NoteTable::getUpdateSequenceNumber(qint32 lid) {
+    NSqlQuery query(db);
+    qint32 retval = -1;
+    db->lockForRead();
+    query.prepare("Select data from DataStore where key=:key and lid=:lid");
+    query.bindValue(":lid", lid);
+    query.bindValue(":key", NOTE_UPDATE_SEQUENCE_NUMBER);
+    query.exec();
+    if (query.next())
+        retval = query.value(0).toInt();
+    query.finish();
+    db->unlock();
+    return retval;
+}
+
+
+
 // Update the USN
-void NoteTable::setUpdateSequenceNumber(qint32 lid, qint32 usn) {
+bool NoteTable::setUpdateSequenceNumber(qint32 lid, qint32 usn) {
     NSqlQuery query(db);
     db->lockForWrite();
     query.prepare("Update DataStore set data=:data where key=:key and lid=:lid");
     query.bindValue(":data", usn);
     query.bindValue(":lid", lid);
     query.bindValue(":key", NOTE_UPDATE_SEQUENCE_NUMBER);
-    query.exec();
+    bool rc = query.exec();
     query.finish();
     db->unlock();
+    return rc;
 }
 
 
@@ -2262,7 +2630,7 @@ void NoteTable::setGeography(qint32 lid, double longitude, double latitude, doub
 
 
 void NoteTable::setThumbnailNeeded(qint32 lid, bool value) {
-    if (lid >=0)
+    if (lid <= 0)
         return;
 
     // If it is already set to this value, then we don't need to
@@ -2343,6 +2711,53 @@ qint32 NoteTable::getNextThumbnailNeeded() {
 
 
 
+// Get a batch of notes needing a thumbnail
+qint32 NoteTable::getNextThumbnailsNeeded(QList<qint32> &lids, qint32 limit) {
+    lids.clear();
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("select lid from datastore where data=1 and key=:key limit :limit;");
+    query.bindValue(":key", NOTE_THUMBNAIL_NEEDED);
+    query.bindValue(":limit", limit);
+    query.exec();
+    while (query.next()) {
+        lids.append(query.value(0).toInt());
+    }
+    query.finish();
+    db->unlock();
+    return lids.size();
+}
+
+
+
+// Given a list of notes, remove any that already have a current thumbnail.
+void NoteTable::filterThumbnailsNeeded(QList<qint32> &lids) {
+    if (lids.size() == 0)
+        return;
+    QStringList values;
+    for (int i=0; i<lids.size(); i++)
+        values.append(QString::number(lids[i]));
+    QList<qint32> needed;
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("select lid from datastore where data=1 and key=:key and lid in (" +values.join(",") +");");
+    query.bindValue(":key", NOTE_THUMBNAIL_NEEDED);
+    query.exec();
+    while (query.next()) {
+        needed.append(query.value(0).toInt());
+    }
+    query.finish();
+    db->unlock();
+
+    // Keep the original order
+    for (int i=lids.size()-1; i>=0; i--) {
+        if (!needed.contains(lids[i]))
+            lids.removeAt(i);
+    }
+}
+
+
+
 qint32 NoteTable::getThumbnailsNeededCount() {
     qint32 retval = 0;
     NSqlQuery query(db);
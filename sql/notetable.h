@@ -94,6 +94,9 @@ class NoteTable
 
 private:
     DatabaseConnection *db;
+    void loadBulkLids(const QList<qint32> &lids);                         // Load the lids for a bulk change
+    void setBulkDirty();                                                 // Mark the bulk lids dirty
+    void rebuildBulkNoteListTags();                                      // Update the bulk lids' tags in the display table
 
 public:
 
@@ -102,7 +105,7 @@ public:
     qint32 getLid(QString guid);                             // given a guid, return the lid
     qint32 getLid(string guid);                              // Given a guid, return the lid
     QString getGuid(int lid);                                // given a lid, get the guid
-    bool get(Note &note, qint32 lid, bool loadResources, bool loadBinary);           // Get a note given a lid
+    bool get(Note &note, qint32 lid, bool loadResources, bool loadBinary, bool changedBinaryOnly=false);   // Get a note given a lid
     bool get(Note &note, QString guid, bool loadResources, bool loadBinary);         // get a note given a guid
     bool get(Note &note, string guid,bool loadResources, bool loadBinary);           // get a note given a guid
     bool isDirty(qint32 lid);                                // Check if a note is dirty
@@ -127,6 +130,7 @@ public:
     qint32 getUnindexedCount();                              // count of unindexed notes
     qint32 getAllDeleted(QList<qint32> &lids);               // Get all deleted notes
     qint32 getAllDirty(QList<qint32> &lids);                 // get all dirty notes
+    void getDirtyPersonalNotes(QList<qint32> &updatedLids, QList<qint32> &deletedLids, QList<qint32> &movedLids);  // Classify dirty notes for upload
     qint32 getAllDirty(QList<qint32> &lids, qint32 notebookLid);  // Get all dirty for a particular (linked) notebook
     qint32 getNotebookLid(qint32 noteLid);                   // Get the notebook for a note
     bool isDeleted(qint32 lid);                              // Is this note deleted?
@@ -137,6 +141,8 @@ public:
     bool isThumbnailNeeded(string guid);                     // see if a thumbnail is needed
     bool isIndexNeeded(qint32 lid);                          // see if an index is needed
     qint32 getNextThumbnailNeeded();                         // get any note that needs a thumbnail
+    qint32 getNextThumbnailsNeeded(QList<qint32> &lids, qint32 limit);   // get a batch of notes that need a thumbnail
+    void filterThumbnailsNeeded(QList<qint32> &lids);        // Remove any notes that don't need a thumbnail
     void getAllReminders(QList< QPair<qint32, qlonglong>* > *reminders);  // Get all notes with un-completed reminders
     qint32 getThumbnailsNeededCount();                       // Get a count of all notes in need of a thumbnail
     void getAll(QList<qint32> &lids);                        // Get all note lids
@@ -157,14 +163,15 @@ public:
     void setThumbnailNeeded(string guid, bool value);                   // see if a thumbnail is needed
     void setThumbnail(qint32 lid, QString filename);                    // set the file containing the thumbnail
     qint32 duplicateNote(qint32 oldLid, bool keepCreatedDate=false);    // Duplicate an existing note
-    void setUpdateSequenceNumber(qint32 lid, qint32 usn);               // set the update sequence number
+    qint32 getUpdateSequenceNumber(qint32 lid);                         // get the update sequence number
+    bool setUpdateSequenceNumber(qint32 lid, qint32 usn);               // set the update sequence number
     void updateNoteContent(qint32 lid, QString content, bool isDirty=true);   // Update the content of a note
     void updateEnmediaHash(qint32 lid, QByteArray oldHash, QByteArray newHash, bool isDirty=true);      // Update the hash value for a resource in a notte
     bool updateNotebookGuid(QString oldGuid, QString newGuid, QString name);       // Update a notebook's name/guid
     bool updateNoteList(qint32 lid, const Note &t, bool isDirty, qint32 account);  // Update the user viewing list
     bool updateNotebookName(qint32 lid, QString name);                   // Update a notebook's name in the user listing
     void updateNotebook(qint32 noteLid, qint32 notebookLid);             // Set the current note's notebook
-    void setDirty(qint32 lid, bool dirty, bool setDateUpdated=true);     // Set if a note needs a sync
+    bool setDirty(qint32 lid, bool dirty, bool setDateUpdated=true);     // Set if a note needs a sync
     void updateNotebook(qint32 noteLid, qint32 notebookLid, bool setAsDirty=false);    // Update the notebook for a note
     void updateUrl(qint32 lid, QString text, bool dirty);                // Update a URL for a note
     void updateTitle(qint32 noteLid, QString title, bool setAsDirty);    // Update a title for a note
@@ -178,10 +185,16 @@ public:
     void expunge(qint32 lid);                                            // expunge a note permanently
     void expunge(QString guid);                                          // expunge a note permanently
     void expunge(string guid);                                           // expunge a note permanently
+    void deleteMany(const QList<qint32> &lids, bool isDirty=true);       // mark a set of notes for deletion
+    void restoreMany(const QList<qint32> &lids, bool isDirty=true);      // unmark a set of notes for deletion
+    void expungeMany(const QList<qint32> &lids, bool queueSyncedDeletes=false);  // expunge a set of notes permanently
+    void moveToNotebook(const QList<qint32> &lids, qint32 notebookLid, bool setAsDirty=true);  // Move a set of notes to a notebook
+    void addTag(const QList<qint32> &lids, qint32 tag, bool isDirty=true);     // Add a tag to a set of notes
+    void removeTag(const QList<qint32> &lids, qint32 tag, bool isDirty=true);  // Remove a tag from a set of notes
     void pinNote(string guid, bool value);                               // pin the current note
     void pinNote(QString guid, bool value);                              // pin the current note
     void pinNote(qint32 lid, bool value);                                // pin the current note
-    void updateGuid(qint32 lid, Guid &guid);                             // Update a note's guid
+    bool updateGuid(qint32 lid, Guid &guid);                             // Update a note's guid
     void sync(Note &note, qint32 account=0);                             // Sync a note with a new record
     void sync(qint32 lid, const Note &note, qint32 account=0);           // Sync a note with a new record
     qint32 add(qint32 lid, const Note &t, bool isDirty, qint32 account=0); // Add a new note
@@ -0,0 +1,231 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "noteversiontable.h"
+#include "sql/nsqlquery.h"
+#include "qevercloud/thrift.h"
+#include "qevercloud/generated/types_impl.h"
+#include "logger/qslog.h"
+
+NoteVersionTable::NoteVersionTable(DatabaseConnection *db)
+{
+    this->db = db;
+}
+
+
+
+// Get the versions of a note.  The list is only returned if it was
+// fetched when the note was at noteUsn, otherwise the note has changed
+// since and there may be newer versions.  A row with a usn of 0 marks
+// that the list was fetched, so an empty list can be cached too.
+bool NoteVersionTable::getVersions(QString guid, qint32 noteUsn, QList<NoteVersionId> &versions) {
+    versions.clear();
+    bool found = false;
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("Select noteUsn, usn, updated, saved, title from NoteVersionList where noteGuid=:guid order by usn desc");
+    query.bindValue(":guid", guid);
+    query.exec();
+    while (query.next()) {
+        if (noteUsn >= 0 && query.value(0).toInt() != noteUsn) {
+            versions.clear();
+            found = false;
+            break;
+        }
+        found = true;
+        if (query.value(1).toInt() <= 0)
+            continue;
+        NoteVersionId version;
+        version.updateSequenceNum = query.value(1).toInt();
+        version.updated = query.value(2).toLongLong();
+        version.saved = query.value(3).toLongLong();
+        version.title = query.value(4).toString();
+        versions.append(version);
+    }
+    query.finish();
+    db->unlock();
+    return found;
+}
+
+
+
+bool NoteVersionTable::getVersion(QString guid, qint32 usn, Note &note) {
+    QByteArray data;
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.prepare("Select data from NoteVersionCache where noteGuid=:guid and usn=:usn");
+    query.bindValue(":guid", guid);
+    query.bindValue(":usn", usn);
+    query.exec();
+    if (query.next())
+        data = query.value(0).toByteArray();
+    if (!data.isEmpty()) {
+        query.prepare("Update NoteVersionCache set lastUsed=(select max(lastUsed)+1 from NoteVersionCache) where noteGuid=:guid and usn=:usn");
+        query.bindValue(":guid", guid);
+        query.bindValue(":usn", usn);
+        query.exec();
+    }
+    query.finish();
+    db->unlock();
+    if (data.isEmpty())
+        return false;
+
+    try {
+        ThriftBinaryBufferReader reader(data);
+        readNote(reader, note);
+    } catch (EverCloudException &e) {
+        QLOG_ERROR() << "Unable to read cached version " << usn << " of note " << guid << ": " << e.what();
+        return false;
+    }
+    return true;
+}
+
+
+
+bool NoteVersionTable::hasVersion(QString guid, qint32 usn) {
+    bool found = false;
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("Select usn from NoteVersionCache where noteGuid=:guid and usn=:usn");
+    query.bindValue(":guid", guid);
+    query.bindValue(":usn", usn);
+    query.exec();
+    if (query.next())
+        found = true;
+    query.finish();
+    db->unlock();
+    return found;
+}
+
+
+
+void NoteVersionTable::saveVersions(QString guid, qint32 noteUsn, const QList<NoteVersionId> &versions) {
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint saveNoteVersions");
+    query.prepare("Delete from NoteVersionList where noteGuid=:guid");
+    query.bindValue(":guid", guid);
+    query.exec();
+    query.prepare("Insert into NoteVersionList (noteGuid, noteUsn, usn, updated, saved, title) values (:guid, :noteUsn, :usn, :updated, :saved, :title)");
+    query.bindValue(":guid", guid);
+    query.bindValue(":noteUsn", noteUsn);
+    query.bindValue(":usn", 0);
+    query.bindValue(":updated", 0);
+    query.bindValue(":saved", 0);
+    query.bindValue(":title", "");
+    query.exec();
+    for (int i=0; i<versions.size(); i++) {
+        query.bindValue(":guid", guid);
+        query.bindValue(":noteUsn", noteUsn);
+        query.bindValue(":usn", versions[i].updateSequenceNum);
+        query.bindValue(":updated", versions[i].updated);
+        query.bindValue(":saved", versions[i].saved);
+        query.bindValue(":title", versions[i].title);
+        query.exec();
+    }
+    query.exec("release saveNoteVersions");
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Save a downloaded version as the most recently used, then make
+// room for it.
+void NoteVersionTable::saveVersion(QString guid, qint32 usn, const Note &note) {
+    ThriftBinaryBufferWriter writer;
+    writeNote(writer, note);
+    QByteArray data = writer.buffer();
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.prepare("Insert or replace into NoteVersionCache (noteGuid, usn, data, size, lastUsed) values (:guid, :usn, :data, :size, (select coalesce(max(lastUsed),0)+1 from NoteVersionCache))");
+    query.bindValue(":guid", guid);
+    query.bindValue(":usn", usn);
+    query.bindValue(":data", data);
+    query.bindValue(":size", data.size());
+    query.exec();
+    query.finish();
+    db->unlock();
+    trim(NOTE_HISTORY_CACHE_SIZE);
+}
+
+
+
+// Remove the least recently used versions until the rest fit in
+// maxSize bytes.  The most recently used is always kept, since
+// someone is about to use it.
+void NoteVersionTable::trim(qint64 maxSize) {
+    NSqlQuery query(db);
+    NSqlQuery remove(db);
+    db->lockForWrite();
+    query.exec("Select noteGuid, usn, size from NoteVersionCache order by lastUsed desc");
+    remove.prepare("Delete from NoteVersionCache where noteGuid=:guid and usn=:usn");
+    qint64 size = 0;
+    bool first = true;
+    while (query.next()) {
+        size = size + query.value(2).toLongLong();
+        if (!first && size > maxSize) {
+            remove.bindValue(":guid", query.value(0).toString());
+            remove.bindValue(":usn", query.value(1).toInt());
+            remove.exec();
+        }
+        first = false;
+    }
+    query.finish();
+    remove.finish();
+    db->unlock();
+}
+
+
+
+void NoteVersionTable::expunge(QString guid) {
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.prepare("Delete from NoteVersionList where noteGuid=:guid");
+    query.bindValue(":guid", guid);
+    query.exec();
+    query.prepare("Delete from NoteVersionCache where noteGuid=:guid");
+    query.bindValue(":guid", guid);
+    query.exec();
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Forget the history of a set of notes.  Used when notes are expunged
+// in bulk, so the caller is expected to have a savepoint open.
+void NoteVersionTable::expungeMany(const QStringList &guids) {
+    NSqlQuery list(db);
+    NSqlQuery cache(db);
+    db->lockForWrite();
+    list.prepare("Delete from NoteVersionList where noteGuid=:guid");
+    cache.prepare("Delete from NoteVersionCache where noteGuid=:guid");
+    for (int i=0; i<guids.size(); i++) {
+        list.bindValue(":guid", guids[i]);
+        list.exec();
+        cache.bindValue(":guid", guids[i]);
+        cache.exec();
+    }
+    list.finish();
+    cache.finish();
+    db->unlock();
+}
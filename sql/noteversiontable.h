@@ -0,0 +1,70 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#ifndef NOTEVERSIONTABLE_H
+#define NOTEVERSIONTABLE_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include "sql/databaseconnection.h"
+#include "qevercloud/include/QEverCloud.h"
+
+using namespace qevercloud;
+
+// Most space (in bytes) the downloaded versions may take.  The
+// least recently used versions are removed past this.
+#define NOTE_HISTORY_CACHE_SIZE 67108864
+
+//*************************************
+//* This table caches the history of
+//* notes downloaded from Evernote so
+//* it can be viewed again (or offline)
+//* without downloading it again.  The
+//* cache of versions is kept to
+//* NOTE_HISTORY_CACHE_SIZE bytes.
+//*************************************
+
+class NoteVersionTable : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NoteVersionTable(DatabaseConnection *db);
+    DatabaseConnection *db;
+
+    // DB Read Functions
+    bool getVersions(QString guid, qint32 noteUsn, QList<NoteVersionId> &versions);   // Get the versions of a note. noteUsn<0 accepts an old list
+    bool getVersion(QString guid, qint32 usn, Note &note);                          // Get a downloaded version & mark it as used
+    bool hasVersion(QString guid, qint32 usn);                                      // Has a version been downloaded?
+
+    // DB Write Functions
+    void saveVersions(QString guid, qint32 noteUsn, const QList<NoteVersionId> &versions);  // Replace the list of versions
+    void saveVersion(QString guid, qint32 usn, const Note &note);                   // Save a downloaded version
+    void trim(qint64 maxSize);                                                      // Remove the least recently used versions past maxSize bytes
+    void expunge(QString guid);                                                     // Forget a note's history
+    void expungeMany(const QStringList &guids);                                     // Forget the history of a set of notes
+
+signals:
+
+public slots:
+
+};
+
+#endif // NOTEVERSIONTABLE_H
@@ -0,0 +1,153 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "pdftexttable.h"
+#include "sql/nsqlquery.h"
+
+#include <QDataStream>
+
+PdfTextTable::PdfTextTable(DatabaseConnection *db)
+{
+    this->db = db;
+}
+
+
+
+// Get the text of each page of a PDF.  If the PDF has changed since
+// it was cached (the hash is different) nothing is returned.
+bool PdfTextTable::getText(qint32 resLid, QString hash, QStringList &pages) {
+    pages.clear();
+    bool found = false;
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("Select hash, content from PdfTextCache where resourceLid=:lid order by page");
+    query.bindValue(":lid", resLid);
+    query.exec();
+    while (query.next()) {
+        if (query.value(0).toString() != hash) {
+            pages.clear();
+            found = false;
+            break;
+        }
+        pages.append(query.value(1).toString());
+        found = true;
+    }
+    query.finish();
+    db->unlock();
+    return found;
+}
+
+
+
+// Get the words on a page & where they are.
+bool PdfTextTable::getPage(qint32 resLid, qint32 page, QStringList &words, QList<QRectF> &boxes) {
+    words.clear();
+    boxes.clear();
+    bool found = false;
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("Select words from PdfTextCache where resourceLid=:lid and page=:page");
+    query.bindValue(":lid", resLid);
+    query.bindValue(":page", page);
+    query.exec();
+    if (query.next()) {
+        unpackWords(query.value(0).toByteArray(), words, boxes);
+        found = true;
+    }
+    query.finish();
+    db->unlock();
+    return found;
+}
+
+
+
+bool PdfTextTable::exists(qint32 resLid) {
+    bool found = false;
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("Select page from PdfTextCache where resourceLid=:lid limit 1");
+    query.bindValue(":lid", resLid);
+    query.exec();
+    if (query.next())
+        found = true;
+    query.finish();
+    db->unlock();
+    return found;
+}
+
+
+
+// Replace the cached pages for a PDF.
+void PdfTextTable::save(qint32 resLid, QString hash, const QStringList &pages, const QList<QByteArray> &words) {
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint savePdfText");
+    query.prepare("Delete from PdfTextCache where resourceLid=:lid");
+    query.bindValue(":lid", resLid);
+    query.exec();
+    query.prepare("Insert into PdfTextCache (resourceLid, hash, page, content, words) values (:lid, :hash, :page, :content, :words)");
+    for (int i=0; i<pages.size(); i++) {
+        query.bindValue(":lid", resLid);
+        query.bindValue(":hash", hash);
+        query.bindValue(":page", i);
+        query.bindValue(":content", pages[i]);
+        query.bindValue(":words", i < words.size() ? words[i] : QByteArray());
+        query.exec();
+    }
+    query.exec("release savePdfText");
+    query.finish();
+    db->unlock();
+}
+
+
+
+void PdfTextTable::expunge(qint32 resLid) {
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.prepare("Delete from PdfTextCache where resourceLid=:lid");
+    query.bindValue(":lid", resLid);
+    query.exec();
+    query.finish();
+    db->unlock();
+}
+
+
+
+// The words & their locations are stored together in one blob per page.
+QByteArray PdfTextTable::packWords(const QStringList &words, const QList<QRectF> &boxes) {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << words << boxes;
+    return data;
+}
+
+
+void PdfTextTable::unpackWords(const QByteArray &data, QStringList &words, QList<QRectF> &boxes) {
+    words.clear();
+    boxes.clear();
+    if (data.size() == 0)
+        return;
+    QDataStream in(data);
+    in >> words >> boxes;
+    if (words.size() != boxes.size()) {
+        words.clear();
+        boxes.clear();
+    }
+}
@@ -0,0 +1,63 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#ifndef PDFTEXTTABLE_H
+#define PDFTEXTTABLE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QRectF>
+#include "sql/databaseconnection.h"
+
+//*************************************
+//* This table caches the text of each
+//* page of a PDF along with where each
+//* word is on the page.  It is filled
+//* in by the indexer & used by the
+//* search & PDF viewer.
+//*************************************
+
+class PdfTextTable : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PdfTextTable(DatabaseConnection *db);
+    DatabaseConnection *db;
+
+    // DB Read Functions
+    bool getText(qint32 resLid, QString hash, QStringList &pages);       // Get each page's text if the hash still matches
+    bool getPage(qint32 resLid, qint32 page, QStringList &words, QList<QRectF> &boxes);  // Get the words on a page
+    bool exists(qint32 resLid);                                          // Has this PDF been cached?
+
+    // DB Write Functions
+    void save(qint32 resLid, QString hash, const QStringList &pages, const QList<QByteArray> &words);  // Replace a PDF's pages
+    void expunge(qint32 resLid);                                         // Delete a PDF's pages
+
+    // Word list packing
+    static QByteArray packWords(const QStringList &words, const QList<QRectF> &boxes);
+    static void unpackWords(const QByteArray &data, QStringList &words, QList<QRectF> &boxes);
+
+signals:
+
+public slots:
+
+};
+
+#endif // PDFTEXTTABLE_H
@@ -24,8 +24,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "utilities/mimereference.h"
 #include "sql/nsqlquery.h"
 #include "utilities/noteindexer.h"
+#include "communication/syncfetcher.h"
 
 #include <QSqlTableModel>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSet>
 
 #include <iostream>
 #include <fstream>
@@ -33,6 +37,24 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 using namespace std;
 extern Global global;
 
+
+// Data bodies too large to download into memory arrive as a file (see
+// SyncFetcher::spillFile).  Small fields stored in the database want the
+// bytes, so read them back & drop the file.
+static void loadSpillFile(Data &d) {
+    QString spillFile = SyncFetcher::spillFile(d);
+    if (spillFile == "")
+        return;
+    QFile file(spillFile);
+    if (file.open(QIODevice::ReadOnly)) {
+        d.body = file.readAll();
+        file.close();
+    } else {
+        QLOG_ERROR() << "Unable to read resource data " << spillFile;
+    }
+    file.remove();
+}
+
 // Default constructor
 ResourceTable::ResourceTable(DatabaseConnection *db)
 {
@@ -274,7 +296,7 @@ void ResourceTable::mapResource(NSqlQuery &query, Resource &resource) {
         resource.recognition = rd;
         break;
     case (RESOURCE_UPDATE_SEQUENCE_NUMBER):
-        resource.duration = query.value(1).toString().toInt();
+        resource.updateSequenceNum = query.value(1).toString().toInt();
         break;
     case (RESOURCE_ALTERNATE_BODY):
         ad.body = query.value(1).toByteArray();
@@ -479,7 +501,8 @@ qint32 ResourceTable::add(qint32 l, Resource &t, bool isDirty, int noteLid) {
             query.exec();
         }
 
-        if (d.body.isSet()) {
+        QString spillFile = SyncFetcher::spillFile(d);
+        if (d.body.isSet() || spillFile != "") {
             QString mimetype = t.mime;
             QString filename;
             MimeReference ref;
@@ -490,10 +513,23 @@ qint32 ResourceTable::add(qint32 l, Resource &t, bool isDirty, int noteLid) {
                 filename = attributes.fileName;
             QString fileExt = ref.getExtensionFromMime(mimetype, filename);
             QFile tfile(global.fileManager.getDbDirPath("/dba/"+QString::number(lid)) +fileExt );
-            tfile.open(QIODevice::WriteOnly);
-            if (d.size > 0)
-                tfile.write(d.body);
-            tfile.close();
+            if (spillFile != "") {
+                // Large bodies were downloaded straight to a file, so move it into place
+                QFile::remove(tfile.fileName());
+                if (!QFile::rename(spillFile, tfile.fileName())) {
+                    if (!QFile::copy(spillFile, tfile.fileName()))
+                        QLOG_ERROR() << "Unable to save resource data " << spillFile << " to " << tfile.fileName();
+                    QFile::remove(spillFile);
+                }
+            } else {
+                // Removing the file first breaks any link to a copy shared with
+                // another resource without copying data we're about to replace
+                tfile.remove();
+                tfile.open(QIODevice::WriteOnly);
+                if (d.size > 0)
+                    tfile.write(d.body);
+                tfile.close();
+            }
         }
     }
 
@@ -539,6 +575,7 @@ qint32 ResourceTable::add(qint32 l, Resource &t, bool isDirty, int noteLid) {
 
     if (t.recognition.isSet()) {
         Data r = t.recognition;
+        loadSpillFile(r);
         if (r.size.isSet()) {
             query.bindValue(":lid", lid);
             query.bindValue(":key", RESOURCE_RECOGNITION_SIZE);
@@ -575,6 +612,7 @@ qint32 ResourceTable::add(qint32 l, Resource &t, bool isDirty, int noteLid) {
 
     if (t.alternateData.isSet()) {
         Data ad = t.alternateData;
+        loadSpillFile(ad);
         if (ad.size.isSet()) {
             qint32 size = ad.size;
             query.bindValue(":lid", lid);
@@ -695,6 +733,8 @@ qint32 ResourceTable::add(qint32 l, Resource &t, bool isDirty, int noteLid) {
     query.finish();
     db->unlock();
 
+    updateHashIndex(lid);
+
     NoteIndexer indexer(db);
     indexer.indexResource(lid);
     return lid;
@@ -742,33 +782,68 @@ bool ResourceTable::getResourceRecognition(Resource &resource, qint32 lid) {
 qint32 ResourceTable::getLidByHashHex(QString noteGuid, QString hash) {
     NoteTable noteTable(db);
     qint32 notelid = noteTable.getLid(noteGuid);
+    return getLidByHashHex(notelid, hash);
+}
 
+
+
+// Get a resource for a note by the resource data hash.  The lookup
+// uses the ResourceHashIndex table so it doesn't need to scan all of
+// the note's resources.
+qint32 ResourceTable::getLidByHashHex(qint32 noteLid, QString hash) {
     NSqlQuery query(db);
     db->lockForRead();
-    query.prepare("Select lid from DataStore where data=:lid and key=:key");
-    query.bindValue(":lid", notelid);
-    query.bindValue(":key", RESOURCE_NOTE_LID);
+    query.prepare("Select resourceLid from ResourceHashIndex where noteLid=:noteLid and hash=:hash");
+    query.bindValue(":noteLid", noteLid);
+    query.bindValue(":hash", hash.toLower());
+    query.exec();
+    qint32 retval = 0;
+    if (query.next())
+        retval = query.value(0).toInt();
+    else {
+        QLOG_ERROR() << "Resource not found for note lid:" << noteLid << " hash:" << hash;
+    }
+    query.finish();
+    db->unlock();
+    return retval;
+}
+
+
+
+// Get all of the hash values for a note's resources in one pass.  The
+// hash is the lower case hex value used in the <en-media> tags.
+void ResourceTable::getLidsByHashes(QHash<QString, qint32> &map, qint32 noteLid) {
+    map.clear();
+    NSqlQuery query(db);
+    db->lockForRead();
+    query.prepare("Select hash, resourceLid from ResourceHashIndex where noteLid=:noteLid");
+    query.bindValue(":noteLid", noteLid);
     query.exec();
     while (query.next()) {
-        NSqlQuery query2(db);
-        qint32 lid = query.value(0).toInt();
-        QByteArray b;
-        b.append(hash);
-        query2.prepare("Select lid from DataStore where upper(data) like upper(:hash) and key=:key and lid=:lid");
-        query2.bindValue(":hash", hash);
-        query2.bindValue(":key", RESOURCE_DATA_HASH);
-        query2.bindValue(":lid", lid);
-        query2.exec();
-        if (query2.next()) {
-            db->unlock();
-            return query2.value(0).toInt();
-        } else {
-            QLOG_ERROR() << "Resource not found for lid:" << lid << " key:" << RESOURCE_DATA_HASH << " hash:" << hash;
-            QLOG_DEBUG() << query2.lastError();
-        }
+        map.insert(query.value(0).toString(), query.value(1).toInt());
     }
+    query.finish();
+    db->unlock();
+}
+
+
+
+// Rebuild the hash index entry for a resource.  This needs to be
+// called any time the resource's hash or owning note changes.
+void ResourceTable::updateHashIndex(qint32 lid) {
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.prepare("Delete from ResourceHashIndex where resourceLid=:lid");
+    query.bindValue(":lid", lid);
+    query.exec();
+
+    query.prepare("Insert into ResourceHashIndex (resourceLid, noteLid, hash) select h.lid, n.data, lower(h.data) from DataStore h, DataStore n where h.lid=:lid and h.key=:hashKey and n.lid=h.lid and n.key=:noteKey");
+    query.bindValue(":lid", lid);
+    query.bindValue(":hashKey", RESOURCE_DATA_HASH);
+    query.bindValue(":noteKey", RESOURCE_NOTE_LID);
+    query.exec();
+    query.finish();
     db->unlock();
-    return 0;
 }
 
 
@@ -862,6 +937,15 @@ void ResourceTable::expunge(qint32 lid) {
     query.prepare("delete from DataStore where lid=:lid");
     query.bindValue(":lid", lid);
     query.exec();
+    query.prepare("delete from ResourceHashIndex where resourceLid=:lid");
+    query.bindValue(":lid", lid);
+    query.exec();
+    query.prepare("delete from PdfTextCache where resourceLid=:lid");
+    query.bindValue(":lid", lid);
+    query.exec();
+    query.prepare("delete from SearchIndex where lid=:lid");
+    query.bindValue(":lid", lid);
+    query.exec();
     query.finish();
     db->unlock();
 
@@ -885,6 +969,71 @@ void ResourceTable::expunge(qint32 lid) {
 
 
 
+// Remove the files belonging to a set of lids.  The directory is only
+// listed once rather than once per lid, and the removal happens off
+// the GUI thread.
+class FileRemover : public QRunnable
+{
+public:
+    QString dir;
+    QSet<QString> lids;
+
+    void run() {
+        QDir myDir(dir);
+        QStringList list = myDir.entryList(QDir::Files, QDir::NoSort);
+        for (int i=0; i<list.size(); i++) {
+            if (lids.contains(list[i].section('.', 0, 0)))
+                myDir.remove(list[i]);
+        }
+    }
+};
+
+
+
+// Delete any files named <lid>.* in a directory in the background.
+void ResourceTable::removeFilesLater(QString dir, const QList<qint32> &lids) {
+    if (lids.size() == 0)
+        return;
+    FileRemover *remover = new FileRemover();
+    remover->dir = dir;
+    for (int i=0; i<lids.size(); i++)
+        remover->lids.insert(QString::number(lids[i]));
+    QThreadPool::globalInstance()->start(remover);
+}
+
+
+
+// Permanently delete a set of resources.  This is done with a couple
+// of statements rather than one pair per resource, and the files are
+// removed in the background.
+void ResourceTable::expungeMany(const QList<qint32> &lids) {
+    if (lids.size() == 0)
+        return;
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint expungeResources");
+    query.exec("create temporary table if not exists bulkResourceLids (lid integer primary key)");
+    query.exec("delete from bulkResourceLids");
+    query.prepare("insert or ignore into bulkResourceLids (lid) values (:lid)");
+    for (int i=0; i<lids.size(); i++) {
+        query.bindValue(":lid", lids[i]);
+        query.exec();
+    }
+    query.exec("delete from DataStore where lid in (select lid from bulkResourceLids)");
+    query.exec("delete from ResourceHashIndex where resourceLid in (select lid from bulkResourceLids)");
+    query.exec("delete from PdfTextCache where resourceLid in (select lid from bulkResourceLids)");
+    query.exec("delete from SearchIndex where lid in (select lid from bulkResourceLids)");
+    query.exec("release expungeResources");
+    query.finish();
+    db->unlock();
+
+    removeFilesLater(global.fileManager.getDbaDirPath(), lids);
+    removeFilesLater(global.fileManager.getThumbnailDirPath(), lids);
+}
+
+
+
 // Permanently delete a resource
 void ResourceTable::expunge(QString guid) {
     int lid = this->getLid(guid);
@@ -927,6 +1076,8 @@ void ResourceTable::updateResourceHash(qint32 lid, QByteArray newhash) {
     query.exec();
     query.finish();
     db->unlock();
+
+    updateHashIndex(lid);
 }
 
 
@@ -1020,6 +1171,23 @@ QByteArray ResourceTable::getDataHash(qint32 lid) {
 }
 
 
+// Get a resource's update sequence number.  Returns -1 if it isn't known.
+qint32 ResourceTable::getUpdateSequenceNumber(qint32 lid) {
+    NSqlQuery query(db);
+    qint32 retval = -1;
+    db->lockForRead();
+    query.prepare("Select data from datastore where lid=:lid and key=:key");
+    query.bindValue(":lid", lid);
+    query.bindValue(":key", RESOURCE_UPDATE_SEQUENCE_NUMBER);
+    query.exec();
+    if (query.next()) {
+        retval = query.value(0).toInt();
+    }
+    db->unlock();
+    return retval;
+}
+
+
 // Mark all note resource as needing reindexed
 void ResourceTable::reindexAllResources() {
     NSqlQuery query(db);
@@ -1049,6 +1217,69 @@ void ResourceTable::updateNoteLid(qint32 resourceLid, qint32 newNoteLid) {
     query.exec();
     query.finish();
     db->unlock();
+
+    updateHashIndex(resourceLid);
+}
+
+
+
+// Copy a resource to another note.  Only the database rows are copied.
+// The data file is shared with the old resource & its search index and
+// PDF text are cloned, so nothing needs to be read or reindexed.
+qint32 ResourceTable::duplicateResource(qint32 oldLid, qint32 newNoteLid) {
+    ConfigStore cs(db);
+    qint32 newLid = cs.incrementLidCounter();
+
+    NSqlQuery query(db);
+    db->lockForWrite();
+    query.exec("savepoint duplicateResource");
+    query.prepare("insert into datastore (lid, key, data) select :newLid, key, data from datastore where lid=:oldLid");
+    query.bindValue(":newLid", newLid);
+    query.bindValue(":oldLid", oldLid);
+    query.exec();
+
+    query.prepare("update datastore set data=:data where lid=:lid and key=:key");
+    query.bindValue(":data", QString::number(newLid));
+    query.bindValue(":lid", newLid);
+    query.bindValue(":key", RESOURCE_GUID);
+    query.exec();
+
+    query.prepare("update datastore set data=:data where lid=:lid and key=:key");
+    query.bindValue(":data", 0);
+    query.bindValue(":lid", newLid);
+    query.bindValue(":key", RESOURCE_UPDATE_SEQUENCE_NUMBER);
+    query.exec();
+
+    query.prepare("update datastore set data=:data where lid=:lid and key=:key");
+    query.bindValue(":data", newNoteLid);
+    query.bindValue(":lid", newLid);
+    query.bindValue(":key", RESOURCE_NOTE_LID);
+    query.exec();
+
+    query.prepare("insert into SearchIndex (lid, weight, source, content) select :newLid, weight, source, content from SearchIndex where lid=:oldLid");
+    query.bindValue(":newLid", newLid);
+    query.bindValue(":oldLid", oldLid);
+    query.exec();
+
+    query.prepare("insert into PdfTextCache (resourceLid, hash, page, content, words) select :newLid, hash, page, content, words from PdfTextCache where resourceLid=:oldLid");
+    query.bindValue(":newLid", newLid);
+    query.bindValue(":oldLid", oldLid);
+    query.exec();
+    query.exec("release duplicateResource");
+    query.finish();
+    db->unlock();
+    updateHashIndex(newLid);
+
+    QStringList filter;
+    QDir resDir(global.fileManager.getDbaDirPath());
+    filter << QString::number(oldLid)+".*";
+    QStringList files = resDir.entryList(filter);
+    for (int i=0; i<files.size(); i++) {
+        QString type = files[i].mid(files[i].indexOf("."));
+        global.fileManager.shareDbaFile(global.fileManager.getDbaDirPath()+files[i],
+                                        global.fileManager.getDbaDirPath()+QString::number(newLid)+type);
+    }
+    return newLid;
 }
 
 
@@ -1131,7 +1362,7 @@ void ResourceTable::getResourceMap(QHash<QString, qint32> &hashMap, QHash<qint32
 
 
 // Get all resources for a note
-void ResourceTable::getAllResources(QList<Resource> &list, qint32 noteLid, bool fullLoad, bool withBinary) {
+void ResourceTable::getAllResources(QList<Resource> &list, qint32 noteLid, bool fullLoad, bool withBinary, bool changedBinaryOnly) {
     //NoteTable ntable(db);
     //QString noteGuid = ntable.getGuid(noteLid);
     NSqlQuery query(db);
@@ -1166,9 +1397,16 @@ void ResourceTable::getAllResources(QList<Resource> &list, qint32 noteLid, bool
     QHash<qint32, Resource*>::iterator i;
     list.clear();
     for (i=lidMap.begin(); i!=lidMap.end(); ++i) {
-        if (withBinary && fullLoad) {
-            Resource *r = i.value();
-            qint32 lid = i.key();
+        Resource *r = i.value();
+        qint32 lid = i.key();
+
+        // Evernote already has the data of a resource it gave us a USN for,
+        // unless it has been changed since.  Its hash is enough to keep it.
+        bool loadBinary = withBinary && fullLoad;
+        if (loadBinary && changedBinaryOnly && r->updateSequenceNum.isSet()
+                && r->updateSequenceNum > 0 && !isDirty(lid))
+            loadBinary = false;
+        if (loadBinary) {
             QString mimetype = r->mime;
             MimeReference ref;
             QString filename;
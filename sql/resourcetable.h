@@ -92,6 +92,8 @@ public:
     bool exists(string noteGuid, string guid);                   // Does this resource exist?
     bool getResourceRecognition(Resource &resource, qint32 lid); // Get a resource's recognition data
     qint32 getLidByHashHex(QString noteGuid, QString hash);      // Get a lid by the resource's hash value
+    qint32 getLidByHashHex(qint32 noteLid, QString hash);        // Get a lid by the resource's hash value
+    void getLidsByHashes(QHash<QString, qint32> &map, qint32 noteLid);  // Get all hash->lid values for a note
     bool getInkNote(QByteArray &value, qint32 lid);              // Get an inknote
     qint32 getIndexNeeded(QList<qint32> &lids);                  // Get a list of all resources needing indexing
     bool getResourceList(QList<qint32> &resourceList, qint32 noteLid);  // Get resources for a note
@@ -99,10 +101,11 @@ public:
     qint32 getUnindexedCount();                                  // count of unindexed resources
     qint32 getNoteLid(qint32 resLid);                            // Get the owning note for this resource
     QByteArray getDataHash(qint32 lid);                          // Get the hash value for the data in a resource
+    qint32 getUpdateSequenceNumber(qint32 lid);                  // Get the last synchronized USN of a resource
     void getResourceMap(QHash<QString, qint32> &map, QHash<qint32, Resource> &resourceMap, qint32 noteLid);  // Get a resource MAP data
     void getResourceMap(QHash<QString, qint32> &map, QHash<qint32, Resource> &resourceMap, string guid);     // Get a resource's MAP data
     void getResourceMap(QHash<QString, qint32> &map, QHash<qint32, Resource> &resourceMap, QString guid);    // Get a resource's MAP data
-    void getAllResources(QList<Resource> &list, qint32 noteLid, bool fullLoad, bool withBinary);  // Get all resources for a note
+    void getAllResources(QList<Resource> &list, qint32 noteLid, bool fullLoad, bool withBinary, bool changedBinaryOnly=false);  // Get all resources for a note
 
     // DB Write Functions
     void updateGuid(qint32 lid, Guid &guid);                     // Update a resource's guid
@@ -116,8 +119,12 @@ public:
     qint32 addStub(qint32 resLid, qint32 noteLid);               // Add a basic "stub" record.  Useful when duplicating notes
     void reindexAllResources();                                  // Reindex all relources
     void updateNoteLid(qint32 resourceLid, qint32 newNoteLid);   // Update the owning note
+    qint32 duplicateResource(qint32 oldLid, qint32 newNoteLid);  // Copy a resource to a note, sharing its data
     void expungeByNote(qint32 notebookLid);                      // Given a note's LID, erase the resource
+    void expungeMany(const QList<qint32> &lids);                 // erase a set of resources at once
+    static void removeFilesLater(QString dir, const QList<qint32> &lids);  // Delete <lid>.* files in the background
     void mapResource(NSqlQuery &query, Resource &resource);      // Save a resource map data
+    void updateHashIndex(qint32 lid);                            // Rebuild a resource's hash index entry
 };
 
 
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Attachment badge cache persistence & eviction.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_attachmenticoncache
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_attachmenticoncache.cpp
+TRANSLATIONS =
+INSTALLS =
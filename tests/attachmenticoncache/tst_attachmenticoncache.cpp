@@ -0,0 +1,127 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QDir>
+#include "testdatabase.h"
+#include "global.h"
+#include "html/attachmenticoncache.h"
+
+extern Global global;
+
+//**********************************************************
+// The attachment badge cache keeps its files between
+// sessions, only the newest badge of each resource, and
+// no more than its file limit.
+//**********************************************************
+class TestAttachmentIconCache : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    QString render(AttachmentIconCache &cache, QString key);
+    int fileCount();
+
+private slots:
+    void initTestCase();
+    void keptInCacheDirectory();
+    void foundAfterRestart();
+    void newKeyReplacesOldBadge();
+    void trimmedToLimit();
+};
+
+
+
+void TestAttachmentIconCache::initTestCase() {
+    QVERIFY(database.open());
+}
+
+
+
+// Stands in for NoteFormatter::findIcon painting a badge on a miss
+QString TestAttachmentIconCache::render(AttachmentIconCache &cache, QString key) {
+    QString file;
+    if (cache.find(key, file))
+        return file;
+    file = cache.fileName(key);
+    QFile f(file);
+    f.open(QIODevice::WriteOnly);
+    f.write("png");
+    f.close();
+    cache.insert(key, file);
+    return file;
+}
+
+
+int TestAttachmentIconCache::fileCount() {
+    QDir dir(global.fileManager.getIconCacheDirPath());
+    return dir.entryList(QStringList() << "*_icon.png", QDir::Files).size();
+}
+
+
+
+// The tmp directory is emptied at startup & shutdown, so it can't be used
+void TestAttachmentIconCache::keptInCacheDirectory() {
+    AttachmentIconCache cache;
+    QString file = render(cache, AttachmentIconCache::buildKey(1, 100, "a.pdf", "Sans", "black", "white", false));
+    QVERIFY(file.startsWith(global.fileManager.getIconCacheDirPath().replace("\\", "/")));
+    QVERIFY(!file.startsWith(global.fileManager.getTmpDirPath().replace("\\", "/")));
+}
+
+
+
+void TestAttachmentIconCache::foundAfterRestart() {
+    QString key = AttachmentIconCache::buildKey(2, 100, "b.pdf", "Sans", "black", "white", false);
+    AttachmentIconCache first;
+    QString file = render(first, key);
+
+    AttachmentIconCache second;
+    QString found;
+    QVERIFY(second.find(key, found));
+    QCOMPARE(found, file);
+}
+
+
+
+// Highlighting or a font change makes a new badge, the old one must go
+void TestAttachmentIconCache::newKeyReplacesOldBadge() {
+    AttachmentIconCache cache;
+    QString plain = render(cache, AttachmentIconCache::buildKey(3, 100, "c.pdf", "Sans", "black", "white", false));
+    QString highlighted = render(cache, AttachmentIconCache::buildKey(3, 100, "c.pdf", "Sans", "black", "white", true));
+    QVERIFY(plain != highlighted);
+    QVERIFY(!QFile::exists(plain));
+    QVERIFY(QFile::exists(highlighted));
+
+    QDir dir(global.fileManager.getIconCacheDirPath());
+    QCOMPARE(dir.entryList(QStringList() << "3_*_icon.png", QDir::Files).size(), 1);
+}
+
+
+
+void TestAttachmentIconCache::trimmedToLimit() {
+    AttachmentIconCache cache;
+    for (int i=100; i<150; i++)
+        render(cache, AttachmentIconCache::buildKey(i, 100, "d.pdf", "Sans", "black", "white", false));
+    QVERIFY(fileCount() >= 50);
+    cache.setMaxFiles(10);
+    QCOMPARE(fileCount(), 10);
+}
+
+QTEST_MAIN(TestAttachmentIconCache)
+#include "tst_attachmenticoncache.moc"
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Shared database fixture & fake NoteStore server
+# for the tests.  The program directory is the
+# source tree so images, translations, etc. are
+# found.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+HEADERS += $$PWD/testdatabase.h \
+           $$PWD/fakenotestore.h
+SOURCES += $$PWD/testdatabase.cpp \
+           $$PWD/fakenotestore.cpp
+DEFINES += PROGRAM_DIR=\\\"$$PWD/../../\\\"
@@ -0,0 +1,288 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "fakenotestore.h"
+#include "qevercloud/thrift.h"
+#include "qevercloud/generated/types_impl.h"
+
+#include <QTimer>
+#include <QUuid>
+
+
+FakeNoteStore::FakeNoteStore(QObject *parent) :
+    QTcpServer(parent)
+{
+    latency = 0;
+    failNext = 0;
+    inFlight = 0;
+    maxInFlight = 0;
+    updateCount = 0;
+    connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+}
+
+
+
+bool FakeNoteStore::start() {
+    return listen(QHostAddress::LocalHost);
+}
+
+
+
+QString FakeNoteStore::url() {
+    return "http://127.0.0.1:" + QString::number(serverPort()) + "/edam/note/s1";
+}
+
+
+
+void FakeNoteStore::acceptConnection() {
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        buffers.insert(socket, QByteArray());
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(dropConnection()));
+    }
+}
+
+
+
+void FakeNoteStore::dropConnection() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    buffers.remove(socket);
+    socket->deleteLater();
+}
+
+
+
+// Split the data on a connection into HTTP requests.  Keep-alive
+// connections can carry several one after another.
+void FakeNoteStore::readRequest() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    QByteArray &buffer = buffers[socket];
+    buffer.append(socket->readAll());
+    while (true) {
+        int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0)
+            return;
+        int length = 0;
+        QList<QByteArray> headers = buffer.left(headerEnd).split('\n');
+        for (int i=0; i<headers.size(); i++) {
+            if (headers[i].toLower().startsWith("content-length:"))
+                length = headers[i].mid(15).trimmed().toInt();
+        }
+        if (buffer.size() < headerEnd+4+length)
+            return;
+        QByteArray body = buffer.mid(headerEnd+4, length);
+        buffer.remove(0, headerEnd+4+length);
+        handleRequest(socket, body);
+    }
+}
+
+
+
+void FakeNoteStore::handleRequest(QTcpSocket *socket, QByteArray body) {
+    PendingReply reply;
+    reply.socket = socket;
+    if (failNext > 0) {
+        failNext--;
+        calls.append("HTTP 503");
+        reply.data = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+    } else {
+        QByteArray data = call(body);
+        reply.data = "HTTP/1.1 200 OK\r\nContent-Type: application/x-thrift\r\nContent-Length: "
+                + QByteArray::number(data.size()) + "\r\n\r\n" + data;
+    }
+    replies.append(reply);
+    inFlight++;
+    maxInFlight = qMax(maxInFlight, inFlight);
+    QTimer::singleShot(latency, this, SLOT(sendReply()));
+}
+
+
+
+// Every reply waits the same time, so they are sent in the order received
+void FakeNoteStore::sendReply() {
+    PendingReply reply = replies.takeFirst();
+    inFlight--;
+    if (!reply.socket.isNull())
+        reply.socket->write(reply.data);
+}
+
+
+
+// Read the simple arguments of a call by field id.  A structure is read
+// into the note if one is given & skipped otherwise.
+void FakeNoteStore::readArguments(ThriftBinaryBufferReader &r, QHash<qint16, QVariant> &args, Note *note) {
+    QString name;
+    ThriftFieldType::type fieldType;
+    qint16 fieldId;
+    r.readStructBegin(name);
+    while (true) {
+        r.readFieldBegin(name, fieldType, fieldId);
+        if (fieldType == ThriftFieldType::T_STOP)
+            break;
+        if (fieldType == ThriftFieldType::T_STRING) {
+            QString value;
+            r.readString(value);
+            args.insert(fieldId, value);
+        } else if (fieldType == ThriftFieldType::T_BOOL) {
+            bool value;
+            r.readBool(value);
+            args.insert(fieldId, value);
+        } else if (fieldType == ThriftFieldType::T_I32) {
+            qint32 value;
+            r.readI32(value);
+            args.insert(fieldId, value);
+        } else if (fieldType == ThriftFieldType::T_STRUCT && note != NULL) {
+            readNote(r, *note);
+        } else {
+            r.skip(fieldType);
+        }
+        r.readFieldEnd();
+    }
+    r.readStructEnd();
+}
+
+
+
+void FakeNoteStore::writeNoteReply(ThriftBinaryBufferWriter &w, QString method, qint32 seqid, const Note &note) {
+    w.writeMessageBegin(method, ThriftMessageType::T_REPLY, seqid);
+    w.writeStructBegin("result");
+    w.writeFieldBegin("success", ThriftFieldType::T_STRUCT, 0);
+    writeNote(w, note);
+    w.writeFieldEnd();
+    w.writeFieldStop();
+    w.writeStructEnd();
+    w.writeMessageEnd();
+}
+
+
+
+// Answer one Thrift call.  Anything unknown gets a Thrift exception.
+QByteArray FakeNoteStore::call(QByteArray request) {
+    ThriftBinaryBufferReader r(request);
+    QString method;
+    ThriftMessageType::type messageType;
+    qint32 seqid;
+    r.readMessageBegin(method, messageType, seqid);
+    calls.append(method);
+
+    QHash<qint16, QVariant> args;
+    Note uploaded;
+    readArguments(r, args, &uploaded);
+    r.readMessageEnd();
+
+    ThriftBinaryBufferWriter w;
+    QString guid = args.value(2).toString();
+    if (method == "createNote" || (method == "updateNote" && uploaded.guid.isSet()
+                                   && notes.contains(uploaded.guid))) {
+        if (method == "createNote")
+            uploaded.guid = QUuid::createUuid().toString().remove("{").remove("}");
+        uploaded.updateSequenceNum = ++updateCount;
+        notes.insert(uploaded.guid, uploaded);
+        writeNoteReply(w, method, seqid, uploaded);
+        return w.buffer();
+    }
+    if (method == "getNote" && notes.contains(guid)) {
+        writeNoteReply(w, method, seqid, notes[guid]);
+        return w.buffer();
+    }
+    if (method == "listNoteVersions" && versions.contains(guid)) {
+        const QList<Note> &list = versions[guid];
+        w.writeMessageBegin(method, ThriftMessageType::T_REPLY, seqid);
+        w.writeStructBegin("result");
+        w.writeFieldBegin("success", ThriftFieldType::T_LIST, 0);
+        w.writeListBegin(ThriftFieldType::T_STRUCT, list.size());
+        for (int i=0; i<list.size(); i++) {
+            NoteVersionId version;
+            version.updateSequenceNum = list[i].updateSequenceNum;
+            version.updated = list[i].updated;
+            version.saved = list[i].updated;
+            version.title = list[i].title;
+            writeNoteVersionId(w, version);
+        }
+        w.writeListEnd();
+        w.writeFieldEnd();
+        w.writeFieldStop();
+        w.writeStructEnd();
+        w.writeMessageEnd();
+        return w.buffer();
+    }
+    if (method == "getNoteVersion" && versions.contains(guid)) {
+        const QList<Note> &list = versions[guid];
+        for (int i=0; i<list.size(); i++) {
+            if (list[i].updateSequenceNum != args.value(3).toInt())
+                continue;
+            // Leave out what wasn't asked for, as Evernote does
+            Note version = list[i];
+            QList<Resource> versionResources;
+            if (version.resources.isSet())
+                versionResources = version.resources;
+            for (int j=0; j<versionResources.size(); j++) {
+                if (!args.value(4).toBool() && versionResources[j].data.isSet()) {
+                    Data data = versionResources[j].data;
+                    data.body.clear();
+                    versionResources[j].data = data;
+                }
+                if (!args.value(5).toBool())
+                    versionResources[j].recognition.clear();
+                if (!args.value(6).toBool())
+                    versionResources[j].alternateData.clear();
+            }
+            if (version.resources.isSet())
+                version.resources = versionResources;
+            writeNoteReply(w, method, seqid, version);
+            return w.buffer();
+        }
+    }
+    if (method == "getResourceData" && resources.contains(guid)) {
+        w.writeMessageBegin(method, ThriftMessageType::T_REPLY, seqid);
+        w.writeStructBegin("result");
+        w.writeFieldBegin("success", ThriftFieldType::T_STRING, 0);
+        w.writeBinary(resources[guid].data->body.ref());
+        w.writeFieldEnd();
+        w.writeFieldStop();
+        w.writeStructEnd();
+        w.writeMessageEnd();
+        return w.buffer();
+    }
+    if (method == "getResource" && resources.contains(guid)) {
+        w.writeMessageBegin(method, ThriftMessageType::T_REPLY, seqid);
+        w.writeStructBegin("result");
+        w.writeFieldBegin("success", ThriftFieldType::T_STRUCT, 0);
+        writeResource(w, resources[guid]);
+        w.writeFieldEnd();
+        w.writeFieldStop();
+        w.writeStructEnd();
+        w.writeMessageEnd();
+        return w.buffer();
+    }
+
+    w.writeMessageBegin(method, ThriftMessageType::T_EXCEPTION, seqid);
+    w.writeStructBegin("TApplicationException");
+    w.writeFieldBegin("message", ThriftFieldType::T_STRING, 1);
+    w.writeString("Not handled by the fake NoteStore: " + method + " " + guid);
+    w.writeFieldEnd();
+    w.writeFieldBegin("type", ThriftFieldType::T_I32, 2);
+    w.writeI32(ThriftException::Type::UNKNOWN_METHOD);
+    w.writeFieldEnd();
+    w.writeFieldStop();
+    w.writeStructEnd();
+    w.writeMessageEnd();
+    return w.buffer();
+}
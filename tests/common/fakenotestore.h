@@ -0,0 +1,80 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef FAKENOTESTORE_H
+#define FAKENOTESTORE_H
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+
+#include "qevercloud/include/QEverCloud.h"
+using namespace qevercloud;
+
+
+//**********************************************************
+// A NoteStore server on the loopback interface.  It answers
+// the Thrift calls the tests make from the notes & resources
+// it is given.  Every reply is held back for the latency so
+// the effect of round trips can be measured, and requests
+// can be made to fail to test the error handling.  Notes
+// that are uploaded are kept & given the next USN.  Past
+// versions of notes can be listed & downloaded.
+//**********************************************************
+class FakeNoteStore : public QTcpServer
+{
+    Q_OBJECT
+private:
+    struct PendingReply {
+        QPointer<QTcpSocket> socket;
+        QByteArray data;
+    };
+    QHash<QTcpSocket*, QByteArray> buffers;   // Partial requests by connection
+    QList<PendingReply> replies;              // Replies waiting for the latency to pass
+    int inFlight;
+    void handleRequest(QTcpSocket *socket, QByteArray body);
+    QByteArray call(QByteArray request);
+    void readArguments(ThriftBinaryBufferReader &r, QHash<qint16, QVariant> &args, Note *note=NULL);
+    void writeNoteReply(ThriftBinaryBufferWriter &w, QString method, qint32 seqid, const Note &note);
+
+public:
+    explicit FakeNoteStore(QObject *parent = 0);
+    bool start();
+    QString url();
+    int latency;                              // Milliseconds before each reply is sent
+    int failNext;                             // Answer this many requests with HTTP 503
+    QHash<QString, Note> notes;               // Notes by guid, including any uploaded
+    QHash<QString, Resource> resources;       // Resources by guid
+    QHash<QString, QList<Note> > versions;    // Past versions of notes by guid, newest first.  Each needs a USN, updated & title
+    QStringList calls;                        // Methods called, in the order received
+    int maxInFlight;                          // Most requests waiting at one time
+    qint32 updateCount;                       // Last USN given to an uploaded note
+
+private slots:
+    void acceptConnection();
+    void readRequest();
+    void dropConnection();
+    void sendReply();
+};
+
+#endif // FAKENOTESTORE_H
@@ -0,0 +1,138 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "testdatabase.h"
+#include "global.h"
+#include "settings/startupconfig.h"
+#include "sql/notetable.h"
+#include "sql/notebooktable.h"
+#include "sql/tagtable.h"
+
+#include <QCryptographicHash>
+#include <QUuid>
+#include <QDateTime>
+
+extern Global global;
+
+
+TestDatabase::TestDatabase()
+{
+    db = NULL;
+}
+
+
+TestDatabase::~TestDatabase() {
+    if (db != NULL)
+        delete db;
+}
+
+
+
+// Point the globals at the temporary home directory & open the database.
+bool TestDatabase::open() {
+    if (!home.isValid())
+        return false;
+    StartupConfig config;
+    config.homeDirPath = home.path() + "/";
+    config.programDirPath = QString(PROGRAM_DIR);
+    config.accountId = 1;
+    global.setup(config, false);
+    db = new DatabaseConnection("nixnote");
+    return true;
+}
+
+
+QString TestDatabase::homePath() {
+    return home.path() + "/";
+}
+
+
+QString TestDatabase::hashHex(const QByteArray &data) {
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+}
+
+
+
+qint32 TestDatabase::addNotebook(QString name) {
+    NotebookTable table(db);
+    Notebook book;
+    book.guid = QUuid::createUuid().toString().remove("{").remove("}");
+    book.name = name;
+    return table.add(0, book, false, true);
+}
+
+
+
+qint32 TestDatabase::addTag(QString name, QString parentGuid) {
+    TagTable table(db);
+    Tag tag;
+    tag.guid = QUuid::createUuid().toString().remove("{").remove("}");
+    tag.name = name;
+    if (parentGuid != "")
+        tag.parentGuid = parentGuid;
+    return table.add(0, tag, false, 0);
+}
+
+
+
+// Add a note with one resource for each attachment.  The note's content
+// refers to every resource with an en-media tag.
+qint32 TestDatabase::addNote(qint32 notebookLid, QString title, QList<QByteArray> attachments,
+                             QString mime, QString fileName) {
+    NotebookTable notebookTable(db);
+    Note note;
+    note.guid = QUuid::createUuid().toString().remove("{").remove("}");
+    note.title = title;
+    QString notebookGuid;
+    notebookTable.getGuid(notebookGuid, notebookLid);
+    note.notebookGuid = notebookGuid;
+    note.active = true;
+    note.updateSequenceNum = 0;
+    note.created = QDateTime::currentMSecsSinceEpoch();
+    note.updated = note.created;
+
+    QString content = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<!DOCTYPE en-note SYSTEM \"http://xml.evernote.com/pub/enml2.dtd\"><en-note>";
+    QList<Resource> resources;
+    for (int i=0; i<attachments.size(); i++) {
+        Resource r;
+        Data d;
+        d.body = attachments[i];
+        d.size = attachments[i].size();
+        d.bodyHash = QCryptographicHash::hash(attachments[i], QCryptographicHash::Md5);
+        r.guid = QUuid::createUuid().toString().remove("{").remove("}");
+        r.noteGuid = note.guid;
+        r.mime = mime;
+        r.data = d;
+        r.active = true;
+        if (fileName != "") {
+            ResourceAttributes attributes;
+            attributes.fileName = fileName;
+            r.attributes = attributes;
+        }
+        resources.append(r);
+        content += "<div><en-media type=\"" + mime + "\" hash=\"" + hashHex(attachments[i]) + "\"/></div>";
+    }
+    content += "</en-note>";
+    note.content = content;
+    note.resources = resources;
+
+    NoteTable noteTable(db);
+    return noteTable.add(0, note, false, notebookLid);
+}
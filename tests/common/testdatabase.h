@@ -0,0 +1,55 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef TESTDATABASE_H
+#define TESTDATABASE_H
+
+#include <QTemporaryDir>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include "sql/databaseconnection.h"
+
+
+//**********************************************************
+// Shared setup for tests that need a database.  The global
+// settings & a "nixnote" connection are created in an empty
+// home directory which is removed afterwards.  Only one can
+// exist in a test program since it sets up the globals.
+//**********************************************************
+class TestDatabase
+{
+private:
+    QTemporaryDir home;
+
+public:
+    TestDatabase();
+    ~TestDatabase();
+    DatabaseConnection *db;
+    bool open();
+    QString homePath();
+    qint32 addNotebook(QString name);
+    qint32 addTag(QString name, QString parentGuid="");
+    qint32 addNote(qint32 notebookLid, QString title, QList<QByteArray> attachments,
+                   QString mime="image/png", QString fileName="");
+    static QString hashHex(const QByteArray &data);
+};
+
+#endif // TESTDATABASE_H
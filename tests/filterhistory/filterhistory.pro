@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# The capped back & forward history, its cached
+# results & the memory a long session uses.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+
+TARGET = tst_filterhistory
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_filterhistory.cpp
+TRANSLATIONS =
+INSTALLS =
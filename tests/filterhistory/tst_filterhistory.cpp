@@ -0,0 +1,214 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include "global.h"
+#include "filters/filterhistory.h"
+#include "filters/filtercriteria.h"
+
+#define SESSION_CLICKS 20000
+#define SELECTED_NOTES 1000
+
+extern Global global;
+
+//**********************************************************
+// The navigation history.  It is capped so a long session
+// doesn't keep every selection made, each entry shares the
+// selected notes it was copied from, & the results of the
+// most recently used entries are kept for back & forward.
+//**********************************************************
+class TestFilterHistory : public QObject
+{
+    Q_OBJECT
+private:
+    void navigate(FilterHistory &history, int clicks);
+
+private slots:
+    void dropsOldestEntries();
+    void keepsViewedEntry();
+    void removeLastDropsResults();
+    void keepsRecentResults();
+    void staleResultsDropped();
+    void sharesSelectedNotes();
+    void benchmarkSession_data();
+    void benchmarkSession();
+    void benchmarkBack();
+};
+
+
+
+// Click through the notes like a user does.  Each new entry is a copy
+// of the one being viewed with a different note opened.
+void TestFilterHistory::navigate(FilterHistory &history, int clicks) {
+    QList<qint32> selected;
+    for (int i=0; i<SELECTED_NOTES; i++)
+        selected.append(i+1);
+    FilterCriteria *first = new FilterCriteria();
+    first->setSelectedNotes(selected);
+    global.filterPosition = history.size();
+    history.append(first);
+    for (int i=0; i<clicks; i++) {
+        FilterCriteria *criteria = new FilterCriteria();
+        history.at(global.filterPosition)->duplicate(*criteria);
+        criteria->setLid(i%SELECTED_NOTES+1);
+        global.filterPosition = history.size();
+        history.append(criteria);
+    }
+}
+
+
+
+// Positions stay absolute when the oldest entries go
+void TestFilterHistory::dropsOldestEntries() {
+    FilterHistory history;
+    history.setCapacity(5, 2);
+    navigate(history, 19);
+    QCOMPARE(history.size(), 20);
+    QCOMPARE(history.firstPosition(), 15);
+    QCOMPARE(history.at(19)->getLid(), 19);
+    QCOMPARE(history[15]->getLid(), 15);
+}
+
+
+
+// The user went back to the first entry, so it can't be dropped
+void TestFilterHistory::keepsViewedEntry() {
+    FilterHistory history;
+    history.setCapacity(3, 2);
+    global.filterPosition = 0;
+    for (int i=0; i<6; i++) {
+        FilterCriteria *criteria = new FilterCriteria();
+        criteria->setLid(i);
+        history.append(criteria);
+    }
+    QCOMPARE(history.firstPosition(), 0);
+    QCOMPARE(history.at(0)->getLid(), 0);
+    global.filterPosition = 5;
+    history.setCapacity(3, 2);
+    QCOMPARE(history.firstPosition(), 3);
+}
+
+
+
+void TestFilterHistory::removeLastDropsResults() {
+    FilterHistory history;
+    navigate(history, 3);
+    history.setResults(3, QList<qint32>() << 1 << 2, "stamp");
+    QCOMPARE(history.resultCount(), 1);
+    history.removeLast();
+    QCOMPARE(history.size(), 3);
+    QCOMPARE(history.resultCount(), 0);
+}
+
+
+
+// Only the most recently used results are kept
+void TestFilterHistory::keepsRecentResults() {
+    FilterHistory history;
+    history.setCapacity(10, 2);
+    navigate(history, 3);
+    QList<qint32> lids;
+    history.setResults(0, QList<qint32>() << 10, "stamp");
+    history.setResults(1, QList<qint32>() << 11, "stamp");
+    QVERIFY(history.getResults(0, lids, "stamp"));
+    history.setResults(2, QList<qint32>() << 12, "stamp");
+    QCOMPARE(history.resultCount(), 2);
+    QVERIFY(!history.getResults(1, lids, "stamp"));
+    QVERIFY(history.getResults(0, lids, "stamp"));
+    QCOMPARE(lids, QList<qint32>() << 10);
+    QVERIFY(history.getResults(2, lids, "stamp"));
+    QCOMPARE(lids, QList<qint32>() << 12);
+}
+
+
+
+// Results saved before the database changed are thrown away
+void TestFilterHistory::staleResultsDropped() {
+    FilterHistory history;
+    navigate(history, 1);
+    QList<qint32> lids;
+    history.setResults(1, QList<qint32>() << 5, "before");
+    QVERIFY(!history.getResults(1, lids, "after"));
+    QCOMPARE(history.resultCount(), 0);
+    QVERIFY(!history.getResults(1, lids, "before"));
+}
+
+
+
+// A thousand entries copied from each other hold one list of notes
+void TestFilterHistory::sharesSelectedNotes() {
+    FilterHistory history;
+    history.setCapacity(1000, 10);
+    navigate(history, 999);
+    qint64 used = history.memoryUsage();
+    qDebug() << "1000 entries use about" << used/1024 << "KiB";
+    QVERIFY(used < 1000*qint64(sizeof(FilterCriteria)) + 2*SELECTED_NOTES*qint64(sizeof(void*)) + 1000*qint64(sizeof(void*)));
+}
+
+
+
+void TestFilterHistory::benchmarkSession_data() {
+    QTest::addColumn<int>("capacity");
+    QTest::newRow("capped at 100") << 100;
+    QTest::newRow("uncapped") << SESSION_CLICKS+1;
+}
+
+
+
+// A day's clicking, with the memory the history is left holding
+void TestFilterHistory::benchmarkSession() {
+    QFETCH(int, capacity);
+    qint64 used = 0;
+    int entries = 0;
+    QBENCHMARK {
+        FilterHistory *history = new FilterHistory();
+        history->setCapacity(capacity, 10);
+        navigate(*history, SESSION_CLICKS);
+        used = history->memoryUsage();
+        entries = history->size() - history->firstPosition();
+        while (history->size() > history->firstPosition())
+            history->removeLast();
+        delete history;
+    }
+    qDebug() << entries << "entries kept using about" << used/1024 << "KiB";
+}
+
+
+
+// Going back to an entry with saved results is a lookup, not a filter
+void TestFilterHistory::benchmarkBack() {
+    FilterHistory history;
+    history.setCapacity(100, 10);
+    navigate(history, 99);
+    QList<qint32> matched;
+    for (int i=0; i<50000; i++)
+        matched.append(i);
+    for (int i=90; i<100; i++)
+        history.setResults(i, matched, "stamp");
+    QList<qint32> lids;
+    QBENCHMARK {
+        for (int i=99; i>=90; i--)
+            history.getResults(i, lids, "stamp");
+    }
+    QCOMPARE(lids.size(), matched.size());
+}
+
+
+QTEST_MAIN(TestFilterHistory)
+#include "tst_filterhistory.moc"
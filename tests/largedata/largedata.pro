@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Peak memory test for downloading a resource much
+# larger than the spill threshold.  Needs a loopback
+# network interface.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+
+TARGET = tst_largedata
+QT += testlib network
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_largedata.cpp
+TRANSLATIONS =
+INSTALLS =
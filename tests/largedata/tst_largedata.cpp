@@ -0,0 +1,369 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include "qevercloud/include/QEverCloud.h"
+#include "qevercloud/thrift.h"
+#include "qevercloud/http.h"
+#include "qevercloud/generated/types_impl.h"
+
+using namespace qevercloud;
+
+#define LARGE_BODY_SIZE 67108864
+#define SPILL_THRESHOLD 1048576
+#define SEND_CHUNK_SIZE 1048576
+
+
+//**********************************************************
+// Serves one getResource reply with a very large body.
+// The body is generated as it is sent so the server
+// doesn't add its own copy to the memory being measured.
+//**********************************************************
+class LargeReplyServer : public QTcpServer
+{
+    Q_OBJECT
+private:
+    QTcpSocket *socket;
+    QByteArray head;
+    QByteArray tail;
+    qint64 bodySent;
+    bool replying;
+
+public:
+    LargeReplyServer(QObject *parent = 0);
+    QByteArray bodyHash;
+
+private slots:
+    void connectionReady();
+    void requestReady();
+    void sendMore();
+};
+
+
+
+LargeReplyServer::LargeReplyServer(QObject *parent) : QTcpServer(parent) {
+    socket = NULL;
+    bodySent = 0;
+    replying = false;
+    connect(this, SIGNAL(newConnection()), this, SLOT(connectionReady()));
+
+    // The body is all 'x', so its hash can be worked out a piece at a time
+    QCryptographicHash md5(QCryptographicHash::Md5);
+    QByteArray chunk(SEND_CHUNK_SIZE, 'x');
+    for (qint64 i=0; i<LARGE_BODY_SIZE; i+=SEND_CHUNK_SIZE)
+        md5.addData(chunk.constData(), (int)qMin((qint64)SEND_CHUNK_SIZE, LARGE_BODY_SIZE - i));
+    bodyHash = md5.result();
+
+    // getResource reply: message header, result struct (field 0), Resource.guid (1),
+    // Resource.data (3) with Data.bodyHash (1), Data.size (2) & Data.body (3)
+    QByteArray thrift;
+    ThriftBinaryBufferWriter w;
+    w.writeMessageBegin("getResource", ThriftMessageType::T_REPLY, 0);
+    w.writeStructBegin("getResource_result");
+    w.writeFieldBegin("result", ThriftFieldType::T_STRUCT, 0);
+    w.writeStructBegin("Resource");
+    w.writeFieldBegin("guid", ThriftFieldType::T_STRING, 1);
+    w.writeString("large-resource");
+    w.writeFieldEnd();
+    w.writeFieldBegin("data", ThriftFieldType::T_STRUCT, 3);
+    w.writeStructBegin("Data");
+    w.writeFieldBegin("bodyHash", ThriftFieldType::T_STRING, 1);
+    w.writeBinary(bodyHash);
+    w.writeFieldEnd();
+    w.writeFieldBegin("size", ThriftFieldType::T_I32, 2);
+    w.writeI32(LARGE_BODY_SIZE);
+    w.writeFieldEnd();
+    w.writeFieldBegin("body", ThriftFieldType::T_STRING, 3);
+    w.writeI32(LARGE_BODY_SIZE);
+    thrift = w.buffer();
+
+    ThriftBinaryBufferWriter t;
+    t.writeFieldEnd();
+    t.writeFieldStop();
+    t.writeStructEnd();
+    t.writeFieldEnd();
+    t.writeFieldStop();
+    t.writeStructEnd();
+    t.writeFieldEnd();
+    t.writeFieldStop();
+    t.writeStructEnd();
+    t.writeMessageEnd();
+    tail = t.buffer();
+
+    qint64 length = thrift.size() + LARGE_BODY_SIZE + tail.size();
+    head = "HTTP/1.1 200 OK\r\n"
+           "Content-Type: application/x-thrift\r\n"
+           "Connection: close\r\n"
+           "Content-Length: " + QByteArray::number(length) + "\r\n\r\n";
+    head.append(thrift);
+}
+
+
+
+void LargeReplyServer::connectionReady() {
+    socket = nextPendingConnection();
+    connect(socket, SIGNAL(readyRead()), this, SLOT(requestReady()));
+    connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(sendMore()));
+}
+
+
+
+// The request itself doesn't matter.  Answer once it starts arriving.
+void LargeReplyServer::requestReady() {
+    socket->readAll();
+    if (replying)
+        return;
+    replying = true;
+    socket->write(head);
+}
+
+
+
+// Keep about one chunk queued on the socket
+void LargeReplyServer::sendMore() {
+    if (socket->bytesToWrite() > SEND_CHUNK_SIZE)
+        return;
+    if (bodySent >= LARGE_BODY_SIZE) {
+        if (!tail.isEmpty()) {
+            socket->write(tail);
+            tail.clear();
+            socket->disconnectFromHost();
+        }
+        return;
+    }
+    qint64 size = qMin((qint64)SEND_CHUNK_SIZE, LARGE_BODY_SIZE - bodySent);
+    socket->write(QByteArray((int)size, 'x'));
+    bodySent += size;
+}
+
+
+
+
+//**********************************************************
+// Downloads a resource much larger than the spill threshold
+// & checks the body ends up in a file, not in memory.  The
+// spiller is also fed replies a few bytes at a time to check
+// only Data bodies are taken out.
+//**********************************************************
+class TestLargeData : public QObject
+{
+    Q_OBJECT
+private:
+    QVariant result;
+    QSharedPointer<EverCloudExceptionData> error;
+    qint64 peakAnon;
+    qint64 anonMemory();
+    QByteArray noteReply(Note note);
+    bool spill(QByteArray reply, QString dir, QByteArray &kept);
+
+private slots:
+    void spillResourceBody();
+    void spillOnlyDataBodies();
+    void spillChecksHash();
+    void finished(QVariant result, QSharedPointer<EverCloudExceptionData> error);
+    void sampleMemory();
+};
+
+
+
+// Private (anonymous) resident memory in bytes, or -1 if unknown
+qint64 TestLargeData::anonMemory() {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly))
+        return -1;
+    QList<QByteArray> lines = status.readAll().split('\n');
+    for (int i=0; i<lines.size(); i++) {
+        if (lines[i].startsWith("RssAnon:")) {
+            QList<QByteArray> fields = lines[i].simplified().split(' ');
+            if (fields.size() >= 2)
+                return fields[1].toLongLong()*1024;
+        }
+    }
+    return -1;
+}
+
+
+
+void TestLargeData::sampleMemory() {
+    peakAnon = qMax(peakAnon, anonMemory());
+}
+
+
+
+void TestLargeData::finished(QVariant result, QSharedPointer<EverCloudExceptionData> error) {
+    this->result = result;
+    this->error = error;
+}
+
+
+
+void TestLargeData::spillResourceBody() {
+    qint64 startAnon = anonMemory();
+    if (startAnon < 0)
+        QSKIP("Resident memory can't be measured on this system");
+    peakAnon = startAnon;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LargeReplyServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QTimer sampler;
+    connect(&sampler, SIGNAL(timeout()), this, SLOT(sampleMemory()));
+    sampler.start(5);
+
+    NoteStore noteStore(QString("http://127.0.0.1:%1/edam/note/s1").arg(server.serverPort()), "token");
+    AsyncResult *request = noteStore.getResourceAsync("large-resource", true, false, false, false);
+    request->spillLargeData(dir.path(), SPILL_THRESHOLD);
+    connect(request, SIGNAL(finished(QVariant,QSharedPointer<EverCloudExceptionData>)),
+            this, SLOT(finished(QVariant,QSharedPointer<EverCloudExceptionData>)));
+    QVERIFY(request->waitForFinished(60000));
+    sampler.stop();
+    sampleMemory();
+
+    QVERIFY2(error.isNull(), error.isNull() ? "" : qPrintable(error->errorMessage));
+    Resource resource = result.value<Resource>();
+    QVERIFY(resource.data.isSet());
+    Data data = resource.data;
+    QVERIFY(!data.body.isSet());
+    QCOMPARE(data.bodyHash.ref(), server.bodyHash);
+    QString file = dir.path() + "/" + server.bodyHash.toHex() + ".spill";
+    QCOMPARE(QFileInfo(file).size(), (qint64)LARGE_BODY_SIZE);
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 1);
+
+    // Holding the body (or the reply) in memory would cost at least its size
+    QVERIFY2(peakAnon - startAnon < LARGE_BODY_SIZE/2,
+             qPrintable(QString("Peak memory grew by %1 bytes").arg(peakAnon - startAnon)));
+}
+
+
+
+// A getNote reply as the server would send it
+QByteArray TestLargeData::noteReply(Note note) {
+    ThriftBinaryBufferWriter w;
+    w.writeMessageBegin("getNote", ThriftMessageType::T_REPLY, 0);
+    w.writeStructBegin("getNote_result");
+    w.writeFieldBegin("success", ThriftFieldType::T_STRUCT, 0);
+    writeNote(w, note);
+    w.writeFieldEnd();
+    w.writeFieldStop();
+    w.writeStructEnd();
+    w.writeMessageEnd();
+    return w.buffer();
+}
+
+
+
+// Feed a reply to the spiller 7 bytes at a time, like a slow network would
+bool TestLargeData::spill(QByteArray reply, QString dir, QByteArray &kept) {
+    ReplySpiller spiller(dir, SPILL_THRESHOLD);
+    for (int i=0; i<reply.size(); i+=7) {
+        if (!spiller.write(reply.mid(i, 7)))
+            return false;
+    }
+    if (!spiller.finish())
+        return false;
+    kept = spiller.data();
+    return true;
+}
+
+
+
+// Note content is field 3 too, but isn't Data so it has to stay in the reply
+void TestLargeData::spillOnlyDataBodies() {
+    QTemporaryDir dir;
+    QByteArray large(SPILL_THRESHOLD + 100, 'y');
+    QByteArray small("small body");
+
+    Note note;
+    note.guid = "note-guid";
+    note.content = QString(SPILL_THRESHOLD + 100, QChar('c'));
+    Resource resource;
+    Data data;
+    data.bodyHash = QCryptographicHash::hash(large, QCryptographicHash::Md5);
+    data.size = large.size();
+    data.body = large;
+    resource.data = data;
+    Data recognition;
+    recognition.bodyHash = QCryptographicHash::hash(small, QCryptographicHash::Md5);
+    recognition.size = small.size();
+    recognition.body = small;
+    resource.recognition = recognition;
+    QList<Resource> resources;
+    resources.append(resource);
+    note.resources = resources;
+
+    QByteArray kept;
+    QVERIFY(spill(noteReply(note), dir.path(), kept));
+    QVERIFY(kept.size() < SPILL_THRESHOLD*2);
+
+    ThriftBinaryBufferReader r(kept);
+    QString name;
+    ThriftMessageType::type messageType;
+    qint32 seqid;
+    ThriftFieldType::type fieldType;
+    qint16 fieldId;
+    r.readMessageBegin(name, messageType, seqid);
+    r.readStructBegin(name);
+    r.readFieldBegin(name, fieldType, fieldId);
+    QCOMPARE(fieldId, (qint16)0);
+    Note result;
+    readNote(r, result);
+
+    QCOMPARE(result.content.ref(), note.content.ref());
+    QCOMPARE(result.resources->size(), 1);
+    Resource r0 = result.resources.ref()[0];
+    QVERIFY(!r0.data->body.isSet());
+    QCOMPARE(r0.data->size.ref(), large.size());
+    QCOMPARE(r0.recognition->body.ref(), small);
+
+    QFile file(dir.path() + "/" + data.bodyHash.ref().toHex() + ".spill");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.readAll() == large);
+}
+
+
+
+// A body that doesn't match its hash is an error, and leaves no file behind
+void TestLargeData::spillChecksHash() {
+    QTemporaryDir dir;
+    QByteArray large(SPILL_THRESHOLD + 100, 'y');
+    Note note;
+    note.guid = "note-guid";
+    Resource resource;
+    Data data;
+    data.bodyHash = QCryptographicHash::hash("something else", QCryptographicHash::Md5);
+    data.size = large.size();
+    data.body = large;
+    resource.data = data;
+    QList<Resource> resources;
+    resources.append(resource);
+    note.resources = resources;
+
+    QByteArray kept;
+    QVERIFY(!spill(noteReply(note), dir.path(), kept));
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 0);
+}
+
+QTEST_MAIN(TestLargeData)
+#include "tst_largedata.moc"
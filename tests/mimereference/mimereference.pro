@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Consistency tests for the static mime tables &
+# content sniffing, plus a lookup benchmark.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+
+TARGET = tst_mimereference
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_mimereference.cpp
+TRANSLATIONS =
+INSTALLS =
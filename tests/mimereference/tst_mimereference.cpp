@@ -0,0 +1,147 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include "utilities/mimereference.h"
+
+//**********************************************************
+// Checks the static mime tables are usable (sorted for the
+// binary search & consistent with each other) and that a
+// file's contents only override its extension when they
+// should.
+//**********************************************************
+class TestMimeReference : public QObject
+{
+    Q_OBJECT
+private:
+    void checkSorted(QList< QPair<QString, QString> > table);
+
+private slots:
+    void mimeTableSorted();
+    void extensionTableSorted();
+    void tablesConsistent();
+    void mimeFromData_data();
+    void mimeFromData();
+    void lookupSpeed();
+};
+
+
+
+// Keys must be in strictly increasing order or bsearch misses entries
+void TestMimeReference::checkSorted(QList< QPair<QString, QString> > table) {
+    QVERIFY(table.size() > 0);
+    for (int i=1; i<table.size(); i++) {
+        QVERIFY2(qstrcmp(table[i-1].first.toLatin1(), table[i].first.toLatin1()) < 0,
+                 qPrintable(table[i-1].first + " is not before " + table[i].first));
+    }
+}
+
+
+void TestMimeReference::mimeTableSorted() {
+    checkSorted(MimeReference::mimeTable());
+}
+
+
+void TestMimeReference::extensionTableSorted() {
+    checkSorted(MimeReference::extensionTable());
+}
+
+
+
+// Every extension's mime type must be known, and every mime type
+// with an extension must map back through it.
+void TestMimeReference::tablesConsistent() {
+    MimeReference ref;
+    QList< QPair<QString, QString> > mimes = MimeReference::mimeTable();
+    QList< QPair<QString, QString> > extensions = MimeReference::extensionTable();
+    QSet<QString> knownMimes;
+    QSet<QString> knownExtensions;
+    for (int i=0; i<mimes.size(); i++)
+        knownMimes.insert(mimes[i].first);
+    for (int i=0; i<extensions.size(); i++)
+        knownExtensions.insert(extensions[i].first);
+
+    for (int i=0; i<extensions.size(); i++) {
+        QString ext = extensions[i].first;
+        QVERIFY2(knownMimes.contains(extensions[i].second), qPrintable(ext + " -> " + extensions[i].second));
+        QCOMPARE(ref.getMimeFromExtension(ext), extensions[i].second);
+    }
+    for (int i=0; i<mimes.size(); i++) {
+        QString mime = mimes[i].first;
+        QCOMPARE(ref.getExtensionFromMime(mime, QString("")), mimes[i].second);
+        if (!mimes[i].second.startsWith("."))
+            continue;
+        QVERIFY2(knownExtensions.contains(mimes[i].second), qPrintable(mime + " -> " + mimes[i].second));
+        QVERIFY(knownMimes.contains(ref.getMimeFromExtension(mimes[i].second)));
+    }
+}
+
+
+
+void TestMimeReference::mimeFromData_data() {
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QString>("mime");
+
+    QByteArray png("\x89PNG\r\n\x1a\n\0\0\0\rIHDR", 16);
+    QByteArray zip("PK\x03\x04\x14\0\0\0", 8);
+
+    // Strong signatures beat a wrong extension
+    QTest::newRow("png named jpg") << png << "photo.jpg" << "image/png";
+    QTest::newRow("pdf no extension") << QByteArray("%PDF-1.4\n") << "scan" << "application/pdf";
+    QTest::newRow("docx is a zip") << zip << "report.docx"
+                                   << "application/vnd.openxmlformats-officedocument.wordprocessingml.document";
+    QTest::newRow("zip unknown extension") << zip << "archive.zzz" << "application/zip";
+
+    // Text files can start with anything
+    QTest::newRow("text MZ") << QByteArray("MZ is a postcode") << "notes.txt" << "text/plain";
+    QTest::newRow("text ID3") << QByteArray("ID3 tags explained") << "tags.txt" << "text/plain";
+    QTest::newRow("csv BZh") << QByteArray("BZh,1,2\n") << "data.csv" << "text/csv";
+    QTest::newRow("html PS") << QByteArray("%!PS not really") << "page.html" << "text/html";
+    QTest::newRow("text png") << png << "readme.txt" << "text/plain";
+
+    // Weak signatures only fill in for an unknown extension
+    QTest::newRow("exe MZ") << QByteArray("MZ\x90\0", 4) << "setup.exe" << "application/x-msdownload";
+    QTest::newRow("ogg unknown") << QByteArray("OggS\0\x02", 6) << "clip.zzz" << "audio/ogg";
+    QTest::newRow("mp3 frame known") << QByteArray("\xff\xfb\x90\x64", 4) << "sound.wav" << "audio/x-wav";
+    QTest::newRow("nothing recognized") << QByteArray("hello") << "hello.zzz" << "application/data";
+}
+
+
+void TestMimeReference::mimeFromData() {
+    QFETCH(QByteArray, data);
+    QFETCH(QString, fileName);
+    QFETCH(QString, mime);
+    MimeReference ref;
+    QCOMPARE(ref.getMimeFromData(data, fileName), mime);
+}
+
+
+
+// The lookups used for every resource in an import
+void TestMimeReference::lookupSpeed() {
+    QBENCHMARK {
+        MimeReference ref;
+        ref.getExtensionFromMime(QString("image/png"), QString(""));
+        ref.getMimeFromFileName(QString("report.pdf"));
+    }
+}
+
+QTEST_MAIN(TestMimeReference)
+#include "tst_mimereference.moc"
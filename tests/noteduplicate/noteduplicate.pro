@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Duplicating a note with a large PDF shares the
+# attachment's file, & changing either copy must
+# leave the other alone.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_noteduplicate
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_noteduplicate.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,225 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QDir>
+#include <QCryptographicHash>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+#include "testdatabase.h"
+#include "sql/notetable.h"
+#include "sql/resourcetable.h"
+#include "global.h"
+
+extern Global global;
+
+#define PDF_SIZE 20971520
+
+//**********************************************************
+// Duplicating a note with a large PDF.  The copy's data
+// file is a second name for the original's, so rewriting,
+// editing or removing either one must not show through in
+// the other.
+//**********************************************************
+class TestNoteDuplicate : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    QByteArray pdf;
+    qint32 noteLid;
+    qint32 resourceLid;
+
+    qint32 duplicate(qint32 &copyResourceLid);
+    qint32 firstResource(qint32 lid);
+    static QString resourceFile(qint32 lid);
+    static QByteArray readFile(QString path);
+
+private slots:
+    void initTestCase();
+    void sharesData();
+    void rewriteLeavesSibling();
+    void editInPlaceLeavesSibling();
+    void expungeLeavesSibling();
+    void benchmarkDuplicate();
+    void benchmarkCopyFile();
+};
+
+
+
+void TestNoteDuplicate::initTestCase() {
+    QVERIFY(database.open());
+    pdf = "%PDF-1.4\n";
+    pdf.reserve(PDF_SIZE);
+    while (pdf.size() < PDF_SIZE)
+        pdf.append("% filler to make the document large\n");
+    qint32 notebookLid = database.addNotebook("Duplicates");
+    QList<QByteArray> attachments;
+    attachments.append(pdf);
+    noteLid = database.addNote(notebookLid, "Large PDF", attachments, "application/pdf", "large.pdf");
+    resourceLid = firstResource(noteLid);
+    QVERIFY(resourceLid > 0);
+    QVERIFY(readFile(resourceFile(resourceLid)) == pdf);
+}
+
+
+
+qint32 TestNoteDuplicate::duplicate(qint32 &copyResourceLid) {
+    NoteTable noteTable(database.db);
+    qint32 copyLid = noteTable.duplicateNote(noteLid);
+    copyResourceLid = firstResource(copyLid);
+    return copyLid;
+}
+
+
+
+qint32 TestNoteDuplicate::firstResource(qint32 lid) {
+    ResourceTable resourceTable(database.db);
+    QList<qint32> lids;
+    resourceTable.getResourceList(lids, lid);
+    if (lids.size() == 0)
+        return 0;
+    return lids[0];
+}
+
+
+
+// The data file of a resource, whatever its extension
+QString TestNoteDuplicate::resourceFile(qint32 lid) {
+    QDir dir(global.fileManager.getDbaDirPath());
+    QStringList files = dir.entryList(QStringList() << QString::number(lid)+".*", QDir::Files);
+    if (files.size() == 0)
+        return "";
+    return dir.absoluteFilePath(files[0]);
+}
+
+
+
+QByteArray TestNoteDuplicate::readFile(QString path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+
+
+// The copy has the same data without a second copy of it on disk
+void TestNoteDuplicate::sharesData() {
+    qint32 copyResourceLid;
+    qint32 copyLid = duplicate(copyResourceLid);
+    QVERIFY(copyLid > 0);
+    QVERIFY(copyResourceLid > 0 && copyResourceLid != resourceLid);
+    QString copyFile = resourceFile(copyResourceLid);
+    QVERIFY(copyFile.endsWith(".pdf"));
+    QVERIFY(readFile(copyFile) == pdf);
+
+#ifndef _WIN32
+    struct stat original, copy;
+    QCOMPARE(stat(QFile::encodeName(resourceFile(resourceLid)).constData(), &original), 0);
+    QCOMPARE(stat(QFile::encodeName(copyFile).constData(), &copy), 0);
+    QVERIFY(original.st_ino == copy.st_ino);
+    QVERIFY(copy.st_nlink >= 2);
+#endif
+}
+
+
+
+// Saving new data for the copy, as an edit or sync does, replaces its
+// file.  The original keeps its data.
+void TestNoteDuplicate::rewriteLeavesSibling() {
+    qint32 copyResourceLid;
+    qint32 copyLid = duplicate(copyResourceLid);
+    ResourceTable resourceTable(database.db);
+    Resource r;
+    QVERIFY(resourceTable.get(r, copyResourceLid, false));
+
+    QByteArray rewritten = "%PDF-1.4\n% a different document\n";
+    Data data;
+    data.body = rewritten;
+    data.size = rewritten.size();
+    data.bodyHash = QCryptographicHash::hash(rewritten, QCryptographicHash::Md5);
+    r.data = data;
+    resourceTable.add(copyResourceLid, r, true, copyLid);
+
+    QVERIFY(readFile(resourceFile(copyResourceLid)) == rewritten);
+    QVERIFY(readFile(resourceFile(resourceLid)) == pdf);
+}
+
+
+
+// Something changing the copy's file in place (an external editor)
+// has to stop sharing it first.
+void TestNoteDuplicate::editInPlaceLeavesSibling() {
+    qint32 copyResourceLid;
+    duplicate(copyResourceLid);
+    QString copyFile = resourceFile(copyResourceLid);
+    global.fileManager.unshareDbaFile(copyFile);
+
+    QFile file(copyFile);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(PDF_SIZE/2));
+    QCOMPARE(file.write("edited"), (qint64) 6);
+    file.close();
+
+    QByteArray edited = readFile(copyFile);
+    QCOMPARE(edited.mid(PDF_SIZE/2, 6), QByteArray("edited"));
+    QVERIFY(readFile(resourceFile(resourceLid)) == pdf);
+}
+
+
+
+// Expunging the copy removes only its name for the data
+void TestNoteDuplicate::expungeLeavesSibling() {
+    qint32 copyResourceLid;
+    qint32 copyLid = duplicate(copyResourceLid);
+    NoteTable noteTable(database.db);
+    noteTable.expunge(copyLid);
+    QCOMPARE(resourceFile(copyResourceLid), QString(""));
+    QVERIFY(readFile(resourceFile(resourceLid)) == pdf);
+}
+
+
+
+// Duplicating the note, data & all
+void TestNoteDuplicate::benchmarkDuplicate() {
+    qint32 copyResourceLid = 0;
+    QBENCHMARK {
+        duplicate(copyResourceLid);
+    }
+    QVERIFY(copyResourceLid > 0);
+}
+
+
+
+// What duplicating used to cost for the attachment alone
+void TestNoteDuplicate::benchmarkCopyFile() {
+    QString source = resourceFile(resourceLid);
+    QString target = global.fileManager.getDbaDirPath() + "copy.pdf";
+    QBENCHMARK {
+        QFile::remove(target);
+        QFile::copy(source, target);
+    }
+    QVERIFY(readFile(target) == pdf);
+    QFile::remove(target);
+}
+
+QTEST_MAIN(TestNoteDuplicate)
+#include "tst_noteduplicate.moc"
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Golden output tests for the ENML renderer.  The
+# program's own project file is used so the formatter
+# is built exactly as it is in NixNote.  The old DOM
+# based formatter is built alongside as the baseline.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_noteformatter
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+HEADERS += legacynoteformatter.h
+SOURCES += legacynoteformatter.cpp \
+           tst_noteformatter.cpp
+DEFINES += FIXTURE_DIR=\\\"$$PWD/fixtures/\\\"
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,320 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QFile>
+#include <QBuffer>
+#include <QImage>
+#include <QUuid>
+#include <QWebPage>
+#include <QWebFrame>
+#include <QWebElement>
+#include "testdatabase.h"
+#include "legacynoteformatter.h"
+#include "html/noteformatter.h"
+#include "html/enmltag.h"
+#include "sql/notetable.h"
+#include "sql/notebooktable.h"
+#include "filters/filtercriteria.h"
+#include "global.h"
+
+extern Global global;
+
+#define LARGE_NOTE_PARAGRAPHS 2000
+
+//**********************************************************
+// Golden output tests for the ENML renderer.  The baseline
+// is the DOM based formatter the renderer replaced, kept in
+// legacynoteformatter.cpp.  Each ENML file in the fixtures
+// directory is rendered by both & the documents compared.
+// Running with NIXNOTE_CAPTURE_GOLDEN=1 writes the baseline
+// output to the fixtures directory.  Once a golden file is
+// there it is checked as well, so the renderer is still
+// held to it after the old formatter is gone.
+//**********************************************************
+class TestNoteFormatter : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    qint32 notebookLid;
+    QString notebookGuid;
+    QString readFixture(QString name);
+    void writeFixture(QString name, QString text);
+    Note addNote(QString enml);
+    QString largeNote();
+    QString render(Note &note);
+    QString renderLegacy(Note &note);
+    QString normalize(QString html);
+    void normalizeElement(QWebElement element, QString &out);
+
+private slots:
+    void initTestCase();
+    void renderEnml_data();
+    void renderEnml();
+    void latexLink();
+    void unescapeEntities();
+    void benchmarkRender_data();
+    void benchmarkRender();
+    void benchmarkLegacyRender_data();
+    void benchmarkLegacyRender();
+};
+
+
+
+void TestNoteFormatter::initTestCase() {
+    QVERIFY(database.open());
+    notebookLid = database.addNotebook("Formatter");
+    NotebookTable notebookTable(database.db);
+    notebookTable.getGuid(notebookGuid, notebookLid);
+
+    // Both formatters look at the current search to highlight matches
+    if (global.filterCriteria.size() == 0) {
+        global.filterCriteria.append(new FilterCriteria());
+        global.filterPosition = 0;
+    }
+}
+
+
+
+QString TestNoteFormatter::readFixture(QString name) {
+    QFile file(QString(FIXTURE_DIR) + name);
+    if (!file.open(QIODevice::ReadOnly))
+        return "";
+    return QString::fromUtf8(file.readAll()).trimmed();
+}
+
+
+
+void TestNoteFormatter::writeFixture(QString name, QString text) {
+    QFile file(QString(FIXTURE_DIR) + name);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(text.toUtf8() + "\n");
+}
+
+
+
+// Save a note using the fixture's ENML.  Each HASHn placeholder becomes
+// a resource of the type given in its en-media tag.  Image resources
+// get a real picture so the image code paths are taken.
+Note TestNoteFormatter::addNote(QString enml) {
+    Note note;
+    note.guid = QUuid::createUuid().toString().remove("{").remove("}");
+    note.title = "Formatter";
+    note.notebookGuid = notebookGuid;
+    note.active = true;
+    note.created = QDateTime::currentMSecsSinceEpoch();
+    note.updated = note.created;
+
+    QList<Resource> resources;
+    QRegExp media("<en-media type=\"([^\"]*)\" hash=\"(HASH\\d+)\"");
+    qint32 pos = 0;
+    while ((pos = media.indexIn(enml, pos)) != -1) {
+        QString mime = media.cap(1);
+        QString placeholder = media.cap(2);
+        QByteArray data = placeholder.toUtf8() + " data";
+        if (mime.startsWith("image/")) {
+            QImage image(16, 16, QImage::Format_RGB32);
+            image.fill(QColor(Qt::blue).rgb());
+            data.clear();
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::WriteOnly);
+            image.save(&buffer, mime == "image/jpeg" ? "JPG" : "PNG");
+        }
+        Resource r;
+        Data d;
+        d.body = data;
+        d.size = data.size();
+        d.bodyHash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+        r.guid = QUuid::createUuid().toString().remove("{").remove("}");
+        r.noteGuid = note.guid;
+        r.mime = mime;
+        r.data = d;
+        r.active = true;
+        ResourceAttributes attributes;
+        attributes.fileName = placeholder.toLower() + "." + mime.section('/', 1);
+        if (enml.indexOf("latex.codecogs.com") != -1)
+            attributes.sourceURL = "http://latex.codecogs.com/gif.latex?x^2";
+        r.attributes = attributes;
+        resources.append(r);
+        enml.replace("\"" + placeholder + "\"", "\"" + TestDatabase::hashHex(data) + "\"");
+        pos = 0;
+    }
+    note.content = enml;
+    note.resources = resources;
+
+    NoteTable noteTable(database.db);
+    noteTable.add(0, note, false, notebookLid);
+    return note;
+}
+
+
+
+// A long note with the usual mix of text, links & to-do items
+QString TestNoteFormatter::largeNote() {
+    QString enml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<!DOCTYPE en-note SYSTEM \"http://xml.evernote.com/pub/enml2.dtd\"><en-note>";
+    for (int i=0; i<LARGE_NOTE_PARAGRAPHS; i++) {
+        QString n = QString::number(i);
+        enml += "<div><en-todo checked=\"" + QString(i%2 ? "true" : "false") + "\"/>Item " + n
+                + " &amp; <b>bold</b> <a href=\"http://example.com/" + n + "\">link " + n + "</a></div>";
+    }
+    enml += "<div><en-media type=\"image/png\" hash=\"HASH1\"/></div></en-note>";
+    return enml;
+}
+
+
+
+QString TestNoteFormatter::render(Note &note) {
+    global.cryptCounter = 0;
+    NoteFormatter formatter;
+    formatter.setNote(note, false);
+    return QString::fromUtf8(formatter.rebuildNoteHTML());
+}
+
+
+
+QString TestNoteFormatter::renderLegacy(Note &note) {
+    global.cryptCounter = 0;
+    LegacyNoteFormatter formatter;
+    formatter.setNote(note, false);
+    return QString::fromUtf8(formatter.rebuildNoteHTML());
+}
+
+
+
+// Reduce a rendered page to what the editor sees: the DOM WebKit builds
+// from it, with attributes sorted, and its text.  Quoting & attribute
+// order are serialization details the two formatters don't share.  Icon
+// files are generated per run, so only the fact there is one is kept.
+QString TestNoteFormatter::normalize(QString html) {
+    QWebPage page;
+    page.mainFrame()->setHtml(html);
+    QString out;
+    normalizeElement(page.mainFrame()->findFirstElement("body"), out);
+    out += "\n" + page.mainFrame()->toPlainText();
+    out.replace(QRegExp("[^\"]*_icon\\.png"), "ICON");
+    out.replace(global.fileManager.getDbaDirPath(), "DBA/");
+    out.replace(global.fileManager.getTmpDirPath(), "TMP/");
+    return out;
+}
+
+
+
+void TestNoteFormatter::normalizeElement(QWebElement element, QString &out) {
+    QStringList attributes = element.attributeNames();
+    attributes.sort();
+    out += "<" + element.tagName().toLower();
+    for (int i=0; i<attributes.size(); i++)
+        out += " " + attributes[i] + "=\"" + element.attribute(attributes[i]) + "\"";
+    out += ">";
+    for (QWebElement child = element.firstChild(); !child.isNull(); child = child.nextSibling())
+        normalizeElement(child, out);
+    out += "</" + element.tagName().toLower() + ">";
+}
+
+
+
+void TestNoteFormatter::renderEnml_data() {
+    QTest::addColumn<QString>("fixture");
+    QTest::newRow("basic") << "basic";
+    QTest::newRow("todo") << "todo";
+    QTest::newRow("links") << "links";
+    QTest::newRow("media") << "media";
+    QTest::newRow("crypt") << "crypt";
+}
+
+
+
+void TestNoteFormatter::renderEnml() {
+    QFETCH(QString, fixture);
+    QString enml = readFixture(fixture + ".enml");
+    QVERIFY(enml != "");
+
+    Note note = addNote(enml);
+    QString expected = normalize(renderLegacy(note));
+    if (qgetenv("NIXNOTE_CAPTURE_GOLDEN") == "1")
+        writeFixture(fixture + ".html", expected);
+    QString actual = normalize(render(note));
+    QCOMPARE(actual, expected);
+
+    QString golden = readFixture(fixture + ".html");
+    if (golden != "")
+        QCOMPARE(actual.trimmed(), golden);
+}
+
+
+
+// The LaTeX image is found from the resource index, not a DOM lookup
+void TestNoteFormatter::latexLink() {
+    NoteFormatter formatter;
+    formatter.lidByHash.insert("abcdef", 7);
+    QString html = formatter.renderEnml("<en-note><a href=\"http://latex.codecogs.com/gif.latex?x^2\">"
+                                        "<en-media type=\"image/gif\" hash=\"ABCDEF\"/></a></en-note>");
+    QVERIFY(html.contains("href=\"latex:///7\""));
+    QVERIFY(html.contains("title=\"x^2\""));
+}
+
+
+
+// Characters outside the basic plane need a surrogate pair
+void TestNoteFormatter::unescapeEntities() {
+    uint fish = 0x1F41F;
+    QCOMPARE(EnmlTag::unescape("&#x1F41F;"), QString::fromUcs4(&fish, 1));
+    QCOMPARE(EnmlTag::unescape("&#128031;"), QString::fromUcs4(&fish, 1));
+    QCOMPARE(EnmlTag::unescape("a &lt;&amp;&gt; b"), QString("a <&> b"));
+    QCOMPARE(EnmlTag::unescape("&#xZZ;"), QString("&#xZZ;"));
+}
+
+
+
+void TestNoteFormatter::benchmarkRender_data() {
+    renderEnml_data();
+    QTest::newRow("large") << "large";
+}
+
+
+
+void TestNoteFormatter::benchmarkRender() {
+    QFETCH(QString, fixture);
+    Note note = addNote(fixture == "large" ? largeNote() : readFixture(fixture + ".enml"));
+    QBENCHMARK {
+        render(note);
+    }
+}
+
+
+
+void TestNoteFormatter::benchmarkLegacyRender_data() {
+    benchmarkRender_data();
+}
+
+
+
+void TestNoteFormatter::benchmarkLegacyRender() {
+    QFETCH(QString, fixture);
+    Note note = addNote(fixture == "large" ? largeNote() : readFixture(fixture + ".enml"));
+    QBENCHMARK {
+        renderLegacy(note);
+    }
+}
+
+
+QTEST_MAIN(TestNoteFormatter)
+#include "tst_noteformatter.moc"
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Note history against a fake NoteStore: only the
+# list of versions is fetched ahead of time, the
+# attachments only when a version is restored, &
+# the cache of versions is kept to its size.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_notehistory
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_notehistory.cpp
+TRANSLATIONS =
+INSTALLS =
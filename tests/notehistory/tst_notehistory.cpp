@@ -0,0 +1,302 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QUuid>
+#include <QCryptographicHash>
+#include "testdatabase.h"
+#include "fakenotestore.h"
+#include "threads/notehistoryrunner.h"
+#include "sql/noteversiontable.h"
+#include "sql/notetable.h"
+#include "sql/nsqlquery.h"
+
+#define VERSION_COUNT 3
+#define VERSION_SIZE 100000
+#define VERSION_WAIT 100
+#define VERSION_WAIT_STEP 50
+
+//**********************************************************
+// The history runner talking to a fake NoteStore.  The note
+// has an attachment we already have & one that was removed
+// since, so restoring a version has to download just that
+// one.
+//**********************************************************
+class TestNoteHistory : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    FakeNoteStore server;
+    NoteStore *noteStore;
+    NoteHistoryRunner runner;
+    QString guid;
+    QByteArray keptData;
+    QByteArray removedData;
+    QString removedGuid;
+    QList<qint32> readyUsns;
+    QList<bool> readyFound;
+
+    bool waitForVersion(qint32 usn);
+    int cachedVersions();
+    static Resource makeResource(QString noteGuid, const QByteArray &body);
+
+public slots:
+    void versionReady(QString guid, qint32 usn, bool found);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void listsOnlyMetadata();
+    void prefetchSkipsData();
+    void restoreFillsData();
+    void cancelDropsQueue();
+    void cacheKeptToSize();
+};
+
+
+
+Resource TestNoteHistory::makeResource(QString noteGuid, const QByteArray &body) {
+    Resource r;
+    Data data;
+    data.body = body;
+    data.size = body.size();
+    data.bodyHash = QCryptographicHash::hash(body, QCryptographicHash::Md5);
+    r.guid = QUuid::createUuid().toString().remove("{").remove("}");
+    r.noteGuid = noteGuid;
+    r.mime = "application/octet-stream";
+    r.data = data;
+    r.active = true;
+    return r;
+}
+
+
+
+// The runner normally connects to Evernote itself.  Point it at the
+// fake NoteStore instead.
+void TestNoteHistory::initTestCase() {
+    QVERIFY(database.open());
+    QVERIFY(server.start());
+    runner.init = true;
+    runner.connected = true;
+    runner.db = database.db;
+    runner.comm = new CommunicationManager(database.db);
+    noteStore = new NoteStore(server.url(), "token");
+    runner.comm->noteStore = noteStore;
+    runner.comm->initComplete = true;
+    connect(&runner, SIGNAL(versionReady(QString,qint32,bool)), this, SLOT(versionReady(QString,qint32,bool)));
+
+    keptData = QByteArray(VERSION_SIZE, 'k');
+    removedData = QByteArray(VERSION_SIZE, 'r');
+    qint32 notebookLid = database.addNotebook("History");
+    QList<QByteArray> attachments;
+    attachments.append(keptData);
+    qint32 lid = database.addNote(notebookLid, "Current", attachments);
+    NoteTable noteTable(database.db);
+    guid = noteTable.getGuid(lid);
+
+    QList<Note> versions;
+    for (int i=VERSION_COUNT; i>0; i--) {
+        Note version;
+        version.guid = guid;
+        version.title = "Version " + QString::number(i);
+        version.content = "<en-note>Version " + QString::number(i) + "</en-note>";
+        version.updateSequenceNum = i;
+        version.updated = i*1000;
+        QList<Resource> resources;
+        resources.append(makeResource(guid, keptData));
+        Resource removed = makeResource(guid, removedData);
+        if (removedGuid == "") {
+            removedGuid = removed.guid;
+            server.resources.insert(removedGuid, removed);
+        }
+        removed.guid = removedGuid;
+        resources.append(removed);
+        version.resources = resources;
+        versions.append(version);
+    }
+    server.versions.insert(guid, versions);
+}
+
+
+
+void TestNoteHistory::cleanupTestCase() {
+    delete noteStore;
+}
+
+
+
+void TestNoteHistory::init() {
+    server.calls.clear();
+    readyUsns.clear();
+    readyFound.clear();
+    NSqlQuery query(database.db);
+    query.exec("Delete from NoteVersionList");
+    query.exec("Delete from NoteVersionCache");
+    query.finish();
+}
+
+
+
+void TestNoteHistory::versionReady(QString guid, qint32 usn, bool found) {
+    Q_UNUSED(guid);
+    readyUsns.append(usn);
+    readyFound.append(found);
+}
+
+
+
+bool TestNoteHistory::waitForVersion(qint32 usn) {
+    for (int i=0; i<VERSION_WAIT && !readyUsns.contains(usn); i++)
+        QTest::qWait(VERSION_WAIT_STEP);
+    return readyUsns.contains(usn);
+}
+
+
+
+int TestNoteHistory::cachedVersions() {
+    int count = 0;
+    NSqlQuery query(database.db);
+    query.exec("Select count(*) from NoteVersionCache");
+    if (query.next())
+        count = query.value(0).toInt();
+    query.finish();
+    return count;
+}
+
+
+
+// Staying on a note only lists its versions.  Nothing is downloaded,
+// and the list isn't asked for again while the note is unchanged.
+void TestNoteHistory::listsOnlyMetadata() {
+    runner.loadVersions(guid, VERSION_COUNT+1);
+    QTest::qWait(VERSION_WAIT_STEP);
+    QCOMPARE(server.calls, QStringList() << "listNoteVersions");
+    QCOMPARE(cachedVersions(), 0);
+
+    NoteVersionTable versionTable(database.db);
+    QList<NoteVersionId> versions;
+    QVERIFY(versionTable.getVersions(guid, VERSION_COUNT+1, versions));
+    QCOMPARE(versions.size(), VERSION_COUNT);
+    QCOMPARE(versions[0].updateSequenceNum, VERSION_COUNT);
+
+    runner.loadVersions(guid, VERSION_COUNT+1);
+    QCOMPARE(server.calls.size(), 1);
+}
+
+
+
+// Versions got ready while the dialog is open don't carry their
+// attachments' data.
+void TestNoteHistory::prefetchSkipsData() {
+    for (int usn=VERSION_COUNT; usn>0; usn--)
+        runner.loadVersion(guid, usn, false);
+    QVERIFY(waitForVersion(1));
+    QCOMPARE(server.calls.count("getNoteVersion"), VERSION_COUNT);
+    QCOMPARE(server.calls.count("getResourceData"), 0);
+    QVERIFY(!readyFound.contains(false));
+
+    NoteVersionTable versionTable(database.db);
+    Note note;
+    QVERIFY(versionTable.getVersion(guid, VERSION_COUNT, note));
+    QList<Resource> resources = note.resources;
+    QCOMPARE(resources.size(), 2);
+    for (int i=0; i<resources.size(); i++) {
+        QVERIFY(resources[i].data->bodyHash.isSet());
+        QVERIFY(!resources[i].data->body.isSet());
+    }
+}
+
+
+
+// Restoring a version fills in its attachments.  The one we still
+// have is copied from the note; only the removed one is downloaded.
+void TestNoteHistory::restoreFillsData() {
+    runner.loadVersion(guid, VERSION_COUNT, false);
+    QVERIFY(waitForVersion(VERSION_COUNT));
+    readyUsns.clear();
+    readyFound.clear();
+
+    runner.loadVersion(guid, VERSION_COUNT, true);
+    QVERIFY(waitForVersion(VERSION_COUNT));
+    QVERIFY(readyFound[0]);
+    QCOMPARE(server.calls.count("getNoteVersion"), 1);
+    QCOMPARE(server.calls.count("getResourceData"), 1);
+
+    NoteVersionTable versionTable(database.db);
+    Note note;
+    QVERIFY(versionTable.getVersion(guid, VERSION_COUNT, note));
+    QList<Resource> resources = note.resources;
+    QCOMPARE(resources.size(), 2);
+    QVERIFY(resources[0].data->body.ref() == keptData);
+    QVERIFY(resources[1].data->body.ref() == removedData);
+
+    // It is complete now, so restoring it again needs nothing
+    readyUsns.clear();
+    runner.loadVersion(guid, VERSION_COUNT, true);
+    QVERIFY(waitForVersion(VERSION_COUNT));
+    QCOMPARE(server.calls.count("getNoteVersion"), 1);
+    QCOMPARE(server.calls.count("getResourceData"), 1);
+}
+
+
+
+// Closing the dialog drops what was being got ready
+void TestNoteHistory::cancelDropsQueue() {
+    for (int usn=VERSION_COUNT; usn>0; usn--)
+        runner.loadVersion(guid, usn, false);
+    runner.cancelVersions();
+    QTest::qWait(VERSION_WAIT_STEP*4);
+    QCOMPARE(server.calls.size(), 0);
+    QCOMPARE(cachedVersions(), 0);
+}
+
+
+
+// The least recently used versions go first, & reading a version
+// counts as using it.
+void TestNoteHistory::cacheKeptToSize() {
+    NoteVersionTable versionTable(database.db);
+    for (int usn=1; usn<=4; usn++) {
+        Note note;
+        note.guid = guid;
+        note.updateSequenceNum = usn;
+        note.content = QString(VERSION_SIZE, 'a'+usn);
+        versionTable.saveVersion(guid, usn, note);
+    }
+    QCOMPARE(cachedVersions(), 4);
+
+    Note note;
+    QVERIFY(versionTable.getVersion(guid, 1, note));
+    versionTable.trim(VERSION_SIZE*2 + VERSION_SIZE/2);
+    QCOMPARE(cachedVersions(), 2);
+    QVERIFY(versionTable.hasVersion(guid, 1));
+    QVERIFY(versionTable.hasVersion(guid, 4));
+    QVERIFY(!versionTable.hasVersion(guid, 2));
+    QVERIFY(!versionTable.hasVersion(guid, 3));
+
+    // The newest is kept even if it is too big on its own
+    versionTable.trim(0);
+    QCOMPARE(cachedVersions(), 1);
+    QVERIFY(versionTable.hasVersion(guid, 1));
+}
+
+QTEST_MAIN(TestNoteHistory)
+#include "tst_notehistory.moc"
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Uploading dirty notes to a fake NoteStore &
+# recording what it accepted.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_noteupload
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_noteupload.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,164 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include "testdatabase.h"
+#include "fakenotestore.h"
+#include "communication/noteuploader.h"
+#include "sql/notetable.h"
+#include "sql/nsqlquery.h"
+
+//**********************************************************
+// Sending dirty notes to Evernote & recording the guid &
+// USN it gives back.  The notes are only marked clean if
+// all of that is saved; otherwise they stay dirty so they
+// are sent again on the next sync.
+//**********************************************************
+class TestNoteUpload : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    FakeNoteStore server;
+    qint32 notebookLid;
+    qint32 addDirtyNote(QString title);
+    bool upload(QList<qint32> lids, QList<NoteUploader::Result> &uploaded);
+
+private slots:
+    void initTestCase();
+    void createsAndUpdates();
+    void failedUploadStaysDirty();
+    void saveRollsBack();
+};
+
+
+
+void TestNoteUpload::initTestCase() {
+    QVERIFY(database.open());
+    QVERIFY(server.start());
+    notebookLid = database.addNotebook("Upload");
+}
+
+
+
+qint32 TestNoteUpload::addDirtyNote(QString title) {
+    qint32 lid = database.addNote(notebookLid, title, QList<QByteArray>());
+    NoteTable noteTable(database.db);
+    noteTable.setDirty(lid, true);
+    return lid;
+}
+
+
+
+bool TestNoteUpload::upload(QList<qint32> lids, QList<NoteUploader::Result> &uploaded) {
+    NoteStore noteStore(server.url(), "token");
+    NoteUploader uploader(database.db, &noteStore, "token", 4);
+    for (int i=0; i<lids.size(); i++)
+        uploader.addNote(lids[i]);
+    bool rc = uploader.upload();
+    uploaded = uploader.uploaded;
+    return rc;
+}
+
+
+
+// New notes are created & get the server's guid; notes the server
+// already has are updated in place.
+void TestNoteUpload::createsAndUpdates() {
+    NoteTable noteTable(database.db);
+    qint32 first = addDirtyNote("First");
+    qint32 second = addDirtyNote("Second");
+    qint32 existing = addDirtyNote("Existing");
+    QString localGuid = noteTable.getGuid(first);
+    QString existingGuid = noteTable.getGuid(existing);
+    noteTable.setUpdateSequenceNumber(existing, 5);
+    Note original;
+    original.guid = existingGuid;
+    original.updateSequenceNum = 5;
+    server.notes.insert(existingGuid, original);
+    server.calls.clear();
+
+    QList<NoteUploader::Result> uploaded;
+    QVERIFY(upload(QList<qint32>() << first << second << existing, uploaded));
+    QCOMPARE(uploaded.size(), 3);
+    QCOMPARE(server.calls.count("createNote"), 2);
+    QCOMPARE(server.calls.count("updateNote"), 1);
+    QVERIFY(NoteUploader::save(database.db, uploaded));
+
+    QVERIFY(noteTable.getGuid(first) != localGuid);
+    QVERIFY(server.notes.contains(noteTable.getGuid(first)));
+    QCOMPARE(server.notes[noteTable.getGuid(first)].title.ref(), QString("First"));
+    QCOMPARE(noteTable.getGuid(existing), existingGuid);
+    QCOMPARE(noteTable.getUpdateSequenceNumber(existing), server.notes[existingGuid].updateSequenceNum.ref());
+    QVERIFY(!noteTable.isDirty(first));
+    QVERIFY(!noteTable.isDirty(second));
+    QVERIFY(!noteTable.isDirty(existing));
+}
+
+
+
+// A note the server refused is not in the results, so it stays dirty
+void TestNoteUpload::failedUploadStaysDirty() {
+    NoteTable noteTable(database.db);
+    qint32 lid = addDirtyNote("Refused");
+    server.failNext = 1;
+    QList<NoteUploader::Result> uploaded;
+    QVERIFY(!upload(QList<qint32>() << lid, uploaded));
+    QVERIFY(uploaded.isEmpty());
+    QVERIFY(NoteUploader::save(database.db, uploaded));
+    QVERIFY(noteTable.isDirty(lid));
+}
+
+
+
+// If one note can't be recorded none of them are
+void TestNoteUpload::saveRollsBack() {
+    NoteTable noteTable(database.db);
+    qint32 first = addDirtyNote("Kept dirty 1");
+    qint32 second = addDirtyNote("Kept dirty 2");
+    QString firstGuid = noteTable.getGuid(first);
+    QString secondGuid = noteTable.getGuid(second);
+    QList<NoteUploader::Result> uploaded;
+    QVERIFY(upload(QList<qint32>() << first << second, uploaded));
+    QCOMPARE(uploaded.size(), 2);
+
+    NSqlQuery query(database.db);
+    QVERIFY(query.exec("create temp trigger refuseUsn before update on DataStore when new.lid="
+                       + QString::number(second) + " and new.key="
+                       + QString::number(NOTE_UPDATE_SEQUENCE_NUMBER)
+                       + " begin select raise(abort, 'refused'); end"));
+    QVERIFY(!NoteUploader::save(database.db, uploaded));
+    QVERIFY(query.exec("drop trigger refuseUsn"));
+    query.finish();
+
+    QCOMPARE(noteTable.getGuid(first), firstGuid);
+    QCOMPARE(noteTable.getGuid(second), secondGuid);
+    QCOMPARE(noteTable.getUpdateSequenceNumber(first), 0);
+    QVERIFY(noteTable.isDirty(first));
+    QVERIFY(noteTable.isDirty(second));
+
+    // Nothing is left open, so the next save goes through
+    QVERIFY(NoteUploader::save(database.db, uploaded));
+    QVERIFY(!noteTable.isDirty(first));
+    QVERIFY(!noteTable.isDirty(second));
+}
+
+
+QTEST_MAIN(TestNoteUpload)
+#include "tst_noteupload.moc"
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Pulling the text out of a 500 page PDF, the per
+# page text cache & cleaning both up when the
+# resource is expunged.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_pdftext
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_pdftext.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,254 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QPrinter>
+#include <QPainter>
+#include "testdatabase.h"
+#include "threads/indexrunner.h"
+#include "sql/pdftexttable.h"
+#include "sql/resourcetable.h"
+#include "sql/nsqlquery.h"
+#if QT_VERSION < 0x050000
+#include <poppler-qt4.h>
+#else
+#include <poppler-qt5.h>
+#endif
+
+#define PDF_PAGES 500
+
+//**********************************************************
+// The text of a PDF is pulled out once, page by page, &
+// cached.  Each page is indexed as its own search row on
+// the resource, so those rows & the cache have to go when
+// the resource does.
+//**********************************************************
+class TestPdfText : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    QString pdfFile;
+    qint32 notebookLid;
+    qint32 addPdfResource();
+    int countRows(QString table, QString column, qint32 lid);
+
+private slots:
+    void initTestCase();
+    void extractsEveryPage();
+    void cacheKeyedByHash();
+    void expungeRemovesPages();
+    void expungeManyRemovesPages();
+    void benchmarkConcatenate();
+    void benchmarkExtract();
+    void benchmarkCached();
+};
+
+
+
+// Write a PDF with a word on each page that only that page has
+void TestPdfText::initTestCase() {
+    QVERIFY(database.open());
+    notebookLid = database.addNotebook("PDF");
+    pdfFile = database.homePath() + "corpus.pdf";
+    QPrinter printer;
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(pdfFile);
+    QPainter painter;
+    QVERIFY(painter.begin(&printer));
+    for (int i=0; i<PDF_PAGES; i++) {
+        if (i > 0)
+            printer.newPage();
+        for (int line=0; line<40; line++) {
+            painter.drawText(50, 50+line*20, "Page " + QString::number(i) + " line " + QString::number(line)
+                             + " the quick brown fox jumps over the lazy dog");
+        }
+        painter.drawText(50, 900, "marker" + QString::number(i));
+    }
+    painter.end();
+    QVERIFY(QFileInfo(pdfFile).size() > 0);
+}
+
+
+
+// Add a note with the PDF attached, along with the search rows & cache
+// the indexer would have made for it.  The resource lid is returned.
+qint32 TestPdfText::addPdfResource() {
+    QFile file(pdfFile);
+    file.open(QIODevice::ReadOnly);
+    qint32 noteLid = database.addNote(notebookLid, "PDF", QList<QByteArray>() << file.readAll(),
+                                      "application/pdf", "corpus.pdf");
+    file.close();
+    ResourceTable resTable(database.db);
+    QList<qint32> resLids;
+    resTable.getResourceList(resLids, noteLid);
+    if (resLids.size() != 1)
+        return 0;
+
+    QStringList pages;
+    QList<QByteArray> words;
+    for (int i=0; i<3; i++) {
+        pages.append("marker" + QString::number(i));
+        words.append(QByteArray());
+    }
+    PdfTextTable pdfTable(database.db);
+    pdfTable.save(resLids[0], "hash", pages, words);
+    NSqlQuery sql(database.db);
+    sql.prepare("Insert into SearchIndex (lid, weight, source, content) values (:lid, 100, :source, :content)");
+    for (int i=0; i<pages.size(); i++) {
+        sql.bindValue(":lid", resLids[0]);
+        sql.bindValue(":source", "pdf:"+QString::number(i));
+        sql.bindValue(":content", pages[i]);
+        sql.exec();
+    }
+    sql.finish();
+    return resLids[0];
+}
+
+
+
+int TestPdfText::countRows(QString table, QString column, qint32 lid) {
+    NSqlQuery sql(database.db);
+    sql.prepare("select count(*) from " + table + " where " + column + "=:lid");
+    sql.bindValue(":lid", lid);
+    int count = -1;
+    if (sql.exec() && sql.next())
+        count = sql.value(0).toInt();
+    sql.finish();
+    return count;
+}
+
+
+
+void TestPdfText::extractsEveryPage() {
+    IndexRunner runner;
+    QStringList pages;
+    QList<QByteArray> words;
+    QVERIFY(runner.extractPdf(pdfFile, pages, words));
+    QCOMPARE(pages.size(), PDF_PAGES);
+    QCOMPARE(words.size(), PDF_PAGES);
+    for (int i=0; i<PDF_PAGES; i += 37) {
+        QVERIFY(pages[i].contains("marker" + QString::number(i)));
+        QStringList pageWords;
+        QList<QRectF> boxes;
+        PdfTextTable::unpackWords(words[i], pageWords, boxes);
+        QVERIFY(pageWords.contains("marker" + QString::number(i)));
+        QCOMPARE(pageWords.size(), boxes.size());
+    }
+}
+
+
+
+// A PDF is only read again when its data changes
+void TestPdfText::cacheKeyedByHash() {
+    PdfTextTable pdfTable(database.db);
+    QStringList pages;
+    pages << "first" << "second";
+    QList<QByteArray> words;
+    words << QByteArray() << QByteArray();
+    pdfTable.save(999999, "abc", pages, words);
+    QStringList cached;
+    QVERIFY(pdfTable.getText(999999, "abc", cached));
+    QCOMPARE(cached, pages);
+    QVERIFY(!pdfTable.getText(999999, "def", cached));
+    pdfTable.expunge(999999);
+}
+
+
+
+// Page rows left behind would keep matching searches for a deleted PDF
+void TestPdfText::expungeRemovesPages() {
+    qint32 resLid = addPdfResource();
+    QVERIFY(resLid > 0);
+    QCOMPARE(countRows("SearchIndex", "lid", resLid), 3);
+    QCOMPARE(countRows("PdfTextCache", "resourceLid", resLid), 3);
+    ResourceTable resTable(database.db);
+    resTable.expunge(resLid);
+    QCOMPARE(countRows("SearchIndex", "lid", resLid), 0);
+    QCOMPARE(countRows("PdfTextCache", "resourceLid", resLid), 0);
+}
+
+
+
+void TestPdfText::expungeManyRemovesPages() {
+    qint32 first = addPdfResource();
+    qint32 second = addPdfResource();
+    QVERIFY(first > 0 && second > 0);
+    ResourceTable resTable(database.db);
+    resTable.expungeMany(QList<qint32>() << first << second);
+    QCOMPARE(countRows("SearchIndex", "lid", first), 0);
+    QCOMPARE(countRows("SearchIndex", "lid", second), 0);
+    QCOMPARE(countRows("PdfTextCache", "resourceLid", first), 0);
+    QCOMPARE(countRows("PdfTextCache", "resourceLid", second), 0);
+}
+
+
+
+// How the indexer used to read a PDF: one page after another, adding
+// each to one growing string.
+void TestPdfText::benchmarkConcatenate() {
+    QString text;
+    QBENCHMARK {
+        Poppler::Document *doc = Poppler::Document::load(pdfFile);
+        QVERIFY(doc != NULL);
+        text = "";
+        for (int i=0; i<doc->numPages(); i++) {
+            Poppler::Page *page = doc->page(i);
+            text = text + page->text(QRectF()) + " ";
+            delete page;
+        }
+        delete doc;
+    }
+    QVERIFY(text.contains("marker" + QString::number(PDF_PAGES-1)));
+}
+
+
+
+// Pages & word boxes pulled out in parallel
+void TestPdfText::benchmarkExtract() {
+    IndexRunner runner;
+    QStringList pages;
+    QList<QByteArray> words;
+    QBENCHMARK {
+        runner.extractPdf(pdfFile, pages, words);
+    }
+    QCOMPARE(pages.size(), PDF_PAGES);
+}
+
+
+
+// Reindexing a PDF that hasn't changed only reads the cache
+void TestPdfText::benchmarkCached() {
+    IndexRunner runner;
+    QStringList pages;
+    QList<QByteArray> words;
+    QVERIFY(runner.extractPdf(pdfFile, pages, words));
+    PdfTextTable pdfTable(database.db);
+    pdfTable.save(888888, "cached", pages, words);
+    QStringList cached;
+    QBENCHMARK {
+        pdfTable.getText(888888, "cached", cached);
+    }
+    QCOMPARE(cached.size(), PDF_PAGES);
+    pdfTable.expunge(888888);
+}
+
+
+QTEST_MAIN(TestPdfText)
+#include "tst_pdftext.moc"
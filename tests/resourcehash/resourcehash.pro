@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Resource hash index lookups & a benchmark over a
+# note with hundreds of attachments.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_resourcehash
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_resourcehash.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,155 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include "testdatabase.h"
+#include "sql/resourcetable.h"
+#include "sql/nsqlquery.h"
+
+#define ATTACHMENT_COUNT 300
+
+//**********************************************************
+// Resolving the en-media tags of a note with hundreds of
+// attachments.  The old LIKE scan is kept here as the
+// baseline the index is measured against.
+//**********************************************************
+class TestResourceHash : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    qint32 noteLid;
+    QStringList hashes;
+    QList<qint32> resourceLids;
+    qint32 likeScan(QString hash);
+
+private slots:
+    void initTestCase();
+    void lookupFindsEveryResource();
+    void bulkLookupFindsEveryResource();
+    void expungeRemovesIndex();
+    void benchmarkLikeScan();
+    void benchmarkIndexedLookup();
+    void benchmarkBulkLookup();
+};
+
+
+
+void TestResourceHash::initTestCase() {
+    QVERIFY(database.open());
+    qint32 notebookLid = database.addNotebook("Attachments");
+    QList<QByteArray> attachments;
+    for (int i=0; i<ATTACHMENT_COUNT; i++) {
+        QByteArray data = "attachment " + QByteArray::number(i);
+        attachments.append(data);
+        hashes.append(TestDatabase::hashHex(data));
+    }
+    noteLid = database.addNote(notebookLid, "Many attachments", attachments);
+    QVERIFY(noteLid > 0);
+
+    ResourceTable resTable(database.db);
+    QVERIFY(resTable.getResourceList(resourceLids, noteLid));
+    QCOMPARE(resourceLids.size(), ATTACHMENT_COUNT);
+}
+
+
+
+// How getLidByHashHex used to work: check every resource of the note
+qint32 TestResourceHash::likeScan(QString hash) {
+    NSqlQuery query(database.db);
+    for (int i=0; i<resourceLids.size(); i++) {
+        query.prepare("Select lid from DataStore where upper(data) like upper(:hash) and key=:key and lid=:lid");
+        query.bindValue(":hash", hash);
+        query.bindValue(":key", RESOURCE_DATA_HASH);
+        query.bindValue(":lid", resourceLids[i]);
+        query.exec();
+        if (query.next())
+            return query.value(0).toInt();
+    }
+    return 0;
+}
+
+
+
+// Upper case hashes have to work too since older notes use them
+void TestResourceHash::lookupFindsEveryResource() {
+    ResourceTable resTable(database.db);
+    for (int i=0; i<hashes.size(); i++) {
+        qint32 lid = resTable.getLidByHashHex(noteLid, hashes[i]);
+        QVERIFY(lid > 0);
+        QCOMPARE(lid, likeScan(hashes[i]));
+        QCOMPARE(resTable.getLidByHashHex(noteLid, hashes[i].toUpper()), lid);
+    }
+}
+
+
+
+void TestResourceHash::bulkLookupFindsEveryResource() {
+    ResourceTable resTable(database.db);
+    QHash<QString, qint32> map;
+    resTable.getLidsByHashes(map, noteLid);
+    QCOMPARE(map.size(), ATTACHMENT_COUNT);
+    for (int i=0; i<hashes.size(); i++)
+        QCOMPARE(map.value(hashes[i], 0), resTable.getLidByHashHex(noteLid, hashes[i]));
+}
+
+
+
+void TestResourceHash::expungeRemovesIndex() {
+    qint32 notebookLid = database.addNotebook("Expunged");
+    QList<QByteArray> attachments;
+    attachments.append("expunged attachment");
+    qint32 lid = database.addNote(notebookLid, "Expunged", attachments);
+    ResourceTable resTable(database.db);
+    QString hash = TestDatabase::hashHex(attachments[0]);
+    qint32 resLid = resTable.getLidByHashHex(lid, hash);
+    QVERIFY(resLid > 0);
+    resTable.expunge(resLid);
+    QCOMPARE(resTable.getLidByHashHex(lid, hash), 0);
+}
+
+
+
+void TestResourceHash::benchmarkLikeScan() {
+    QBENCHMARK {
+        for (int i=0; i<hashes.size(); i++)
+            likeScan(hashes[i]);
+    }
+}
+
+
+void TestResourceHash::benchmarkIndexedLookup() {
+    ResourceTable resTable(database.db);
+    QBENCHMARK {
+        for (int i=0; i<hashes.size(); i++)
+            resTable.getLidByHashHex(noteLid, hashes[i]);
+    }
+}
+
+
+void TestResourceHash::benchmarkBulkLookup() {
+    ResourceTable resTable(database.db);
+    QHash<QString, qint32> map;
+    QBENCHMARK {
+        resTable.getLidsByHashes(map, noteLid);
+    }
+}
+
+QTEST_MAIN(TestResourceHash)
+#include "tst_resourcehash.moc"
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Query latency & size of the FTS4 search index
+# compared with the FTS5 & trigram indexes.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_searchindex
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_searchindex.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,210 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include "testdatabase.h"
+#include "sql/datastore.h"
+#include "sql/nsqlquery.h"
+
+#define INDEX_ROWS 5000
+#define WORDS_PER_ROW 60
+#define VOCABULARY 4000
+
+//**********************************************************
+// The search index before & after the move to FTS5.  The
+// same text is loaded into the old FTS4 table, the FTS5
+// table with prefix indexes and, if this SQLite has it, an
+// FTS5 trigram table.  The size of each is logged and the
+// benchmarks time the queries the filters run against them.
+//**********************************************************
+class TestSearchIndex : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    bool fts5;
+    bool trigram;
+    QStringList rows;
+    qint64 pageCount();
+    qint64 load(QString table);
+    QList<qint32> lids(QString sql, QString word);
+
+private slots:
+    void initTestCase();
+    void prefixSearchMatchesFts4();
+    void trigramMatchesLike();
+    void benchmarkPrefix_data();
+    void benchmarkPrefix();
+    void benchmarkInfix_data();
+    void benchmarkInfix();
+    void benchmarkRanked();
+};
+
+
+
+// Load the same text into every kind of index & log how much space each takes
+void TestSearchIndex::initTestCase() {
+    QVERIFY(database.open());
+    DataStore store(database.db);
+    fts5 = store.fts5Available();
+    trigram = store.fts5Available(", tokenize='trigram'");
+    if (!fts5)
+        QSKIP("This SQLite does not have FTS5");
+
+    qsrand(1);
+    for (int i=0; i<INDEX_ROWS; i++) {
+        QStringList words;
+        for (int j=0; j<WORDS_PER_ROW; j++)
+            words.append("word" + QString::number(qrand() % VOCABULARY));
+        rows.append(words.join(" "));
+    }
+
+    NSqlQuery query(database.db);
+    QVERIFY(query.exec("create virtual table IndexFts4 using fts4 (lid int, weight int, source text, content text)"));
+    qint64 fts4Size = load("IndexFts4");
+    QVERIFY(store.createSearchIndex("IndexFts5"));
+    qint64 fts5Size = load("IndexFts5");
+    qDebug() << "FTS4 index:" << fts4Size << "bytes";
+    qDebug() << "FTS5 index:" << fts5Size << "bytes";
+    if (trigram) {
+        QVERIFY(query.exec("create virtual table IndexTrigram using fts5 (lid unindexed, weight unindexed, "
+                           "source unindexed, content, tokenize='trigram')"));
+        qDebug() << "FTS5 trigram index:" << load("IndexTrigram") << "bytes";
+    }
+}
+
+
+
+qint64 TestSearchIndex::pageCount() {
+    NSqlQuery query(database.db);
+    query.exec("pragma page_count");
+    query.next();
+    qint64 pages = query.value(0).toLongLong();
+    query.exec("pragma page_size");
+    query.next();
+    return pages * query.value(0).toLongLong();
+}
+
+
+
+// Fill one index and return how much the database grew
+qint64 TestSearchIndex::load(QString table) {
+    qint64 before = pageCount();
+    NSqlQuery query(database.db);
+    query.exec("savepoint loadindex");
+    query.prepare("insert into " +table +" (lid, weight, source, content) values (:lid, 100, 'text', :content)");
+    for (int i=0; i<rows.size(); i++) {
+        query.bindValue(":lid", i+1);
+        query.bindValue(":content", rows[i]);
+        query.exec();
+    }
+    query.exec("release loadindex");
+    return pageCount() - before;
+}
+
+
+
+QList<qint32> TestSearchIndex::lids(QString sql, QString word) {
+    QList<qint32> retval;
+    NSqlQuery query(database.db);
+    query.prepare(sql);
+    query.bindValue(":word", word);
+    query.exec();
+    while (query.next())
+        retval.append(query.value(0).toInt());
+    qSort(retval);
+    return retval;
+}
+
+
+
+// FTS5 needs the term quoted as a phrase, but must find the same rows
+void TestSearchIndex::prefixSearchMatchesFts4() {
+    QList<qint32> old = lids("select lid from IndexFts4 where content match :word", "word12*");
+    QVERIFY(old.size() > 0);
+    QCOMPARE(lids("select lid from IndexFts5 where content match :word", "\"word12\"*"), old);
+}
+
+
+
+// The trigram index answers leading wildcard searches the old table scanned for
+void TestSearchIndex::trigramMatchesLike() {
+    if (!trigram)
+        QSKIP("This SQLite does not have the trigram tokenizer");
+    QList<qint32> old = lids("select lid from IndexFts4 where content like :word", "%ord123%");
+    QVERIFY(old.size() > 0);
+    QCOMPARE(lids("select lid from IndexTrigram where content like :word", "%ord123%"), old);
+    QCOMPARE(lids("select lid from IndexTrigram where content match :word", "\"ord123\""), old);
+}
+
+
+
+void TestSearchIndex::benchmarkPrefix_data() {
+    QTest::addColumn<QString>("sql");
+    QTest::addColumn<QString>("word");
+    QTest::newRow("fts4") << "select lid from IndexFts4 where content match :word" << "word12*";
+    QTest::newRow("fts5") << "select lid from IndexFts5 where content match :word" << "\"word12\"*";
+    QTest::newRow("fts4 short") << "select lid from IndexFts4 where content match :word" << "wo*";
+    QTest::newRow("fts5 short") << "select lid from IndexFts5 where content match :word" << "\"wo\"*";
+}
+
+
+
+void TestSearchIndex::benchmarkPrefix() {
+    QFETCH(QString, sql);
+    QFETCH(QString, word);
+    QBENCHMARK {
+        lids(sql, word);
+    }
+}
+
+
+
+void TestSearchIndex::benchmarkInfix_data() {
+    QTest::addColumn<QString>("sql");
+    QTest::addColumn<QString>("word");
+    QTest::newRow("fts4 like") << "select lid from IndexFts4 where content like :word" << "%ord123%";
+    if (trigram) {
+        QTest::newRow("trigram like") << "select lid from IndexTrigram where content like :word" << "%ord123%";
+        QTest::newRow("trigram match") << "select lid from IndexTrigram where content match :word" << "\"ord123\"";
+    }
+}
+
+
+
+void TestSearchIndex::benchmarkInfix() {
+    QFETCH(QString, sql);
+    QFETCH(QString, word);
+    QBENCHMARK {
+        lids(sql, word);
+    }
+}
+
+
+
+// What the relevance column costs on top of a plain prefix search
+void TestSearchIndex::benchmarkRanked() {
+    QBENCHMARK {
+        lids("select lid from IndexFts5 where content match :word order by bm25(IndexFts5)", "\"word12\"*");
+    }
+}
+
+
+QTEST_MAIN(TestSearchIndex)
+#include "tst_searchindex.moc"
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Sends mail through a loopback SMTP sink to check
+# what actually goes over the wire: dot stuffing &
+# attachments streamed as base64.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+
+TARGET = tst_smtpsink
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_smtpsink.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,255 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThreadPool>
+#include <QTemporaryDir>
+#include "email/emailsendtask.h"
+#include "email/mimetext.h"
+#include "email/mimefile.h"
+
+// Big enough that the attachment is read & encoded in several pieces
+#define ATTACHMENT_SIZE 400000
+#define SEND_WAIT 200
+#define SEND_WAIT_STEP 50
+
+//**********************************************************
+// A minimal SMTP server.  It accepts whatever it is sent
+// and keeps the DATA section exactly as it came over the
+// wire, so dot stuffing is still in place.
+//**********************************************************
+class SmtpSink : public QTcpServer
+{
+    Q_OBJECT
+public:
+    QList<QByteArray> commands;
+    QByteArray data;
+    int messages;
+
+    SmtpSink() {
+        socket = NULL;
+        inData = false;
+        messages = 0;
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptClient()));
+    }
+
+private:
+    QTcpSocket *socket;
+    QByteArray buffer;
+    bool inData;
+
+    void reply(const QByteArray &line) {
+        socket->write(line + "\r\n");
+    }
+
+    void command(const QByteArray &line) {
+        commands.append(line);
+        QByteArray verb = line.left(4).toUpper();
+        if (verb == "EHLO")
+            reply("250 sink");
+        else if (verb == "AUTH")
+            reply("235 ok");
+        else if (verb == "MAIL" || verb == "RCPT")
+            reply("250 ok");
+        else if (verb == "DATA") {
+            inData = true;
+            reply("354 go ahead");
+        } else if (verb == "QUIT")
+            reply("221 bye");
+        else
+            reply("500 unknown command");
+    }
+
+private slots:
+    void acceptClient() {
+        socket = nextPendingConnection();
+        buffer.clear();
+        inData = false;
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readLines()));
+        reply("220 sink ESMTP");
+    }
+
+    void readLines() {
+        buffer.append(socket->readAll());
+        int start = 0;
+        int end;
+        while ((end = buffer.indexOf("\r\n", start)) >= 0) {
+            QByteArray line = buffer.mid(start, end-start);
+            start = end+2;
+            if (!inData) {
+                command(line);
+            } else if (line == ".") {
+                inData = false;
+                messages++;
+                reply("250 queued");
+            } else {
+                data.append(line).append("\r\n");
+            }
+        }
+        buffer.remove(0, start);
+    }
+};
+
+
+
+//**********************************************************
+// Send a message with EmailSendTask, the way the note
+// browser does, & look at what the server received.
+//**********************************************************
+class TestSmtpSink : public QObject
+{
+    Q_OBJECT
+private:
+    QTemporaryDir dir;
+    bool done;
+    QString error;
+
+    bool send(SmtpSink &sink, MimeMessage *message);
+    static QByteArray unstuff(const QByteArray &data);
+    static QByteArray attachment(const QByteArray &data, const QString &name);
+
+private slots:
+    void sent();
+    void failed(QString title, QString text);
+    void stuffsLeadingDots();
+    void attachmentDecodes();
+};
+
+
+
+// Run the task on a pool thread (the SMTP client blocks) while
+// this thread serves the sink.
+bool TestSmtpSink::send(SmtpSink &sink, MimeMessage *message) {
+    done = false;
+    error = "";
+    message->setSender(new EmailAddress("sender@localhost", "Sender"));
+    message->addRecipient(new EmailAddress("recipient@localhost", "Recipient"));
+    message->setSubject("SMTP sink");
+    EmailSendTask *task = new EmailSendTask(message, "127.0.0.1", sink.serverPort(),
+                                            SmtpClient::TcpConnection, "user", "password");
+    connect(task, SIGNAL(sent()), this, SLOT(sent()));
+    connect(task, SIGNAL(failed(QString,QString)), this, SLOT(failed(QString,QString)));
+    QThreadPool::globalInstance()->start(task);
+    for (int i=0; i<SEND_WAIT && !done; i++)
+        QTest::qWait(SEND_WAIT_STEP);
+    QThreadPool::globalInstance()->waitForDone();
+    return done && error == "";
+}
+
+
+void TestSmtpSink::sent() {
+    done = true;
+}
+
+
+void TestSmtpSink::failed(QString title, QString text) {
+    error = title + ": " + text;
+    done = true;
+}
+
+
+// What the client meant to send: a '.' starting a line is doubled
+// on the wire, so drop one again.
+QByteArray TestSmtpSink::unstuff(const QByteArray &data) {
+    QByteArray result;
+    QList<QByteArray> lines = data.split('\n');
+    for (int i=0; i<lines.size(); i++) {
+        if (i > 0)
+            result.append('\n');
+        if (lines[i].startsWith('.'))
+            result.append(lines[i].mid(1));
+        else
+            result.append(lines[i]);
+    }
+    return result;
+}
+
+
+// Decode the base64 body of the part with the given name
+QByteArray TestSmtpSink::attachment(const QByteArray &data, const QString &name) {
+    int header = data.indexOf("name=\"" + name.toUtf8() + "\"");
+    if (header < 0)
+        return QByteArray();
+    int start = data.indexOf("\r\n\r\n", header);
+    if (start < 0)
+        return QByteArray();
+    start += 4;
+    int end = data.indexOf("\r\n--", start);
+    if (end < 0)
+        return QByteArray();
+    QByteArray encoded = data.mid(start, end-start);
+    encoded.replace("\r\n", "");
+    return QByteArray::fromBase64(encoded);
+}
+
+
+// A line that is just "." would end the message early if it
+// weren't escaped, and ".." would lose a dot.
+void TestSmtpSink::stuffsLeadingDots() {
+    SmtpSink sink;
+    QVERIFY(sink.listen(QHostAddress::LocalHost));
+
+    QString text = "First line\r\n.\r\n.hidden\r\n..two dots\r\nmiddle . dot\r\nlast line";
+    MimeMessage *message = new MimeMessage();
+    message->addPart(new MimeText(text));
+    QVERIFY2(send(sink, message), qPrintable(error));
+
+    QCOMPARE(sink.messages, 1);
+    QVERIFY(sink.commands.last().toUpper() == "QUIT");
+    QVERIFY(sink.data.contains("\r\n..\r\n"));
+    QVERIFY(sink.data.contains("\r\n..hidden\r\n"));
+    QVERIFY(sink.data.contains("\r\n...two dots\r\n"));
+    QVERIFY(sink.data.contains("\r\nmiddle . dot\r\n"));
+    QVERIFY(unstuff(sink.data).contains(text.toUtf8()));
+}
+
+
+// The attachment is read from disk & encoded as it is sent, in
+// more than one piece.  It has to come back byte for byte.
+void TestSmtpSink::attachmentDecodes() {
+    QVERIFY(dir.isValid());
+    SmtpSink sink;
+    QVERIFY(sink.listen(QHostAddress::LocalHost));
+
+    QByteArray bytes;
+    bytes.reserve(ATTACHMENT_SIZE);
+    qsrand(ATTACHMENT_SIZE);
+    for (int i=0; i<ATTACHMENT_SIZE; i++)
+        bytes.append((char) (qrand() & 0xff));
+    QString path = dir.path() + "/attachment.bin";
+    QFile out(path);
+    QVERIFY(out.open(QIODevice::WriteOnly));
+    QCOMPARE(out.write(bytes), (qint64) bytes.size());
+    out.close();
+
+    MimeMessage *message = new MimeMessage();
+    message->addPart(new MimeText("See attached."));
+    message->addPart(new MimeFile(new QFile(path)));
+    QVERIFY2(send(sink, message), qPrintable(error));
+
+    QCOMPARE(sink.messages, 1);
+    QByteArray received = attachment(unstuff(sink.data), "attachment.bin");
+    QCOMPARE(received.size(), bytes.size());
+    QVERIFY(received == bytes);
+}
+
+QTEST_MAIN(TestSmtpSink)
+#include "tst_smtpsink.moc"
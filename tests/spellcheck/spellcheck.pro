@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# The background spell check service against a
+# small in-memory dictionary, & how long a long
+# note takes compared with one lookup per word.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+
+TARGET = tst_spellcheck
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_spellcheck.cpp
+TRANSLATIONS =
+INSTALLS =
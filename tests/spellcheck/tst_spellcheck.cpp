@@ -0,0 +1,267 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include "utilities/spellcheckservice.h"
+
+#define NOTE_WORDS 20000
+#define LOOKUP_COST 2000
+
+//**********************************************************
+// A dictionary that counts how often it is asked about a
+// word.  Each lookup does some work so the benchmarks show
+// what repeated lookups cost, the way Hunspell's do.
+//**********************************************************
+class CountingDictionary : public HunspellInterface
+{
+public:
+    QSet<QString> known;
+    int checks;
+    int suggestionLookups;
+
+    CountingDictionary() {
+        checks = 0;
+        suggestionLookups = 0;
+    }
+    void initialize(QString programDictionary, QString userDictionary) {
+        Q_UNUSED(programDictionary);
+        Q_UNUSED(userDictionary);
+        QStringList words = QString("the quick brown fox jumps over lazy dog a note with some words in it don't").split(' ');
+        for (int i=0; i<words.size(); i++)
+            known.insert(words[i]);
+    }
+    bool lookUp(QString word) {
+        volatile int work = 0;
+        for (int i=0; i<LOOKUP_COST; i++)
+            work = work + i;
+        return known.contains(word.toLower());
+    }
+    bool spellCheck(QString word, QStringList &suggestions) {
+        suggestionLookups++;
+        suggestions.clear();
+        if (lookUp(word))
+            return true;
+        suggestions.append(word.toLower());
+        return false;
+    }
+    bool isCorrect(QString word) {
+        checks++;
+        return lookUp(word);
+    }
+    void addWord(QString dictionary, QString word) {
+        Q_UNUSED(dictionary);
+        known.insert(word.toLower());
+    }
+};
+
+
+
+//**********************************************************
+// Words are split out of a note once, each unique word is
+// looked up once per dictionary, & suggestions are only
+// found when asked for.
+//**********************************************************
+class TestSpellCheck : public QObject
+{
+    Q_OBJECT
+private:
+    QString longNote;
+    int finishedRequest;
+    QList<SpellCheckRange> finishedRanges;
+    bool waitForCheck(int request);
+
+private slots:
+    void initTestCase();
+    void tokenizeKeepsApostrophes();
+    void reportsRanges();
+    void looksUpEachWordOnce();
+    void suggestionsOnlyWhenAsked();
+    void addedWordIsCorrect();
+    void benchmarkWordByWord();
+    void benchmarkService();
+    void benchmarkServiceCached();
+
+public slots:
+    void checkFinished(int request, QList<SpellCheckRange> misspelled);
+};
+
+
+
+// A long note made of a small vocabulary with a few misspellings
+void TestSpellCheck::initTestCase() {
+    QStringList vocabulary = QString("the quick brown fox jumps over the lazy dog teh quikc").split(' ');
+    QStringList words;
+    for (int i=0; i<NOTE_WORDS; i++)
+        words.append(vocabulary[(i*7)%vocabulary.size()] + (i%50 == 0 ? QString::number(i) : QString()));
+    longNote = words.join(" ");
+}
+
+
+
+void TestSpellCheck::checkFinished(int request, QList<SpellCheckRange> misspelled) {
+    finishedRequest = request;
+    finishedRanges = misspelled;
+}
+
+
+
+// Wait for the service's thread to report on a request
+bool TestSpellCheck::waitForCheck(int request) {
+    QElapsedTimer timer;
+    timer.start();
+    while (finishedRequest != request && timer.elapsed() < 30000)
+        QTest::qWait(5);
+    return finishedRequest == request;
+}
+
+
+
+void TestSpellCheck::tokenizeKeepsApostrophes() {
+    QList<SpellCheckRange> words;
+    SpellCheckService::tokenize("Don't stop, O'Neil! 42 x1 'quoted'", words);
+    QStringList found;
+    for (int i=0; i<words.size(); i++)
+        found.append(words[i].word);
+    QCOMPARE(found, QStringList() << "Don't" << "stop" << "O'Neil" << "x1" << "quoted");
+    QCOMPARE(words[2].start, 12);
+    QCOMPARE(words[2].length, 6);
+}
+
+
+
+void TestSpellCheck::reportsRanges() {
+    CountingDictionary dictionary;
+    SpellCheckService service;
+    service.initialize(&dictionary, "", "");
+    connect(&service, SIGNAL(checked(int,QList<SpellCheckRange>)),
+            this, SLOT(checkFinished(int,QList<SpellCheckRange>)));
+    QString text = "the quikc brown fox, teh dog";
+    finishedRequest = 0;
+    QVERIFY(waitForCheck(service.check(text)));
+    QCOMPARE(finishedRanges.size(), 2);
+    QCOMPARE(finishedRanges[0].word, QString("quikc"));
+    QCOMPARE(text.mid(finishedRanges[0].start, finishedRanges[0].length), QString("quikc"));
+    QCOMPARE(finishedRanges[1].word, QString("teh"));
+    QCOMPARE(finishedRanges[1].start, 21);
+}
+
+
+
+// The cache is kept between notes, so the second note costs no lookups
+void TestSpellCheck::looksUpEachWordOnce() {
+    CountingDictionary dictionary;
+    SpellCheckService service;
+    service.initialize(&dictionary, "", "");
+    connect(&service, SIGNAL(checked(int,QList<SpellCheckRange>)),
+            this, SLOT(checkFinished(int,QList<SpellCheckRange>)));
+    finishedRequest = 0;
+    QVERIFY(waitForCheck(service.check("teh dog teh dog teh dog the")));
+    QCOMPARE(dictionary.checks, 3);
+    QCOMPARE(finishedRanges.size(), 3);
+    QVERIFY(waitForCheck(service.check("dog the teh")));
+    QCOMPARE(dictionary.checks, 3);
+}
+
+
+
+void TestSpellCheck::suggestionsOnlyWhenAsked() {
+    CountingDictionary dictionary;
+    SpellCheckService service;
+    service.initialize(&dictionary, "", "");
+    connect(&service, SIGNAL(checked(int,QList<SpellCheckRange>)),
+            this, SLOT(checkFinished(int,QList<SpellCheckRange>)));
+    finishedRequest = 0;
+    QVERIFY(waitForCheck(service.check(longNote)));
+    QCOMPARE(dictionary.suggestionLookups, 0);
+    QCOMPARE(service.suggestions("Teh"), QStringList() << "teh");
+    QCOMPARE(service.suggestions("Teh"), QStringList() << "teh");
+    QCOMPARE(dictionary.suggestionLookups, 1);
+}
+
+
+
+void TestSpellCheck::addedWordIsCorrect() {
+    CountingDictionary dictionary;
+    SpellCheckService service;
+    service.initialize(&dictionary, "", "");
+    QVERIFY(!service.isCorrect("nixnote"));
+    service.addWord("user.lst", "nixnote");
+    QVERIFY(service.isCorrect("nixnote"));
+}
+
+
+
+// What the editor used to do: split on spaces & look up every word,
+// with suggestions, however many times it appears.
+void TestSpellCheck::benchmarkWordByWord() {
+    CountingDictionary dictionary;
+    dictionary.initialize("", "");
+    int misspelled = 0;
+    QBENCHMARK {
+        misspelled = 0;
+        QStringList words = longNote.split(" ");
+        for (int i=0; i<words.size(); i++) {
+            QStringList suggestions;
+            if (!dictionary.spellCheck(words[i], suggestions))
+                misspelled++;
+        }
+    }
+    QVERIFY(misspelled > 0);
+}
+
+
+
+// A new service each time, so every unique word is looked up
+void TestSpellCheck::benchmarkService() {
+    CountingDictionary dictionary;
+    int misspelled = 0;
+    QBENCHMARK {
+        SpellCheckService service;
+        service.initialize(&dictionary, "", "");
+        connect(&service, SIGNAL(checked(int,QList<SpellCheckRange>)),
+                this, SLOT(checkFinished(int,QList<SpellCheckRange>)));
+        finishedRequest = 0;
+        QVERIFY(waitForCheck(service.check(longNote)));
+        misspelled = finishedRanges.size();
+    }
+    QVERIFY(misspelled > 0);
+}
+
+
+
+// Checking a note again, or one like it, only tokenizes it
+void TestSpellCheck::benchmarkServiceCached() {
+    CountingDictionary dictionary;
+    SpellCheckService service;
+    service.initialize(&dictionary, "", "");
+    connect(&service, SIGNAL(checked(int,QList<SpellCheckRange>)),
+            this, SLOT(checkFinished(int,QList<SpellCheckRange>)));
+    finishedRequest = 0;
+    QVERIFY(waitForCheck(service.check(longNote)));
+    int lookups = dictionary.checks;
+    QBENCHMARK {
+        QVERIFY(waitForCheck(service.check(longNote)));
+    }
+    QCOMPARE(dictionary.checks, lookups);
+}
+
+
+QTEST_MAIN(TestSpellCheck)
+#include "tst_spellcheck.moc"
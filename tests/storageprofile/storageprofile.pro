@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Page cache hit rate & read time of each storage
+# profile on a large synthetic database.  The cache
+# statistics come straight from SQLite, so this
+# links the system library.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_storageprofile
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+LIBS += -lsqlite3
+SOURCES -= main.cpp
+SOURCES += tst_storageprofile.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,206 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <sqlite3.h>
+#include "testdatabase.h"
+#include "global.h"
+#include "sql/databaseconnection.h"
+#include "sql/nsqlquery.h"
+
+#define DATABASE_NOTES 50000
+#define NOTE_KEYS 6
+#define LOOKUPS 20000
+#define HOT_NOTES (DATABASE_NOTES/5)
+
+extern Global global;
+
+//**********************************************************
+// How well each storage profile keeps a large database in
+// its page cache.  The database is built & read with the
+// SQLite library directly since Qt doesn't expose the cache
+// statistics; each connection gets the same pragmas that
+// DatabaseConnection sends for the profile.  The reads are
+// skewed the way a user's are: most of them go to a fifth
+// of the notes.
+//**********************************************************
+class TestStorageProfile : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    QString largePath;
+    bool readDatabase(const StorageProfile *profile, int &hits, int &misses);
+    StorageProfile profile(QString name);
+
+private slots:
+    void initTestCase();
+    void connectionUsesProfile();
+    void biggerCacheHitsMore();
+    void benchmarkProfile_data();
+    void benchmarkProfile();
+};
+
+
+
+// Build a DataStore table much bigger than the smaller page caches
+void TestStorageProfile::initTestCase() {
+    QVERIFY(database.open());
+    largePath = database.homePath() + "large.db";
+    sqlite3 *db;
+    QCOMPARE(sqlite3_open(largePath.toUtf8().constData(), &db), SQLITE_OK);
+    QCOMPARE(sqlite3_exec(db, "pragma journal_mode=wal; begin;"
+                          "create table DataStore (lid integer, key integer, data blob default null collate nocase);",
+                          NULL, NULL, NULL), SQLITE_OK);
+    sqlite3_stmt *insert;
+    QCOMPARE(sqlite3_prepare_v2(db, "insert into DataStore (lid, key, data) values (?, ?, ?)", -1, &insert, NULL), SQLITE_OK);
+    QByteArray data(160, 'x');
+    for (int lid=1; lid<=DATABASE_NOTES; lid++) {
+        for (int key=0; key<NOTE_KEYS; key++) {
+            data.replace(0, 16, QByteArray::number(lid*NOTE_KEYS+key).rightJustified(16, '0'));
+            sqlite3_bind_int(insert, 1, lid);
+            sqlite3_bind_int(insert, 2, 5000+key);
+            sqlite3_bind_blob(insert, 3, data.constData(), data.size(), SQLITE_TRANSIENT);
+            QCOMPARE(sqlite3_step(insert), SQLITE_DONE);
+            sqlite3_reset(insert);
+        }
+    }
+    sqlite3_finalize(insert);
+    QCOMPARE(sqlite3_exec(db, "create index DataStore_Lid on DataStore (lid);"
+                          "create index DataStore_Key on DataStore (key);"
+                          "commit; pragma wal_checkpoint(truncate);", NULL, NULL, NULL), SQLITE_OK);
+    sqlite3_close(db);
+    qDebug() << "Synthetic database is" << QFileInfo(largePath).size()/(1024*1024) << "MiB";
+}
+
+
+
+// A profile by role, or SQLite's own defaults for "baseline"
+StorageProfile TestStorageProfile::profile(QString name) {
+    if (name != "baseline")
+        return global.getStorageProfile(name);
+    StorageProfile profile;
+    profile.cacheSize = 2000;
+    profile.mmapSize = 0;
+    profile.synchronous = "FULL";
+    return profile;
+}
+
+
+
+// Open the large database with a profile's settings & do the reads.
+// The page cache statistics are returned.
+bool TestStorageProfile::readDatabase(const StorageProfile *profile, int &hits, int &misses) {
+    sqlite3 *db;
+    if (sqlite3_open(largePath.toUtf8().constData(), &db) != SQLITE_OK)
+        return false;
+    QStringList pragmas = DatabaseConnection::getStoragePragmas(*profile);
+    for (int i=0; i<pragmas.size(); i++)
+        sqlite3_exec(db, pragmas[i].toUtf8().constData(), NULL, NULL, NULL);
+
+    sqlite3_stmt *select;
+    sqlite3_prepare_v2(db, "select data from DataStore where lid=? and key=?", -1, &select, NULL);
+    qsrand(42);
+    bool ok = true;
+    for (int i=0; i<LOOKUPS && ok; i++) {
+        int lid = (qrand()%5 < 4) ? 1+qrand()%HOT_NOTES : 1+qrand()%DATABASE_NOTES;
+        sqlite3_bind_int(select, 1, lid);
+        sqlite3_bind_int(select, 2, 5000+qrand()%NOTE_KEYS);
+        ok = sqlite3_step(select) == SQLITE_ROW;
+        sqlite3_reset(select);
+    }
+    sqlite3_finalize(select);
+
+    int highwater;
+    sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_HIT, &hits, &highwater, 0);
+    sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_MISS, &misses, &highwater, 0);
+    sqlite3_close(db);
+    return ok;
+}
+
+
+
+// The Qt connection really is tuned by its role
+void TestStorageProfile::connectionUsesProfile() {
+    DatabaseConnection *sync = new DatabaseConnection("syncrunner");
+    QCOMPARE(sync->getStorageRole(), QString("sync"));
+    int cacheSize = 0;
+    int synchronous = -1;
+    {
+        NSqlQuery query(sync);
+        if (query.exec("pragma cache_size") && query.next())
+            cacheSize = query.value(0).toInt();
+        if (query.exec("pragma synchronous") && query.next())
+            synchronous = query.value(0).toInt();
+    }
+    delete sync;
+    QSqlDatabase::removeDatabase("syncrunner");
+    QCOMPARE(cacheSize, -global.getStorageProfile("sync").cacheSize);
+    QCOMPARE(synchronous, 1);
+}
+
+
+
+// Without memory mapping every page comes through the cache, so the
+// GUI's large cache should miss less than the small "other" one.
+void TestStorageProfile::biggerCacheHitsMore() {
+    StorageProfile gui = profile("gui");
+    StorageProfile other = profile("other");
+    gui.mmapSize = 0;
+    other.mmapSize = 0;
+    int guiHits, guiMisses, otherHits, otherMisses;
+    QVERIFY(readDatabase(&gui, guiHits, guiMisses));
+    QVERIFY(readDatabase(&other, otherHits, otherMisses));
+    qDebug() << "gui:" << guiHits << "hits" << guiMisses << "misses.  other:"
+             << otherHits << "hits" << otherMisses << "misses.";
+    QVERIFY(guiMisses < otherMisses);
+}
+
+
+
+void TestStorageProfile::benchmarkProfile_data() {
+    QTest::addColumn<QString>("name");
+    QTest::newRow("baseline") << "baseline";
+    QTest::newRow("gui") << "gui";
+    QTest::newRow("sync") << "sync";
+    QTest::newRow("index") << "index";
+    QTest::newRow("counter") << "counter";
+    QTest::newRow("other") << "other";
+}
+
+
+
+// Time the reads & report the hit rate.  Pages read through the memory
+// map don't go through the cache, so those profiles show few lookups.
+void TestStorageProfile::benchmarkProfile() {
+    QFETCH(QString, name);
+    StorageProfile settings = profile(name);
+    int hits = 0;
+    int misses = 0;
+    QBENCHMARK {
+        QVERIFY(readDatabase(&settings, hits, misses));
+    }
+    double rate = hits+misses > 0 ? 100.0*hits/(hits+misses) : 100.0;
+    qDebug() << name << "cache" << settings.cacheSize << "KiB, mmap" << settings.mmapSize
+             << "MiB:" << hits << "hits" << misses << "misses," << rate << "% hit rate";
+}
+
+
+QTEST_MAIN(TestStorageProfile)
+#include "tst_storageprofile.moc"
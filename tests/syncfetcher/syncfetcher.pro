@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Concurrent sync downloads from a fake NoteStore
+# with latency added to every reply.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_syncfetcher
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_syncfetcher.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,177 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QUuid>
+#include "testdatabase.h"
+#include "fakenotestore.h"
+#include "communication/syncfetcher.h"
+
+#define CHUNK_NOTES 20
+#define REPLY_LATENCY 100
+
+//**********************************************************
+// Downloading a sync chunk from a NoteStore that takes a
+// while to answer.  Fetching one note at a time pays the
+// latency for every note; the fetcher should only pay it
+// once for each group of requests it keeps running.
+//**********************************************************
+class TestSyncFetcher : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    FakeNoteStore server;
+    QStringList noteGuids;
+    QStringList resourceGuids;
+    qint64 fetchChunk(int maxRunning);
+
+private slots:
+    void initTestCase();
+    void keepsChunkOrder();
+    void limitsRequestsRunning();
+    void retriesFailedRequest();
+    void concurrentIsFaster();
+    void benchmarkFetch_data();
+    void benchmarkFetch();
+};
+
+
+
+void TestSyncFetcher::initTestCase() {
+    QVERIFY(database.open());
+    QVERIFY(server.start());
+    for (int i=0; i<CHUNK_NOTES; i++) {
+        Note note;
+        note.guid = QUuid::createUuid().toString().remove("{").remove("}");
+        note.title = "Note " + QString::number(i);
+        note.content = "<en-note>Note " + QString::number(i) + "</en-note>";
+        server.notes.insert(note.guid, note);
+        noteGuids.append(note.guid);
+
+        Resource resource;
+        Data data;
+        data.body = "Resource " + QByteArray::number(i);
+        data.size = data.body->size();
+        resource.guid = QUuid::createUuid().toString().remove("{").remove("}");
+        resource.noteGuid = note.guid;
+        resource.data = data;
+        server.resources.insert(resource.guid, resource);
+        resourceGuids.append(resource.guid);
+    }
+    server.latency = REPLY_LATENCY;
+}
+
+
+
+// Download the whole chunk & return how long it took in milliseconds
+qint64 TestSyncFetcher::fetchChunk(int maxRunning) {
+    NoteStore noteStore(server.url(), "token");
+    SyncFetcher fetcher(&noteStore, "token", maxRunning);
+    for (int i=0; i<noteGuids.size(); i++)
+        fetcher.addNote(noteGuids[i]);
+    for (int i=0; i<resourceGuids.size(); i++)
+        fetcher.addResource(resourceGuids[i]);
+    QElapsedTimer timer;
+    timer.start();
+    if (!fetcher.fetch())
+        return -1;
+    return timer.elapsed();
+}
+
+
+
+// Replies come back in any order, but the writer needs them as requested
+void TestSyncFetcher::keepsChunkOrder() {
+    NoteStore noteStore(server.url(), "token");
+    SyncFetcher fetcher(&noteStore, "token", 8);
+    for (int i=noteGuids.size()-1; i>=0; i--)
+        fetcher.addNote(noteGuids[i]);
+    for (int i=0; i<resourceGuids.size(); i++)
+        fetcher.addResource(resourceGuids[i]);
+    QVERIFY(fetcher.fetch());
+    QCOMPARE(fetcher.notes.size(), noteGuids.size());
+    QCOMPARE(fetcher.resources.size(), resourceGuids.size());
+    for (int i=0; i<noteGuids.size(); i++) {
+        QCOMPARE(QString(fetcher.notes[i].guid), noteGuids[noteGuids.size()-1-i]);
+        QCOMPARE(QString(fetcher.notes[i].title), server.notes[noteGuids[noteGuids.size()-1-i]].title.ref());
+    }
+    for (int i=0; i<resourceGuids.size(); i++) {
+        QCOMPARE(QString(fetcher.resources[i].guid), resourceGuids[i]);
+        QCOMPARE(fetcher.resources[i].data->body.ref(), QByteArray("Resource ") + QByteArray::number(i));
+    }
+}
+
+
+
+void TestSyncFetcher::limitsRequestsRunning() {
+    server.maxInFlight = 0;
+    QVERIFY(fetchChunk(4) >= 0);
+    QVERIFY(server.maxInFlight > 1);
+    QVERIFY(server.maxInFlight <= 4);
+}
+
+
+
+// A server error is retried instead of stopping the sync
+void TestSyncFetcher::retriesFailedRequest() {
+    server.calls.clear();
+    server.failNext = 1;
+    NoteStore noteStore(server.url(), "token");
+    SyncFetcher fetcher(&noteStore, "token", 1);
+    fetcher.addNote(noteGuids[0]);
+    QVERIFY(fetcher.fetch());
+    QCOMPARE(QString(fetcher.notes[0].guid), noteGuids[0]);
+    QCOMPARE(server.calls, QStringList() << "HTTP 503" << "getNote");
+}
+
+
+
+// With four requests running the latency is paid about a quarter as often
+void TestSyncFetcher::concurrentIsFaster() {
+    qint64 serial = fetchChunk(1);
+    qint64 concurrent = fetchChunk(4);
+    qDebug() << "One at a time:" << serial << "ms.  Four at a time:" << concurrent << "ms.";
+    QVERIFY(serial >= 2*CHUNK_NOTES*REPLY_LATENCY);
+    QVERIFY(concurrent >= 0);
+    QVERIFY(concurrent*2 < serial);
+}
+
+
+
+void TestSyncFetcher::benchmarkFetch_data() {
+    QTest::addColumn<int>("maxRunning");
+    QTest::newRow("1") << 1;
+    QTest::newRow("4") << 4;
+    QTest::newRow("8") << 8;
+    QTest::newRow("16") << 16;
+}
+
+
+
+void TestSyncFetcher::benchmarkFetch() {
+    QFETCH(int, maxRunning);
+    QBENCHMARK {
+        fetchChunk(maxRunning);
+    }
+}
+
+
+QTEST_MAIN(TestSyncFetcher)
+#include "tst_syncfetcher.moc"
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Loading & updating the tag tree with 10,000
+# tags in place.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+include(../common/common.pri)
+
+TARGET = tst_tagtree
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_tagtree.cpp
+TRANSLATIONS =
+INSTALLS =
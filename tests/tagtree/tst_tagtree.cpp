@@ -0,0 +1,175 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include "testdatabase.h"
+#include "gui/ntagview.h"
+#include "sql/tagtable.h"
+#include "sql/nsqlquery.h"
+
+#define PARENT_TAGS 1000
+#define CHILD_TAGS 9
+#define UPDATED_TAGS 100
+
+//**********************************************************
+// The tag tree with 10,000 tags: a thousand parents with
+// nine children each.  Reloading after a sync or an edit
+// should update the items in place, not rebuild the tree.
+//**********************************************************
+class TestTagTree : public QObject
+{
+    Q_OBJECT
+private:
+    TestDatabase database;
+    QList<qint32> parentLids;
+    QList<qint32> childLids;
+    QStringList parentGuids;
+
+private slots:
+    void initTestCase();
+    void loadsEveryTag();
+    void parentsResolved();
+    void reloadKeepsItems();
+    void removedTagDropped();
+    void benchmarkLoad();
+    void benchmarkReload();
+    void benchmarkUpdate();
+};
+
+
+
+void TestTagTree::initTestCase() {
+    QVERIFY(database.open());
+    NSqlQuery transaction(database.db);
+    transaction.exec("begin");
+    TagTable tagTable(database.db);
+    for (int i=0; i<PARENT_TAGS; i++) {
+        qint32 lid = database.addTag("Parent " + QString::number(i));
+        QString guid;
+        tagTable.getGuid(guid, lid);
+        parentLids.append(lid);
+        parentGuids.append(guid);
+        for (int j=0; j<CHILD_TAGS; j++)
+            childLids.append(database.addTag("Child " + QString::number(i) + "." + QString::number(j), guid));
+    }
+    transaction.exec("commit");
+    transaction.finish();
+}
+
+
+
+void TestTagTree::loadsEveryTag() {
+    NTagView view;
+    view.loadData();
+    QCOMPARE(view.dataStore.size(), PARENT_TAGS*(CHILD_TAGS+1));
+}
+
+
+
+void TestTagTree::parentsResolved() {
+    NTagView view;
+    view.loadData();
+    for (int i=0; i<PARENT_TAGS; i += 97) {
+        NTagViewItem *parent = view.getItem(parentLids[i]);
+        NTagViewItem *child = view.getItem(childLids[i*CHILD_TAGS]);
+        QVERIFY(parent != NULL);
+        QVERIFY(child != NULL);
+        QCOMPARE(child->parentLid, parentLids[i]);
+        QVERIFY(child->parent() == parent);
+        QCOMPARE(parent->childCount(), CHILD_TAGS);
+    }
+}
+
+
+
+// Anything pointing at an item, like the selection history, stays valid
+void TestTagTree::reloadKeepsItems() {
+    NTagView view;
+    view.loadData();
+    NTagViewItem *before = view.getItem(childLids[5]);
+    Tag tag;
+    TagTable tagTable(database.db);
+    QVERIFY(tagTable.get(tag, childLids[5]));
+    tag.name = "Renamed child";
+    tagTable.update(tag, false);
+
+    view.loadData();
+    QVERIFY(view.getItem(childLids[5]) == before);
+    QCOMPARE(before->data(0, Qt::DisplayRole).toString(), QString("Renamed child"));
+}
+
+
+
+void TestTagTree::removedTagDropped() {
+    NTagView view;
+    view.loadData();
+    qint32 lid = database.addTag("Short lived", parentGuids[0]);
+    view.loadData();
+    QVERIFY(view.getItem(lid) != NULL);
+    QCOMPARE(view.getItem(parentLids[0])->childCount(), CHILD_TAGS+1);
+
+    TagTable tagTable(database.db);
+    tagTable.expunge(lid);
+    view.loadData();
+    QVERIFY(!view.dataStore.contains(lid));
+    QCOMPARE(view.getItem(parentLids[0])->childCount(), CHILD_TAGS);
+}
+
+
+
+// Building the tree the first time
+void TestTagTree::benchmarkLoad() {
+    QBENCHMARK {
+        NTagView view;
+        view.loadData();
+    }
+}
+
+
+
+// Reloading after a sync when nothing moved
+void TestTagTree::benchmarkReload() {
+    NTagView view;
+    view.loadData();
+    QBENCHMARK {
+        view.loadData();
+    }
+}
+
+
+
+// Sync reporting a batch of changed tags, each moved to a new parent
+void TestTagTree::benchmarkUpdate() {
+    NTagView view;
+    view.loadData();
+    int pass = 0;
+    QBENCHMARK {
+        pass++;
+        for (int i=0; i<UPDATED_TAGS; i++) {
+            qint32 lid = childLids[i*CHILD_TAGS];
+            QString parentGuid = parentGuids[(i+pass)%PARENT_TAGS];
+            view.tagUpdated(lid, "Moved " + QString::number(i), parentGuid, 0);
+        }
+        view.rebuildTree();
+    }
+}
+
+
+QTEST_MAIN(TestTagTree)
+#include "tst_tagtree.moc"
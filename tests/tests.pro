@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Unit tests.  Build & run with:
+#    qmake && make && make check
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+SUBDIRS = noteformatter \
+    largedata \
+    mimereference \
+    resourcehash \
+    attachmenticoncache \
+    searchindex \
+    syncfetcher \
+    thriftdecode \
+    noteupload \
+    storageprofile \
+    filterhistory \
+    tagtree \
+    pdftext \
+    spellcheck \
+    smtpsink \
+    notehistory \
+    noteduplicate
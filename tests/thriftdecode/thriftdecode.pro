@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Decode benchmark for sync chunks, with & without
+# interning the repeated strings.
+#
+#-------------------------------------------------
+
+VPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../..
+include(../../NixNote2.pro)
+
+TARGET = tst_thriftdecode
+QT += testlib
+CONFIG += testcase
+CONFIG -= debug_and_release
+RESOURCES = $$PWD/../../NixNote2.qrc
+SOURCES -= main.cpp
+SOURCES += tst_thriftdecode.cpp
+TRANSLATIONS =
+INSTALLS =
@@ -0,0 +1,218 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include <QtTest>
+#include <QUuid>
+#include "qevercloud/include/QEverCloud.h"
+#include "qevercloud/thrift.h"
+#include "qevercloud/generated/types_impl.h"
+
+using namespace qevercloud;
+
+#define CHUNK_NOTES 1000
+#define CHUNK_NOTEBOOKS 20
+#define CHUNK_TAGS 100
+#define TAGS_PER_NOTE 3
+
+
+// Count every heap allocation made while counting is on.  The program's
+// malloc is used ahead of the C library's, so this sees Qt's allocations
+// too.  Only glibc lets us reach the real malloc this way.
+#ifdef __GLIBC__
+#define COUNT_ALLOCATIONS
+extern "C" void *__libc_malloc(size_t size);
+static volatile bool counting = false;
+static volatile qint64 allocations = 0;
+
+extern "C" void *malloc(size_t size) {
+    if (counting)
+        allocations++;
+    return __libc_malloc(size);
+}
+#endif
+
+
+//**********************************************************
+// Decoding a sync chunk shaped like a real one: many notes
+// spread over a few notebooks & tags, with attributes and
+// resources whose values repeat from note to note.  The
+// chunk is decoded with the string pool on & off to show
+// what interning saves.
+//**********************************************************
+class TestThriftDecode : public QObject
+{
+    Q_OBJECT
+private:
+    QByteArray corpus;
+    SyncChunk decode(bool interning);
+    qint64 allocationsPerNote(bool interning);
+
+private slots:
+    void initTestCase();
+    void internedDecodeMatches();
+    void internedAllocatesLess();
+    void benchmarkDecode_data();
+    void benchmarkDecode();
+};
+
+
+
+static QString newGuid() {
+    return QUuid::createUuid().toString().remove("{").remove("}");
+}
+
+
+
+void TestThriftDecode::initTestCase() {
+    QStringList notebooks, tags, sources, mimes;
+    for (int i=0; i<CHUNK_NOTEBOOKS; i++)
+        notebooks.append(newGuid());
+    for (int i=0; i<CHUNK_TAGS; i++)
+        tags.append(newGuid());
+    sources << "mobile.android" << "mobile.ios" << "web.clip" << "evernote.win32" << "NixNote";
+    mimes << "image/png" << "image/jpeg" << "application/pdf" << "audio/wav";
+
+    SyncChunk chunk;
+    chunk.currentTime = QDateTime::currentMSecsSinceEpoch();
+    chunk.chunkHighUSN = CHUNK_NOTES;
+    chunk.updateCount = CHUNK_NOTES;
+    QList<Note> notes;
+    for (int i=0; i<CHUNK_NOTES; i++) {
+        Note note;
+        note.guid = newGuid();
+        note.title = "Note number " + QString::number(i);
+        note.contentLength = 1000+i;
+        note.contentHash = QCryptographicHash::hash(QByteArray::number(i), QCryptographicHash::Md5);
+        note.created = chunk.currentTime - i*1000;
+        note.updated = note.created;
+        note.active = true;
+        note.updateSequenceNum = i+1;
+        note.notebookGuid = notebooks[i % CHUNK_NOTEBOOKS];
+        QList<Guid> tagGuids;
+        for (int j=0; j<TAGS_PER_NOTE; j++)
+            tagGuids.append(tags[(i*7 + j*13) % CHUNK_TAGS]);
+        note.tagGuids = tagGuids;
+
+        NoteAttributes attributes;
+        attributes.source = i % 2 ? "mobile.android" : "web.clip";
+        attributes.sourceApplication = sources[i % sources.size()];
+        attributes.author = "Author " + QString::number(i % 10);
+        attributes.sourceURL = "http://example.com/page/" + QString::number(i);
+        note.attributes = attributes;
+
+        if (i % 2 == 0) {
+            Resource resource;
+            resource.guid = newGuid();
+            resource.noteGuid = note.guid;
+            resource.mime = mimes[i % mimes.size()];
+            resource.width = 640;
+            resource.height = 480;
+            Data data;
+            data.bodyHash = QCryptographicHash::hash(resource.guid.ref().toUtf8(), QCryptographicHash::Md5);
+            data.size = 50000+i;
+            resource.data = data;
+            ResourceAttributes resourceAttributes;
+            resourceAttributes.fileName = "attachment" + QString::number(i) + ".png";
+            resourceAttributes.cameraMake = "Camera";
+            resource.attributes = resourceAttributes;
+            QList<Resource> resources;
+            resources.append(resource);
+            note.resources = resources;
+        }
+        notes.append(note);
+    }
+    chunk.notes = notes;
+
+    ThriftBinaryBufferWriter w;
+    writeSyncChunk(w, chunk);
+    corpus = w.buffer();
+    qDebug() << "Corpus:" << CHUNK_NOTES << "notes," << corpus.size() << "bytes";
+}
+
+
+
+SyncChunk TestThriftDecode::decode(bool interning) {
+    ThriftBinaryBufferReader r(corpus);
+    r.setInterning(interning);
+    SyncChunk chunk;
+    readSyncChunk(r, chunk);
+    return chunk;
+}
+
+
+
+// Heap allocations made decoding the chunk, divided by the notes in it.
+// The pool is warmed up first, like it is part way through a long sync.
+qint64 TestThriftDecode::allocationsPerNote(bool interning) {
+#ifdef COUNT_ALLOCATIONS
+    decode(interning);
+    allocations = 0;
+    counting = true;
+    SyncChunk chunk = decode(interning);
+    counting = false;
+    return allocations / CHUNK_NOTES;
+#else
+    Q_UNUSED(interning);
+    return -1;
+#endif
+}
+
+
+
+// Interning may only change where the strings live, never what they are
+void TestThriftDecode::internedDecodeMatches() {
+    SyncChunk plain = decode(false);
+    SyncChunk interned = decode(true);
+    QCOMPARE(interned.notes->size(), CHUNK_NOTES);
+    QVERIFY(interned == plain);
+}
+
+
+
+void TestThriftDecode::internedAllocatesLess() {
+#ifndef COUNT_ALLOCATIONS
+    QSKIP("Allocations can only be counted with glibc");
+#endif
+    qint64 plain = allocationsPerNote(false);
+    qint64 interned = allocationsPerNote(true);
+    qDebug() << "Allocations per note:" << plain << "without interning," << interned << "with interning";
+    QVERIFY(interned < plain);
+}
+
+
+
+void TestThriftDecode::benchmarkDecode_data() {
+    QTest::addColumn<bool>("interning");
+    QTest::newRow("plain") << false;
+    QTest::newRow("interned") << true;
+}
+
+
+
+void TestThriftDecode::benchmarkDecode() {
+    QFETCH(bool, interning);
+    decode(interning);
+    QBENCHMARK {
+        decode(interning);
+    }
+}
+
+
+QTEST_MAIN(TestThriftDecode)
+#include "tst_thriftdecode.moc"
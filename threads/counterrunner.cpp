@@ -29,6 +29,7 @@ CounterRunner::CounterRunner(QObject *parent) :
     QObject(parent)
 {
     init = false;
+    filterGeneration = -1;
 }
 
 
@@ -42,6 +43,29 @@ void CounterRunner::initialize() {
 }
 
 
+
+// Copy the notes the note list is showing into this connection's
+// filter table.  It is only rebuilt if the selection has changed
+// since the last count.
+void CounterRunner::loadFilter() {
+    QList<qint32> lids;
+    qint32 generation = global.getFilterSnapshot(lids);
+    if (generation == filterGeneration)
+        return;
+    filterGeneration = generation;
+
+    NSqlQuery sql(db);
+    sql.exec("begin");
+    sql.exec("delete from filter");
+    sql.prepare("insert into filter (lid) values (:lid)");
+    for (int i=0; i<lids.size(); i++) {
+        sql.bindValue(":lid", lids[i]);
+        sql.exec();
+    }
+    sql.exec("commit");
+}
+
+
 void CounterRunner::countAll() {
     if (global.countBehavior == Global::CountNone)
         return;
@@ -75,6 +99,7 @@ void CounterRunner::countNotebooks() {
     QLOG_TRACE_IN();
     if (!init)
         initialize();
+    loadFilter();
 
     // First get every possible notebook
     NotebookTable nTable(db);
@@ -118,6 +143,8 @@ void CounterRunner::countTags() {
     QLOG_TRACE_IN();
     if (!init)
         initialize();
+    loadFilter();
+
     // First get every possible tag
     TagTable tTable(db);
     QList<qint32> lids;
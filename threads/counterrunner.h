@@ -38,6 +38,8 @@ private:
     DatabaseConnection *db;
     void initialize();
     bool init;
+    qint32 filterGeneration;
+    void loadFilter();
 
 public:
     explicit CounterRunner(QObject *parent = 0);
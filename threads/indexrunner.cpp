@@ -22,8 +22,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "sql/notetable.h"
 #include "sql/nsqlquery.h"
 #include "sql/resourcetable.h"
+#include "sql/pdftexttable.h"
 #include <QTextDocument>
 #include <QtXml>
+#include <QThreadPool>
+#include <QRunnable>
 #if QT_VERSION < 0x050000
 #include <poppler-qt4.h>
 #else
@@ -329,8 +332,103 @@ void IndexRunner::indexRecognition(qint32 lid, Resource &r) {
 }
 
 
-// Index any PDFs that are attached.  Basically it turns the PDF into text and adds it the same
-// way as a note's body
+// Pulls the text & word locations out of a share of the pages of a PDF.
+// Several of these run at once.  Poppler documents can't be shared
+// between threads so each opens its own copy.
+class PdfPageExtractor : public QRunnable
+{
+public:
+    QString file;
+    int firstPage;
+    int step;
+    const bool *keepRunning;
+    const bool *pauseIndexing;
+    QList<int> pages;
+    QStringList text;
+    QList<QByteArray> words;
+
+    void run() {
+        Poppler::Document *doc = Poppler::Document::load(file);
+        if (doc == NULL)
+            return;
+        if (!doc->isLocked()) {
+            for (int i=firstPage; *keepRunning && !*pauseIndexing && i<doc->numPages(); i=i+step) {
+                Poppler::Page *page = doc->page(i);
+                if (page == NULL)
+                    continue;
+                QStringList pageWords;
+                QList<QRectF> boxes;
+                QList<Poppler::TextBox*> textBoxes = page->textList();
+                for (int j=0; j<textBoxes.size(); j++) {
+                    pageWords.append(textBoxes[j]->text());
+                    boxes.append(textBoxes[j]->boundingBox());
+                }
+                qDeleteAll(textBoxes);
+                delete page;
+                pages.append(i);
+                text.append(pageWords.join(" "));
+                words.append(PdfTextTable::packWords(pageWords, boxes));
+            }
+        }
+        delete doc;
+    }
+};
+
+
+
+// Pull the text out of every page of a PDF, spreading the pages
+// across a few threads.
+bool IndexRunner::extractPdf(QString file, QStringList &pages, QList<QByteArray> &words) {
+    pages.clear();
+    words.clear();
+    Poppler::Document *doc = Poppler::Document::load(file);
+    if (doc == NULL || doc->isEncrypted() || doc->isLocked()) {
+        if (doc != NULL)
+            delete doc;
+        return false;
+    }
+    int pageCount = doc->numPages();
+    delete doc;
+
+    QThreadPool pool;
+    int threads = qBound(1, QThread::idealThreadCount()-1, 4);
+    threads = qMin(threads, pageCount);
+    pool.setMaxThreadCount(qMax(threads, 1));
+    QList<PdfPageExtractor*> extractors;
+    for (int i=0; i<threads; i++) {
+        PdfPageExtractor *extractor = new PdfPageExtractor();
+        extractor->setAutoDelete(false);
+        extractor->file = file;
+        extractor->firstPage = i;
+        extractor->step = threads;
+        extractor->keepRunning = &keepRunning;
+        extractor->pauseIndexing = &pauseIndexing;
+        extractors.append(extractor);
+        pool.start(extractor);
+    }
+    pool.waitForDone();
+
+    for (int i=0; i<pageCount; i++) {
+        pages.append("");
+        words.append(QByteArray());
+    }
+    for (int i=0; i<extractors.size(); i++) {
+        PdfPageExtractor *extractor = extractors[i];
+        for (int j=0; j<extractor->pages.size(); j++) {
+            pages[extractor->pages[j]] = extractor->text[j];
+            words[extractor->pages[j]] = extractor->words[j];
+        }
+    }
+    qDeleteAll(extractors);
+    return keepRunning && !pauseIndexing;
+}
+
+
+
+// Index any PDFs that are attached.  Each page is added to the index
+// separately (with a source of "pdf:<page>") so a search can tell which
+// pages matched.  The text is cached, so it is only pulled out of the
+// PDF again if the PDF changes.
 void IndexRunner::indexPdf(qint32 lid, Resource &r) {
     if (!global.indexPDFLocally)
         return;
@@ -340,32 +438,50 @@ void IndexRunner::indexPdf(qint32 lid, Resource &r) {
     }
     ResourceTable rtable(db);
     qint32 reslid = rtable.getLid(r.guid);
-    if (lid <= 0) {
+    if (lid <= 0 || reslid <= 0) {
         //indexTimer->start();
         return;
     }
     QString file = global.fileManager.getDbaDirPath() + QString::number(reslid) +".pdf";
 
-    QString text = "";
-    Poppler::Document *doc = Poppler::Document::load(file);
-    if (doc == NULL || doc->isEncrypted() || doc->isLocked()) {
-        //indexTimer->start();
-        return;
+    QString hash = "";
+    if (r.data.isSet()) {
+        Data d = r.data;
+        if (d.bodyHash.isSet())
+            hash = QString(QByteArray(d.bodyHash).toHex());
     }
-    for (int i=0; keepRunning && !pauseIndexing && i<doc->numPages(); i++) {
-        QRectF rect;
-        text = text + doc->page(i)->text(rect) + QString(" ");
+
+    PdfTextTable pdfTable(db);
+    QStringList pages;
+    if (hash == "" || !pdfTable.getText(reslid, hash, pages)) {
+        QList<QByteArray> words;
+        if (!extractPdf(file, pages, words))
+            return;
+        pdfTable.save(reslid, hash, pages, words);
     }
-    IndexRecord *rec = new IndexRecord();
-    rec->content = text;
-    rec->source = "recognition";
-    rec->weight = 100;
-    rec->lid = lid;
-    if (indexHash->contains(lid)) {
-        delete indexHash->value(lid);
-        indexHash->remove(lid);
+
+    NSqlQuery sql(db);
+    db->lockForWrite();
+    sql.exec("savepoint indexPdf");
+    sql.prepare("Delete from SearchIndex where lid=:lid and source like 'pdf:%'");
+    sql.bindValue(":lid", reslid);
+    sql.exec();
+    sql.prepare("Insert into SearchIndex (lid, weight, source, content) values (:lid, :weight, :source, :content)");
+    for (int i=0; i<pages.size(); i++) {
+        if (pages[i].trimmed() == "")
+            continue;
+        sql.bindValue(":lid", reslid);
+        sql.bindValue(":weight", 100);
+        sql.bindValue(":source", "pdf:"+QString::number(i));
+        if (!global.forceSearchLowerCase)
+            sql.bindValue(":content", pages[i]);
+        else
+            sql.bindValue(":content", pages[i].toLower());
+        sql.exec();
     }
-    indexHash->insert(lid, rec);
+    sql.exec("release indexPdf");
+    sql.finish();
+    db->unlock();
 }
 
 
@@ -59,6 +59,7 @@ public:
 class IndexRunner : public QObject
 {
     Q_OBJECT
+    friend class TestPdfText;
 private:
 //    QTimer *indexTimer;
     QHash<qint32, IndexRecord*> *indexHash;
@@ -66,6 +67,7 @@ private:
     void indexRecognition(qint32 lid, Resource &r);
     void indexNote(qint32 lid, Note &n);
     void indexPdf(qint32 lid, Resource &r);
+    bool extractPdf(QString file, QStringList &pages, QList<QByteArray> &words);
     void indexAttachment(qint32 lid, Resource &r);
     QTextDocument *textDocument;
     DatabaseConnection *db;
@@ -0,0 +1,161 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "maintenancerunner.h"
+#include "sql/nsqlquery.h"
+
+#include <QFileInfo>
+
+MaintenanceRunner::MaintenanceRunner(QObject *parent) :
+    QObject(parent)
+{
+    init = false;
+    syncRunning = false;
+    timer = NULL;
+    db = NULL;
+    lastCheckpointPages = 0;
+}
+
+
+
+void MaintenanceRunner::initialize() {
+    init = true;
+    QLOG_DEBUG() << "Starting MaintenanceRunner";
+    db = new DatabaseConnection("maintenancerunner");
+}
+
+
+
+// Start the timer.  This must be called after we've been moved to
+// our thread so the timer belongs to it.
+void MaintenanceRunner::start() {
+    if (timer != NULL)
+        return;
+    timer = new QTimer(this);
+    connect(timer, SIGNAL(timeout()), this, SLOT(timerExpired()));
+    timer->start(global.walCheckpointInterval*60*1000);
+}
+
+
+
+// Time to do some housekeeping.  A passive checkpoint never waits
+// on anyone, so it is always done.  If the WAL is still too big
+// afterwards we try to truncate it.
+void MaintenanceRunner::timerExpired() {
+    if (syncRunning)
+        return;
+    if (!init)
+        initialize();
+
+    checkpoint(false);
+    if (walSize() > qint64(global.walTruncateSize)*1024*1024)
+        checkpoint(true);
+
+    if (!lastOptimize.isValid() || lastOptimize.secsTo(QDateTime::currentDateTime()) > 60*60)
+        optimize();
+}
+
+
+
+void MaintenanceRunner::syncStarted() {
+    syncRunning = true;
+}
+
+
+
+// A sync can leave a very large WAL behind, so clean it up as soon
+// as the sync is done.
+void MaintenanceRunner::syncFinished() {
+    syncRunning = false;
+    timerExpired();
+}
+
+
+
+// Copy the WAL back into the database.  A truncating checkpoint has to
+// wait for readers to finish, so it gets a short busy timeout rather
+// than holding up the other threads.
+void MaintenanceRunner::checkpoint(bool truncate) {
+    QString mode = truncate ? "TRUNCATE" : "PASSIVE";
+    NSqlQuery sql(db);
+    if (truncate)
+        sql.exec("pragma busy_timeout=1000");
+    sql.exec("pragma wal_checkpoint(" +mode +")");
+    bool busy = true;
+    qint32 pages = 0;
+    if (sql.next()) {
+        busy = sql.value(0).toInt() != 0;
+        pages = sql.value(2).toInt();
+    }
+    sql.finish();
+    if (truncate)
+        sql.exec("pragma busy_timeout=50000");
+
+    QLOG_DEBUG() << "WAL checkpoint " << mode << " busy:" << busy << " pages:" << pages;
+    if (busy)
+        return;
+
+    QMutexLocker locker(&statusMutex);
+    lastCheckpoint = QDateTime::currentDateTime();
+    lastCheckpointMode = mode;
+    lastCheckpointPages = pages;
+}
+
+
+
+// Let SQLite refresh its statistics.  The analysis limit keeps ANALYZE
+// from reading every row of the big tables.  The first time through
+// there may not be any statistics at all, so do a full ANALYZE.
+void MaintenanceRunner::optimize() {
+    NSqlQuery sql(db);
+    sql.exec("pragma analysis_limit=1000");
+    sql.exec("select name from sqlite_master where type='table' and name='sqlite_stat1'");
+    bool analyzed = sql.next();
+    sql.finish();
+    if (!analyzed)
+        sql.exec("analyze");
+    else
+        sql.exec("pragma optimize");
+    sql.finish();
+
+    QMutexLocker locker(&statusMutex);
+    lastOptimize = QDateTime::currentDateTime();
+}
+
+
+
+// Get the size of the WAL file.
+qint64 MaintenanceRunner::walSize() {
+    QFileInfo wal(global.fileManager.getDbDirPath("nixnote.db-wal"));
+    if (!wal.exists())
+        return 0;
+    return wal.size();
+}
+
+
+
+// Get the results of the last checkpoint & optimize.  This is called
+// from the GUI thread.
+void MaintenanceRunner::getStatus(QDateTime &checkpointTime, QString &checkpointMode, qint32 &checkpointPages, QDateTime &optimizeTime) {
+    QMutexLocker locker(&statusMutex);
+    checkpointTime = lastCheckpoint;
+    checkpointMode = lastCheckpointMode;
+    checkpointPages = lastCheckpointPages;
+    optimizeTime = lastOptimize;
+}
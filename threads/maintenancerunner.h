@@ -0,0 +1,67 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2013 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef MAINTENANCERUNNER_H
+#define MAINTENANCERUNNER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QDateTime>
+#include "global.h"
+#include "sql/databaseconnection.h"
+
+extern Global global;
+
+//************************************************************
+//* Background database housekeeping.  This checkpoints the
+//* WAL so it doesn't keep growing after large syncs and lets
+//* SQLite refresh its query planner statistics.  Nothing is
+//* done while a sync is running.
+//************************************************************
+class MaintenanceRunner : public QObject
+{
+    Q_OBJECT
+private:
+    DatabaseConnection *db;
+    QTimer *timer;
+    bool init;
+    bool syncRunning;
+    QMutex statusMutex;
+    QDateTime lastCheckpoint;
+    QString lastCheckpointMode;
+    qint32 lastCheckpointPages;
+    QDateTime lastOptimize;
+    void initialize();
+    void checkpoint(bool truncate);
+    void optimize();
+
+public:
+    explicit MaintenanceRunner(QObject *parent = 0);
+    static qint64 walSize();
+    void getStatus(QDateTime &checkpointTime, QString &checkpointMode, qint32 &checkpointPages, QDateTime &optimizeTime);
+
+public slots:
+    void start();
+    void timerExpired();
+    void syncStarted();
+    void syncFinished();
+};
+
+#endif // MAINTENANCERUNNER_H
@@ -0,0 +1,224 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#include "notehistoryrunner.h"
+#include "sql/noteversiontable.h"
+#include "sql/usertable.h"
+#include "sql/resourcetable.h"
+#include "global.h"
+
+extern Global global;
+
+NoteHistoryRunner::NoteHistoryRunner(QObject *parent) :
+    QObject(parent)
+{
+    init = false;
+    connected = false;
+    fetchScheduled = false;
+    db = NULL;
+    comm = NULL;
+}
+
+
+
+NoteHistoryRunner::~NoteHistoryRunner() {
+    if (comm != NULL)
+        delete comm;
+}
+
+
+
+void NoteHistoryRunner::initialize() {
+    init = true;
+    QLOG_DEBUG() << "Starting NoteHistoryRunner";
+    db = new DatabaseConnection("historyrunner");
+    comm = new CommunicationManager(db);
+}
+
+
+
+// Connect to Evernote.  The connection is reused for later requests
+// rather than connecting each time the history is viewed.
+bool NoteHistoryRunner::connectToEvernote() {
+    if (!init)
+        initialize();
+    if (connected)
+        return true;
+    if (!global.accountsManager->oauthTokenFound())
+        return false;
+    comm->error.reset();
+    connected = comm->enConnect();
+    if (!connected)
+        QLOG_DEBUG() << "NoteHistoryRunner unable to connect to Evernote";
+    return connected;
+}
+
+
+
+// Only premium users can see a note's history
+bool NoteHistoryRunner::premiumUser() {
+    UserTable userTable(db);
+    User user;
+    userTable.getUser(user);
+    return !(user.privilege.isSet() && user.privilege == PrivilegeLevel::NORMAL);
+}
+
+
+
+// Get the list of versions Evernote has for a note.  Nothing is
+// downloaded if the cached list is still current.
+void NoteHistoryRunner::loadVersions(QString guid, qint32 noteUsn) {
+    if (!init)
+        initialize();
+    NoteVersionTable versionTable(db);
+    QList<NoteVersionId> versions;
+    if (versionTable.getVersions(guid, noteUsn, versions)) {
+        emit versionsReady(guid);
+        return;
+    }
+    if (!premiumUser() || !connectToEvernote())
+        return;
+
+    if (!comm->listNoteVersions(versions, guid)) {
+        connected = false;
+        return;
+    }
+    versionTable.saveVersions(guid, noteUsn, versions);
+    emit versionsReady(guid);
+}
+
+
+
+// Queue a version of a note to be downloaded.  Versions being restored
+// go to the front of the queue, since the user is waiting on them.
+void NoteHistoryRunner::loadVersion(QString guid, qint32 usn, bool restore) {
+    PendingNoteVersion version;
+    version.guid = guid;
+    version.usn = usn;
+    version.withData = restore;
+    pendingVersions.removeAll(version);
+    if (restore)
+        pendingVersions.prepend(version);
+    else
+        pendingVersions.append(version);
+    if (!fetchScheduled) {
+        fetchScheduled = true;
+        QMetaObject::invokeMethod(this, "fetchNextVersion", Qt::QueuedConnection);
+    }
+}
+
+
+
+// The history dialog has closed, so nobody wants the versions we
+// were getting ready.
+void NoteHistoryRunner::cancelVersions() {
+    pendingVersions.clear();
+}
+
+
+
+// Download one version, then come back for the next.  Going back through
+// the event loop between each lets a version the user is waiting on jump
+// ahead of the ones being prefetched.  Only the note itself is downloaded
+// unless the version is being restored.
+void NoteHistoryRunner::fetchNextVersion() {
+    fetchScheduled = false;
+    if (pendingVersions.size() == 0)
+        return;
+    if (!init)
+        initialize();
+
+    PendingNoteVersion version = pendingVersions.takeFirst();
+    NoteVersionTable versionTable(db);
+
+    // Past versions never change, so if we have it we are done.  The
+    // current version (0) is always downloaded again.
+    Note note;
+    bool loaded = version.usn > 0 && versionTable.getVersion(version.guid, version.usn, note);
+    bool downloaded = false;
+    if (!loaded && connectToEvernote()) {
+        if (version.usn > 0)
+            loaded = comm->getNoteVersion(note, version.guid, version.usn, false, false, false);
+        else
+            loaded = comm->getNote(note, version.guid, false, false, false);
+        downloaded = loaded;
+        if (!loaded)
+            connected = false;
+    }
+
+    bool found = loaded;
+    if (loaded && version.withData) {
+        bool changed = false;
+        found = loadResourceData(note, changed);
+        downloaded = downloaded || changed;
+    }
+    if (downloaded)
+        versionTable.saveVersion(version.guid, version.usn, note);
+    emit versionReady(version.guid, version.usn, found);
+
+    if (pendingVersions.size() > 0) {
+        fetchScheduled = true;
+        QMetaObject::invokeMethod(this, "fetchNextVersion", Qt::QueuedConnection);
+    }
+}
+
+
+
+// Fill in the data of a version's attachments so it can be restored.
+// Most are unchanged from the note we already have, so only the ones
+// we don't have are downloaded.
+bool NoteHistoryRunner::loadResourceData(Note &note, bool &changed) {
+    changed = false;
+    if (!note.resources.isSet())
+        return true;
+    ResourceTable resourceTable(db);
+    QList<Resource> resources = note.resources;
+    for (int i=0; i<resources.size(); i++) {
+        Resource r = resources[i];
+        if (!r.data.isSet() || r.data->body.isSet() || !r.data->bodyHash.isSet())
+            continue;
+        Data data = r.data;
+        Resource local;
+        qint32 lid = resourceTable.getLidByHashHex(note.guid, data.bodyHash->toHex());
+        if (lid > 0 && resourceTable.get(local, lid, true) && local.data.isSet() &&
+                local.data->body.isSet() && local.data->body->size() > 0) {
+            data.body = local.data->body;
+        } else {
+            QByteArray body;
+            if (!connectToEvernote() || !r.guid.isSet())
+                break;
+            if (!comm->getResourceData(body, r.guid)) {
+                connected = false;
+                break;
+            }
+            data.body = body;
+        }
+        r.data = data;
+        resources[i] = r;
+        changed = true;
+    }
+    if (changed)
+        note.resources = resources;
+    for (int i=0; i<resources.size(); i++) {
+        const Resource &r = resources[i];
+        if (r.data.isSet() && r.data->bodyHash.isSet() && !r.data->body.isSet())
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+#ifndef NOTEHISTORYRUNNER_H
+#define NOTEHISTORYRUNNER_H
+
+#include <QObject>
+#include <QList>
+#include "sql/databaseconnection.h"
+#include "communication/communicationmanager.h"
+
+// Number of the newest versions downloaded while the history dialog is open
+#define NOTE_HISTORY_PREFETCH 5
+
+// How long a note must stay open (in ms) before its list of versions is requested
+#define NOTE_HISTORY_PREFETCH_DELAY 5000
+
+//*************************************
+//* Downloads the history of notes in
+//* the background & caches it in the
+//* NoteVersionList & NoteVersionCache
+//* tables.  The GUI only ever reads
+//* the cache.  Versions are downloaded
+//* without their attachments' data,
+//* which is only filled in when a
+//* version is restored.
+//*************************************
+
+// A version waiting to be downloaded
+struct PendingNoteVersion {
+    QString guid;
+    qint32 usn;             // 0 is the current version
+    bool withData;          // Is it being restored?  If so its attachments are needed too
+    bool operator==(const PendingNoteVersion &other) const {
+        return guid == other.guid && usn == other.usn;
+    }
+};
+
+class NoteHistoryRunner : public QObject
+{
+    Q_OBJECT
+    friend class TestNoteHistory;
+private:
+    DatabaseConnection *db;
+    CommunicationManager *comm;
+    bool init;
+    bool connected;
+    bool fetchScheduled;
+    QList<PendingNoteVersion> pendingVersions;  // Versions waiting to be downloaded
+    void initialize();
+    bool connectToEvernote();
+    bool premiumUser();
+    bool loadResourceData(Note &note, bool &changed);
+
+public:
+    explicit NoteHistoryRunner(QObject *parent = 0);
+    ~NoteHistoryRunner();
+
+signals:
+    void versionsReady(QString guid);                   // The list of versions has been cached
+    void versionReady(QString guid, qint32 usn, bool found);   // A version has been downloaded (or couldn't be)
+
+public slots:
+    void loadVersions(QString guid, qint32 noteUsn);     // Download the list of a note's versions
+    void loadVersion(QString guid, qint32 usn, bool restore);    // Queue a version to be downloaded.  0 is the current version
+    void cancelVersions();                               // Forget the versions waiting to be downloaded
+
+private slots:
+    void fetchNextVersion();
+};
+
+#endif // NOTEHISTORYRUNNER_H
@@ -18,6 +18,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 ***********************************************************************************/
 
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QRunnable>
 
 #include "syncrunner.h"
 #include "global.h"
@@ -33,15 +35,51 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "nixnote.h"
 #include "communication/communicationmanager.h"
 #include "communication/communicationerror.h"
+#include "communication/linkedsyncchecker.h"
+#include "communication/syncfetcher.h"
 #include "sql/nsqlquery.h"
 
 extern Global global;
 
+
+// Saves a downloaded thumbnail or ink note image.  PNG encoding is the slow
+// part of saving a chunk, so it is done on a pool thread instead of the sync
+// thread.  The pool has a single thread so images are written in order.
+// The image is written under a temporary name and renamed into place, so a
+// reader on the sync thread either finds the whole file or none at all.
+class ImageWriter : public QRunnable {
+private:
+    QImage *image;
+    QString filename;
+
+public:
+    ImageWriter(QImage *image, QString filename) {
+        this->image = image;
+        this->filename = filename;
+    }
+    ~ImageWriter() {
+        delete image;
+    }
+    void run() {
+        QString part = filename + ".part";
+        QFile::remove(part);
+        if (image->save(part, "png")) {
+            QFile::remove(filename);
+            if (!QFile::rename(part, filename))
+                QFile::remove(part);
+        } else {
+            QFile::remove(part);
+        }
+    }
+};
+
+
 SyncRunner::SyncRunner()
 {
     init = false;
     finalSync = false;
     apiRateLimitExceeded=false;
+    imageWriters.setMaxThreadCount(1);
 }
 
 SyncRunner::~SyncRunner() {
@@ -88,6 +126,8 @@ void SyncRunner::synchronize() {
     global.connected = true;
     keepRunning = true;
     evernoteSync();
+    imageWriters.waitForDone();
+    SyncFetcher::removeSpillFiles();
     emit syncComplete();
     comm->enDisconnect();
     global.connected=false;
@@ -238,7 +278,10 @@ bool SyncRunner::syncRemoteToLocal(qint32 updateCount) {
         int pct = (updateSequenceNumber-startingSequenceNumber)*100/(updateCount-startingSequenceNumber);
         emit setMessage(tr("Download ") +QString::number(pct) + tr("% complete for notebooks, tags, & searches."), defaultMsgTimeout);
 
-        processSyncChunk(chunk);
+        if (!processSyncChunk(chunk)) {
+            QLOG_TRACE_OUT();
+            return false;
+        }
 
         updateSequenceNumber = chunk.chunkHighUSN;
         if (!chunk.chunkHighUSN.isSet() || chunk.chunkHighUSN >= chunk.updateCount)
@@ -267,7 +310,10 @@ bool SyncRunner::syncRemoteToLocal(qint32 updateCount) {
         QLOG_DEBUG() << "-(Pass 2) ->>>>  Old USN:" << updateSequenceNumber << " New USN:" << chunk.chunkHighUSN;
         int pct = (updateSequenceNumber-startingSequenceNumber)*100/(updateCount-startingSequenceNumber);
         emit setMessage(tr("Download ") +QString::number(pct) + tr("% complete."), defaultMsgTimeout);
-        processSyncChunk(chunk);
+        if (!processSyncChunk(chunk)) {
+            QLOG_TRACE_OUT();
+            return false;
+        }
 
         userTable.updateLastSyncNumber(chunk.chunkHighUSN);
         userTable.updateLastSyncDate(chunk.currentTime);
@@ -286,8 +332,19 @@ bool SyncRunner::syncRemoteToLocal(qint32 updateCount) {
 
 
 
-// Deal with the sync chunk returned
-void SyncRunner::processSyncChunk(SyncChunk &chunk, qint32 linkedNotebook) {
+// Deal with the sync chunk returned.  The whole chunk is applied under one
+// savepoint rather than one autocommit per statement.  If it can't be applied
+// completely it is rolled back and false is returned, so the caller must not
+// move its USN past this chunk.
+bool SyncRunner::processSyncChunk(SyncChunk &chunk, qint32 linkedNotebook) {
+    QElapsedTimer timer;
+    timer.start();
+    NSqlQuery transaction(db);
+    if (!transaction.exec("savepoint syncchunk")) {
+        QLOG_ERROR() << "Unable to start sync chunk: " << transaction.lastError();
+        pendingSignals.clear();
+        return false;
+    }
 
     // Now start processing the chunk
     if (chunk.expungedNotes.isSet())
@@ -337,32 +394,111 @@ void SyncRunner::processSyncChunk(SyncChunk &chunk, qint32 linkedNotebook) {
     chunk.linkedNotebooks.clear();
     chunk.searches.clear();
 
-    // Save any thumbnails notes
+    // Save any thumbnails notes.  The images are only written once the
+    // chunk has been released, since their lids may not survive a rollback.
+    QList<ImageWriter*> writers;
+    NoteTable nTable(db);
     while (comm->thumbnailList->size() > 0) {
         QPair<QString, QImage *> *pair = comm->thumbnailList->takeFirst();
-        NoteTable nTable(db);
         qint32 lid = nTable.getLid(pair->first);
         if (lid > 0) {
             QString filename = global.fileManager.getThumbnailDirPath() + QString::number(lid) + QString(".png");
-            pair->second->save(filename, "png");
             nTable.setThumbnail(lid, filename);
+            writers.append(new ImageWriter(pair->second, filename));
+        } else {
+            delete pair->second;
         }
-        delete pair->second;
         delete pair;
     }
 
     // Save any ink notes
+    ResourceTable resTable(db);
     while (comm->inkNoteList->size() > 0) {
         QPair<QString, QImage *> *pair = comm->inkNoteList->takeFirst();
-        ResourceTable resTable(db);
         qint32 resLid = resTable.getLid(pair->first);
         if (resLid > 0) {
             QString filename = global.fileManager.getDbaDirPath() + QString::number(resLid) + QString(".png");
-            pair->second->save(filename);
+            writers.append(new ImageWriter(pair->second, filename));
+        } else {
+            delete pair->second;
         }
-        delete pair->second;
         delete pair;
     }
+
+    // A stop request ends the sync loops part way through the chunk, so
+    // what has been applied is incomplete.
+    bool ok = keepRunning;
+    qint64 applyTime = timer.elapsed();
+    if (ok && !transaction.exec("release syncchunk")) {
+        QLOG_ERROR() << "Unable to commit sync chunk: " << transaction.lastError();
+        ok = false;
+    }
+    if (!ok) {
+        transaction.exec("rollback to syncchunk");
+        transaction.exec("release syncchunk");
+        transaction.finish();
+        pendingSignals.clear();
+        for (int i=0; i<writers.size(); i++)
+            delete writers[i];
+        QLOG_DEBUG() << "Sync chunk rolled back";
+        return false;
+    }
+    transaction.finish();
+    QLOG_DEBUG() << "Sync chunk applied in" << applyTime << "ms & committed in" << timer.elapsed()-applyTime << "ms";
+
+    for (int i=0; i<writers.size(); i++)
+        imageWriters.start(writers[i]);
+    emitPendingSignals();
+    return true;
+}
+
+
+
+// Hold a GUI notification until the current chunk has been committed
+void SyncRunner::queueSignal(PendingSignalType type, qint32 lid, QString name, QString extra,
+                             qint32 account, bool linked, bool shared) {
+    PendingSignal pending;
+    pending.type = type;
+    pending.lid = lid;
+    pending.name = name;
+    pending.extra = extra;
+    pending.account = account;
+    pending.linked = linked;
+    pending.shared = shared;
+    pendingSignals.append(pending);
+}
+
+
+
+// Send any notifications held back while the last chunk was applied
+void SyncRunner::emitPendingSignals() {
+    for (int i=0; i<pendingSignals.size(); i++) {
+        const PendingSignal &p = pendingSignals[i];
+        switch (p.type) {
+        case NoteUpdatedSignal:
+            emit noteUpdated(p.lid);
+            break;
+        case NotebookUpdatedSignal:
+            emit notebookUpdated(p.lid, p.name, p.extra, p.linked, p.shared);
+            break;
+        case TagUpdatedSignal:
+            emit tagUpdated(p.lid, p.name, p.extra, p.account);
+            break;
+        case SearchUpdatedSignal:
+            emit searchUpdated(p.lid, p.name);
+            break;
+        case NotebookExpungedSignal:
+            emit notebookExpunged(p.lid);
+            break;
+        case TagExpungedSignal:
+            emit tagExpunged(p.lid);
+            break;
+        case SearchExpungedSignal:
+            emit searchExpunged(p.lid);
+            break;
+        }
+    }
+    pendingSignals.clear();
 }
 
 
@@ -386,7 +522,7 @@ void SyncRunner::syncRemoteExpungedNotebooks(QList<Guid> guids) {
         int lid = notebookTable.getLid(guids[i]);
         notebookTable.expunge(guids[i]);
         if (!finalSync)
-            emit notebookExpunged(lid);
+            queueSignal(NotebookExpungedSignal, lid);
     }
     QLOG_TRACE() << "Leaving SyncRunner::syncRemoteExpungedNotebooks";
 }
@@ -400,7 +536,7 @@ void SyncRunner::syncRemoteExpungedTags(QList<Guid> guids) {
         int lid = tagTable.getLid(guids[i]);
         tagTable.expunge(guids[i]);
         if (!finalSync)
-            emit tagExpunged(lid);
+            queueSignal(TagExpungedSignal, lid);
     }
     QLOG_TRACE() << "Leaving SyncRunner::syncRemoteExpungedTags";
 }
@@ -414,7 +550,7 @@ void SyncRunner::syncRemoteExpungedSavedSearches(QList<Guid> guids) {
         int lid = searchTable.getLid(guids[i]);
         searchTable.expunge(guids[i]);
         if (!finalSync)
-            emit searchExpunged(lid);
+            queueSignal(SearchExpungedSignal, lid);
     }
     QLOG_TRACE() << "Leaving SyncRunner::syncRemoteExpungedSavedSearches";
 }
@@ -461,9 +597,9 @@ void SyncRunner::syncRemoteTags(QList<Tag> tags, qint32 account) {
             parentGuid = t.parentGuid;
         if (!finalSync) {
             if (t.name.isSet())
-                emit tagUpdated(lid, t.name, parentGuid, account);
+                queueSignal(TagUpdatedSignal, lid, t.name, parentGuid, account);
             else
-                emit(tagUpdated(lid, "", parentGuid, account));
+                queueSignal(TagUpdatedSignal, lid, "", parentGuid, account);
             }
     }
 
@@ -488,9 +624,9 @@ void SyncRunner::syncRemoteSearches(QList<SavedSearch> searches) {
         }
         if (!finalSync) {
             if (t.name.isSet())
-                emit searchUpdated(lid, t.name);
+                queueSignal(SearchUpdatedSignal, lid, t.name);
             else
-                emit searchUpdated(lid, "");
+                queueSignal(SearchUpdatedSignal, lid);
         }
     }
 
@@ -552,9 +688,9 @@ void SyncRunner::syncRemoteNotebooks(QList<Notebook> books, qint32 account) {
         }
         if (!finalSync) {
             if (t.name.isSet())
-                emit notebookUpdated(lid, t.name, stack, false, shared);
+                queueSignal(NotebookUpdatedSignal, lid, t.name, stack, 0, false, shared);
             else
-                emit notebookUpdated(lid, "", stack, false, shared);
+                queueSignal(NotebookUpdatedSignal, lid, "", stack, 0, false, shared);
         }
     }
     QLOG_TRACE() << "Leaving SyncRunner::syncRemoteNotebooks";
@@ -577,8 +713,13 @@ void SyncRunner::syncRemoteNotes(QList<Note> notes, qint32 account) {
                 qint32 conflictNotebook = bookTable.getConflictNotebook();
                 noteTable.updateNotebook(newLid, conflictNotebook, true);
                 if (!finalSync)
-                    emit noteUpdated(newLid);
-             }
+                    queueSignal(NoteUpdatedSignal, newLid);
+            } else if (t.updateSequenceNum.isSet() &&
+                       noteTable.getUpdateSequenceNumber(lid) == t.updateSequenceNum) {
+                // We already have this exact version (typically a full
+                // resync), so there is nothing to rewrite.
+                continue;
+            }
             noteTable.sync(lid, notes.at(i), account);
         } else {
             noteTable.sync(t, account);
@@ -590,7 +731,7 @@ void SyncRunner::syncRemoteNotes(QList<Note> notes, qint32 account) {
             global.cache.remove(lid);
         }
         if (!finalSync)
-            emit noteUpdated(lid);
+            queueSignal(NoteUpdatedSignal, lid);
     }
 
     QLOG_TRACE() << "Leaving SyncRunner::syncRemoteNotes";
@@ -606,9 +747,13 @@ void SyncRunner::syncRemoteResources(QList<Resource> resources) {
     for (int i=0; i<resources.size(); i++) {
         Resource r = resources[i];
         qint32 lid = resTable.getLid(r.noteGuid, r.guid);
-        if (lid > 0)
+        if (lid > 0) {
+            // Skip resources we already have at this version
+            if (r.updateSequenceNum.isSet() && !resTable.isDirty(lid) &&
+                    resTable.getUpdateSequenceNumber(lid) == r.updateSequenceNum)
+                continue;
             resTable.sync(lid, r);
-        else
+        } else
             resTable.sync(r);
     }
     QLOG_TRACE() << "Leaving SyncRunner::syncRemoteResources";
@@ -630,7 +775,7 @@ void SyncRunner::syncRemoteLinkedNotebooksChunk(QList<LinkedNotebook> books) {
         if (lbk.username.isSet())
             username = lbk.username;
         if (!finalSync)
-            emit notebookUpdated(lid, sharename, username, true, false);
+            queueSignal(NotebookUpdatedSignal, lid, sharename, username, 0, true, false);
     }
     QLOG_TRACE_OUT();
 }
@@ -645,36 +790,79 @@ bool SyncRunner::syncRemoteLinkedNotebooksActual() {
     QList<qint32> lids;
     ltable.getAll(lids);
     bool fs;
+
+    // Authenticate to every linked notebook & get its sync state first.
+    // Usually only a few have changed, so these round trips are most of
+    // the time spent here.  Several are done at once, but only a couple
+    // at a time against any one shard.
+    LinkedSyncChecker checker(comm->getAuthToken(), global.syncFetchCount, LINKED_SYNC_SHARD_LIMIT);
+    connect(&checker, SIGNAL(progress(int,int)), this, SLOT(linkedNotebookChecked(int,int)));
     for (int i=0; i<lids.size(); i++) {
         LinkedNotebook book;
+        ltable.get(book, lids[i]);
+        checker.addNotebook(lids[i], book);
+    }
+    checker.check();
+
+    // Retrying one by one would only be refused again, so stop here
+    if (checker.rateLimitReached) {
+        int duration = checker.rateLimitDuration/60+1;
+        comm->error.type = CommunicationError::RateLimitExceeded;
+        comm->error.message = tr("API rate limit exceeded.  Please try again in ") +QString::number(duration)+ tr(" minutes.");
+        this->communicationErrorHandler();
+        error = true;
+        QLOG_TRACE_OUT();
+        return false;
+    }
+
+    // A notebook that fails is skipped so the rest can still be synchronized.
+    int failures = 0;
+    for (int i=0; i<lids.size() && keepRunning; i++) {
+        LinkedSyncChecker::Result check = checker.results[lids[i]];
+        LinkedNotebook book = check.book;
         qint32 usn = ltable.getLastUpdateSequenceNumber(lids[i]);
         qint32 startingUSN = usn;
-        ltable.get(book, lids[i]);
         int chunkSize = 5000;
+        QString sharename = "";
+        if (book.shareName.isSet())
+            sharename = book.shareName;
 
-        // If the share key is set, we need to authenticate
-        if (!comm->authenticateToLinkedNotebookShard(book)) {
-
-            // If we can't authenticate, we just gid of the notebook
-            // because the user probably stopped sharing.
-            qint32 linkedLid=0;
-            LinkedNotebookTable ntable(db);
-            linkedLid = ntable.getLid(book.guid);
-            ntable.expunge(book.guid);
-            emit notebookExpunged(linkedLid);
-            return true;
-
-            //this->communicationErrorHandler();
-            //error = true;
-            //return false;
+        // If we can't authenticate, we just get rid of the notebook
+        // because the user probably stopped sharing.
+        if (check.status == LinkedSyncChecker::AuthenticationFailed) {
+            QLOG_INFO() << "Unable to authenticate to shared notebook " << sharename << ": " << check.message;
+            ltable.expunge(lids[i]);
+            if (!finalSync)
+                emit notebookExpunged(lids[i]);
+            continue;
         }
-        bool more = true;
+
         SyncState syncState;
-        if (!comm->getLinkedNotebookSyncState(syncState, book)) {
-            this->communicationErrorHandler();
-            error = true;
-            return false;
+        if (check.status == LinkedSyncChecker::Ready) {
+            if (check.syncState.updateCount <= usn && !linkedNotesPending(lids[i])) {
+                QLOG_DEBUG() << "Shared notebook " << sharename << " is up to date";
+                continue;
+            }
+            syncState = check.syncState;
+            comm->useLinkedNotebook(book, check.token);
+        } else {
+            // The quick check didn't work, so try it again the slow way
+            if (!comm->authenticateToLinkedNotebookShard(book) ||
+                    !comm->getLinkedNotebookSyncState(syncState, book)) {
+                QLOG_ERROR() << "Unable to check shared notebook " << sharename;
+                this->communicationErrorHandler();
+                if (apiRateLimitExceeded) {
+                    error = true;
+                    QLOG_TRACE_OUT();
+                    return false;
+                }
+                failures++;
+                continue;
+            }
         }
+
+        bool more = true;
+        bool failed = false;
         if (syncState.updateCount <= usn)
             more=false;
         qint32 startingSequenceNumber = usn;
@@ -695,18 +883,15 @@ bool SyncRunner::syncRemoteLinkedNotebooksActual() {
                         emit(notebookExpunged(lids[i]));
                 } else {
                     this->communicationErrorHandler();
-                    error = true;
-                    QLOG_TRACE_OUT();
-                    return false;
+                    failed = true;
                 }
+            } else if (!processSyncChunk(chunk, lids[i])) {
+                more = false;
+                failed = true;
             } else {
-                processSyncChunk(chunk, lids[i]);
                 usn = chunk.chunkHighUSN;
                 if (chunk.updateCount > 0 && chunk.updateCount > startingSequenceNumber) {
                     int pct = (usn-startingSequenceNumber)*100/(chunk.updateCount-startingSequenceNumber);
-                    QString sharename = "";
-                    if (book.shareName.isSet())
-                        sharename = book.shareName;
                     emit setMessage(tr("Downloading ") +QString::number(pct) + tr("% complete for tags in shared notebook ") +sharename + tr("."), defaultMsgTimeout);
                 }
                 if (!chunk.chunkHighUSN.isSet()|| chunk.chunkHighUSN >= chunk.updateCount)
@@ -717,15 +902,11 @@ bool SyncRunner::syncRemoteLinkedNotebooksActual() {
         //************* STARTING PASS 2
 
         usn = startingUSN;
-        more = true;
+        more = !failed;
         chunkSize = 50;
-        if (error == true)
-            more=false;
 
-        QString sharename = "";
-        if (book.shareName.isSet())
-            sharename = book.shareName;
-        emit setMessage(tr("Downloading notes for shared notebook ") +sharename + tr("."), defaultMsgTimeout);
+        if (more)
+            emit setMessage(tr("Downloading notes for shared notebook ") +sharename + tr("."), defaultMsgTimeout);
         while (more && keepRunning) {
             SyncChunk chunk;
             if (!comm->getLinkedNotebookSyncChunk(chunk, book, usn, chunkSize, fs)) {
@@ -736,38 +917,78 @@ bool SyncRunner::syncRemoteLinkedNotebooksActual() {
                         emit(notebookExpunged(lids[i]));
                 } else {
                     this->communicationErrorHandler();
-                    error = true;
-                    return false;
+                    failed = true;
                 }
+            } else if (!processSyncChunk(chunk, lids[i])) {
+                more = false;
+                failed = true;
             } else {
-                processSyncChunk(chunk, lids[i]);
                 usn = chunk.chunkHighUSN;
                 if (chunk.updateCount > 0 && chunk.updateCount > startingSequenceNumber) {
                     int pct = (usn-startingSequenceNumber)*100/(chunk.updateCount-startingSequenceNumber);
-                    QString sharename = "";
-                    if (book.shareName.isSet())
-                        sharename = book.shareName;
                     emit setMessage(tr("Downloading ") +QString::number(pct) + tr("% complete for shared notebook ") +sharename + tr("."), defaultMsgTimeout);
                 }
                 if (!chunk.chunkHighUSN.isSet() || chunk.chunkHighUSN >= chunk.updateCount) {
                     more = false;
                     ltable.setLastUpdateSequenceNumber(lids[i], syncState.updateCount);
+                } else {
+                    // Checkpoint so an interrupted sync picks up from here
+                    ltable.setLastUpdateSequenceNumber(lids[i], usn);
                 }
             }
         }
 
+        if (failed) {
+            QLOG_ERROR() << "Synchronization of shared notebook " << sharename << " failed";
+            if (apiRateLimitExceeded) {
+                error = true;
+                QLOG_TRACE_OUT();
+                return false;
+            }
+            failures++;
+            continue;
+        }
+
         qint32 noteUSN = uploadLinkedNotes(lids[i]);
         if (noteUSN > usn)
             ltable.setLastUpdateSequenceNumber(lids[i], noteUSN);
     }
     TagTable tagTable(db);
     tagTable.cleanupLinkedTags();
+    if (failures > 0)
+        emit setMessage(QString::number(failures) + tr(" shared notebook(s) could not be synchronized."), defaultMsgTimeout);
     QLOG_TRACE_OUT();
     return true;
 }
 
 
 
+// Does a linked notebook have local changes waiting to be uploaded?
+bool SyncRunner::linkedNotesPending(qint32 notebookLid) {
+    NoteTable noteTable(db);
+    QList<qint32> dirtyLids;
+    noteTable.getAllDirty(dirtyLids, notebookLid);
+    if (dirtyLids.size() > 0)
+        return true;
+
+    NotebookTable bookTable(db);
+    QString notebookGuid = "";
+    bookTable.getGuid(notebookGuid, notebookLid);
+    QStringList deleteQueueGuids;
+    noteTable.getAllDeleteQueue(deleteQueueGuids, notebookGuid);
+    return deleteQueueGuids.size() > 0;
+}
+
+
+
+// Report progress while checking linked notebooks
+void SyncRunner::linkedNotebookChecked(int completed, int total) {
+    emit setMessage(tr("Checked ") + QString::number(completed) + tr(" of ") + QString::number(total)
+                    + tr(" shared notebooks."), defaultMsgTimeout);
+}
+
+
+
 // Upload notes that belong to me
 qint32 SyncRunner::uploadLinkedNotes(qint32 notebookLid) {
     QLOG_TRACE_IN();
@@ -788,7 +1009,6 @@ qint32 SyncRunner::uploadLinkedNotes(qint32 notebookLid) {
     // Start deleting notes
     for (int i=0; i<deletedLids.size(); i++) {
         QString guid = noteTable.getGuid(deletedLids[i]);
-        noteTable.setDirty(lids[i], false);
         usn = comm->deleteLinkedNote(guid);
         if (usn > maxUsn) {
             maxUsn = usn;
@@ -1095,50 +1315,27 @@ qint32 SyncRunner::uploadPersonalNotes() {
     QLOG_TRACE_IN();
     qint32 usn;
     qint32 maxUsn = 0;
-    NotebookTable notebookTable(db);
-    LinkedNotebookTable linkedNotebookTable(db);
     NoteTable noteTable(db);
-    QList<qint32> lids, validLids, deletedLids, movedLids;
+    QList<qint32> validLids, deletedLids, movedLids;
     QStringList deleteQueueGuids;
-    noteTable.getAllDirty(lids);
+
+    // Get a list of all notes that are both dirty and in an account we own
+    noteTable.getDirtyPersonalNotes(validLids, deletedLids, movedLids);
 
     // Get all of the notes that were deleted, and then removed from the trash
     noteTable.getAllDeleteQueue(deleteQueueGuids);
 
-
-    // Get a list of all notes that are both dirty and in an account we own and isn't deleted
-    for (int i=0; i<lids.size(); i++) {
-        qint32 notebookLid = noteTable.getNotebookLid(lids[i]);
-        if (!linkedNotebookTable.exists(notebookLid)) {
-            if (!notebookTable.isLocal(notebookLid)) {
-                if (noteTable.isDeleted(lids[i]))
-                    deletedLids.append(lids[i]);
-                else
-                    validLids.append(lids[i]);
-            } else {
-                // We have a note that is local.  Check if it was once
-                // synchronized.  If so, it was moved to a local notebook
-                // and now needs to be deleted on the remote end
-                Note n;
-                noteTable.get(n, lids[i], false, false);
-                if (n.updateSequenceNum.isSet() && n.updateSequenceNum > 0) {
-                    movedLids.append(lids[i]);
-                }
-            }
-        }
-    }
-
     // Start deleting notes
+    QList<NoteUploader::Result> synchronized;
     for (int i=0; i<deletedLids.size(); i++) {
         QString guid = noteTable.getGuid(deletedLids[i]);
-        noteTable.setDirty(lids[i], false);
         usn = comm->deleteNote(guid);
-        if (usn > maxUsn) {
-            maxUsn = usn;
-            noteTable.setUpdateSequenceNumber(deletedLids[i], usn);
-            noteTable.setDirty(deletedLids[i], false);
-            if (!finalSync)
-                emit(noteSynchronized(deletedLids[i], false));
+        if (usn > 0) {
+            NoteUploader::Result result;
+            result.lid = deletedLids[i];
+            result.updateSequenceNum = usn;
+            result.created = false;
+            synchronized.append(result);
         }
     }
 
@@ -1152,7 +1349,7 @@ qint32 SyncRunner::uploadPersonalNotes() {
         QString guid = noteTable.getGuid(movedLids[i]);
         noteTable.setDirty(movedLids[i], false);
         noteTable.updateGuid(movedLids[i], newGuid);
-        noteTable.setUpdateSequenceNumber(movedLids[0], 0);
+        noteTable.setUpdateSequenceNumber(movedLids[i], 0);
         usn = comm->deleteNote(guid);
         if (usn > maxUsn) {
             maxUsn = usn;
@@ -1173,36 +1370,31 @@ qint32 SyncRunner::uploadPersonalNotes() {
     }
 
 
-    // Start uploading notes
-    for (int i=0; i<validLids.size(); i++) {
-        Note note;
-        noteTable.get(note, validLids[i],true, true);
+    // Start uploading notes.  Several are sent at once.
+    QList<NoteUploader::Result> uploaded;
+    if (validLids.size() > 0 && !comm->uploadNotes(validLids, uploaded)) {
+        this->communicationErrorHandler();
+        QLOG_ERROR() << tr("Error uploading notes");
+        error = true;
+    }
+    synchronized.append(uploaded);
 
-        qint32 oldUsn=0;
-        if (note.updateSequenceNum.isSet())
-            oldUsn = note.updateSequenceNum;
-        usn = comm->uploadNote(note);
-        if (usn == 0) {
-            this->communicationErrorHandler();
-            if (note.title.isSet())
-                QLOG_ERROR() << tr("Error uploading note:") +note.title;
-            else
-                QLOG_ERROR() << tr("Error uploading note with a missing title!");
-            error = true;
-            //return maxUsn;
-        }
-        if (usn > maxUsn) {
-            maxUsn = usn;
-            if (oldUsn == 0)
-                noteTable.updateGuid(validLids[i], note.guid);
-            noteTable.setUpdateSequenceNumber(validLids[i], usn);
-            noteTable.setDirty(validLids[i], false);
-            if (!finalSync)
-                emit(noteSynchronized(validLids[i], false));
-        } else {
-            error = true;
-        }
+    // Record everything Evernote accepted in one transaction.  If that
+    // fails the notes are still dirty, so don't report a USN past them.
+    if (!NoteUploader::save(db, synchronized)) {
+        QLOG_ERROR() << tr("Error recording uploaded notes");
+        error = true;
+        QLOG_TRACE_OUT();
+        return 0;
+    }
+    for (int i=0; i<synchronized.size(); i++) {
+        if (synchronized[i].updateSequenceNum > maxUsn)
+            maxUsn = synchronized[i].updateSequenceNum;
     }
+
+    for (int i=0; i<synchronized.size() && !finalSync; i++)
+        emit(noteSynchronized(synchronized[i].lid, false));
+
     QLOG_TRACE_OUT();
     return maxUsn;
 }
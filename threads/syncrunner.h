@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QHash>
 #include <QVector>
 #include <QTimer>
+#include <QThreadPool>
 #include "communication/communicationmanager.h"
 #include "sql/databaseconnection.h"
 
@@ -38,6 +39,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "qevercloud/include/QEverCloud.h"
 using namespace qevercloud;
 
+// Most linked notebooks checked at the same time on any one shard
+#define LINKED_SYNC_SHARD_LIMIT 2
+
 class SyncRunner : public QObject
 {
     Q_OBJECT
@@ -71,11 +75,32 @@ private:
     QHash<QString, QString> changedNotebooks;
     QHash<QString, QString> changedTags;
 
+    // GUI notifications raised while a sync chunk is being applied.  They are
+    // held until the chunk is committed so the GUI never reloads stale rows.
+    enum PendingSignalType {
+        NoteUpdatedSignal, NotebookUpdatedSignal, TagUpdatedSignal, SearchUpdatedSignal,
+        NotebookExpungedSignal, TagExpungedSignal, SearchExpungedSignal
+    };
+    struct PendingSignal {
+        PendingSignalType type;
+        qint32 lid;
+        QString name;
+        QString extra;           // Parent guid for tags, stack for notebooks
+        qint32 account;
+        bool linked;
+        bool shared;
+    };
+    QList<PendingSignal> pendingSignals;
+    void queueSignal(PendingSignalType type, qint32 lid, QString name="", QString extra="",
+                     qint32 account=0, bool linked=false, bool shared=false);
+    void emitPendingSignals();
+    QThreadPool imageWriters;                // Saves thumbnail & ink note PNGs off the sync thread
+
     void evernoteSync();
     bool syncRemoteToLocal(qint32 highSequence);
     void syncRemoteExpungedNotes(QList<Guid> guids);
     void syncRemoteExpungedNotebooks(QList<Guid> guids);
-    void processSyncChunk(SyncChunk &chunk, qint32 linkedNotebook=0);
+    bool processSyncChunk(SyncChunk &chunk, qint32 linkedNotebook=0);
     void syncRemoteExpungedTags(QList<Guid> guids);
     void syncRemoteExpungedSavedSearches(QList<Guid> guid);
 
@@ -87,6 +112,7 @@ private:
     void syncRemoteLinkedNotebooksChunk(QList<LinkedNotebook> books);
     void syncRemoteExpungedLinkedNotebooks(QList<Guid> guids);
     bool syncRemoteLinkedNotebooksActual();
+    bool linkedNotesPending(qint32 notebookLid);
 
     //void checkForInkNotes(QList<Resource> &resources);
 
@@ -124,6 +150,9 @@ signals:
  public slots:
     void synchronize();
     void applicationException(QString);
+
+ private slots:
+    void linkedNotebookChecked(int completed, int total);
 };
 
 #endif // SYNCRUNNER_H
@@ -22,6 +22,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <QObject>
 #include <QHash>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
 #include <string>
 
 using namespace std;
@@ -29,16 +32,23 @@ using namespace std;
 class MimeReference : public QObject
 {
     Q_OBJECT
+    friend class TestMimeReference;
+private:
+    static QList< QPair<QString, QString> > mimeTable();
+    static QList< QPair<QString, QString> > extensionTable();
+    static bool isTextMime(QString mime);
+
 public:
     explicit MimeReference(QObject *parent = 0);
     ~MimeReference();
-    QHash<QString,QString> *table;
     QString getExtensionFromMime(QString mime, QString filename);
     QString getMimeFromExtension(QString fileExtension);
     QString getMimeFromExtension(string fileExtension);
     QString getMimeFromFileName(QString fileName);
     QString getMimeFromFileName(string filename);
     QString getExtensionFromMime(string extension, string filename);
+    QString getMimeFromData(const QByteArray &data, QString fileName);
+    static QString sniffMime(const QByteArray &data, bool *strong = NULL);
     
 signals:
     
@@ -199,7 +199,9 @@ void NoteIndexer::indexRecognition(qint32 reslid, Resource &r) {
 
     QLOG_TRACE() << "Beginning insertion of recognition:";
     QLOG_TRACE() << "Anchors found: " << anchors.length();
-    sql.exec("begin;");
+    // A savepoint rather than begin/commit, since this may run inside the
+    // transaction of a sync chunk.
+    sql.exec("savepoint indexRecognition");
 #if QT_VERSION < 0x050000
     for (unsigned int i=0;  i<anchors.length(); i++) {
 #else
@@ -225,7 +227,7 @@ void NoteIndexer::indexRecognition(qint32 reslid, Resource &r) {
         }
     }
     QLOG_TRACE() << "Committing";
-    sql.exec("commit");
+    sql.exec("release indexRecognition");
     QLOG_TRACE_OUT();
 }
 
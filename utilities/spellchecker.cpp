@@ -45,6 +45,7 @@ SpellChecker::SpellChecker(QObject *parent) :
     dictionaryPath.append("/usr/lib/openoffice.org2.0/share/dict/ooo/");
 
     error = false;
+    hunspell = NULL;
 }
 
 
@@ -90,21 +91,35 @@ void SpellChecker::setup(QString programDictionary, QString customDictionary) {
 
 
 bool SpellChecker::spellCheck(QString word, QStringList &suggestions) {
-    int isValid = hunspell->spell(word.toStdString().c_str());
-    suggestions.empty();
+    suggestions.clear();
+    if (hunspell == NULL)
+        return true;
+    std::string w = word.toStdString();
+    int isValid = hunspell->spell(w.c_str());
     if (isValid) {
         return true;
     }
     char **wlst;
-    int ns = hunspell->suggest(&wlst,word.toStdString().c_str());
+    int ns = hunspell->suggest(&wlst,w.c_str());
     for (int i=0; i < ns; i++) {
       suggestions.append(QString::fromStdString(wlst[i]));
     }
+    hunspell->free_list(&wlst, ns);
     return false;
 }
 
 
+// Check a word without looking up suggestions, which is much slower.
+bool SpellChecker::isCorrect(QString word) {
+    if (hunspell == NULL)
+        return true;
+    return hunspell->spell(word.toStdString().c_str()) != 0;
+}
+
+
 void SpellChecker::addWord(QString dictionary, QString word) {
+    if (hunspell == NULL)
+        return;
     hunspell->add(word.toStdString().c_str());
 
     // Append to the end of the user dictionary
@@ -112,6 +127,6 @@ void SpellChecker::addWord(QString dictionary, QString word) {
     QFile f(dictionary);
     f.open(QIODevice::Append);
     QTextStream out(&f);
-    out << word;
+    out << word << "\n";
     f.close();
 }
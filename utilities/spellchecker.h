@@ -43,6 +43,7 @@ public:
     explicit SpellChecker(QObject *parent = 0);
     void setup(QString programDictionary, QString customDictionary);
     bool spellCheck(QString word, QStringList &suggestions);
+    bool isCorrect(QString word);
     void addWord(QString dictionary, QString word);
     
 signals:
@@ -0,0 +1,205 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#include "spellcheckservice.h"
+#include <QMutexLocker>
+#include <QLocale>
+
+
+
+// Checks a block of text on the service's thread
+class SpellCheckTask : public QRunnable
+{
+public:
+    SpellCheckService *service;
+    int request;
+    QString text;
+
+    void run() {
+        service->runCheck(request, text);
+    }
+};
+
+
+
+SpellCheckService::SpellCheckService(QObject *parent) :
+    QObject(parent)
+{
+    checker = NULL;
+    latestRequest.fetchAndStoreRelaxed(0);
+
+    // One thread, so requests are handled in the order they are made
+    pool.setMaxThreadCount(1);
+    qRegisterMetaType< QList<SpellCheckRange> >("QList<SpellCheckRange>");
+}
+
+
+
+SpellCheckService *SpellCheckService::instance() {
+    static SpellCheckService *service = new SpellCheckService();
+    return service;
+}
+
+
+
+// Load the dictionaries.  This is only done once, no matter how many
+// editors ask for it.
+void SpellCheckService::initialize(HunspellInterface *checker, QString programDictionary, QString userDictionary) {
+    QMutexLocker locker(&lock);
+    if (this->checker == checker)
+        return;
+    checker->initialize(programDictionary, userDictionary);
+    this->checker = checker;
+    dictionary = QLocale::system().name();
+}
+
+
+
+// Split text into words.  Apostrophes are kept when they are inside a
+// word (don't, O'Neil) and anything without a letter in it is skipped.
+void SpellCheckService::tokenize(const QString &text, QList<SpellCheckRange> &words) {
+    words.clear();
+    int start = -1;
+    bool hasLetter = false;
+    int length = text.length();
+    for (int i=0; i<=length; i++) {
+        bool wordChar = false;
+        if (i < length) {
+            QChar c = text[i];
+            if (c.isLetterOrNumber())
+                wordChar = true;
+            else if ((c == QChar('\'') || c == QChar(0x2019)) && start >= 0 &&
+                     i+1 < length && text[i+1].isLetter())
+                wordChar = true;
+        }
+        if (wordChar) {
+            if (start < 0)
+                start = i;
+            if (text[i].isLetter())
+                hasLetter = true;
+            continue;
+        }
+        if (start >= 0 && hasLetter) {
+            SpellCheckRange range;
+            range.start = start;
+            range.length = i-start;
+            range.word = text.mid(start, i-start);
+            words.append(range);
+        }
+        start = -1;
+        hasLetter = false;
+    }
+}
+
+
+
+// Start checking a block of text.  The result is sent by the checked()
+// signal.  If another check is started before this one finishes, this one
+// is abandoned.
+int SpellCheckService::check(QString text) {
+    int request = latestRequest.fetchAndAddRelaxed(1)+1;
+    SpellCheckTask *task = new SpellCheckTask();
+    task->service = this;
+    task->request = request;
+    task->text = text;
+    pool.start(task);
+    return request;
+}
+
+
+
+// Check the words in a block of text.  Each word is only looked up once.
+void SpellCheckService::runCheck(int request, QString text) {
+    QList<SpellCheckRange> words;
+    tokenize(text, words);
+
+    // Find the words we haven't seen before
+    QSet<QString> unknown;
+    lock.lock();
+    if (checker == NULL) {
+        lock.unlock();
+        return;
+    }
+    const QHash<QString, bool> &known = verdicts[dictionary];
+    for (int i=0; i<words.size(); i++) {
+        if (!known.contains(words[i].word))
+            unknown.insert(words[i].word);
+    }
+    lock.unlock();
+
+    // Look them up.  The lock is taken for each word so someone
+    // waiting on a suggestion doesn't wait for the whole note.
+    QSet<QString>::const_iterator it;
+    for (it = unknown.constBegin(); it != unknown.constEnd(); ++it) {
+        if (latestRequest.fetchAndAddRelaxed(0) != request)
+            return;
+        QMutexLocker locker(&lock);
+        verdicts[dictionary].insert(*it, checker->isCorrect(*it));
+    }
+
+    QList<SpellCheckRange> misspelled;
+    lock.lock();
+    const QHash<QString, bool> &results = verdicts[dictionary];
+    for (int i=0; i<words.size(); i++) {
+        if (!results.value(words[i].word, true))
+            misspelled.append(words[i]);
+    }
+    lock.unlock();
+    emit checked(request, misspelled);
+}
+
+
+
+bool SpellCheckService::isCorrect(QString word) {
+    QMutexLocker locker(&lock);
+    if (checker == NULL)
+        return true;
+    QHash<QString, bool> &known = verdicts[dictionary];
+    if (!known.contains(word))
+        known.insert(word, checker->isCorrect(word));
+    return known.value(word);
+}
+
+
+
+QStringList SpellCheckService::suggestions(QString word) {
+    QMutexLocker locker(&lock);
+    if (checker == NULL)
+        return QStringList();
+    QHash<QString, QStringList> &cache = suggestionCache[dictionary];
+    if (!cache.contains(word)) {
+        QStringList list;
+        checker->spellCheck(word, list);
+        cache.insert(word, list);
+    }
+    return cache.value(word);
+}
+
+
+
+void SpellCheckService::addWord(QString dictionaryFile, QString word) {
+    QMutexLocker locker(&lock);
+    if (checker == NULL)
+        return;
+    checker->addWord(dictionaryFile, word);
+    verdicts[dictionary].insert(word, true);
+    suggestionCache[dictionary].remove(word);
+}
+
@@ -0,0 +1,85 @@
+/*********************************************************************************
+NixNote - An open-source client for the Evernote service.
+Copyright (C) 2015 Randy Baumgarte
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+***********************************************************************************/
+
+
+#ifndef SPELLCHECKSERVICE_H
+#define SPELLCHECKSERVICE_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QMetaType>
+#include "plugins/hunspell/hunspellinterface.h"
+
+// A misspelled word found in a block of text
+class SpellCheckRange
+{
+public:
+    int start;
+    int length;
+    QString word;
+};
+
+Q_DECLARE_METATYPE(QList<SpellCheckRange>)
+
+
+//*************************************
+//* Checks the spelling of a block of
+//* text in the background.  Each word
+//* is only looked up once for each
+//* dictionary, no matter how many notes
+//* it appears in.  Suggestions are only
+//* looked up when they are asked for.
+//*************************************
+
+class SpellCheckService : public QObject
+{
+    Q_OBJECT
+    friend class SpellCheckTask;
+
+private:
+    HunspellInterface *checker;
+    QString dictionary;                                          // The dictionary being used
+    QHash<QString, QHash<QString, bool> > verdicts;              // Is a word spelled correctly? (by dictionary)
+    QHash<QString, QHash<QString, QStringList> > suggestionCache;  // Suggested spellings (by dictionary)
+    QMutex lock;                                                 // Hunspell isn't thread safe
+    QAtomicInt latestRequest;                                    // Older requests are abandoned
+    QThreadPool pool;
+    void runCheck(int request, QString text);
+
+public:
+    explicit SpellCheckService(QObject *parent = 0);
+    static SpellCheckService *instance();                        // The service shared by all the editors
+    static void tokenize(const QString &text, QList<SpellCheckRange> &words);   // Split text into words
+    void initialize(HunspellInterface *checker, QString programDictionary, QString userDictionary);
+    int check(QString text);                                     // Start checking text.  Returns the request number
+    bool isCorrect(QString word);                                // Check a single word
+    QStringList suggestions(QString word);                       // Get the suggested spellings of a word
+    void addWord(QString dictionaryFile, QString word);          // Add a word to the user's dictionary
+
+signals:
+    void checked(int request, QList<SpellCheckRange> misspelled);   // A check has finished
+};
+
+#endif // SPELLCHECKSERVICE_H
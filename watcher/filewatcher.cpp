@@ -148,7 +148,7 @@ void FileWatcher::saveFile(QString file) {
         newNoteBody.append(newNote.content);
 
     MimeReference mimeRef;
-    QString mime = mimeRef.getMimeFromFileName(file);
+    QString mime = mimeRef.getMimeFromData(data, file);
     QString enMedia =QString("<en-media hash=\"") +hash.toHex() +QString("\" border=\"0\"")
             +QString(" type=\"" +mime +"\" ")
             +QString("/>");
@@ -241,11 +241,7 @@ qint32 BatchImport::addNoteNode() {
                         QByteArray ba = file.readAll();
                         file.close();
                         MimeReference mimeRef;
-                        QString extension = filename;
-                        int endPos = filename.lastIndexOf(".");
-                        if (endPos != -1)
-                            extension = extension.mid(endPos);
-                        QString mime =  mimeRef.getMimeFromExtension(extension);
+                        QString mime = mimeRef.getMimeFromData(ba, filename);
                         Resource newRes;
                         bool attachment = true;
                         if (mime == "application/pdf" || mime.startsWith("image/"))
@@ -298,11 +294,7 @@ qint32 BatchImport::addNoteNode() {
                         QByteArray ba = file.readAll();
                         file.close();
                         MimeReference mimeRef;
-                        QString extension = filename;
-                        int endPos = filename.lastIndexOf(".");
-                        if (endPos != -1)
-                            extension = extension.mid(endPos);
-                        QString mime =  mimeRef.getMimeFromExtension(extension);
+                        QString mime = mimeRef.getMimeFromData(ba, filename);
                         Resource newRes;
                         bool attachment = true;
                         if (mime == "application/pdf" || mime.startsWith("image/"))